@@ -0,0 +1,355 @@
+#include "CategoryTree.h"
+#include <QJsonObject>
+
+/**
+ * @brief CategoryTree默认构造函数
+ *
+ * 虚拟根分类占据整个区间[0, kSpan]
+ */
+CategoryTree::CategoryTree() : relabels(0) {
+    Node root;
+    root.low = 0;
+    root.high = kSpan;
+    nodes.insert(kRoot, root);
+}
+
+/**
+ * @brief 新增分类
+ *
+ * 从上级分类最后一个下级之后的空隙中取一半作为新分类的区间，空隙不够时整棵树重新编号
+ * @param id 分类ID
+ * @param name 名称
+ * @param parentId 上级分类ID
+ * @return 新增成功返回true，否则返回false
+ */
+bool CategoryTree::add(int id, const QString& name, int parentId) {
+    if (id <= 0 || nodes.contains(id) || !nodes.contains(parentId)) {
+        return false;
+    }
+
+    qint64 low = 0;
+    qint64 high = 0;
+    const bool allocated = allocate(parentId, 1, low, high);
+    Node node;
+    node.name = name;
+    node.parent = parentId;
+    node.low = low;
+    node.high = high;
+    nodes.insert(id, node);
+    nodes[parentId].children.append(id);
+    if (allocated) {
+        byLow.insert(low, id);
+    } else {
+        relabel();
+    }
+    return true;
+}
+
+/**
+ * @brief 把分类连同其下级移动到另一个上级之下
+ *
+ * 只给被移动的子树重新编号，耗时与子树大小成正比；新上级的空隙不够时整棵树重新编号
+ * @param id 分类ID
+ * @param parentId 新的上级分类ID
+ * @return 移动成功返回true，否则返回false
+ */
+bool CategoryTree::move(int id, int parentId) {
+    if (id == kRoot || !nodes.contains(id) || !nodes.contains(parentId) || isWithin(id, parentId)) {
+        return false;
+    }
+    Node& node = nodes[id];
+    if (node.parent == parentId) {
+        return true;
+    }
+
+    unlink(id);
+    nodes[node.parent].children.removeOne(id);
+    qint64 low = 0;
+    qint64 high = 0;
+    const bool allocated = allocate(parentId, subtreeSize(id), low, high);
+    node.parent = parentId;
+    nodes[parentId].children.append(id);
+    if (allocated) {
+        assign(id, low, high);
+        link(id);
+    } else {
+        relabel();
+    }
+    return true;
+}
+
+/**
+ * @brief 删除没有下级的分类，留下的空隙不回收
+ * @param id 分类ID
+ * @return 删除成功返回true，否则返回false
+ */
+bool CategoryTree::remove(int id) {
+    auto it = nodes.find(id);
+    if (id == kRoot || it == nodes.end() || !it.value().children.isEmpty()) {
+        return false;
+    }
+    byLow.remove(it.value().low);
+    nodes[it.value().parent].children.removeOne(id);
+    nodes.erase(it);
+    return true;
+}
+
+/**
+ * @brief 是否存在指定分类
+ * @param id 分类ID
+ * @return 存在返回true，否则返回false
+ */
+bool CategoryTree::contains(int id) const {
+    return id != kRoot && nodes.contains(id);
+}
+
+/**
+ * @brief 获取分类
+ * @param id 分类ID
+ * @return 分类
+ */
+CategoryTree::Category CategoryTree::category(int id) const {
+    Category result;
+    auto it = nodes.constFind(id);
+    if (id != kRoot && it != nodes.constEnd()) {
+        result.id = id;
+        result.name = it.value().name;
+        result.parentId = it.value().parent;
+    }
+    return result;
+}
+
+/**
+ * @brief 获取直接下级分类
+ * @param id 分类ID
+ * @return 下级分类ID
+ */
+QList<int> CategoryTree::children(int id) const {
+    auto it = nodes.constFind(id);
+    return it != nodes.constEnd() ? it.value().children : QList<int>();
+}
+
+/**
+ * @brief 分类是否在另一个分类的子树中
+ *
+ * 只比较两个区间，与树的深度无关
+ * @param ancestorId 子树根分类ID
+ * @param id 分类ID
+ * @return 在子树中返回true，否则返回false
+ */
+bool CategoryTree::isWithin(int ancestorId, int id) const {
+    auto ancestor = nodes.constFind(ancestorId);
+    auto node = nodes.constFind(id);
+    if (ancestor == nodes.constEnd() || node == nodes.constEnd()) {
+        return false;
+    }
+    return ancestor.value().low <= node.value().low && node.value().high <= ancestor.value().high;
+}
+
+/**
+ * @brief 获取子树中的全部分类
+ *
+ * 子树中的分类在按区间起点排序的映射中是连续的一段
+ * @param id 子树根分类ID
+ * @return 先序排列的分类ID
+ */
+QList<int> CategoryTree::subtree(int id) const {
+    QList<int> result;
+    auto node = nodes.constFind(id);
+    if (node == nodes.constEnd()) {
+        return result;
+    }
+    for (auto it = byLow.lowerBound(node.value().low); it != byLow.constEnd() && it.key() <= node.value().high; ++it) {
+        result.append(it.value());
+    }
+    return result;
+}
+
+/**
+ * @brief 获取分类数
+ * @return 分类数
+ */
+int CategoryTree::size() const {
+    return nodes.size() - 1;
+}
+
+/**
+ * @brief 获取整棵树重新编号的次数
+ * @return 次数
+ */
+int CategoryTree::relabelCount() const {
+    return relabels;
+}
+
+/**
+ * @brief 按先序导出为JSON数组
+ * @return JSON数组
+ */
+QJsonArray CategoryTree::toJson() const {
+    QJsonArray array;
+    for (int id : byLow) {
+        const Node& node = nodes[id];
+        QJsonObject object;
+        object["id"] = id;
+        object["name"] = node.name;
+        object["parentId"] = node.parent;
+        object["low"] = QString::number(node.low);
+        object["high"] = QString::number(node.high);
+        array.append(object);
+    }
+    return array;
+}
+
+/**
+ * @brief 从JSON数组加载
+ *
+ * 先建立全部节点再检查上级和环，区间存为字符串以免超出JSON数值的精度
+ * @param array JSON数组
+ * @return 加载成功返回true，否则返回false
+ */
+bool CategoryTree::loadFromJson(const QJsonArray& array) {
+    CategoryTree loaded;
+    for (const QJsonValue& value : array) {
+        const QJsonObject object = value.toObject();
+        const int id = object["id"].toInt();
+        if (id <= 0 || loaded.nodes.contains(id)) {
+            return false;
+        }
+        Node node;
+        node.name = object["name"].toString();
+        node.parent = object["parentId"].toInt();
+        node.low = object["low"].toString().toLongLong();
+        node.high = object["high"].toString().toLongLong();
+        loaded.nodes.insert(id, node);
+    }
+    for (const QJsonValue& value : array) {
+        const int id = value.toObject()["id"].toInt();
+        int steps = 0;
+        for (int current = loaded.nodes[id].parent; current != kRoot; current = loaded.nodes[current].parent) {
+            if (!loaded.nodes.contains(current) || ++steps > loaded.nodes.size()) {
+                return false;
+            }
+        }
+        loaded.nodes[loaded.nodes[id].parent].children.append(id);
+    }
+
+    // 兄弟按导出顺序（先序）排列，区间必须依次排开并嵌套在上级之内
+    bool nested = true;
+    for (auto it = loaded.nodes.constBegin(); it != loaded.nodes.constEnd() && nested; ++it) {
+        qint64 previous = it.value().low;
+        for (int child : it.value().children) {
+            const Node& node = loaded.nodes[child];
+            nested = nested && node.low > previous && node.low < node.high && node.high < it.value().high;
+            previous = node.high;
+        }
+    }
+    if (nested) {
+        loaded.link(kRoot);
+    } else {
+        loaded.relabel();
+    }
+    loaded.relabels = relabels + loaded.relabels;
+    *this = loaded;
+    return true;
+}
+
+/**
+ * @brief 在上级分类已有下级之后分配一段区间
+ *
+ * 取剩余空隙的前一半，要求每个分类至少能分到起点和终点两个位置
+ * @param parentId 上级分类ID
+ * @param count 区间中要容纳的分类数
+ * @param low 输出参数，区间起点
+ * @param high 输出参数，区间终点
+ * @return 剩余空隙足够时返回true，否则返回false
+ */
+bool CategoryTree::allocate(int parentId, int count, qint64& low, qint64& high) const {
+    const Node& parent = nodes[parentId];
+    const qint64 start = parent.children.isEmpty() ? parent.low : nodes[parent.children.last()].high;
+    const qint64 span = (parent.high - start - 1) / 2;
+    if (span < 2 * qint64(count)) {
+        return false;
+    }
+    low = start + 1;
+    high = start + span;
+    return true;
+}
+
+/**
+ * @brief 给子树重新编号
+ *
+ * 每个下级先分得容纳其子树所需的最少位置，区间内多余的位置再按子树大小分一半给下级，
+ * 另一半留在最后一个下级之后，供以后新增或移入的分类使用
+ * @param id 子树根分类ID
+ * @param low 区间起点
+ * @param high 区间终点
+ */
+void CategoryTree::assign(int id, qint64 low, qint64 high) {
+    Node& node = nodes[id];
+    node.low = low;
+    node.high = high;
+    if (node.children.isEmpty()) {
+        return;
+    }
+
+    QList<int> sizes;
+    qint64 descendants = 0;
+    for (int child : node.children) {
+        sizes.append(subtreeSize(child));
+        descendants += sizes.last();
+    }
+    const qint64 slack = (high - low - 1 - 2 * descendants) / 2;
+    qint64 next = low + 1;
+    for (int i = 0; i < node.children.size(); ++i) {
+        const qint64 span = 2 * qint64(sizes.at(i)) + slack / descendants * sizes.at(i);
+        assign(node.children.at(i), next, next + span - 1);
+        next += span;
+    }
+}
+
+/**
+ * @brief 整棵树重新编号
+ */
+void CategoryTree::relabel() {
+    assign(kRoot, 0, kSpan);
+    byLow.clear();
+    link(kRoot);
+    ++relabels;
+}
+
+/**
+ * @brief 获取子树中的分类数
+ * @param id 子树根分类ID
+ * @return 分类数
+ */
+int CategoryTree::subtreeSize(int id) const {
+    int count = 1;
+    for (int child : nodes[id].children) {
+        count += subtreeSize(child);
+    }
+    return count;
+}
+
+/**
+ * @brief 把子树的区间从按起点排序的映射中移除
+ * @param id 子树根分类ID
+ */
+void CategoryTree::unlink(int id) {
+    byLow.remove(nodes[id].low);
+    for (int child : nodes[id].children) {
+        unlink(child);
+    }
+}
+
+/**
+ * @brief 把子树的区间登记到按起点排序的映射中，虚拟根分类本身不登记
+ * @param id 子树根分类ID
+ */
+void CategoryTree::link(int id) {
+    if (id != kRoot) {
+        byLow.insert(nodes[id].low, id);
+    }
+    for (int child : nodes[id].children) {
+        link(child);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,184 @@
+#ifndef CATEGORYTREE_H
+#define CATEGORYTREE_H
+
+#include <QHash>
+#include <QJsonArray>
+#include <QList>
+#include <QMap>
+#include <QString>
+
+/**
+ * @brief 分类树类
+ *
+ * CategoryTree保存分类的名称和上级，并为每个分类维护先序区间[low, high]：
+ * 下级分类的区间严格嵌套在上级之内，兄弟分类的区间互不相交，
+ * 因此“是否属于某分类的子树”只需比较两个区间，列出子树也只需在按low排序的映射中取一段，不必递归展开。
+ * 区间之间留有空隙，新增和移动分类时只给新增的分类或被移动的子树重新编号，
+ * 空隙用尽时才整棵树重新编号
+ */
+class CategoryTree {
+public:
+    static constexpr int kRoot = 0;                  ///< 虚拟根分类ID，顶级分类的上级
+    static constexpr qint64 kSpan = qint64(1) << 62; ///< 根分类的区间长度
+
+    /**
+     * @brief 一个分类
+     */
+    struct Category {
+        int id = kRoot;       ///< 分类ID
+        QString name;         ///< 名称
+        int parentId = kRoot; ///< 上级分类ID，顶级分类为kRoot
+    };
+
+    /**
+     * @brief 默认构造函数，创建只有虚拟根分类的空树
+     */
+    CategoryTree();
+
+    /**
+     * @brief 新增分类，排在上级分类已有下级之后
+     * @param id 分类ID，必须为正且未被使用
+     * @param name 名称
+     * @param parentId 上级分类ID，kRoot表示顶级分类
+     * @return 新增成功返回true，否则返回false
+     */
+    bool add(int id, const QString& name, int parentId = kRoot);
+
+    /**
+     * @brief 把分类连同其下级移动到另一个上级之下
+     * @param id 分类ID
+     * @param parentId 新的上级分类ID，不能是该分类本身或其下级
+     * @return 移动成功返回true，否则返回false
+     */
+    bool move(int id, int parentId);
+
+    /**
+     * @brief 删除没有下级的分类
+     * @param id 分类ID
+     * @return 删除成功返回true，分类不存在或有下级时返回false
+     */
+    bool remove(int id);
+
+    /**
+     * @brief 是否存在指定分类
+     * @param id 分类ID
+     * @return 存在返回true，否则返回false
+     */
+    bool contains(int id) const;
+
+    /**
+     * @brief 获取分类
+     * @param id 分类ID
+     * @return 分类，不存在时返回默认构造的Category对象
+     */
+    Category category(int id) const;
+
+    /**
+     * @brief 获取直接下级分类
+     * @param id 分类ID，kRoot表示顶级分类
+     * @return 按顺序排列的下级分类ID
+     */
+    QList<int> children(int id) const;
+
+    /**
+     * @brief 分类是否在另一个分类的子树中
+     * @param ancestorId 子树根分类ID，kRoot表示整棵树
+     * @param id 分类ID
+     * @return id是ancestorId本身或其下级时返回true，否则返回false
+     */
+    bool isWithin(int ancestorId, int id) const;
+
+    /**
+     * @brief 获取子树中的全部分类
+     * @param id 子树根分类ID
+     * @return 先序排列的分类ID，包括id本身；分类不存在时为空
+     */
+    QList<int> subtree(int id) const;
+
+    /**
+     * @brief 获取分类数，不包括虚拟根分类
+     * @return 分类数
+     */
+    int size() const;
+
+    /**
+     * @brief 获取整棵树重新编号的次数
+     * @return 次数
+     */
+    int relabelCount() const;
+
+    /**
+     * @brief 按先序导出为JSON数组，区间一并导出
+     * @return JSON数组
+     */
+    QJsonArray toJson() const;
+
+    /**
+     * @brief 从JSON数组加载，替换现有的全部分类
+     *
+     * 导出的区间能构成合法的嵌套关系时直接使用，否则整棵树重新编号
+     * @param array toJson()导出的JSON数组
+     * @return 加载成功返回true，上级分类不存在或出现环时返回false且不修改现有分类
+     */
+    bool loadFromJson(const QJsonArray& array);
+
+private:
+    /**
+     * @brief 分类树中的一个节点
+     */
+    struct Node {
+        QString name;        ///< 名称
+        int parent = kRoot;  ///< 上级分类ID
+        qint64 low = 0;      ///< 先序区间起点
+        qint64 high = 0;     ///< 先序区间终点
+        QList<int> children; ///< 直接下级分类ID，按区间顺序排列
+    };
+
+    /**
+     * @brief 在上级分类已有下级之后分配一段区间
+     * @param parentId 上级分类ID
+     * @param count 区间中要容纳的分类数
+     * @param low 输出参数，区间起点
+     * @param high 输出参数，区间终点
+     * @return 剩余空隙足够时返回true，否则返回false
+     */
+    bool allocate(int parentId, int count, qint64& low, qint64& high) const;
+
+    /**
+     * @brief 给子树重新编号，下级按子树大小分得区间的前一半，后一半留作空隙
+     * @param id 子树根分类ID
+     * @param low 区间起点
+     * @param high 区间终点
+     */
+    void assign(int id, qint64 low, qint64 high);
+
+    /**
+     * @brief 整棵树重新编号
+     */
+    void relabel();
+
+    /**
+     * @brief 获取子树中的分类数
+     * @param id 子树根分类ID
+     * @return 分类数，包括id本身
+     */
+    int subtreeSize(int id) const;
+
+    /**
+     * @brief 把子树的区间从按起点排序的映射中移除
+     * @param id 子树根分类ID
+     */
+    void unlink(int id);
+
+    /**
+     * @brief 把子树的区间登记到按起点排序的映射中
+     * @param id 子树根分类ID
+     */
+    void link(int id);
+
+    QHash<int, Node> nodes;  ///< 分类ID到节点的映射，包括虚拟根分类
+    QMap<qint64, int> byLow; ///< 区间起点到分类ID的映射，即先序
+    int relabels;            ///< 整棵树重新编号的次数
+};
+
+#endif // CATEGORYTREE_H
\ No newline at end of file
@@ -4,19 +4,66 @@
 #include <QDebug>
 
 QString ConfigManager::getProductDataFile() {
-    // 获取应用程序数据目录
-    QString dataDir = QCoreApplication::applicationDirPath();
+    // 获取数据目录
+    QString dataDir = getDataDirectory();
     QDir dir(dataDir);
     
     // 返回商品数据文件路径
     return dir.filePath("products.json");
 }
 
+QString ConfigManager::getProductSnapshotFile() {
+    // 二进制快照与JSON数据文件位于同一目录
+    QString dataDir = getDataDirectory();
+    QDir dir(dataDir);
+    
+    // 返回商品二进制快照文件路径
+    return dir.filePath("products.snap");
+}
+
+QString ConfigManager::getProductJournalFile() {
+    // 日志文件与商品快照位于同一目录
+    QString dataDir = getDataDirectory();
+    QDir dir(dataDir);
+    
+    // 返回商品变更日志文件路径
+    return dir.filePath("products.journal");
+}
+
+QString ConfigManager::getCategoryDataFile() {
+    // 分类树与商品快照位于同一目录
+    QString dataDir = getDataDirectory();
+    QDir dir(dataDir);
+    
+    // 返回商品分类树文件路径
+    return dir.filePath("categories.json");
+}
+
 QString ConfigManager::getUserDataFile() {
-    // 获取应用程序数据目录
-    QString dataDir = QCoreApplication::applicationDirPath();
+    // 获取数据目录
+    QString dataDir = getDataDirectory();
     QDir dir(dataDir);
     
     // 返回用户数据文件路径
     return dir.filePath("users.json");
+}
+
+QString ConfigManager::getDatabaseFile() {
+    // 数据库文件与其他数据文件位于同一目录
+    QString dataDir = getDataDirectory();
+    QDir dir(dataDir);
+    
+    // 返回SQLite数据库文件路径
+    return dir.filePath("shop.db");
+}
+
+QString ConfigManager::getDataDirectory() {
+    // 未指定时数据文件位于应用程序所在目录
+    QString dataDir = QString::fromUtf8(qgetenv("SHOP_DATA_DIR"));
+    return dataDir.isEmpty() ? QCoreApplication::applicationDirPath() : dataDir;
+}
+
+QString ConfigManager::getStorageBackend() {
+    QString backend = QString::fromUtf8(qgetenv("SHOP_STORAGE_BACKEND")).toLower();
+    return backend == "sqlite" ? backend : QString("file");
 }
\ No newline at end of file
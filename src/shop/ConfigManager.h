@@ -15,12 +15,53 @@ public:
      * @return 商品数据文件路径
      */
     static QString getProductDataFile();
+
+    /**
+     * @brief 获取商品二进制快照文件路径
+     * @return 商品二进制快照文件路径
+     */
+    static QString getProductSnapshotFile();
+
+    /**
+     * @brief 获取商品变更日志文件路径
+     * @return 商品变更日志文件路径
+     */
+    static QString getProductJournalFile();
+
+    /**
+     * @brief 获取商品分类树文件路径
+     * @return 商品分类树文件路径
+     */
+    static QString getCategoryDataFile();
     
     /**
      * @brief 获取用户数据文件路径
      * @return 用户数据文件路径
      */
     static QString getUserDataFile();
+
+    /**
+     * @brief 获取SQLite数据库文件路径
+     * @return SQLite数据库文件路径
+     */
+    static QString getDatabaseFile();
+
+    /**
+     * @brief 获取数据目录
+     *
+     * 由环境变量SHOP_DATA_DIR指定，未设置时为应用程序所在目录
+     * @return 数据目录路径
+     */
+    static QString getDataDirectory();
+
+    /**
+     * @brief 获取存储后端名称
+     *
+     * 由环境变量SHOP_STORAGE_BACKEND指定，"sqlite"表示SQLite数据库，
+     * 其他值或未设置时使用文件存储
+     * @return 存储后端名称
+     */
+    static QString getStorageBackend();
 };
 
 #endif // CONFIGMANAGER_H
\ No newline at end of file
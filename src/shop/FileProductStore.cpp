@@ -0,0 +1,528 @@
+#include "FileProductStore.h"
+#include "ConfigManager.h"
+#include "ProductJsonReader.h"
+#include <QFile>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QThread>
+#include <QDebug>
+#include <algorithm>
+#include <limits>
+
+/**
+ * @brief FileProductStore默认构造函数
+ */
+FileProductStore::FileProductStore()
+    : snapshotFile(ConfigManager::getProductSnapshotFile()),
+      legacyDataFile(ConfigManager::getProductDataFile()),
+      categoryFile(ConfigManager::getCategoryDataFile()), maxId(0),
+      journal(ConfigManager::getProductJournalFile()), journalEnabled(true) {
+}
+
+/**
+ * @brief 打开快照并重放变更日志
+ * @return 存在已持久化的数据并加载成功返回true，否则返回false
+ */
+bool FileProductStore::load() {
+    bool loaded = loadSnapshot();
+
+    // 在快照之上按顺序重放日志
+    int replayed = journal.replay([this](const ProductJournal::Entry& entry) {
+        if (entry.operation == ProductJournal::Entry::Save) {
+            applySave(entry.product);
+        } else {
+            applyRemove(entry.productId);
+        }
+        maxId = qMax(maxId, entry.productId);
+    });
+
+    // 旧版JSON数据和没有卖家表的旧版快照加载后立即重写为当前版本的快照，之后启动只需映射文件
+    if (loaded && (!snapshot.isOpen() || !snapshot.hasSellerTable())) {
+        checkpoint();
+    }
+
+    return loaded || replayed > 0;
+}
+
+/**
+ * @brief 从快照文件加载商品
+ *
+ * 二进制快照只做内存映射；没有快照时导入旧版JSON数据文件
+ * @return 加载成功返回true，否则返回false
+ */
+bool FileProductStore::loadSnapshot() {
+    if (snapshot.open(snapshotFile)) {
+        maxId = qMax(maxId, snapshot.maxProductId());
+        return true;
+    }
+    return loadLegacyFile(legacyDataFile);
+}
+
+/**
+ * @brief 导入旧版JSON数据文件
+ *
+ * 映射整个文件以便多线程解析，映射失败时退化为流式读取
+ * @param fileName 数据文件路径
+ * @return 导入成功返回true，否则返回false
+ */
+bool FileProductStore::loadLegacyFile(const QString& fileName) {
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "Cannot open file for reading:" << fileName;
+        return false;
+    }
+
+    QHash<int, Product> loaded;
+    auto collect = [&loaded](const Product& product) {
+        loaded.insert(product.getProductId(), product);
+    };
+
+    bool ok;
+    QString error;
+    qint64 size = file.size();
+    uchar* mapped = size > 0 && size <= std::numeric_limits<int>::max() ? file.map(0, size) : nullptr;
+    if (mapped) {
+        QByteArray data = QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), int(size));
+        ok = ProductJsonReader::readParallel(data, QThread::idealThreadCount(), collect, &error);
+        file.unmap(mapped);
+    } else {
+        ProductJsonReader reader(&file);
+        ok = reader.read(collect);
+        error = reader.errorString();
+    }
+    file.close();
+
+    if (!ok) {
+        qDebug() << "Error parsing JSON:" << error;
+        return false;
+    }
+    // 由load()在重放日志之后转换为快照
+    merge(loaded);
+    return true;
+}
+
+/**
+ * @brief 存储中是否存在指定商品
+ * @param productId 商品ID
+ * @return 存在返回true，否则返回false
+ */
+bool FileProductStore::contains(int productId) const {
+    if (products.contains(productId)) {
+        return true;
+    }
+    return !removedIds.contains(productId) && snapshot.contains(productId);
+}
+
+/**
+ * @brief 根据ID查找商品
+ * @param productId 商品ID
+ * @return 商品对象，未找到时返回默认构造的Product对象
+ */
+Product FileProductStore::find(int productId) const {
+    auto it = products.constFind(productId);
+    if (it != products.constEnd()) {
+        return it.value();
+    }
+    // 快照中的商品在此时才解码
+    if (!removedIds.contains(productId) && snapshot.contains(productId)) {
+        return snapshot.find(productId);
+    }
+    return Product();
+}
+
+/**
+ * @brief find()能否在多个线程中同时调用
+ * @return true
+ */
+bool FileProductStore::supportsConcurrentFind() const {
+    return true;
+}
+
+/**
+ * @brief 依次访问存储中的每个商品
+ *
+ * 先访问快照之后新增或修改的商品，再按ID顺序解码快照中未被覆盖的商品
+ * @param visit 访问回调
+ */
+void FileProductStore::forEach(const std::function<void(const Product&)>& visit) const {
+    for (const Product& product : products) {
+        visit(product);
+    }
+
+    for (int i = 0; i < snapshot.count(); ++i) {
+        int productId = snapshot.productIdAt(i);
+        if (!products.contains(productId) && !removedIds.contains(productId)) {
+            visit(snapshot.productAt(i));
+        }
+    }
+}
+
+/**
+ * @brief 查找卖家的商品，耗时与该卖家的商品数成正比
+ *
+ * 快照中的商品来自快照的卖家表，跳过之后被修改或删除的；
+ * 快照之后新增或修改的商品来自内存中的卖家索引
+ * @param sellerId 卖家ID
+ * @return 按商品ID升序排列的商品列表
+ */
+QList<Product> FileProductStore::findBySellerId(int sellerId) const {
+    QList<int> productIds;
+    for (int productId : snapshot.productIdsBySeller(sellerId)) {
+        if (!products.contains(productId) && !removedIds.contains(productId)) {
+            productIds.append(productId);
+        }
+    }
+    auto it = sellerIndex.constFind(sellerId);
+    if (it != sellerIndex.constEnd()) {
+        productIds += it.value().values();
+    }
+
+    std::sort(productIds.begin(), productIds.end());
+    QList<Product> result;
+    result.reserve(productIds.size());
+    for (int productId : productIds) {
+        result.append(find(productId));
+    }
+    return result;
+}
+
+/**
+ * @brief 获取存储中的商品数
+ * @return 商品数
+ */
+int FileProductStore::count() const {
+    int overridden = 0;
+    for (auto it = products.constBegin(); it != products.constEnd(); ++it) {
+        if (snapshot.contains(it.key())) {
+            ++overridden;
+        }
+    }
+    return snapshot.count() - removedIds.size() - overridden + products.size();
+}
+
+/**
+ * @brief 获取存储中出现过的最大商品ID
+ * @return 最大商品ID
+ */
+int FileProductStore::maxProductId() const {
+    return maxId;
+}
+
+/**
+ * @brief 保存一个商品
+ *
+ * 先写日志再修改内存，保证已确认的变更不会丢失
+ * @param product 已分配ID的商品对象
+ * @return 保存成功返回true
+ */
+bool FileProductStore::save(const Product& product) {
+    if (journalEnabled) {
+        journal.appendSave(product);
+    }
+    applySave(product);
+    return true;
+}
+
+/**
+ * @brief 删除一个商品
+ * @param productId 商品ID
+ * @return 删除成功返回true，商品不存在返回false
+ */
+bool FileProductStore::remove(int productId) {
+    if (!contains(productId)) {
+        return false;
+    }
+
+    if (journalEnabled) {
+        journal.appendRemove(productId);
+    }
+    applyRemove(productId);
+    return true;
+}
+
+/**
+ * @brief 批量导入商品并落盘
+ *
+ * 导入量较小时与普通保存一样逐条写入日志后提交；达到检查点阈值时不写日志，
+ * 合并到内存后直接写出全量快照，避免同一批商品先写日志再写快照
+ * @param loaded 导入的商品，导入后内容未定义
+ * @return 落盘成功返回true，否则返回false
+ */
+bool FileProductStore::import(QHash<int, Product>& loaded) {
+    if (!journalEnabled || journal.entryCount() + loaded.size() >= checkpointThreshold()) {
+        merge(loaded);
+        return checkpoint();
+    }
+
+    for (const Product& product : loaded) {
+        journal.appendSave(product);
+    }
+    merge(loaded);
+    return commit();
+}
+
+/**
+ * @brief 把商品合并到内存中，不写日志
+ *
+ * 存储为空时直接接管整个哈希表
+ * @param loaded 导入的商品，合并后内容未定义
+ */
+void FileProductStore::merge(QHash<int, Product>& loaded) {
+    for (auto it = loaded.constBegin(); it != loaded.constEnd(); ++it) {
+        maxId = qMax(maxId, it.key());
+    }
+
+    if (products.isEmpty() && snapshot.count() == 0) {
+        products.swap(loaded);
+        for (const Product& product : products) {
+            indexSeller(product.getSellerId(), product.getProductId());
+        }
+    } else {
+        for (auto it = loaded.constBegin(); it != loaded.constEnd(); ++it) {
+            applySave(it.value());
+        }
+    }
+}
+
+/**
+ * @brief 在内存中应用一次保存
+ * @param product 商品对象
+ */
+void FileProductStore::applySave(const Product& product) {
+    auto previous = products.constFind(product.getProductId());
+    if (previous != products.constEnd()) {
+        unindexSeller(previous.value().getSellerId(), product.getProductId());
+    }
+    indexSeller(product.getSellerId(), product.getProductId());
+
+    products.insert(product.getProductId(), product);
+    removedIds.remove(product.getProductId());
+    maxId = qMax(maxId, product.getProductId());
+}
+
+/**
+ * @brief 在内存中应用一次删除
+ * @param productId 商品ID
+ */
+void FileProductStore::applyRemove(int productId) {
+    auto previous = products.constFind(productId);
+    if (previous != products.constEnd()) {
+        unindexSeller(previous.value().getSellerId(), productId);
+    }
+
+    products.remove(productId);
+    if (snapshot.contains(productId)) {
+        removedIds.insert(productId);
+    }
+}
+
+/**
+ * @brief 把商品登记到卖家索引中
+ * @param sellerId 卖家ID
+ * @param productId 商品ID
+ */
+void FileProductStore::indexSeller(int sellerId, int productId) {
+    sellerIndex[sellerId].insert(productId);
+}
+
+/**
+ * @brief 从卖家索引中移除商品，卖家没有商品时删除其条目
+ * @param sellerId 卖家ID
+ * @param productId 商品ID
+ */
+void FileProductStore::unindexSeller(int sellerId, int productId) {
+    auto it = sellerIndex.find(sellerId);
+    if (it == sellerIndex.end()) {
+        return;
+    }
+    it.value().remove(productId);
+    if (it.value().isEmpty()) {
+        sellerIndex.erase(it);
+    }
+}
+
+/**
+ * @brief 获取全部商品ID，按升序排列
+ * @return 商品ID列表
+ */
+QList<int> FileProductStore::sortedProductIds() const {
+    QList<int> changed = products.keys();
+    std::sort(changed.begin(), changed.end());
+
+    // 归并快照中的有序ID与内存中的新增/修改ID
+    QList<int> ids;
+    ids.reserve(snapshot.count() + changed.size());
+    int next = 0;
+    for (int i = 0; i < snapshot.count(); ++i) {
+        int productId = snapshot.productIdAt(i);
+        while (next < changed.size() && changed.at(next) < productId) {
+            ids.append(changed.at(next++));
+        }
+        if (next < changed.size() && changed.at(next) == productId) {
+            ids.append(changed.at(next++));
+        } else if (!removedIds.contains(productId)) {
+            ids.append(productId);
+        }
+    }
+    while (next < changed.size()) {
+        ids.append(changed.at(next++));
+    }
+    return ids;
+}
+
+/**
+ * @brief 把自上次提交以来的变更落盘
+ *
+ * 日志模式下一次性追加本批记录，否则重写整个快照文件
+ * @return 落盘成功返回true，否则返回false
+ */
+bool FileProductStore::commit() {
+    if (!journalEnabled) {
+        return checkpoint();
+    }
+
+    if (!journal.commit()) {
+        return false;
+    }
+    return checkpointIfNeeded();
+}
+
+/**
+ * @brief 日志过长时做一次检查点
+ *
+ * 日志记录数超过商品数量时才重写快照，全量写入的开销被均摊到每次变更上
+ * @return 无需检查点或检查点成功返回true，否则返回false
+ */
+bool FileProductStore::checkpointIfNeeded() {
+    if (journal.entryCount() < checkpointThreshold()) {
+        return true;
+    }
+    return checkpoint();
+}
+
+/**
+ * @brief 获取触发检查点的日志记录数
+ * @return 不小于kMinCheckpointEntries的当前商品记录数
+ */
+int FileProductStore::checkpointThreshold() const {
+    return qMax(kMinCheckpointEntries, snapshot.count() + products.size());
+}
+
+/**
+ * @brief 写出二进制全量快照并清空变更日志（检查点）
+ *
+ * 把快照与内存中的变更合并写成新的二进制快照。先写入临时文件，
+ * 全部写完后再原子地替换原快照，写入中途失败不会损坏原有快照。
+ * 新快照映射成功后才替换旧快照的映射，任何一步失败时都不会只剩下内存中的变更
+ * @return 写出成功返回true，否则返回false
+ */
+bool FileProductStore::checkpoint() {
+    QSaveFile file(snapshotFile);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Cannot open file for writing:" << snapshotFile;
+        return false;
+    }
+
+    bool written = ProductSnapshot::write(&file, sortedProductIds(), [this](int productId) {
+        return find(productId);
+    });
+    if (!written) {
+        qDebug() << "Cannot write file:" << snapshotFile << file.errorString();
+        file.cancelWriting();
+        return false;
+    }
+
+#ifdef Q_OS_WIN
+    // Windows不允许替换已映射的文件，提交前解除旧快照的映射
+    snapshot.close();
+#endif
+    const bool committed = file.commit();
+    ProductSnapshot replacement;
+    if (committed && replacement.open(snapshotFile)) {
+        // 新快照已包含内存中和日志中的全部变更
+        snapshot.swap(replacement);
+        products.clear();
+        removedIds.clear();
+        sellerIndex.clear();
+        return journal.reset();
+    }
+
+    if (!committed) {
+        qDebug() << "Cannot commit file:" << snapshotFile << file.errorString();
+    } else {
+        qDebug() << "Cannot reopen snapshot:" << snapshotFile;
+    }
+    // 旧快照仍然映射时内存中的状态保持完整；日志不清空，
+    // 在磁盘上的任一快照之上重放都得到相同的结果
+    if (snapshot.isOpen() || (!committed && snapshot.open(snapshotFile))) {
+        return false;
+    }
+    // 新旧快照都无法映射：丢弃只覆盖部分商品的内存状态，存储表现为关闭
+    products.clear();
+    removedIds.clear();
+    sellerIndex.clear();
+    return false;
+}
+
+/**
+ * @brief 读取分类树文件
+ * @return 分类树的JSON数组
+ */
+QJsonArray FileProductStore::loadCategories() const {
+    QFile file(categoryFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QJsonArray();
+    }
+    return QJsonDocument::fromJson(file.readAll()).array();
+}
+
+/**
+ * @brief 写出分类树文件
+ *
+ * 分类树很小，每次修改后整体重写，不经过变更日志
+ * @param categories 分类树的JSON数组
+ * @return 写出成功返回true，否则返回false
+ */
+bool FileProductStore::saveCategories(const QJsonArray& categories) {
+    QSaveFile file(categoryFile);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Cannot open file for writing:" << categoryFile;
+        return false;
+    }
+    file.write(QJsonDocument(categories).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        qDebug() << "Cannot commit file:" << categoryFile << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 设置是否启用日志模式
+ * @param enabled 是否启用
+ */
+void FileProductStore::setJournalEnabled(bool enabled) {
+    if (journalEnabled && !enabled) {
+        checkpoint();
+    }
+    journalEnabled = enabled;
+}
+
+/**
+ * @brief 是否启用日志模式
+ * @return 启用返回true，否则返回false
+ */
+bool FileProductStore::isJournalEnabled() const {
+    return journalEnabled;
+}
+
+/**
+ * @brief 获取自上次检查点以来的日志记录数
+ * @return 日志记录数
+ */
+int FileProductStore::journalEntryCount() const {
+    return journal.entryCount();
+}
\ No newline at end of file
@@ -0,0 +1,184 @@
+#ifndef FILEPRODUCTSTORE_H
+#define FILEPRODUCTSTORE_H
+
+#include "ProductStore.h"
+#include "ProductJournal.h"
+#include "ProductSnapshot.h"
+#include <QHash>
+#include <QIODevice>
+#include <QList>
+#include <QSet>
+#include <QString>
+
+/**
+ * @brief 基于文件的商品存储后端
+ *
+ * FileProductStore以内存映射的二进制快照为基础，快照中的商品在查找时才解码，
+ * 快照之后的新增、修改和删除保存在内存中。
+ * 默认以日志模式持久化：每次变更只向日志追加一条记录，
+ * 日志增长到与商品数量相当时再把合并后的全量快照写回快照文件。
+ * 没有快照时导入旧版JSON数据文件并立即转换为快照。
+ * 按卖家查询合并快照中的卖家表和内存中变更的卖家索引，只访问该卖家的商品
+ */
+class FileProductStore : public ProductStore {
+public:
+    /**
+     * @brief 默认构造函数，使用ConfigManager中的文件路径
+     */
+    FileProductStore();
+
+    FileProductStore(const FileProductStore&) = delete;
+    FileProductStore& operator=(const FileProductStore&) = delete;
+
+    bool load() override;
+    bool contains(int productId) const override;
+    Product find(int productId) const override;
+
+    /**
+     * @brief find()只读取内存中的商品和映射的快照，可以在多个线程中同时调用
+     * @return true
+     */
+    bool supportsConcurrentFind() const override;
+    void forEach(const std::function<void(const Product&)>& visit) const override;
+
+    /**
+     * @brief 查找卖家的商品，耗时与该卖家的商品数成正比
+     * @param sellerId 卖家ID
+     * @return 按商品ID升序排列的商品列表
+     */
+    QList<Product> findBySellerId(int sellerId) const override;
+    int count() const override;
+    int maxProductId() const override;
+    bool save(const Product& product) override;
+    bool remove(int productId) override;
+
+    /**
+     * @brief 批量导入商品并落盘
+     *
+     * 导入量较小时逐条写入日志，达到检查点阈值时直接写出全量快照
+     * @param loaded 导入的商品，导入后内容未定义
+     * @return 落盘成功返回true，否则返回false
+     */
+    bool import(QHash<int, Product>& loaded) override;
+    bool commit() override;
+
+    /**
+     * @brief 写出二进制全量快照并清空变更日志（检查点）
+     *
+     * 快照先写入临时文件再原子地替换原文件
+     * @return 写出成功返回true，否则返回false
+     */
+    bool checkpoint() override;
+
+    /**
+     * @brief 读取分类树文件
+     * @return 分类树的JSON数组，文件不存在或格式错误时为空
+     */
+    QJsonArray loadCategories() const override;
+
+    /**
+     * @brief 写出分类树文件，先写入临时文件再原子地替换原文件
+     * @param categories 分类树的JSON数组
+     * @return 写出成功返回true，否则返回false
+     */
+    bool saveCategories(const QJsonArray& categories) override;
+
+    /**
+     * @brief 设置是否启用日志模式
+     *
+     * 关闭日志模式时会先做一次检查点，之后每次提交都重写整个快照文件
+     * @param enabled 是否启用
+     */
+    void setJournalEnabled(bool enabled);
+
+    /**
+     * @brief 是否启用日志模式
+     * @return 启用返回true，否则返回false
+     */
+    bool isJournalEnabled() const;
+
+    /**
+     * @brief 获取自上次检查点以来的日志记录数
+     * @return 日志记录数
+     */
+    int journalEntryCount() const;
+
+private:
+    /**
+     * @brief 把商品合并到内存中，不写日志
+     * @param loaded 导入的商品，合并后内容未定义
+     */
+    void merge(QHash<int, Product>& loaded);
+
+    /**
+     * @brief 在内存中应用一次保存
+     * @param product 商品对象
+     */
+    void applySave(const Product& product);
+
+    /**
+     * @brief 在内存中应用一次删除
+     * @param productId 商品ID
+     */
+    void applyRemove(int productId);
+
+    /**
+     * @brief 把商品登记到卖家索引中
+     * @param sellerId 卖家ID
+     * @param productId 商品ID
+     */
+    void indexSeller(int sellerId, int productId);
+
+    /**
+     * @brief 从卖家索引中移除商品
+     * @param sellerId 卖家ID
+     * @param productId 商品ID
+     */
+    void unindexSeller(int sellerId, int productId);
+
+    /**
+     * @brief 获取全部商品ID，按升序排列
+     * @return 商品ID列表
+     */
+    QList<int> sortedProductIds() const;
+
+    /**
+     * @brief 日志过长时做一次检查点
+     * @return 无需检查点或检查点成功返回true，否则返回false
+     */
+    bool checkpointIfNeeded();
+
+    /**
+     * @brief 获取触发检查点的日志记录数
+     * @return 日志记录数阈值
+     */
+    int checkpointThreshold() const;
+
+    /**
+     * @brief 从快照文件加载商品
+     * @return 加载成功返回true，否则返回false
+     */
+    bool loadSnapshot();
+
+    /**
+     * @brief 导入旧版JSON数据文件
+     * @param fileName 数据文件路径
+     * @return 导入成功返回true，否则返回false
+     */
+    bool loadLegacyFile(const QString& fileName);
+
+    static constexpr int kMinCheckpointEntries = 1024; ///< 触发检查点的最小日志记录数
+
+    QString snapshotFile;              ///< 快照文件路径
+    QString legacyDataFile;            ///< 旧版JSON数据文件路径
+    QString categoryFile;              ///< 分类树文件路径
+    ProductSnapshot snapshot;          ///< 内存映射的只读基础快照
+    QHash<int, Product> products;      ///< 快照之后新增或修改的商品，键为商品ID
+    QSet<int> removedIds;              ///< 快照中已被删除的商品ID
+    QHash<int, QSet<int>> sellerIndex; ///< 快照之后新增或修改的商品按卖家ID的索引
+    int maxId;                         ///< 出现过的最大商品ID
+    ProductJournal journal;            ///< 变更日志
+    bool journalEnabled;               ///< 是否启用日志模式
+};
+
+#endif // FILEPRODUCTSTORE_H
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include "GroupCommitter.h"
+#include <QDebug>
+
+/**
+ * @brief 每次变更都同步落盘的策略
+ * @return 落盘策略
+ */
+FlushPolicy FlushPolicy::immediate() {
+    return FlushPolicy{1, 0};
+}
+
+/**
+ * @brief 批量落盘策略
+ * @param maxPendingMutations 触发落盘的变更数阈值
+ * @param maxDelayMs 未落盘变更的最长等待时间（毫秒）
+ * @return 落盘策略
+ */
+FlushPolicy FlushPolicy::batched(int maxPendingMutations, int maxDelayMs) {
+    return FlushPolicy{qMax(1, maxPendingMutations), qMax(0, maxDelayMs)};
+}
+
+/**
+ * @brief GroupCommitter构造函数
+ * @param writeBack 实际执行落盘的回调
+ * @param policy 落盘策略
+ */
+GroupCommitter::GroupCommitter(std::function<bool()> writeBack, const FlushPolicy& policy)
+    : writeBack(std::move(writeBack)), currentPolicy(policy), pending(0), flushes(0), failedFlushes(0) {
+    timer.setSingleShot(true);
+    QObject::connect(&timer, &QTimer::timeout, [this]() {
+        // 没有调用者接收返回值，失败已记入failedFlushes，稍后重试
+        if (!flush()) {
+            qDebug() << "Deferred flush failed," << pending << "mutations still pending";
+            timer.start(currentPolicy.maxDelayMs);
+        }
+    });
+}
+
+/**
+ * @brief 设置落盘策略
+ * @param policy 落盘策略
+ */
+void GroupCommitter::setPolicy(const FlushPolicy& policy) {
+    flush();
+    currentPolicy = policy;
+}
+
+/**
+ * @brief 获取当前落盘策略
+ * @return 落盘策略
+ */
+FlushPolicy GroupCommitter::policy() const {
+    return currentPolicy;
+}
+
+/**
+ * @brief 记录一次已应用到内存的变更
+ * @return 未触发落盘或落盘成功返回true，落盘失败返回false
+ */
+bool GroupCommitter::notifyMutation() {
+    if (pending++ == 0) {
+        oldestPending.start();
+        if (currentPolicy.maxDelayMs > 0 && currentPolicy.maxPendingMutations > 1) {
+            timer.start(currentPolicy.maxDelayMs);
+        }
+    }
+
+    bool countReached = pending >= currentPolicy.maxPendingMutations;
+    bool delayReached = currentPolicy.maxDelayMs > 0
+                        && oldestPending.elapsed() >= currentPolicy.maxDelayMs;
+    if (countReached || delayReached) {
+        return flush();
+    }
+    return true;
+}
+
+/**
+ * @brief 立即写出所有未落盘的变更
+ * @return 没有待写变更或落盘成功返回true，否则返回false
+ */
+bool GroupCommitter::flush() {
+    timer.stop();
+    if (pending == 0) {
+        return true;
+    }
+
+    ++flushes;
+    if (!writeBack()) {
+        // 保留计数，下一次变更或flush()时重试
+        ++failedFlushes;
+        return false;
+    }
+    pending = 0;
+    return true;
+}
+
+/**
+ * @brief 获取未落盘的变更数
+ * @return 变更数
+ */
+int GroupCommitter::pendingCount() const {
+    return pending;
+}
+
+/**
+ * @brief 获取已执行的落盘次数
+ * @return 落盘次数
+ */
+int GroupCommitter::flushCount() const {
+    return flushes;
+}
+
+/**
+ * @brief 获取失败的落盘次数
+ * @return 落盘失败次数
+ */
+int GroupCommitter::failedFlushCount() const {
+    return failedFlushes;
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#ifndef GROUPCOMMITTER_H
+#define GROUPCOMMITTER_H
+
+#include <QElapsedTimer>
+#include <QTimer>
+#include <functional>
+
+/**
+ * @brief 批量落盘策略
+ *
+ * 累计的变更数达到maxPendingMutations，或最早一次未落盘的变更已等待maxDelayMs毫秒时，
+ * 将所有未落盘的变更一次性写入磁盘。
+ * maxDelayMs由定时器保证，需要线程中运行着事件循环；没有事件循环时（命令行工具、测试）
+ * 只在下一次变更时检查，最后一批变更要到flush()或仓库析构时才落盘
+ */
+struct FlushPolicy {
+    int maxPendingMutations; ///< 触发落盘的变更数阈值，1表示每次变更都同步落盘
+    int maxDelayMs;          ///< 未落盘变更的最长等待时间（毫秒），0表示不按时间落盘，需要事件循环
+
+    /**
+     * @brief 每次变更都同步落盘的策略
+     * @return 落盘策略
+     */
+    static FlushPolicy immediate();
+
+    /**
+     * @brief 批量落盘策略
+     * @param maxPendingMutations 触发落盘的变更数阈值
+     * @param maxDelayMs 未落盘变更的最长等待时间（毫秒）
+     * @return 落盘策略
+     */
+    static FlushPolicy batched(int maxPendingMutations = 256, int maxDelayMs = 1000);
+};
+
+/**
+ * @brief 组提交器
+ *
+ * GroupCommitter类为仓库合并连续的变更，按FlushPolicy在数量阈值或定时器到期时
+ * 调用一次落盘回调，使大量连续写入只产生少量磁盘写
+ */
+class GroupCommitter {
+public:
+    /**
+     * @brief 构造函数
+     * @param writeBack 实际执行落盘的回调，成功返回true
+     * @param policy 落盘策略
+     */
+    explicit GroupCommitter(std::function<bool()> writeBack,
+                            const FlushPolicy& policy = FlushPolicy::batched());
+
+    GroupCommitter(const GroupCommitter&) = delete;
+    GroupCommitter& operator=(const GroupCommitter&) = delete;
+
+    /**
+     * @brief 设置落盘策略，已累计的变更会先按旧策略落盘
+     * @param policy 落盘策略
+     */
+    void setPolicy(const FlushPolicy& policy);
+
+    /**
+     * @brief 获取当前落盘策略
+     * @return 落盘策略
+     */
+    FlushPolicy policy() const;
+
+    /**
+     * @brief 记录一次已应用到内存的变更
+     * @return 未触发落盘或落盘成功返回true，落盘失败返回false
+     */
+    bool notifyMutation();
+
+    /**
+     * @brief 落盘屏障：立即写出所有未落盘的变更
+     * @return 没有待写变更或落盘成功返回true，否则返回false
+     */
+    bool flush();
+
+    /**
+     * @brief 获取未落盘的变更数
+     * @return 变更数
+     */
+    int pendingCount() const;
+
+    /**
+     * @brief 获取已执行的落盘次数
+     * @return 落盘次数
+     */
+    int flushCount() const;
+
+    /**
+     * @brief 获取失败的落盘次数，包括定时器触发的落盘
+     *
+     * 定时器触发的落盘没有调用者可以接收返回值，失败时记入这里并在maxDelayMs后重试
+     * @return 落盘失败次数
+     */
+    int failedFlushCount() const;
+
+private:
+    std::function<bool()> writeBack; ///< 落盘回调
+    FlushPolicy currentPolicy;       ///< 当前落盘策略
+    QTimer timer;                    ///< 按时间落盘的单次定时器（需要事件循环）
+    QElapsedTimer oldestPending;     ///< 最早一次未落盘变更的计时，无事件循环时兜底
+    int pending;                     ///< 未落盘的变更数
+    int flushes;                     ///< 已执行的落盘次数
+    int failedFlushes;               ///< 失败的落盘次数
+};
+
+#endif // GROUPCOMMITTER_H
\ No newline at end of file
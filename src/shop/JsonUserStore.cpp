@@ -0,0 +1,100 @@
+#include "JsonUserStore.h"
+#include "ConfigManager.h"
+#include "UserRepository.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QDebug>
+
+/**
+ * @brief JsonUserStore默认构造函数
+ */
+JsonUserStore::JsonUserStore() : fileName(ConfigManager::getUserDataFile()), dirty(false) {
+}
+
+/**
+ * @brief 读取用户文件并逐个创建用户
+ * @param onUser 每创建一个用户调用一次
+ * @return 加载成功返回true，否则返回false
+ */
+bool JsonUserStore::load(const std::function<void(User*)>& onUser) {
+    QFile file(fileName);
+    
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "Cannot open file for reading:" << fileName;
+        return false;
+    }
+    
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+    file.close();
+    
+    if (error.error != QJsonParseError::NoError) {
+        qDebug() << "Error parsing JSON:" << error.errorString();
+        return false;
+    }
+    
+    if (!doc.isArray()) {
+        qDebug() << "Invalid JSON format: not an array";
+        return false;
+    }
+    
+    const QJsonArray array = doc.array();
+    for (const QJsonValue& value : array) {
+        if (value.isObject()) {
+            QJsonObject obj = value.toObject();
+            rows.insert(obj["userId"].toInt(), obj);
+            onUser(UserRepository::createUserFromJson(obj));
+        }
+    }
+    
+    return true;
+}
+
+/**
+ * @brief 记录一个用户的JSON对象
+ * @param user 用户对象
+ * @return 保存成功返回true
+ */
+bool JsonUserStore::save(const User& user) {
+    rows.insert(user.getUserId(), UserRepository::userToJson(&user));
+    dirty = true;
+    return true;
+}
+
+/**
+ * @brief 有未落盘的写入时重写整个用户文件
+ *
+ * 先写入临时文件再原子地替换原文件，写入失败时原文件保持不变
+ * @return 落盘成功返回true，否则返回false
+ */
+bool JsonUserStore::commit() {
+    if (!dirty) {
+        return true;
+    }
+    
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Cannot open file for writing:" << fileName;
+        return false;
+    }
+    
+    QJsonArray array;
+    for (const QJsonObject& obj : rows) {
+        array.append(obj);
+    }
+    const QByteArray json = QJsonDocument(array).toJson(QJsonDocument::Compact);
+    if (file.write(json) != json.size()) {
+        qDebug() << "Cannot write file:" << fileName << file.errorString();
+        file.cancelWriting();
+        return false;
+    }
+    if (!file.commit()) {
+        qDebug() << "Cannot commit file:" << fileName << file.errorString();
+        return false;
+    }
+    
+    dirty = false;
+    return true;
+}
\ No newline at end of file
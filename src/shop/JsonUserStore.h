@@ -0,0 +1,36 @@
+#ifndef JSONUSERSTORE_H
+#define JSONUSERSTORE_H
+
+#include "UserStore.h"
+#include <QJsonObject>
+#include <QMap>
+#include <QString>
+
+/**
+ * @brief 基于JSON文件的用户存储后端
+ *
+ * JsonUserStore在内存中保存每个用户的JSON对象，commit()时把全部用户重写到users.json
+ */
+class JsonUserStore : public UserStore {
+public:
+    /**
+     * @brief 默认构造函数，使用ConfigManager中的文件路径
+     */
+    JsonUserStore();
+
+    bool load(const std::function<void(User*)>& onUser) override;
+    bool save(const User& user) override;
+
+    /**
+     * @brief 有未落盘的写入时重写整个用户文件，先写入临时文件再原子地替换原文件
+     * @return 落盘成功返回true，否则返回false
+     */
+    bool commit() override;
+
+private:
+    QString fileName;            ///< 用户数据文件路径
+    QMap<int, QJsonObject> rows; ///< 用户JSON对象，键为用户ID
+    bool dirty;                  ///< 是否有未落盘的写入
+};
+
+#endif // JSONUSERSTORE_H
\ No newline at end of file
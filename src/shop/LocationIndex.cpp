@@ -0,0 +1,87 @@
+#include "LocationIndex.h"
+#include "RegionTable.h"
+
+/**
+ * @brief LocationIndex默认构造函数
+ */
+LocationIndex::LocationIndex() : regionSlots(RegionTable::size()) {
+}
+
+/**
+ * @brief 登记槽位的地址
+ *
+ * 地区层级很浅，每个槽位最多登记到三个位图中
+ * @param slot 槽位号
+ * @param location 地址
+ */
+void LocationIndex::insert(quint32 slot, const QString& location) {
+    const int code = RegionTable::find(location);
+    if (code == RegionTable::kUnknown) {
+        unrecognized[location].add(slot);
+        return;
+    }
+    for (int region = code; region != RegionTable::kUnknown; region = RegionTable::parent(region)) {
+        regionSlots[region].add(slot);
+    }
+}
+
+/**
+ * @brief 移除槽位的地址，无法识别的地址的位图为空时删除该桶
+ * @param slot 槽位号
+ * @param location 登记时使用的地址
+ */
+void LocationIndex::remove(quint32 slot, const QString& location) {
+    const int code = RegionTable::find(location);
+    if (code == RegionTable::kUnknown) {
+        auto it = unrecognized.find(location);
+        if (it != unrecognized.end()) {
+            it.value().remove(slot);
+            if (it.value().isEmpty()) {
+                unrecognized.erase(it);
+            }
+        }
+        return;
+    }
+    for (int region = code; region != RegionTable::kUnknown; region = RegionTable::parent(region)) {
+        regionSlots[region].remove(slot);
+    }
+}
+
+/**
+ * @brief 获取地址在指定地区之内的槽位
+ * @param region 地区
+ * @return 槽位位图
+ */
+const SlotBitmap* LocationIndex::lookup(const QString& region) const {
+    const int code = RegionTable::find(region);
+    if (code != RegionTable::kUnknown) {
+        const SlotBitmap& bitmap = regionSlots.at(code);
+        return bitmap.isEmpty() ? nullptr : &bitmap;
+    }
+    auto it = unrecognized.constFind(region);
+    return it != unrecognized.constEnd() ? &it.value() : nullptr;
+}
+
+/**
+ * @brief 地址是否在指定地区之内
+ * @param region 地区
+ * @param location 地址
+ * @return 在地区之内返回true，否则返回false
+ */
+bool LocationIndex::matches(const QString& region, const QString& location) {
+    const int code = RegionTable::find(region);
+    if (code == RegionTable::kUnknown) {
+        return location == region;
+    }
+    return RegionTable::contains(code, RegionTable::find(location));
+}
+
+/**
+ * @brief 获取地区的显示名称
+ * @param region 地区
+ * @return 显示名称
+ */
+QString LocationIndex::displayName(const QString& region) {
+    const int code = RegionTable::find(region);
+    return code != RegionTable::kUnknown ? RegionTable::path(code) : region;
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#ifndef LOCATIONINDEX_H
+#define LOCATIONINDEX_H
+
+#include "SlotBitmap.h"
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief 地区索引类
+ *
+ * LocationIndex用RegionTable把商品地址规范化为地区编码，每个地区对应一个SlotBitmap，
+ * 记录地址在该地区及其下级之内的商品槽位，因此按地区筛选只需取出一个位图。
+ * 无法识别的地址按原字符串分桶，同样保存为位图，只能精确匹配
+ */
+class LocationIndex {
+public:
+    /**
+     * @brief 默认构造函数，创建空索引
+     */
+    LocationIndex();
+
+    /**
+     * @brief 登记槽位的地址
+     *
+     * 可以识别的地址登记到所在地区及其全部上级的位图中
+     * @param slot 槽位号
+     * @param location 地址
+     */
+    void insert(quint32 slot, const QString& location);
+
+    /**
+     * @brief 移除槽位的地址
+     * @param slot 槽位号
+     * @param location 登记时使用的地址
+     */
+    void remove(quint32 slot, const QString& location);
+
+    /**
+     * @brief 获取地址在指定地区之内的槽位
+     * @param region 地区，可以识别时包括全部下级地区，否则精确匹配地址
+     * @return 槽位位图，没有商品时返回nullptr
+     */
+    const SlotBitmap* lookup(const QString& region) const;
+
+    /**
+     * @brief 地址是否在指定地区之内，规则与lookup()相同
+     * @param region 地区
+     * @param location 地址
+     * @return 在地区之内返回true，否则返回false
+     */
+    static bool matches(const QString& region, const QString& location);
+
+    /**
+     * @brief 获取地区的显示名称
+     * @param region 地区
+     * @return 可以识别时返回完整路径，否则返回原字符串
+     */
+    static QString displayName(const QString& region);
+
+private:
+    QVector<SlotBitmap> regionSlots;         ///< 地区编码到槽位位图的映射，包括下级地区的槽位
+    QHash<QString, SlotBitmap> unrecognized; ///< 无法识别的地址到槽位位图的映射
+};
+
+#endif // LOCATIONINDEX_H
\ No newline at end of file
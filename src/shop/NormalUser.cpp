@@ -1,4 +1,5 @@
 #include "NormalUser.h"
+#include "ProductRepository.h"
 #include <QApplication>
 #include <QDebug>
 
@@ -46,10 +47,10 @@ bool NormalUser::deleteProduct(int productId) {
 
 /**
  * @brief 获取用户所拥有的商品列表
+ * @param productRepository 商品仓库
  * @return 商品列表的 QVector
  */
-QVector<Product> NormalUser::getOwnedProducts() const {
-    // 实际实现中会从ProductRepository获取属于当前用户的所有商品
-    // 这里返回一个空的 QVector 作为示例
-    return QVector<Product>();
+QVector<Product> NormalUser::getOwnedProducts(const ProductRepository& productRepository) const {
+    const QList<Product> owned = productRepository.findBySellerId(getUserId());
+    return QVector<Product>(owned.begin(), owned.end());
 }
\ No newline at end of file
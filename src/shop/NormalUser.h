@@ -6,6 +6,8 @@
 #include <QList>
 #include <QVector>
 
+class ProductRepository;
+
 /**
  * @brief 普通用户类
  * 
@@ -47,9 +49,12 @@ public:
     
     /**
      * @brief 获取用户所拥有的商品列表
+     *
+     * 通过商品仓库的卖家索引查询，耗时与该用户的商品数成正比
+     * @param productRepository 商品仓库
      * @return 商品列表的 QVector
      */
-    QVector<Product> getOwnedProducts() const;
+    QVector<Product> getOwnedProducts(const ProductRepository& productRepository) const;
 };
 
 #endif // NORMALUSER_H
\ No newline at end of file
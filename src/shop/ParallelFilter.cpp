@@ -0,0 +1,103 @@
+#include "ParallelFilter.h"
+
+/**
+ * @brief ParallelFilter构造函数
+ * @param threadCount 线程数
+ * @param predicate 过滤条件
+ * @param consume 输出回调
+ */
+ParallelFilter::ParallelFilter(int threadCount, Predicate predicate, Consumer consume)
+    : threads(qMax(1, threadCount)), predicate(std::move(predicate)), consume(std::move(consume)), batchLimit(0),
+      sequential(0), batches(0), stopped(false) {
+}
+
+/**
+ * @brief 接收一个候选槽位
+ *
+ * 逐个过滤阶段立即求值并输出；攒批阶段攒满一批后并行过滤
+ * @param slot 槽位号
+ * @return 还需要更多候选返回true，否则返回false
+ */
+bool ParallelFilter::push(quint32 slot) {
+    if (stopped) {
+        return false;
+    }
+    if (batchLimit == 0) {
+        if (predicate(slot) && !consume(slot)) {
+            stopped = true;
+            return false;
+        }
+        // 一直没有停止说明要过滤大量候选，改为攒批并行
+        if (threads > 1 && ++sequential >= kMinParallelSlots) {
+            batchLimit = kMinParallelSlots;
+        }
+        return true;
+    }
+
+    batch.append(slot);
+    if (batch.size() >= batchLimit) {
+        flush();
+        batchLimit = qMin(batchLimit * 2, kMaxBatch);
+    }
+    return !stopped;
+}
+
+/**
+ * @brief 过滤并输出尚未处理的候选
+ */
+void ParallelFilter::finish() {
+    if (!stopped && !batch.isEmpty()) {
+        flush();
+    }
+    batch.clear();
+}
+
+/**
+ * @brief 获取并行过滤的批数
+ * @return 批数
+ */
+int ParallelFilter::parallelBatchCount() const {
+    return batches;
+}
+
+/**
+ * @brief 在线程池中分段过滤当前批，再按顺序输出
+ *
+ * 每段是批中连续的一部分，各线程只写自己那一段的结果，不需要加锁；
+ * 全部完成后按段的顺序拼接，与逐个过滤的输出顺序相同
+ */
+void ParallelFilter::flush() {
+    if (!pool) {
+        pool.reset(new QThreadPool());
+        pool->setMaxThreadCount(threads);
+    }
+
+    const int parts = qMin(threads, batch.size());
+    const int step = (batch.size() + parts - 1) / parts;
+    QVector<QVector<quint32>> passed(parts);
+    for (int i = 0; i < parts; ++i) {
+        const quint32* begin = batch.constData() + qMin(batch.size(), i * step);
+        const quint32* end = batch.constData() + qMin(batch.size(), (i + 1) * step);
+        QVector<quint32>* output = &passed[i];
+        const Predicate* test = &predicate;
+        pool->start([begin, end, output, test]() {
+            for (const quint32* slot = begin; slot != end; ++slot) {
+                if ((*test)(*slot)) {
+                    output->append(*slot);
+                }
+            }
+        });
+    }
+    pool->waitForDone();
+    ++batches;
+    batch.clear();
+
+    for (const QVector<quint32>& part : passed) {
+        for (quint32 slot : part) {
+            if (!consume(slot)) {
+                stopped = true;
+                return;
+            }
+        }
+    }
+}
\ No newline at end of file
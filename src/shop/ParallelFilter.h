@@ -0,0 +1,80 @@
+#ifndef PARALLELFILTER_H
+#define PARALLELFILTER_H
+
+#include <QThreadPool>
+#include <QVector>
+#include <QtGlobal>
+#include <functional>
+#include <memory>
+
+/**
+ * @brief 分批并行过滤器
+ *
+ * ParallelFilter按顺序接收候选槽位，对每个候选求值过滤条件，把通过的槽位按接收顺序交给输出回调。
+ * 开始时在调用线程上逐个过滤，只取一页的搜索在取满后立即停止，与单线程完全相同；
+ * 连续过滤了kMinParallelSlots个候选仍未停止时改为攒批，每批切成与线程数相同的连续几段在线程池中并行过滤，
+ * 再按段的顺序、段内按接收顺序输出，因此输出顺序与逐个过滤完全一致。批大小逐批翻倍到kMaxBatch为止，
+ * 输出回调要求停止后丢弃剩余的命中，最多多过滤一批候选
+ */
+class ParallelFilter {
+public:
+    static constexpr int kMinParallelSlots = 4096; ///< 逐个过滤多少个候选后开始并行
+    static constexpr int kMaxBatch = 64 * 1024;    ///< 一批最多的候选数
+
+    /**
+     * @brief 过滤条件，对一个槽位求值，会在多个线程中同时调用
+     */
+    using Predicate = std::function<bool(quint32)>;
+
+    /**
+     * @brief 输出回调，在调用线程上按顺序接收通过的槽位，返回false表示不再需要更多槽位
+     */
+    using Consumer = std::function<bool(quint32)>;
+
+    /**
+     * @brief 构造函数
+     * @param threadCount 线程数，不大于1时始终在调用线程上逐个过滤
+     * @param predicate 过滤条件
+     * @param consume 输出回调
+     */
+    ParallelFilter(int threadCount, Predicate predicate, Consumer consume);
+
+    ParallelFilter(const ParallelFilter&) = delete;
+    ParallelFilter& operator=(const ParallelFilter&) = delete;
+
+    /**
+     * @brief 接收一个候选槽位
+     * @param slot 槽位号
+     * @return 还需要更多候选返回true，输出回调已要求停止时返回false
+     */
+    bool push(quint32 slot);
+
+    /**
+     * @brief 过滤并输出尚未处理的候选，在全部候选接收完后调用
+     */
+    void finish();
+
+    /**
+     * @brief 获取并行过滤的批数
+     * @return 批数
+     */
+    int parallelBatchCount() const;
+
+private:
+    /**
+     * @brief 在线程池中分段过滤当前批，再按顺序输出
+     */
+    void flush();
+
+    int threads;                       ///< 线程数
+    Predicate predicate;               ///< 过滤条件
+    Consumer consume;                  ///< 输出回调
+    QVector<quint32> batch;            ///< 攒批中的候选
+    int batchLimit;                    ///< 当前批的大小，0表示仍在逐个过滤
+    int sequential;                    ///< 已逐个过滤的候选数
+    int batches;                       ///< 并行过滤的批数
+    bool stopped;                      ///< 输出回调是否已要求停止
+    std::unique_ptr<QThreadPool> pool; ///< 线程池，第一次攒批时创建
+};
+
+#endif // PARALLELFILTER_H
\ No newline at end of file
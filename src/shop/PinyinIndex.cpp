@@ -0,0 +1,202 @@
+#include "PinyinIndex.h"
+#include "PinyinTable.h"
+#include "TextIndex.h"
+#include <QSet>
+#include <QStringList>
+#include <algorithm>
+
+namespace {
+
+/**
+ * @brief 把文本转换成拼音
+ * @param text 文本
+ * @param initialsOnly 为true时每个汉字只取拼音首字母
+ * @return 小写拼音，不含空白和标点
+ */
+QString convert(const QString& text, bool initialsOnly) {
+    QString result;
+    result.reserve(text.size() * (initialsOnly ? 1 : 4));
+    for (QChar ch : text) {
+        const QString syllable = PinyinTable::syllable(ch);
+        if (!syllable.isEmpty()) {
+            result += initialsOnly ? syllable.left(1) : syllable;
+        } else if (ch.unicode() < 0x80 && ch.isLetterOrNumber()) {
+            result += ch.toLower();
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+/**
+ * @brief PinyinIndex默认构造函数
+ */
+PinyinIndex::PinyinIndex() {
+}
+
+/**
+ * @brief 把标题登记到槽位
+ *
+ * 标题在这里一次转换成全拼和首字母并保存，查询时不再转换
+ * @param slot 槽位号
+ * @param title 标题
+ */
+void PinyinIndex::insert(quint32 slot, const QString& title) {
+    fullIndex.insert(slot, fullPinyin(title));
+    initialsIndex.insert(slot, initials(title));
+}
+
+/**
+ * @brief 从槽位移除标题
+ *
+ * 按登记时保存的拼音移除，不需要原标题
+ * @param slot 槽位号
+ */
+void PinyinIndex::remove(quint32 slot) {
+    fullIndex.remove(slot);
+    initialsIndex.remove(slot);
+}
+
+/**
+ * @brief 查找标题拼音匹配关键词的槽位
+ *
+ * 逐个单词查找后求交集，交集为空时提前结束。含汉字的单词只匹配全拼，
+ * 否则“手机”的首字母“sj”会匹配到“书架”
+ * @param keyword 关键词
+ * @return 升序排列的槽位号
+ */
+QVector<quint32> PinyinIndex::lookup(const QString& keyword) const {
+    QStringList queryWords = TextIndex::words(keyword);
+    queryWords.removeDuplicates();
+    QVector<quint32> matches;
+    for (int i = 0; i < queryWords.size(); ++i) {
+        const QString spelled = fullPinyin(queryWords.at(i));
+        QVector<quint32> found = fullIndex.lookup(spelled);
+        if (initials(queryWords.at(i)) == spelled) {
+            const QVector<quint32> abbreviated = initialsIndex.lookup(spelled);
+            QVector<quint32> merged;
+            std::set_union(found.cbegin(), found.cend(), abbreviated.cbegin(), abbreviated.cend(),
+                           std::back_inserter(merged));
+            found = merged;
+        }
+        matches = i == 0 ? found : PostingList::intersect(matches, found);
+        if (matches.isEmpty()) {
+            break;
+        }
+    }
+    return matches;
+}
+
+/**
+ * @brief 把文本转换成全拼
+ * @param text 文本
+ * @return 小写全拼
+ */
+QString PinyinIndex::fullPinyin(const QString& text) {
+    return convert(text, false);
+}
+
+/**
+ * @brief 把文本转换成拼音首字母
+ * @param text 文本
+ * @return 小写首字母
+ */
+QString PinyinIndex::initials(const QString& text) {
+    return convert(text, true);
+}
+
+/**
+ * @brief 把拼音切成相邻字母对
+ * @param form 拼音
+ * @return 去重后的字母对，拼音短于kGramLength时为空
+ */
+QVector<QString> PinyinIndex::grams(const QString& form) {
+    QSet<QString> seen;
+    QVector<QString> result;
+    for (int i = 0; i + kGramLength <= form.size(); ++i) {
+        const QString gram = form.mid(i, kGramLength);
+        if (!seen.contains(gram)) {
+            seen.insert(gram);
+            result.append(gram);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief 把槽位的拼音登记到倒排表
+ * @param slot 槽位号
+ * @param form 拼音
+ */
+void PinyinIndex::FormIndex::insert(quint32 slot, const QString& form) {
+    if (bySlot.size() <= int(slot)) {
+        bySlot.resize(int(slot) + 1);
+    }
+    bySlot[int(slot)] = form;
+    for (const QString& gram : PinyinIndex::grams(form)) {
+        grams[gram].add(slot);
+    }
+}
+
+/**
+ * @brief 从倒排表移除槽位
+ * @param slot 槽位号
+ */
+void PinyinIndex::FormIndex::remove(quint32 slot) {
+    if (bySlot.size() <= int(slot)) {
+        return;
+    }
+    for (const QString& gram : PinyinIndex::grams(bySlot.at(int(slot)))) {
+        auto it = grams.find(gram);
+        if (it != grams.end()) {
+            it.value().remove(slot);
+        }
+    }
+    bySlot[int(slot)].clear();
+}
+
+/**
+ * @brief 查找拼音含有单词的槽位
+ *
+ * 从最短的倒排表开始对单词的全部字母对求交，字母对相邻不代表单词连续出现，
+ * 因此单词多于一个字母对时再核对保存的拼音；单词短于一个字母对时逐个核对
+ * @param word 全拼单词
+ * @return 升序排列的槽位号
+ */
+QVector<quint32> PinyinIndex::FormIndex::lookup(const QString& word) const {
+    QVector<quint32> matches;
+    if (word.isEmpty()) {
+        return matches;
+    }
+    if (word.size() < kGramLength) {
+        for (int slot = 0; slot < bySlot.size(); ++slot) {
+            if (bySlot.at(slot).contains(word)) {
+                matches.append(quint32(slot));
+            }
+        }
+        return matches;
+    }
+
+    QVector<const PostingList*> lists;
+    for (const QString& gram : PinyinIndex::grams(word)) {
+        auto it = grams.constFind(gram);
+        if (it == grams.constEnd() || it.value().isEmpty()) {
+            return matches;
+        }
+        lists.append(&it.value());
+    }
+    std::sort(lists.begin(), lists.end(), [](const PostingList* a, const PostingList* b) {
+        return a->size() < b->size();
+    });
+    matches = lists.first()->decode();
+    for (int i = 1; i < lists.size() && !matches.isEmpty(); ++i) {
+        matches = PostingList::intersect(matches, lists.at(i)->decode());
+    }
+    if (word.size() > kGramLength) {
+        matches.erase(std::remove_if(matches.begin(), matches.end(),
+                                     [this, &word](quint32 slot) { return !bySlot.at(int(slot)).contains(word); }),
+                      matches.end());
+    }
+    return matches;
+}
\ No newline at end of file
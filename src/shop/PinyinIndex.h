@@ -0,0 +1,101 @@
+#ifndef PINYININDEX_H
+#define PINYININDEX_H
+
+#include "PostingList.h"
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief 标题拼音索引类
+ *
+ * PinyinIndex在登记时用PinyinTable把商品标题转换成全拼（“手机”→“shouji”）和首字母（“sj”）两种形式并按槽位保存，
+ * 拉丁字母和数字原样转成小写保留，其他字符丢弃。两种形式分别切成相邻字母对，字母对到槽位的倒排表使用PostingList保存。
+ * 查询时对查询词的字母对倒排表求交，再用保存的拼音核对子串，标题只在登记时转换一次
+ */
+class PinyinIndex {
+public:
+    static constexpr int kGramLength = 2; ///< 倒排表按几个相邻字母切分
+
+    /**
+     * @brief 默认构造函数，创建空索引
+     */
+    PinyinIndex();
+
+    /**
+     * @brief 把标题登记到槽位
+     * @param slot 槽位号
+     * @param title 标题
+     */
+    void insert(quint32 slot, const QString& title);
+
+    /**
+     * @brief 从槽位移除标题
+     * @param slot 槽位号
+     */
+    void remove(quint32 slot);
+
+    /**
+     * @brief 查找标题拼音匹配关键词的槽位
+     *
+     * 关键词的每个单词（规则同TextIndex::words()）转换成全拼后，都要是标题全拼或首字母的子串
+     * @param keyword 关键词，可以是拼音、首字母或汉字
+     * @return 升序排列的槽位号，关键词没有单词时为空
+     */
+    QVector<quint32> lookup(const QString& keyword) const;
+
+    /**
+     * @brief 把文本转换成全拼
+     * @param text 文本
+     * @return 小写全拼，不含空白和标点
+     */
+    static QString fullPinyin(const QString& text);
+
+    /**
+     * @brief 把文本转换成拼音首字母
+     * @param text 文本
+     * @return 小写首字母，拉丁字母和数字原样保留，不含空白和标点
+     */
+    static QString initials(const QString& text);
+
+private:
+    /**
+     * @brief 一种拼音形式的倒排索引
+     */
+    struct FormIndex {
+        QVector<QString> bySlot;           ///< 槽位到拼音的映射，空槽位为空字符串
+        QHash<QString, PostingList> grams; ///< 字母对到槽位的倒排表
+
+        /**
+         * @brief 把槽位的拼音登记到倒排表
+         * @param slot 槽位号
+         * @param form 拼音
+         */
+        void insert(quint32 slot, const QString& form);
+
+        /**
+         * @brief 从倒排表移除槽位
+         * @param slot 槽位号
+         */
+        void remove(quint32 slot);
+
+        /**
+         * @brief 查找拼音含有单词的槽位
+         * @param word 全拼单词
+         * @return 升序排列的槽位号
+         */
+        QVector<quint32> lookup(const QString& word) const;
+    };
+
+    /**
+     * @brief 把拼音切成相邻字母对
+     * @param form 拼音
+     * @return 去重后的字母对
+     */
+    static QVector<QString> grams(const QString& form);
+
+    FormIndex fullIndex;     ///< 全拼索引
+    FormIndex initialsIndex; ///< 首字母索引
+};
+
+#endif // PINYININDEX_H
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef PINYINTABLE_H
+#define PINYINTABLE_H
+
+#include <QChar>
+#include <QString>
+
+/**
+ * @brief 汉字拼音表类
+ *
+ * PinyinTable内置约两万个常用和次常用汉字（基本区和扩展A区）的不带声调拼音，ü写作v。
+ * 多音字只收一个读音，取常见读音。第一次查询时把内置表展开成散列表，之后每次查询为常数时间
+ */
+class PinyinTable {
+public:
+    /**
+     * @brief 获取汉字的拼音
+     * @param ch 字符
+     * @return 小写拼音，不是收录的汉字时返回空字符串
+     */
+    static QString syllable(QChar ch);
+
+    /**
+     * @brief 获取收录的汉字数
+     * @return 汉字数
+     */
+    static int size();
+};
+
+#endif // PINYINTABLE_H
\ No newline at end of file
@@ -0,0 +1,299 @@
+#include "PostingList.h"
+#include <algorithm>
+
+namespace {
+
+/**
+ * @brief 在有序数组中插入一个不存在的值
+ * @param values 升序数组
+ * @param value 数值
+ * @return 插入返回true，已存在返回false
+ */
+bool insertSorted(QVector<quint32>& values, quint32 value) {
+    auto it = std::lower_bound(values.begin(), values.end(), value);
+    if (it != values.end() && *it == value) {
+        return false;
+    }
+    values.insert(it, value);
+    return true;
+}
+
+/**
+ * @brief 从有序数组中删除一个值
+ * @param values 升序数组
+ * @param value 数值
+ * @return 删除返回true，不存在返回false
+ */
+bool eraseSorted(QVector<quint32>& values, quint32 value) {
+    auto it = std::lower_bound(values.begin(), values.end(), value);
+    if (it == values.end() || *it != value) {
+        return false;
+    }
+    values.erase(it);
+    return true;
+}
+
+/**
+ * @brief 有序数组中是否包含指定值
+ * @param values 升序数组
+ * @param value 数值
+ * @return 包含返回true，否则返回false
+ */
+bool containsSorted(const QVector<quint32>& values, quint32 value) {
+    return std::binary_search(values.begin(), values.end(), value);
+}
+
+} // namespace
+
+/**
+ * @brief PostingList默认构造函数
+ */
+PostingList::PostingList() : encodedCount(0), lastEncoded(0) {
+}
+
+/**
+ * @brief 加入一个槽位
+ *
+ * 比主体中所有槽位都大的槽位直接追加编码，其余的先进入新增缓冲区
+ * @param slot 槽位号
+ */
+void PostingList::add(quint32 slot) {
+    if (eraseSorted(removed, slot)) {
+        // 槽位仍在主体中，撤销删除即可
+        return;
+    }
+    if (added.isEmpty() && (encodedCount == 0 || slot > lastEncoded)) {
+        appendEncoded(slot);
+        return;
+    }
+    if (encodedContains(slot)) {
+        return;
+    }
+    insertSorted(added, slot);
+    compactIfNeeded();
+}
+
+/**
+ * @brief 移除一个槽位
+ * @param slot 槽位号
+ */
+void PostingList::remove(quint32 slot) {
+    if (eraseSorted(added, slot)) {
+        return;
+    }
+    if (!containsSorted(removed, slot) && encodedContains(slot)) {
+        insertSorted(removed, slot);
+        compactIfNeeded();
+    }
+}
+
+/**
+ * @brief 是否包含指定槽位
+ * @param slot 槽位号
+ * @return 包含返回true，否则返回false
+ */
+bool PostingList::contains(quint32 slot) const {
+    if (containsSorted(added, slot)) {
+        return true;
+    }
+    return !containsSorted(removed, slot) && encodedContains(slot);
+}
+
+/**
+ * @brief 获取槽位数
+ * @return 槽位数
+ */
+int PostingList::size() const {
+    return encodedCount - removed.size() + added.size();
+}
+
+/**
+ * @brief 倒排表是否为空
+ * @return 为空返回true，否则返回false
+ */
+bool PostingList::isEmpty() const {
+    return size() == 0;
+}
+
+/**
+ * @brief 解码全部槽位，并与新增、删除缓冲区归并
+ * @return 升序排列的槽位号
+ */
+QVector<quint32> PostingList::decode() const {
+    QVector<quint32> result;
+    result.reserve(size());
+
+    const uchar* data = reinterpret_cast<const uchar*>(encoded.constData());
+    const int length = encoded.size();
+    int position = 0;
+    int nextAdded = 0;
+    int nextRemoved = 0;
+    quint32 value = 0;
+    for (int i = 0; i < encodedCount; ++i) {
+        quint32 delta = 0;
+        int shift = 0;
+        while (position < length) {
+            uchar byte = data[position++];
+            delta |= quint32(byte & 0x7F) << shift;
+            shift += 7;
+            if (!(byte & 0x80)) {
+                break;
+            }
+        }
+        value = i == 0 ? delta : value + delta;
+
+        while (nextAdded < added.size() && added.at(nextAdded) < value) {
+            result.append(added.at(nextAdded++));
+        }
+        if (nextRemoved < removed.size() && removed.at(nextRemoved) == value) {
+            ++nextRemoved;
+        } else {
+            result.append(value);
+        }
+    }
+    while (nextAdded < added.size()) {
+        result.append(added.at(nextAdded++));
+    }
+    return result;
+}
+
+/**
+ * @brief 获取倒排表占用的字节数
+ * @return 字节数
+ */
+int PostingList::byteSize() const {
+    return encoded.size() + int((added.size() + removed.size()) * sizeof(quint32) + skips.size() * sizeof(Skip));
+}
+
+/**
+ * @brief 求两个有序槽位数组的交集
+ * @param a 升序槽位数组
+ * @param b 升序槽位数组
+ * @return 升序排列的交集
+ */
+QVector<quint32> PostingList::intersect(const QVector<quint32>& a, const QVector<quint32>& b) {
+    const QVector<quint32>& shorter = a.size() <= b.size() ? a : b;
+    const QVector<quint32>& longer = a.size() <= b.size() ? b : a;
+
+    QVector<quint32> result;
+    result.reserve(shorter.size());
+    auto low = longer.begin();
+    for (quint32 value : shorter) {
+        // 倍增确定上界后二分查找
+        int step = 1;
+        auto high = low;
+        while (high != longer.end() && *high < value) {
+            low = high;
+            high = longer.end() - high > step ? high + step : longer.end();
+            step *= 2;
+        }
+        low = std::lower_bound(low, high, value);
+        if (low == longer.end()) {
+            break;
+        }
+        if (*low == value) {
+            result.append(value);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief 缓冲区过大时合并
+ */
+void PostingList::compactIfNeeded() {
+    if (added.size() + removed.size() > qMax(16, encodedCount / 8)) {
+        compact();
+    }
+}
+
+/**
+ * @brief 把缓冲区合并进主体并重新编码
+ */
+void PostingList::compact() {
+    const QVector<quint32> values = decode();
+    encoded.clear();
+    encoded.reserve(values.size() * 2);
+    encodedCount = 0;
+    lastEncoded = 0;
+    added.clear();
+    removed.clear();
+    skips.clear();
+    for (quint32 value : values) {
+        appendEncoded(value);
+    }
+    encoded.squeeze();
+    skips.squeeze();
+}
+
+/**
+ * @brief 在主体末尾追加一个比已有槽位都大的槽位，每隔kSkipInterval项记录跳跃点
+ * @param slot 槽位号
+ */
+void PostingList::appendEncoded(quint32 slot) {
+    appendVarint(encoded, encodedCount == 0 ? slot : slot - lastEncoded);
+    if (encodedCount % kSkipInterval == 0) {
+        skips.append({slot, encoded.size()});
+    }
+    lastEncoded = slot;
+    ++encodedCount;
+}
+
+/**
+ * @brief 在编码后的主体中查找槽位
+ *
+ * 二分找到最后一个不大于目标的跳跃点，从它开始顺序解码直到遇到不小于目标的槽位
+ * @param slot 槽位号
+ * @return 找到返回true，否则返回false
+ */
+bool PostingList::encodedContains(quint32 slot) const {
+    if (encodedCount == 0 || slot > lastEncoded) {
+        return false;
+    }
+
+    auto skip = std::upper_bound(skips.cbegin(), skips.cend(), slot, [](quint32 value, const Skip& entry) {
+        return value < entry.value;
+    });
+    if (skip == skips.cbegin()) {
+        return false;
+    }
+    --skip;
+    if (skip->value == slot) {
+        return true;
+    }
+
+    const uchar* data = reinterpret_cast<const uchar*>(encoded.constData());
+    const int length = encoded.size();
+    int position = skip->offset;
+    quint32 value = skip->value;
+    for (int i = int(skip - skips.cbegin()) * kSkipInterval + 1; i < encodedCount; ++i) {
+        quint32 delta = 0;
+        int shift = 0;
+        while (position < length) {
+            uchar byte = data[position++];
+            delta |= quint32(byte & 0x7F) << shift;
+            shift += 7;
+            if (!(byte & 0x80)) {
+                break;
+            }
+        }
+        value += delta;
+        if (value >= slot) {
+            return value == slot;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 追加一个变长字节编码的无符号整数
+ * @param data 输出缓冲区
+ * @param value 数值
+ */
+void PostingList::appendVarint(QByteArray& data, quint32 value) {
+    while (value >= 0x80) {
+        data.append(char((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    data.append(char(value));
+}
\ No newline at end of file
@@ -0,0 +1,126 @@
+#ifndef POSTINGLIST_H
+#define POSTINGLIST_H
+
+#include <QByteArray>
+#include <QVector>
+
+/**
+ * @brief 压缩倒排表类
+ *
+ * PostingList保存一个词项对应的有序槽位号集合。主体按升序做差分后以变长字节（VByte）编码，
+ * 通常每个槽位只占1~2字节；新增和删除先记录在两个小的有序缓冲区中，
+ * 缓冲区超过主体大小的一定比例时才合并重新编码，单次变更的均摊开销与倒排表长度无关。
+ * 主体每隔kSkipInterval项记录一个跳跃点，contains()先二分跳跃点，最多再解码一个区间
+ */
+class PostingList {
+public:
+    /**
+     * @brief 默认构造函数，创建空倒排表
+     */
+    PostingList();
+
+    /**
+     * @brief 加入一个槽位，已存在时不做任何事
+     * @param slot 槽位号
+     */
+    void add(quint32 slot);
+
+    /**
+     * @brief 移除一个槽位，不存在时不做任何事
+     * @param slot 槽位号
+     */
+    void remove(quint32 slot);
+
+    /**
+     * @brief 是否包含指定槽位
+     *
+     * 借助跳跃点查找，代价为O(log n + kSkipInterval)，查询计划据此逐个探测而不必解码整个倒排表
+     * @param slot 槽位号
+     * @return 包含返回true，否则返回false
+     */
+    bool contains(quint32 slot) const;
+
+    /**
+     * @brief 获取槽位数
+     * @return 槽位数
+     */
+    int size() const;
+
+    /**
+     * @brief 倒排表是否为空
+     * @return 为空返回true，否则返回false
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief 解码全部槽位
+     * @return 升序排列的槽位号
+     */
+    QVector<quint32> decode() const;
+
+    /**
+     * @brief 获取倒排表占用的字节数（不含对象本身）
+     * @return 字节数
+     */
+    int byteSize() const;
+
+    /**
+     * @brief 求两个有序槽位数组的交集
+     *
+     * 长度相差悬殊时对较长的数组做倍增查找，耗时接近较短数组的长度
+     * @param a 升序槽位数组
+     * @param b 升序槽位数组
+     * @return 升序排列的交集
+     */
+    static QVector<quint32> intersect(const QVector<quint32>& a, const QVector<quint32>& b);
+
+private:
+    static constexpr int kSkipInterval = 64; ///< 相邻跳跃点之间的项数
+
+    /**
+     * @brief 跳跃点，记录主体中某一项的槽位号和下一项的字节偏移
+     */
+    struct Skip {
+        quint32 value; ///< 该项的槽位号
+        int offset;    ///< 下一项在编码数据中的字节偏移
+    };
+
+    /**
+     * @brief 在主体末尾追加一个比已有槽位都大的槽位
+     * @param slot 槽位号
+     */
+    void appendEncoded(quint32 slot);
+
+    /**
+     * @brief 把缓冲区合并进主体并重新编码
+     */
+    void compact();
+
+    /**
+     * @brief 缓冲区过大时合并
+     */
+    void compactIfNeeded();
+
+    /**
+     * @brief 在编码后的主体中查找槽位
+     * @param slot 槽位号
+     * @return 找到返回true，否则返回false
+     */
+    bool encodedContains(quint32 slot) const;
+
+    /**
+     * @brief 追加一个变长字节编码的无符号整数
+     * @param data 输出缓冲区
+     * @param value 数值
+     */
+    static void appendVarint(QByteArray& data, quint32 value);
+
+    QByteArray encoded;       ///< 差分后VByte编码的主体
+    int encodedCount;         ///< 主体中的槽位数
+    quint32 lastEncoded;      ///< 主体中最大的槽位号
+    QVector<quint32> added;   ///< 尚未合并的新增槽位，升序
+    QVector<quint32> removed; ///< 尚未合并的已删除主体槽位，升序
+    QVector<Skip> skips;      ///< 主体的跳跃点，槽位号升序
+};
+
+#endif // POSTINGLIST_H
\ No newline at end of file
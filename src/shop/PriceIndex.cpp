@@ -0,0 +1,241 @@
+#include "PriceIndex.h"
+#include <QtMath>
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+/**
+ * @brief 按给定顺序归并两个有序区间并跳过已删除项
+ * @param first 主体区间起点
+ * @param firstEnd 主体区间终点
+ * @param second 新增区间起点
+ * @param secondEnd 新增区间终点
+ * @param skip 删除区间起点
+ * @param skipEnd 删除区间终点
+ * @param before 遍历顺序
+ * @param visit 接收索引项的回调，返回false时停止
+ */
+template <typename Iterator, typename Before, typename Visit>
+void mergeRanges(Iterator first, Iterator firstEnd, Iterator second, Iterator secondEnd,
+                 Iterator skip, Iterator skipEnd, Before before, Visit visit) {
+    while (first != firstEnd || second != secondEnd) {
+        if (second == secondEnd || (first != firstEnd && before(*first, *second))) {
+            while (skip != skipEnd && before(*skip, *first)) {
+                ++skip;
+            }
+            if (skip != skipEnd && *skip == *first) {
+                ++first;
+                continue;
+            }
+            if (!visit(*first++)) {
+                return;
+            }
+        } else if (!visit(*second++)) {
+            return;
+        }
+    }
+}
+
+} // namespace
+
+/**
+ * @brief 按（价格，商品ID，槽位号）比较
+ * @param other 另一个索引项
+ * @return 排在other之前返回true，否则返回false
+ */
+bool PriceIndex::Entry::operator<(const Entry& other) const {
+    if (price != other.price) {
+        return price < other.price;
+    }
+    if (productId != other.productId) {
+        return productId < other.productId;
+    }
+    return slot < other.slot;
+}
+
+/**
+ * @brief 是否为同一个索引项
+ * @param other 另一个索引项
+ * @return 相同返回true，否则返回false
+ */
+bool PriceIndex::Entry::operator==(const Entry& other) const {
+    return price == other.price && productId == other.productId && slot == other.slot;
+}
+
+/**
+ * @brief 登记商品价格
+ * @param slot 槽位号
+ * @param productId 商品ID
+ * @param price 价格
+ */
+void PriceIndex::insert(quint32 slot, int productId, double price) {
+    const Entry entry = {price, productId, slot};
+    auto dead = std::lower_bound(removed.begin(), removed.end(), entry);
+    if (dead != removed.end() && *dead == entry) {
+        // 主体中的项仍在，撤销删除即可
+        removed.erase(dead);
+        return;
+    }
+    auto it = std::lower_bound(added.begin(), added.end(), entry);
+    if (it == added.end() || !(*it == entry)) {
+        added.insert(it, entry);
+        compactIfNeeded();
+    }
+}
+
+/**
+ * @brief 移除商品价格
+ * @param slot 槽位号
+ * @param productId 商品ID
+ * @param price 登记时的价格
+ */
+void PriceIndex::remove(quint32 slot, int productId, double price) {
+    const Entry entry = {price, productId, slot};
+    auto it = std::lower_bound(added.begin(), added.end(), entry);
+    if (it != added.end() && *it == entry) {
+        added.erase(it);
+        return;
+    }
+    if (std::binary_search(entries.cbegin(), entries.cend(), entry)) {
+        auto dead = std::lower_bound(removed.begin(), removed.end(), entry);
+        if (dead == removed.end() || !(*dead == entry)) {
+            removed.insert(dead, entry);
+            compactIfNeeded();
+        }
+    }
+}
+
+/**
+ * @brief 获取索引中的商品数
+ * @return 商品数
+ */
+int PriceIndex::size() const {
+    return entries.size() + added.size() - removed.size();
+}
+
+/**
+ * @brief 统计价格区间内的商品数
+ *
+ * 主体和两个缓冲区各做两次二分查找，耗时为O(log n)
+ * @param minPrice 最低价格（含）
+ * @param maxPrice 最高价格（含）
+ * @return 商品数
+ */
+int PriceIndex::count(double minPrice, double maxPrice) const {
+    if (minPrice > maxPrice) {
+        return 0;
+    }
+    auto rangeSize = [minPrice, maxPrice](const QVector<Entry>& values) {
+        auto low = std::lower_bound(values.cbegin(), values.cend(), minPrice, [](const Entry& entry, double price) {
+            return entry.price < price;
+        });
+        auto high = std::upper_bound(low, values.cend(), maxPrice, [](double price, const Entry& entry) {
+            return price < entry.price;
+        });
+        return int(high - low);
+    };
+    return rangeSize(entries) + rangeSize(added) - rangeSize(removed);
+}
+
+/**
+ * @brief 按价格顺序遍历价格区间内的商品
+ * @param minPrice 最低价格（含）
+ * @param maxPrice 最高价格（含）
+ * @param descending 为true时按价格降序，否则按升序
+ * @param visitor 接收槽位的回调，返回false时停止
+ */
+void PriceIndex::scan(double minPrice, double maxPrice, bool descending, const Visitor& visitor) const {
+    scanRange(nullptr, minPrice, maxPrice, descending, visitor);
+}
+
+/**
+ * @brief 从指定商品之后继续按价格顺序遍历
+ * @param afterPrice 上一页最后一个商品的价格
+ * @param afterProductId 上一页最后一个商品的ID
+ * @param minPrice 最低价格（含）
+ * @param maxPrice 最高价格（含）
+ * @param descending 为true时按价格降序，否则按升序
+ * @param visitor 接收槽位的回调，返回false时停止
+ */
+void PriceIndex::scanAfter(double afterPrice, int afterProductId, double minPrice, double maxPrice, bool descending,
+                           const Visitor& visitor) const {
+    const Entry after = {afterPrice, afterProductId, descending ? 0u : std::numeric_limits<quint32>::max()};
+    scanRange(&after, minPrice, maxPrice, descending, visitor);
+}
+
+/**
+ * @brief 按价格顺序遍历价格区间内的商品
+ *
+ * 只定位区间两端，之后按顺序归并主体和新增缓冲区，不对结果排序
+ * @param after 为空时从区间起点开始，否则跳过排在该项之前（降序时为之后）的项
+ * @param minPrice 最低价格（含）
+ * @param maxPrice 最高价格（含）
+ * @param descending 为true时按价格降序，否则按升序
+ * @param visitor 接收槽位的回调，返回false时停止
+ */
+void PriceIndex::scanRange(const Entry* after, double minPrice, double maxPrice, bool descending,
+                           const Visitor& visitor) const {
+    if (minPrice > maxPrice) {
+        return;
+    }
+    using Iterator = QVector<Entry>::const_iterator;
+    auto bounds = [after, minPrice, maxPrice, descending](const QVector<Entry>& values) {
+        Iterator low = std::lower_bound(values.cbegin(), values.cend(), minPrice, [](const Entry& entry, double price) {
+            return entry.price < price;
+        });
+        Iterator high = std::upper_bound(low, values.cend(), maxPrice, [](double price, const Entry& entry) {
+            return price < entry.price;
+        });
+        if (after && !descending) {
+            low = qMax(low, std::upper_bound(values.cbegin(), values.cend(), *after));
+            high = qMax(low, high);
+        } else if (after) {
+            high = qMin(high, std::lower_bound(values.cbegin(), values.cend(), *after));
+            low = qMin(low, high);
+        }
+        return qMakePair(low, high);
+    };
+    const auto main = bounds(entries);
+    const auto pending = bounds(added);
+    const auto dead = bounds(removed);
+    auto visit = [&visitor](const Entry& entry) {
+        return visitor(entry.slot);
+    };
+
+    if (descending) {
+        using Reverse = std::reverse_iterator<Iterator>;
+        mergeRanges(Reverse(main.second), Reverse(main.first), Reverse(pending.second), Reverse(pending.first),
+                    Reverse(dead.second), Reverse(dead.first),
+                    [](const Entry& a, const Entry& b) { return b < a; }, visit);
+    } else {
+        mergeRanges(main.first, main.second, pending.first, pending.second, dead.first, dead.second,
+                    [](const Entry& a, const Entry& b) { return a < b; }, visit);
+    }
+}
+
+/**
+ * @brief 缓冲区超过主体长度的平方根时归并
+ */
+void PriceIndex::compactIfNeeded() {
+    if (added.size() + removed.size() > qMax(32, int(qSqrt(entries.size())))) {
+        compact();
+    }
+}
+
+/**
+ * @brief 把缓冲区归并进主体
+ */
+void PriceIndex::compact() {
+    QVector<Entry> merged;
+    merged.reserve(size());
+    mergeRanges(entries.cbegin(), entries.cend(), added.cbegin(), added.cend(), removed.cbegin(), removed.cend(),
+                [](const Entry& a, const Entry& b) { return a < b; },
+                [&merged](const Entry& entry) {
+                    merged.append(entry);
+                    return true;
+                });
+    entries = merged;
+    added.clear();
+    removed.clear();
+}
\ No newline at end of file
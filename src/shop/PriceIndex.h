@@ -0,0 +1,124 @@
+#ifndef PRICEINDEX_H
+#define PRICEINDEX_H
+
+#include <QVector>
+#include <functional>
+
+/**
+ * @brief 价格有序索引类
+ *
+ * PriceIndex按（价格，商品ID）的顺序保存商品槽位。主体是一个有序数组，
+ * 新增和删除先记录在两个小的有序缓冲区中，缓冲区超过主体长度的平方根时才归并进主体，
+ * 单次变更的均摊开销为O(√n)。区间查询在主体和缓冲区中各做一次二分查找后归并输出，
+ * 耗时为O(log n + k)；可以按价格升序或降序逐个输出，调用方随时可以停止
+ */
+class PriceIndex {
+public:
+    /**
+     * @brief 逐个接收槽位的回调，返回false时停止遍历
+     */
+    using Visitor = std::function<bool(quint32)>;
+
+    /**
+     * @brief 登记商品价格
+     * @param slot 槽位号
+     * @param productId 商品ID，价格相同时按商品ID排序
+     * @param price 价格
+     */
+    void insert(quint32 slot, int productId, double price);
+
+    /**
+     * @brief 移除商品价格
+     * @param slot 槽位号
+     * @param productId 商品ID
+     * @param price 登记时的价格
+     */
+    void remove(quint32 slot, int productId, double price);
+
+    /**
+     * @brief 获取索引中的商品数
+     * @return 商品数
+     */
+    int size() const;
+
+    /**
+     * @brief 统计价格区间内的商品数
+     * @param minPrice 最低价格（含）
+     * @param maxPrice 最高价格（含）
+     * @return 商品数
+     */
+    int count(double minPrice, double maxPrice) const;
+
+    /**
+     * @brief 按价格顺序遍历价格区间内的商品
+     * @param minPrice 最低价格（含）
+     * @param maxPrice 最高价格（含）
+     * @param descending 为true时按价格降序，否则按升序
+     * @param visitor 接收槽位的回调，返回false时停止
+     */
+    void scan(double minPrice, double maxPrice, bool descending, const Visitor& visitor) const;
+
+    /**
+     * @brief 从指定商品之后继续按价格顺序遍历，用于游标分页
+     *
+     * 起点由二分查找定位，不逐个跳过前面的商品
+     * @param afterPrice 上一页最后一个商品的价格
+     * @param afterProductId 上一页最后一个商品的ID
+     * @param minPrice 最低价格（含）
+     * @param maxPrice 最高价格（含）
+     * @param descending 为true时按价格降序，否则按升序
+     * @param visitor 接收槽位的回调，返回false时停止
+     */
+    void scanAfter(double afterPrice, int afterProductId, double minPrice, double maxPrice, bool descending,
+                   const Visitor& visitor) const;
+
+private:
+    /**
+     * @brief 索引项
+     */
+    struct Entry {
+        double price;  ///< 价格
+        int productId; ///< 商品ID
+        quint32 slot;  ///< 槽位号
+
+        /**
+         * @brief 按（价格，商品ID，槽位号）比较
+         * @param other 另一个索引项
+         * @return 排在other之前返回true，否则返回false
+         */
+        bool operator<(const Entry& other) const;
+
+        /**
+         * @brief 是否为同一个索引项
+         * @param other 另一个索引项
+         * @return 相同返回true，否则返回false
+         */
+        bool operator==(const Entry& other) const;
+    };
+
+    /**
+     * @brief 按价格顺序遍历价格区间内的商品
+     * @param after 为空时从区间起点开始，否则跳过排在该项之前（降序时为之后）及与之键相同的项
+     * @param minPrice 最低价格（含）
+     * @param maxPrice 最高价格（含）
+     * @param descending 为true时按价格降序，否则按升序
+     * @param visitor 接收槽位的回调，返回false时停止
+     */
+    void scanRange(const Entry* after, double minPrice, double maxPrice, bool descending, const Visitor& visitor) const;
+
+    /**
+     * @brief 把缓冲区归并进主体
+     */
+    void compact();
+
+    /**
+     * @brief 缓冲区过大时归并
+     */
+    void compactIfNeeded();
+
+    QVector<Entry> entries; ///< 主体，有序
+    QVector<Entry> added;   ///< 尚未归并的新增项，有序
+    QVector<Entry> removed; ///< 尚未归并的主体删除项，有序
+};
+
+#endif // PRICEINDEX_H
\ No newline at end of file
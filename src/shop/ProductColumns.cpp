@@ -0,0 +1,166 @@
+#include "ProductColumns.h"
+#include "RecencyIndex.h"
+
+/**
+ * @brief 计入一个价格
+ * @param price 价格
+ */
+void ProductColumns::PriceSummary::add(double price) {
+    min = count == 0 ? price : qMin(min, price);
+    max = count == 0 ? price : qMax(max, price);
+    sum += price;
+    ++count;
+}
+
+/**
+ * @brief 获取平均价格
+ * @return 平均价格
+ */
+double ProductColumns::PriceSummary::average() const {
+    return count > 0 ? sum / count : 0.0;
+}
+
+/**
+ * @brief 获取槽位数
+ * @return 槽位数
+ */
+int ProductColumns::size() const {
+    return productIdColumn.size();
+}
+
+/**
+ * @brief 在末尾追加一个空闲槽位
+ * @return 新槽位号
+ */
+quint32 ProductColumns::append() {
+    productIdColumn.append(0);
+    priceColumn.append(0.0);
+    categoryColumn.append(0);
+    sellerColumn.append(0);
+    statusColumn.append(0);
+    locationColumn.append(0);
+    timeColumn.append(0);
+    return quint32(productIdColumn.size() - 1);
+}
+
+/**
+ * @brief 把商品的定长字段写入槽位
+ * @param slot 槽位号
+ * @param product 商品对象
+ * @param statusCode 状态的字典编码
+ * @param locationCode 地址的字典编码
+ */
+void ProductColumns::assign(quint32 slot, const Product& product, quint32 statusCode, quint32 locationCode) {
+    const int row = int(slot);
+    productIdColumn[row] = product.getProductId();
+    priceColumn[row] = product.getPrice();
+    categoryColumn[row] = product.getCategoryId();
+    sellerColumn[row] = product.getSellerId();
+    statusColumn[row] = statusCode;
+    locationColumn[row] = locationCode;
+    timeColumn[row] = RecencyIndex::timeKey(product.getPublicTime());
+}
+
+/**
+ * @brief 把槽位标记为空闲
+ * @param slot 槽位号
+ */
+void ProductColumns::release(quint32 slot) {
+    productIdColumn[int(slot)] = 0;
+}
+
+/**
+ * @brief 槽位中的整数列是否等于指定值
+ * @param column 列
+ * @param slot 槽位号
+ * @param value 值
+ * @return 相等返回true，否则返回false
+ */
+bool ProductColumns::equals(Column column, quint32 slot, qint64 value) const {
+    const int row = int(slot);
+    switch (column) {
+    case SellerColumn:
+        return sellerColumn.at(row) == value;
+    case CategoryColumn:
+        return categoryColumn.at(row) == value;
+    case StatusColumn:
+        return statusColumn.at(row) == value;
+    case LocationColumn:
+        return locationColumn.at(row) == value;
+    }
+    return false;
+}
+
+/**
+ * @brief 顺序扫描价格列，聚合全部非空闲槽位的价格
+ *
+ * 只读取商品ID列和价格列两个连续数组
+ * @return 价格聚合
+ */
+ProductColumns::PriceSummary ProductColumns::summarizePrices() const {
+    PriceSummary summary;
+    const int* ids = productIdColumn.constData();
+    const double* prices = priceColumn.constData();
+    for (int row = 0; row < productIdColumn.size(); ++row) {
+        if (ids[row] != 0) {
+            summary.add(prices[row]);
+        }
+    }
+    return summary;
+}
+
+/**
+ * @brief 获取商品ID列
+ * @return 商品ID列，0表示空闲槽位
+ */
+const QVector<int>& ProductColumns::productIds() const {
+    return productIdColumn;
+}
+
+/**
+ * @brief 获取价格列
+ * @return 价格列
+ */
+const QVector<double>& ProductColumns::prices() const {
+    return priceColumn;
+}
+
+/**
+ * @brief 获取分类ID列
+ * @return 分类ID列
+ */
+const QVector<int>& ProductColumns::categoryIds() const {
+    return categoryColumn;
+}
+
+/**
+ * @brief 获取卖家ID列
+ * @return 卖家ID列
+ */
+const QVector<int>& ProductColumns::sellerIds() const {
+    return sellerColumn;
+}
+
+/**
+ * @brief 获取状态编码列
+ * @return 状态编码列
+ */
+const QVector<quint32>& ProductColumns::statusCodes() const {
+    return statusColumn;
+}
+
+/**
+ * @brief 获取地址编码列
+ * @return 地址编码列
+ */
+const QVector<quint32>& ProductColumns::locationCodes() const {
+    return locationColumn;
+}
+
+/**
+ * @brief 获取发布时间键列
+ * @return 发布时间键列
+ */
+const QVector<qint64>& ProductColumns::timeKeys() const {
+    return timeColumn;
+}
\ No newline at end of file
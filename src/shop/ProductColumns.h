@@ -0,0 +1,111 @@
+#ifndef PRODUCTCOLUMNS_H
+#define PRODUCTCOLUMNS_H
+
+#include "Product.h"
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @brief 商品列存储类
+ *
+ * ProductColumns按槽位把商品的定长字段分列保存在连续的数组中（结构数组）：
+ * 商品ID、价格、分类ID、卖家ID、状态编码、地址编码和发布时间键各占一列。
+ * 过滤和聚合只顺序读取用到的列，不需要访问Product对象中分散在堆上的字符串、列表和日期。
+ * 槽位由ProductSearchIndex分配并随每次插入和移除同步维护，商品ID为0的槽位是空闲槽位
+ */
+class ProductColumns {
+public:
+    /**
+     * @brief 可以按值比较的整数列
+     */
+    enum Column {
+        SellerColumn,   ///< 卖家ID
+        CategoryColumn, ///< 分类ID
+        StatusColumn,   ///< 状态编码
+        LocationColumn  ///< 地址编码
+    };
+
+    /**
+     * @brief 价格聚合
+     */
+    struct PriceSummary {
+        int count = 0;    ///< 商品数
+        double min = 0.0; ///< 最低价格
+        double max = 0.0; ///< 最高价格
+        double sum = 0.0; ///< 价格之和
+
+        /**
+         * @brief 计入一个价格
+         * @param price 价格
+         */
+        void add(double price);
+
+        /**
+         * @brief 获取平均价格
+         * @return 平均价格，没有商品时为0
+         */
+        double average() const;
+    };
+
+    /**
+     * @brief 获取槽位数，包括空闲槽位
+     * @return 槽位数
+     */
+    int size() const;
+
+    /**
+     * @brief 在末尾追加一个空闲槽位
+     * @return 新槽位号
+     */
+    quint32 append();
+
+    /**
+     * @brief 把商品的定长字段写入槽位
+     * @param slot 槽位号
+     * @param product 商品对象
+     * @param statusCode 状态的字典编码
+     * @param locationCode 地址的字典编码
+     */
+    void assign(quint32 slot, const Product& product, quint32 statusCode, quint32 locationCode);
+
+    /**
+     * @brief 把槽位标记为空闲，其余列保留旧值直到槽位被复用
+     * @param slot 槽位号
+     */
+    void release(quint32 slot);
+
+    /**
+     * @brief 槽位中的整数列是否等于指定值
+     * @param column 列
+     * @param slot 槽位号
+     * @param value 值
+     * @return 相等返回true，否则返回false
+     */
+    bool equals(Column column, quint32 slot, qint64 value) const;
+
+    /**
+     * @brief 顺序扫描价格列，聚合全部非空闲槽位的价格
+     * @return 价格聚合
+     */
+    PriceSummary summarizePrices() const;
+
+    // Columns
+    const QVector<int>& productIds() const;
+    const QVector<double>& prices() const;
+    const QVector<int>& categoryIds() const;
+    const QVector<int>& sellerIds() const;
+    const QVector<quint32>& statusCodes() const;
+    const QVector<quint32>& locationCodes() const;
+    const QVector<qint64>& timeKeys() const;
+
+private:
+    QVector<int> productIdColumn;    ///< 商品ID，0表示空闲槽位
+    QVector<double> priceColumn;     ///< 价格
+    QVector<int> categoryColumn;     ///< 分类ID
+    QVector<int> sellerColumn;       ///< 卖家ID
+    QVector<quint32> statusColumn;   ///< 状态编码
+    QVector<quint32> locationColumn; ///< 地址编码
+    QVector<qint64> timeColumn;      ///< 发布时间键，见RecencyIndex::timeKey()
+};
+
+#endif // PRODUCTCOLUMNS_H
\ No newline at end of file
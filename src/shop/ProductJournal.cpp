@@ -0,0 +1,208 @@
+#include "ProductJournal.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+
+/**
+ * @brief ProductJournal构造函数
+ * @param fileName 日志文件路径
+ */
+ProductJournal::ProductJournal(const QString& fileName)
+    : file(fileName), entries(0), pendingEntries(0) {
+}
+
+/**
+ * @brief ProductJournal析构函数
+ */
+ProductJournal::~ProductJournal() {
+    file.close();
+}
+
+/**
+ * @brief 缓存一条保存记录
+ * @param product 商品对象
+ */
+void ProductJournal::appendSave(const Product& product) {
+    QJsonObject record;
+    record["op"] = "save";
+    record["product"] = Product::toJson(product);
+    appendRecord(QJsonDocument(record).toJson(QJsonDocument::Compact));
+}
+
+/**
+ * @brief 缓存一条删除记录
+ * @param productId 商品ID
+ */
+void ProductJournal::appendRemove(int productId) {
+    QJsonObject record;
+    record["op"] = "remove";
+    record["productId"] = productId;
+    appendRecord(QJsonDocument(record).toJson(QJsonDocument::Compact));
+}
+
+/**
+ * @brief 将缓存的记录一次性写入日志文件并刷新
+ *
+ * 写入失败时把文件截回写入前的长度，缓存的记录保留，重试时完整地追加一次
+ * @return 没有缓存记录或写入成功返回true，否则返回false
+ */
+bool ProductJournal::commit() {
+    if (pendingEntries == 0) {
+        return true;
+    }
+
+    if (!ensureOpen()) {
+        return false;
+    }
+
+    const qint64 committedSize = file.size();
+    if (file.write(pending) != pending.size() || !file.flush()) {
+        qDebug() << "Cannot append to journal:" << file.fileName();
+        // 关闭后再截断，关闭时写出的残余缓冲也一并截掉
+        file.close();
+        if (!file.resize(committedSize)) {
+            qDebug() << "Cannot truncate partial journal write:" << file.fileName();
+        }
+        return false;
+    }
+
+    entries += pendingEntries;
+    pending.clear();
+    pendingEntries = 0;
+    return true;
+}
+
+/**
+ * @brief 按写入顺序重放日志
+ * @param apply 对每条有效记录调用的回调
+ * @return 重放的记录数
+ */
+int ProductJournal::replay(const std::function<void(const Entry&)>& apply) {
+    file.close();
+
+    QFile input(file.fileName());
+    if (!input.open(QIODevice::ReadOnly)) {
+        entries = 0;
+        return 0;
+    }
+
+    int replayed = 0;
+    qint64 validSize = 0;
+    bool torn = false;
+    while (!input.atEnd()) {
+        QByteArray line = input.readLine();
+        // 没有换行符的最后一行是崩溃时未写完的记录，丢弃
+        if (!line.endsWith('\n')) {
+            qDebug() << "Discarding torn journal record in" << file.fileName();
+            torn = true;
+            break;
+        }
+        validSize += line.size();
+
+        QJsonParseError error;
+        QJsonDocument doc = QJsonDocument::fromJson(line, &error);
+        if (error.error != QJsonParseError::NoError || !doc.isObject()) {
+            qDebug() << "Skipping corrupt journal record:" << error.errorString();
+            continue;
+        }
+
+        QJsonObject record = doc.object();
+        QString op = record["op"].toString();
+        Entry entry;
+        if (op == "save") {
+            entry.operation = Entry::Save;
+            entry.product = Product::fromJson(record["product"].toObject());
+            entry.productId = entry.product.getProductId();
+        } else if (op == "remove") {
+            entry.operation = Entry::Remove;
+            entry.productId = record["productId"].toInt();
+        } else {
+            qDebug() << "Unknown journal operation:" << op;
+            continue;
+        }
+
+        apply(entry);
+        ++replayed;
+    }
+    input.close();
+
+    // 截掉残缺记录，避免后续追加的记录与其拼接成一行
+    if (torn && !file.resize(validSize)) {
+        qDebug() << "Cannot truncate torn journal:" << file.fileName();
+    }
+
+    entries = replayed;
+    return replayed;
+}
+
+/**
+ * @brief 清空日志
+ * @return 清空成功返回true，否则返回false
+ */
+bool ProductJournal::reset() {
+    file.close();
+    entries = 0;
+    pending.clear();
+    pendingEntries = 0;
+
+    if (!QFile::exists(file.fileName())) {
+        return true;
+    }
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "Cannot truncate journal:" << file.fileName();
+        return false;
+    }
+    file.close();
+    return true;
+}
+
+/**
+ * @brief 获取当前日志中的记录数
+ * @return 记录数
+ */
+int ProductJournal::entryCount() const {
+    return entries + pendingEntries;
+}
+
+/**
+ * @brief 获取尚未写入日志文件的缓存记录数
+ * @return 记录数
+ */
+int ProductJournal::pendingCount() const {
+    return pendingEntries;
+}
+
+/**
+ * @brief 获取日志文件路径
+ * @return 日志文件路径
+ */
+QString ProductJournal::fileName() const {
+    return file.fileName();
+}
+
+/**
+ * @brief 缓存一行记录
+ * @param record 紧凑JSON记录
+ */
+void ProductJournal::appendRecord(const QByteArray& record) {
+    pending.append(record);
+    pending.append('\n');
+    ++pendingEntries;
+}
+
+/**
+ * @brief 以追加模式打开日志文件
+ * @return 打开成功返回true，否则返回false
+ */
+bool ProductJournal::ensureOpen() {
+    if (file.isOpen()) {
+        return true;
+    }
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qDebug() << "Cannot open journal for writing:" << file.fileName();
+        return false;
+    }
+    return true;
+}
\ No newline at end of file
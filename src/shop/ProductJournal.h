@@ -0,0 +1,122 @@
+#ifndef PRODUCTJOURNAL_H
+#define PRODUCTJOURNAL_H
+
+#include "Product.h"
+#include <QFile>
+#include <QString>
+#include <functional>
+
+/**
+ * @brief 商品变更日志类
+ *
+ * ProductJournal类实现商品仓库的预写日志（write-ahead journal）。
+ * 每次变更以一行紧凑JSON记录追加到快照旁的日志文件中，
+ * 启动时先加载快照，再按顺序重放日志，写入开销与变更大小成正比，而不是与商品总数成正比。
+ * 追加的记录先缓存在内存中，由commit()一次性写入，以便组提交
+ */
+class ProductJournal {
+public:
+    /**
+     * @brief 日志记录
+     */
+    struct Entry {
+        /**
+         * @brief 记录类型
+         */
+        enum Operation {
+            Save,   ///< 新增或更新商品
+            Remove  ///< 删除商品
+        };
+
+        Operation operation; ///< 记录类型
+        Product product;     ///< 新增或更新后的商品（仅Save有效）
+        int productId;       ///< 被操作的商品ID
+    };
+
+    /**
+     * @brief 构造函数
+     * @param fileName 日志文件路径
+     */
+    explicit ProductJournal(const QString& fileName);
+
+    /**
+     * @brief 析构函数，关闭日志文件
+     */
+    ~ProductJournal();
+
+    ProductJournal(const ProductJournal&) = delete;
+    ProductJournal& operator=(const ProductJournal&) = delete;
+
+    /**
+     * @brief 缓存一条保存记录
+     * @param product 商品对象
+     */
+    void appendSave(const Product& product);
+
+    /**
+     * @brief 缓存一条删除记录
+     * @param productId 商品ID
+     */
+    void appendRemove(int productId);
+
+    /**
+     * @brief 将缓存的记录一次性写入日志文件并刷新
+     *
+     * 写入失败时日志文件恢复到写入前的长度，缓存的记录保留到下次提交
+     * @return 没有缓存记录或写入成功返回true，否则返回false
+     */
+    bool commit();
+
+    /**
+     * @brief 按写入顺序重放日志
+     *
+     * 末尾因崩溃而写了一半的记录会被忽略
+     * @param apply 对每条有效记录调用的回调
+     * @return 重放的记录数，日志不存在时返回0
+     */
+    int replay(const std::function<void(const Entry&)>& apply);
+
+    /**
+     * @brief 清空日志及缓存的记录，在快照落盘之后调用
+     * @return 清空成功返回true，否则返回false
+     */
+    bool reset();
+
+    /**
+     * @brief 获取当前日志中的记录数（含尚未写入的缓存记录）
+     * @return 记录数
+     */
+    int entryCount() const;
+
+    /**
+     * @brief 获取尚未写入日志文件的缓存记录数
+     * @return 记录数
+     */
+    int pendingCount() const;
+
+    /**
+     * @brief 获取日志文件路径
+     * @return 日志文件路径
+     */
+    QString fileName() const;
+
+private:
+    /**
+     * @brief 缓存一行记录
+     * @param record 紧凑JSON记录
+     */
+    void appendRecord(const QByteArray& record);
+
+    /**
+     * @brief 以追加模式打开日志文件
+     * @return 打开成功返回true，否则返回false
+     */
+    bool ensureOpen();
+
+    QFile file;         ///< 日志文件，首次写入时以追加模式打开
+    QByteArray pending; ///< 尚未写入的记录，每条一行
+    int entries;        ///< 已写入日志文件的记录数
+    int pendingEntries; ///< 缓存中的记录数
+};
+
+#endif // PRODUCTJOURNAL_H
\ No newline at end of file
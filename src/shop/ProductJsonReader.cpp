@@ -0,0 +1,796 @@
+#include "ProductJsonReader.h"
+#include <QBuffer>
+#include <QDateTime>
+#include <QThreadPool>
+#include <QVector>
+#include <limits>
+
+/**
+ * @brief 判断是否为JSON空白字符
+ * @param c 字节
+ * @return 是空白返回true，否则返回false
+ */
+static bool isJsonSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+/**
+ * @brief 将一个Unicode码点以UTF-8编码追加到字节数组
+ * @param out 目标字节数组
+ * @param codePoint Unicode码点
+ */
+static void appendUtf8(QByteArray& out, uint codePoint) {
+    if (codePoint < 0x80) {
+        out.append(char(codePoint));
+    } else if (codePoint < 0x800) {
+        out.append(char(0xC0 | (codePoint >> 6)));
+        out.append(char(0x80 | (codePoint & 0x3F)));
+    } else if (codePoint < 0x10000) {
+        out.append(char(0xE0 | (codePoint >> 12)));
+        out.append(char(0x80 | ((codePoint >> 6) & 0x3F)));
+        out.append(char(0x80 | (codePoint & 0x3F)));
+    } else {
+        out.append(char(0xF0 | (codePoint >> 18)));
+        out.append(char(0x80 | ((codePoint >> 12) & 0x3F)));
+        out.append(char(0x80 | ((codePoint >> 6) & 0x3F)));
+        out.append(char(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+/**
+ * @brief 解析4位十六进制数
+ * @param text 字符串内容
+ * @param from 起始位置
+ * @param out 输出数值
+ * @return 解析成功返回true，否则返回false
+ */
+static bool parseHex4(const QByteArray& text, int from, uint& out) {
+    if (from + 4 > text.size()) {
+        return false;
+    }
+
+    out = 0;
+    for (int i = from; i < from + 4; ++i) {
+        char h = text.at(i);
+        uint value;
+        if (h >= '0' && h <= '9') {
+            value = uint(h - '0');
+        } else if (h >= 'a' && h <= 'f') {
+            value = uint(h - 'a' + 10);
+        } else if (h >= 'A' && h <= 'F') {
+            value = uint(h - 'A' + 10);
+        } else {
+            return false;
+        }
+        out = (out << 4) | value;
+    }
+    return true;
+}
+
+/**
+ * @brief 单段数组元素的解析任务
+ */
+class ProductJsonReader::ChunkTask : public QRunnable {
+public:
+    ChunkTask(const char* data, int size, ChunkResult* result)
+        : chunk(QByteArray::fromRawData(data, size)), result(result) {
+    }
+
+    void run() override {
+        QBuffer buffer(&chunk);
+        buffer.open(QIODevice::ReadOnly);
+        ProductJsonReader reader(&buffer);
+        QList<Product>& products = result->products;
+        result->ok = reader.readElements([&products](const Product& product) {
+            products.append(product);
+        });
+        result->error = reader.errorString();
+    }
+
+private:
+    QByteArray chunk;     ///< 本段数据（不拷贝原文档）
+    ChunkResult* result;  ///< 本段的解析结果
+};
+
+/**
+ * @brief ProductJsonReader构造函数
+ * @param device 已以只读方式打开的输入设备
+ * @param chunkSize 每次从设备读取的字节数
+ */
+ProductJsonReader::ProductJsonReader(QIODevice* device, int chunkSize)
+    : device(device), chunkSize(qMax(1, chunkSize)), position(0), offset(0), depth(0), products(0) {
+}
+
+/**
+ * @brief 读取整个商品数组
+ * @param onProduct 每解析出一个商品时调用的回调
+ * @return 读取成功返回true，否则返回false
+ */
+bool ProductJsonReader::read(const std::function<void(const Product&)>& onProduct) {
+    reset();
+
+    char c;
+    if (!peek(c)) {
+        return fail("empty document");
+    }
+    if (c != '[') {
+        return fail("not an array");
+    }
+    ++position;
+
+    if (!peek(c)) {
+        return fail("unterminated array");
+    }
+    if (c == ']') {
+        ++position;
+    } else if (!parseElements(onProduct, true)) {
+        return false;
+    }
+
+    if (peek(c)) {
+        return fail("garbage after array");
+    }
+    return true;
+}
+
+/**
+ * @brief 读取逗号分隔的数组元素序列（不含方括号），直到输入结束
+ * @param onProduct 每解析出一个商品时调用的回调
+ * @return 读取成功返回true，否则返回false
+ */
+bool ProductJsonReader::readElements(const std::function<void(const Product&)>& onProduct) {
+    reset();
+    return parseElements(onProduct, false);
+}
+
+/**
+ * @brief 多线程读取内存中的商品数组
+ *
+ * 先顺序扫描一遍数组结构，在顶层对象边界处把数组切成大小相近的若干段，
+ * 各段在线程池中独立解析，最后按文档顺序回调，结果与read()完全一致
+ * @param data 完整的JSON文档
+ * @param threadCount 线程数，不大于1或文档较小时退化为单线程读取
+ * @param onProduct 每解析出一个商品时在调用线程上调用的回调
+ * @param errorString 读取失败时输出错误信息，可以为nullptr
+ * @return 读取成功返回true，否则返回false
+ */
+bool ProductJsonReader::readParallel(const QByteArray& data, int threadCount,
+                                     const std::function<void(const Product&)>& onProduct,
+                                     QString* errorString) {
+    QList<QPair<int, int>> ranges;
+    if (threadCount > 1 && data.size() >= kMinParallelBytes) {
+        ranges = splitArray(data, threadCount);
+    }
+
+    // 结构扫描失败或只有一段时由顺序读取给出结果和错误信息
+    if (ranges.size() < 2) {
+        QByteArray copy = data;
+        QBuffer buffer(&copy);
+        buffer.open(QIODevice::ReadOnly);
+        ProductJsonReader reader(&buffer);
+        bool ok = reader.read(onProduct);
+        if (!ok && errorString) {
+            *errorString = reader.errorString();
+        }
+        return ok;
+    }
+
+    QVector<ChunkResult> results(ranges.size());
+    {
+        QThreadPool pool;
+        pool.setMaxThreadCount(threadCount);
+        for (int i = 0; i < ranges.size(); ++i) {
+            ChunkResult* result = &results[i];
+            const QPair<int, int> range = ranges.at(i);
+            pool.start(new ChunkTask(data.constData() + range.first, range.second - range.first, result));
+        }
+        pool.waitForDone();
+    }
+
+    for (int i = 0; i < results.size(); ++i) {
+        if (!results.at(i).ok) {
+            if (errorString) {
+                *errorString = QString("%1 (chunk starting at offset %2)")
+                               .arg(results.at(i).error).arg(ranges.at(i).first);
+            }
+            return false;
+        }
+    }
+
+    for (const ChunkResult& result : results) {
+        for (const Product& product : result.products) {
+            onProduct(product);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 获取最近一次读取的错误信息
+ * @return 错误信息
+ */
+QString ProductJsonReader::errorString() const {
+    return error;
+}
+
+/**
+ * @brief 获取最近一次读取解析出的商品数
+ * @return 商品数
+ */
+int ProductJsonReader::productCount() const {
+    return products;
+}
+
+/**
+ * @brief 保证缓冲区中至少还有一个未读字节
+ * @return 有可读字节返回true，输入结束返回false
+ */
+bool ProductJsonReader::fill() {
+    if (position < buffer.size()) {
+        return true;
+    }
+
+    offset += buffer.size();
+    buffer = device->read(chunkSize);
+    position = 0;
+    return !buffer.isEmpty();
+}
+
+/**
+ * @brief 跳过空白并查看下一个字节
+ * @param c 输出下一个字节
+ * @return 有可读字节返回true，输入结束返回false
+ */
+bool ProductJsonReader::peek(char& c) {
+    while (fill()) {
+        c = buffer.at(position);
+        if (!isJsonSpace(c)) {
+            return true;
+        }
+        ++position;
+    }
+    return false;
+}
+
+/**
+ * @brief 跳过空白并消费一个指定字节
+ * @param expected 期望的字节
+ * @return 匹配返回true，否则返回false
+ */
+bool ProductJsonReader::expect(char expected) {
+    char c;
+    if (!peek(c) || c != expected) {
+        return fail(QString("expected '%1'").arg(QChar(expected)));
+    }
+    ++position;
+    return true;
+}
+
+/**
+ * @brief 重置读取状态
+ */
+void ProductJsonReader::reset() {
+    buffer.clear();
+    position = 0;
+    offset = 0;
+    depth = 0;
+    products = 0;
+    error.clear();
+}
+
+/**
+ * @brief 解析逗号分隔的数组元素
+ * @param onProduct 每解析出一个商品时调用的回调
+ * @param bracketed 为true时以']'结束，否则以输入结束
+ * @return 解析成功返回true，否则返回false
+ */
+bool ProductJsonReader::parseElements(const std::function<void(const Product&)>& onProduct,
+                                      bool bracketed) {
+    char c;
+    for (;;) {
+        if (!peek(c)) {
+            return fail("unterminated array");
+        }
+        if (c == '{') {
+            Product product;
+            if (!parseProduct(product)) {
+                return false;
+            }
+            ++products;
+            onProduct(product);
+        } else if (!skipValue()) {
+            // 与旧的加载逻辑一致，数组中的非对象元素被忽略
+            return false;
+        }
+
+        if (!peek(c)) {
+            return bracketed ? fail("unterminated array") : true;
+        }
+        ++position;
+        if (c == ']' && bracketed) {
+            return true;
+        }
+        if (c != ',') {
+            return fail(bracketed ? "expected ',' or ']'" : "expected ','");
+        }
+    }
+}
+
+/**
+ * @brief 在顶层元素边界处把数组切成若干段
+ *
+ * 只跟踪字符串、转义和嵌套深度，不解析值；结构不完整时返回空列表
+ * @param data 完整的JSON文档
+ * @param chunkCount 期望的段数
+ * @return 每段元素序列的[起始, 结束)字节区间，不含方括号和分隔逗号
+ */
+QList<QPair<int, int>> ProductJsonReader::splitArray(const QByteArray& data, int chunkCount) {
+    QList<QPair<int, int>> ranges;
+    const char* bytes = data.constData();
+    int size = data.size();
+
+    int begin = 0;
+    while (begin < size && isJsonSpace(bytes[begin])) {
+        ++begin;
+    }
+    if (begin == size || bytes[begin] != '[') {
+        return ranges;
+    }
+    ++begin;
+
+    int target = begin + qMax(1, (size - begin) / chunkCount);
+    int chunkStart = begin;
+    int nesting = 0;
+    bool inString = false;
+    for (int i = begin; i < size; ++i) {
+        char c = bytes[i];
+        if (inString) {
+            if (c == '\\') {
+                ++i;
+            } else if (c == '"') {
+                inString = false;
+            }
+            continue;
+        }
+
+        if (c == '"') {
+            inString = true;
+        } else if (c == '{' || c == '[') {
+            ++nesting;
+        } else if (c == '}' || c == ']') {
+            if (nesting == 0) {
+                if (c != ']') {
+                    return QList<QPair<int, int>>();
+                }
+                for (int j = i + 1; j < size; ++j) {
+                    if (!isJsonSpace(bytes[j])) {
+                        return QList<QPair<int, int>>();
+                    }
+                }
+                ranges.append(qMakePair(chunkStart, i));
+                return ranges;
+            }
+            --nesting;
+        } else if (c == ',' && nesting == 0 && i >= target) {
+            ranges.append(qMakePair(chunkStart, i));
+            chunkStart = i + 1;
+            target = i + qMax(1, (size - begin) / chunkCount);
+        }
+    }
+
+    // 没有找到数组结尾
+    return QList<QPair<int, int>>();
+}
+
+/**
+ * @brief 解析一个商品对象
+ *
+ * 字段按名称直接写入Product，缺失的字段保持与Product::fromJson相同的默认值
+ * @param product 输出商品对象
+ * @return 解析成功返回true，否则返回false
+ */
+bool ProductJsonReader::parseProduct(Product& product) {
+    if (!expect('{')) {
+        return false;
+    }
+
+    char c;
+    if (!peek(c)) {
+        return fail("unterminated object");
+    }
+    if (c == '}') {
+        ++position;
+        return true;
+    }
+
+    QByteArray key;
+    for (;;) {
+        if (!parseString(key) || !expect(':')) {
+            return false;
+        }
+
+        bool ok = true;
+        int intValue = 0;
+        QString stringValue;
+        if (key == "productId") {
+            ok = parseIntValue(intValue);
+            product.setProductId(intValue);
+        } else if (key == "categoryId") {
+            ok = parseIntValue(intValue);
+            product.setCategoryId(intValue);
+        } else if (key == "sellerId") {
+            ok = parseIntValue(intValue);
+            product.setSellerId(intValue);
+        } else if (key == "price") {
+            double price = 0.0;
+            if (peek(c) && (c == '-' || (c >= '0' && c <= '9'))) {
+                ok = parseNumber(price);
+            } else {
+                ok = skipValue();
+            }
+            product.setPrice(price);
+        } else if (key == "title") {
+            ok = parseStringValue(stringValue);
+            product.setTitle(stringValue);
+        } else if (key == "description") {
+            ok = parseStringValue(stringValue);
+            product.setDescription(stringValue);
+        } else if (key == "location") {
+            ok = parseStringValue(stringValue);
+            product.setLocation(stringValue);
+        } else if (key == "status") {
+            ok = parseStringValue(stringValue);
+            product.setStatus(stringValue);
+        } else if (key == "publicTime") {
+            ok = parseStringValue(stringValue);
+            product.setPublicTime(QDateTime::fromString(stringValue, Qt::ISODate));
+        } else if (key == "tags") {
+            QList<QString> tags;
+            if (peek(c) && c == '[') {
+                ok = parseStringArray(tags);
+            } else {
+                ok = skipValue();
+            }
+            product.setTags(tags);
+        } else {
+            ok = skipValue();
+        }
+        if (!ok) {
+            return false;
+        }
+
+        if (!peek(c)) {
+            return fail("unterminated object");
+        }
+        ++position;
+        if (c == '}') {
+            return true;
+        }
+        if (c != ',') {
+            return fail("expected ',' or '}'");
+        }
+    }
+}
+
+/**
+ * @brief 解析一个字符串值
+ *
+ * 字符串可以跨越多个读取块，先原样收集再统一处理转义
+ * @param out 输出UTF-8编码的字符串内容
+ * @return 解析成功返回true，否则返回false
+ */
+bool ProductJsonReader::parseString(QByteArray& out) {
+    out.clear();
+    if (!expect('"')) {
+        return false;
+    }
+
+    bool escaped = false;
+    for (;;) {
+        if (!fill()) {
+            return fail("unterminated string");
+        }
+
+        // 批量拷贝不含引号和转义的连续字节
+        int start = position;
+        while (position < buffer.size()) {
+            char c = buffer.at(position);
+            if (c == '"' || c == '\\') {
+                break;
+            }
+            if (static_cast<unsigned char>(c) < 0x20) {
+                return fail("control character in string");
+            }
+            ++position;
+        }
+        out.append(buffer.constData() + start, position - start);
+        if (position == buffer.size()) {
+            continue;
+        }
+
+        char c = buffer.at(position++);
+        if (c == '"') {
+            break;
+        }
+
+        // 保留反斜杠及其后一个字节，避免转义的引号结束字符串
+        if (!fill()) {
+            return fail("unterminated escape");
+        }
+        out.append(c);
+        out.append(buffer.at(position++));
+        escaped = true;
+    }
+
+    return !escaped || unescape(out);
+}
+
+/**
+ * @brief 就地处理字符串中的转义序列
+ *
+ * \\uXXXX转义（含代理对）被转换为UTF-8，孤立的代理项替换为U+FFFD
+ * @param text 含转义序列的字符串内容，输出处理后的内容
+ * @return 处理成功返回true，否则返回false
+ */
+bool ProductJsonReader::unescape(QByteArray& text) {
+    QByteArray out;
+    out.reserve(text.size());
+    int size = text.size();
+    for (int i = 0; i < size; ++i) {
+        char c = text.at(i);
+        if (c != '\\') {
+            out.append(c);
+            continue;
+        }
+
+        char escaped = text.at(++i);
+        switch (escaped) {
+        case '"': out.append('"'); break;
+        case '\\': out.append('\\'); break;
+        case '/': out.append('/'); break;
+        case 'b': out.append('\b'); break;
+        case 'f': out.append('\f'); break;
+        case 'n': out.append('\n'); break;
+        case 'r': out.append('\r'); break;
+        case 't': out.append('\t'); break;
+        case 'u': {
+            uint unit;
+            if (!parseHex4(text, i + 1, unit)) {
+                return fail("invalid unicode escape");
+            }
+            i += 4;
+
+            uint low;
+            if (unit >= 0xD800 && unit < 0xDC00 && i + 2 < size && text.at(i + 1) == '\\'
+                && text.at(i + 2) == 'u' && parseHex4(text, i + 3, low)
+                && low >= 0xDC00 && low < 0xE000) {
+                appendUtf8(out, ((unit - 0xD800) << 10) + (low - 0xDC00) + 0x10000);
+                i += 6;
+            } else if (unit >= 0xD800 && unit < 0xE000) {
+                appendUtf8(out, 0xFFFD);
+            } else {
+                appendUtf8(out, unit);
+            }
+            break;
+        }
+        default:
+            return fail("invalid escape");
+        }
+    }
+
+    text = out;
+    return true;
+}
+
+/**
+ * @brief 解析一个数字值
+ * @param out 输出数值
+ * @return 解析成功返回true，否则返回false
+ */
+bool ProductJsonReader::parseNumber(double& out) {
+    QByteArray text;
+    while (fill()) {
+        char c = buffer.at(position);
+        if (!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')) {
+            break;
+        }
+        text.append(c);
+        ++position;
+    }
+
+    bool ok = false;
+    out = text.toDouble(&ok);
+    if (!ok) {
+        return fail("invalid number");
+    }
+    return true;
+}
+
+/**
+ * @brief 解析字符串数组
+ * @param out 输出字符串列表
+ * @return 解析成功返回true，否则返回false
+ */
+bool ProductJsonReader::parseStringArray(QList<QString>& out) {
+    if (!expect('[')) {
+        return false;
+    }
+
+    char c;
+    if (!peek(c)) {
+        return fail("unterminated array");
+    }
+    if (c == ']') {
+        ++position;
+        return true;
+    }
+
+    for (;;) {
+        QString value;
+        if (!parseStringValue(value)) {
+            return false;
+        }
+        out.append(value);
+
+        if (!peek(c)) {
+            return fail("unterminated array");
+        }
+        ++position;
+        if (c == ']') {
+            return true;
+        }
+        if (c != ',') {
+            return fail("expected ',' or ']'");
+        }
+    }
+}
+
+/**
+ * @brief 解析一个整型字段的值
+ * @param out 输出整数
+ * @return 解析成功返回true，否则返回false
+ */
+bool ProductJsonReader::parseIntValue(int& out) {
+    out = 0;
+    char c;
+    if (!peek(c)) {
+        return fail("unexpected end of input");
+    }
+    if (c != '-' && (c < '0' || c > '9')) {
+        return skipValue();
+    }
+
+    double value;
+    if (!parseNumber(value)) {
+        return false;
+    }
+    if (value >= std::numeric_limits<int>::min() && value <= std::numeric_limits<int>::max()
+        && value == double(int(value))) {
+        out = int(value);
+    }
+    return true;
+}
+
+/**
+ * @brief 解析一个字符串字段的值
+ * @param out 输出字符串
+ * @return 解析成功返回true，否则返回false
+ */
+bool ProductJsonReader::parseStringValue(QString& out) {
+    out.clear();
+    char c;
+    if (!peek(c)) {
+        return fail("unexpected end of input");
+    }
+    if (c != '"') {
+        return skipValue();
+    }
+
+    QByteArray utf8;
+    if (!parseString(utf8)) {
+        return false;
+    }
+    out = QString::fromUtf8(utf8);
+    return true;
+}
+
+/**
+ * @brief 跳过任意一个JSON值
+ * @return 跳过成功返回true，否则返回false
+ */
+bool ProductJsonReader::skipValue() {
+    static const int kMaxDepth = 512;
+
+    char c;
+    if (!peek(c)) {
+        return fail("unexpected end of input");
+    }
+
+    if (c == '"') {
+        QByteArray ignored;
+        return parseString(ignored);
+    }
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        double ignored;
+        return parseNumber(ignored);
+    }
+    if (c == 't') {
+        return consumeLiteral("true") || fail("invalid literal");
+    }
+    if (c == 'f') {
+        return consumeLiteral("false") || fail("invalid literal");
+    }
+    if (c == 'n') {
+        return consumeLiteral("null") || fail("invalid literal");
+    }
+    if (c != '[' && c != '{') {
+        return fail("unexpected character");
+    }
+
+    if (++depth > kMaxDepth) {
+        return fail("nesting too deep");
+    }
+    bool isObject = c == '{';
+    char close = isObject ? '}' : ']';
+    ++position;
+
+    if (!peek(c)) {
+        return fail("unterminated container");
+    }
+    if (c == close) {
+        ++position;
+        --depth;
+        return true;
+    }
+
+    for (;;) {
+        if (isObject) {
+            QByteArray key;
+            if (!parseString(key) || !expect(':')) {
+                return false;
+            }
+        }
+        if (!skipValue()) {
+            return false;
+        }
+
+        if (!peek(c)) {
+            return fail("unterminated container");
+        }
+        ++position;
+        if (c == close) {
+            --depth;
+            return true;
+        }
+        if (c != ',') {
+            return fail("expected ','");
+        }
+    }
+}
+
+/**
+ * @brief 消费一个字面量
+ * @param literal 字面量
+ * @return 匹配返回true，否则返回false（不记录错误）
+ */
+bool ProductJsonReader::consumeLiteral(const char* literal) {
+    for (const char* p = literal; *p != '\0'; ++p) {
+        if (!fill() || buffer.at(position) != *p) {
+            return false;
+        }
+        ++position;
+    }
+    return true;
+}
+
+/**
+ * @brief 记录错误信息
+ * @param message 错误描述
+ * @return 总是返回false
+ */
+bool ProductJsonReader::fail(const QString& message) {
+    if (error.isEmpty()) {
+        error = QString("%1 at offset %2").arg(message).arg(offset + position);
+    }
+    return false;
+}
\ No newline at end of file
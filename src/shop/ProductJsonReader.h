@@ -0,0 +1,207 @@
+#ifndef PRODUCTJSONREADER_H
+#define PRODUCTJSONREADER_H
+
+#include "Product.h"
+#include <QByteArray>
+#include <QIODevice>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <functional>
+
+/**
+ * @brief 商品JSON流式读取类
+ *
+ * ProductJsonReader类以事件驱动的方式逐块解析商品数据文件（商品对象组成的JSON数组），
+ * 每解析完一个商品对象就直接构造Product并回调，不会一次性读入整个文件，也不构建DOM。
+ * 内存占用只与读取块大小和单个商品的大小有关，因此不受QJsonDocument的文档大小上限限制。
+ * 字段的类型转换规则与Product::fromJson一致，未知字段会被跳过
+ */
+class ProductJsonReader {
+public:
+    static constexpr int kDefaultChunkSize = 64 * 1024;     ///< 默认每次从设备读取的字节数
+    static constexpr int kMinParallelBytes = 1024 * 1024;   ///< 小于该大小的文档不做多线程读取
+
+    /**
+     * @brief 构造函数
+     * @param device 已以只读方式打开的输入设备
+     * @param chunkSize 每次从设备读取的字节数
+     */
+    explicit ProductJsonReader(QIODevice* device, int chunkSize = kDefaultChunkSize);
+
+    /**
+     * @brief 读取整个商品数组
+     *
+     * 遇到语法错误时停止并返回false，已回调的商品不会撤回
+     * @param onProduct 每解析出一个商品时调用的回调
+     * @return 读取成功返回true，否则返回false
+     */
+    bool read(const std::function<void(const Product&)>& onProduct);
+
+    /**
+     * @brief 读取逗号分隔的数组元素序列（不含方括号），直到输入结束
+     * @param onProduct 每解析出一个商品时调用的回调
+     * @return 读取成功返回true，否则返回false
+     */
+    bool readElements(const std::function<void(const Product&)>& onProduct);
+
+    /**
+     * @brief 多线程读取内存中的商品数组
+     *
+     * 数组在顶层对象边界处切分后由线程池并行解析，再按文档顺序在调用线程上回调，
+     * 回调顺序和结果与单线程的read()完全一致
+     * @param data 完整的JSON文档
+     * @param threadCount 线程数，不大于1或文档较小时退化为单线程读取
+     * @param onProduct 每解析出一个商品时调用的回调
+     * @param errorString 读取失败时输出错误信息，可以为nullptr
+     * @return 读取成功返回true，否则返回false
+     */
+    static bool readParallel(const QByteArray& data, int threadCount,
+                             const std::function<void(const Product&)>& onProduct,
+                             QString* errorString = nullptr);
+
+    /**
+     * @brief 获取最近一次读取的错误信息
+     * @return 错误信息，没有错误时为空
+     */
+    QString errorString() const;
+
+    /**
+     * @brief 获取最近一次读取解析出的商品数
+     * @return 商品数
+     */
+    int productCount() const;
+
+private:
+    /**
+     * @brief 一段数组元素的解析结果
+     */
+    struct ChunkResult {
+        bool ok = false;         ///< 是否解析成功
+        QString error;           ///< 错误信息
+        QList<Product> products; ///< 按文档顺序解析出的商品
+    };
+
+    class ChunkTask;
+
+    /**
+     * @brief 在顶层元素边界处把数组切成若干段
+     * @param data 完整的JSON文档
+     * @param chunkCount 期望的段数
+     * @return 每段元素序列的[起始, 结束)字节区间，结构不完整时为空
+     */
+    static QList<QPair<int, int>> splitArray(const QByteArray& data, int chunkCount);
+
+    /**
+     * @brief 重置读取状态
+     */
+    void reset();
+
+    /**
+     * @brief 解析逗号分隔的数组元素
+     * @param onProduct 每解析出一个商品时调用的回调
+     * @param bracketed 为true时以']'结束，否则以输入结束
+     * @return 解析成功返回true，否则返回false
+     */
+    bool parseElements(const std::function<void(const Product&)>& onProduct, bool bracketed);
+
+    /**
+     * @brief 保证缓冲区中至少还有一个未读字节
+     * @return 有可读字节返回true，输入结束返回false
+     */
+    bool fill();
+
+    /**
+     * @brief 跳过空白并查看下一个字节，不消费
+     * @param c 输出下一个字节
+     * @return 有可读字节返回true，输入结束返回false
+     */
+    bool peek(char& c);
+
+    /**
+     * @brief 跳过空白并消费一个指定字节
+     * @param expected 期望的字节
+     * @return 匹配返回true，否则记录错误并返回false
+     */
+    bool expect(char expected);
+
+    /**
+     * @brief 解析一个商品对象
+     * @param product 输出商品对象
+     * @return 解析成功返回true，否则返回false
+     */
+    bool parseProduct(Product& product);
+
+    /**
+     * @brief 解析一个字符串值，处理转义字符
+     * @param out 输出UTF-8编码的字符串内容
+     * @return 解析成功返回true，否则返回false
+     */
+    bool parseString(QByteArray& out);
+
+    /**
+     * @brief 就地处理字符串中的转义序列
+     * @param text 含转义序列的字符串内容，输出处理后的内容
+     * @return 处理成功返回true，否则返回false
+     */
+    bool unescape(QByteArray& text);
+
+    /**
+     * @brief 解析一个数字值
+     * @param out 输出数值
+     * @return 解析成功返回true，否则返回false
+     */
+    bool parseNumber(double& out);
+
+    /**
+     * @brief 解析字符串数组，非字符串元素按空字符串处理
+     * @param out 输出字符串列表
+     * @return 解析成功返回true，否则返回false
+     */
+    bool parseStringArray(QList<QString>& out);
+
+    /**
+     * @brief 解析一个整型字段的值，规则与QJsonValue::toInt一致
+     * @param out 输出整数，值不是整数时为0
+     * @return 解析成功返回true，否则返回false
+     */
+    bool parseIntValue(int& out);
+
+    /**
+     * @brief 解析一个字符串字段的值，非字符串值按空字符串处理
+     * @param out 输出字符串
+     * @return 解析成功返回true，否则返回false
+     */
+    bool parseStringValue(QString& out);
+
+    /**
+     * @brief 跳过任意一个JSON值
+     * @return 跳过成功返回true，否则返回false
+     */
+    bool skipValue();
+
+    /**
+     * @brief 消费一个字面量（true、false、null）
+     * @param literal 字面量
+     * @return 匹配返回true，否则返回false
+     */
+    bool consumeLiteral(const char* literal);
+
+    /**
+     * @brief 记录错误信息
+     * @param message 错误描述
+     * @return 总是返回false
+     */
+    bool fail(const QString& message);
+
+    QIODevice* device; ///< 输入设备
+    int chunkSize;     ///< 每次读取的字节数
+    QByteArray buffer; ///< 当前读取块
+    int position;      ///< 当前读取块中的读取位置
+    qint64 offset;     ///< 当前读取块之前已消费的字节数，用于错误定位
+    int depth;         ///< skipValue的嵌套深度
+    int products;      ///< 已解析的商品数
+    QString error;     ///< 错误信息
+};
+
+#endif // PRODUCTJSONREADER_H
\ No newline at end of file
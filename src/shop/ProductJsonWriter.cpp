@@ -0,0 +1,167 @@
+#include "ProductJsonWriter.h"
+#include <QDateTime>
+#include <QLocale>
+#include <cmath>
+
+/**
+ * @brief ProductJsonWriter构造函数
+ * @param device 已以只写方式打开的输出设备
+ * @param bufferSize 缓冲区达到该大小时写入设备
+ */
+ProductJsonWriter::ProductJsonWriter(QIODevice* device, int bufferSize)
+    : device(device), bufferSize(qMax(1, bufferSize)), products(0) {
+    // 预留容量，清空缓冲区时不会释放内存
+    buffer.reserve(this->bufferSize + 1024);
+}
+
+/**
+ * @brief 开始写入商品数组
+ * @return 写入成功返回true，否则返回false
+ */
+bool ProductJsonWriter::begin() {
+    products = 0;
+    buffer.append('[');
+    return true;
+}
+
+/**
+ * @brief 写入一个商品
+ *
+ * 键按字母顺序输出，与QJsonDocument生成的紧凑格式一致
+ * @param product 商品对象
+ * @return 写入成功返回true，否则返回false
+ */
+bool ProductJsonWriter::write(const Product& product) {
+    if (products > 0) {
+        buffer.append(',');
+    }
+
+    buffer.append("{\"categoryId\":");
+    appendNumber(product.getCategoryId());
+    buffer.append(",\"description\":");
+    appendString(product.getDescription());
+    buffer.append(",\"location\":");
+    appendString(product.getLocation());
+    buffer.append(",\"price\":");
+    appendNumber(product.getPrice());
+    buffer.append(",\"productId\":");
+    appendNumber(product.getProductId());
+    buffer.append(",\"publicTime\":");
+    appendString(product.getPublicTime().toString(Qt::ISODate));
+    buffer.append(",\"sellerId\":");
+    appendNumber(product.getSellerId());
+    buffer.append(",\"status\":");
+    appendString(product.getStatus());
+    buffer.append(",\"tags\":[");
+    const QList<QString> tags = product.getTags();
+    for (int i = 0; i < tags.size(); ++i) {
+        if (i > 0) {
+            buffer.append(',');
+        }
+        appendString(tags.at(i));
+    }
+    buffer.append("],\"title\":");
+    appendString(product.getTitle());
+    buffer.append('}');
+
+    ++products;
+    return flushIfFull();
+}
+
+/**
+ * @brief 结束商品数组并写出缓冲区中剩余的数据
+ * @return 写入成功返回true，否则返回false
+ */
+bool ProductJsonWriter::end() {
+    buffer.append(']');
+    return flushBuffer();
+}
+
+/**
+ * @brief 获取已写入的商品数
+ * @return 商品数
+ */
+int ProductJsonWriter::productCount() const {
+    return products;
+}
+
+/**
+ * @brief 追加一个带引号并转义的字符串
+ * @param value 字符串
+ */
+void ProductJsonWriter::appendString(const QString& value) {
+    static const char hexDigits[] = "0123456789abcdef";
+
+    const QByteArray utf8 = value.toUtf8();
+    buffer.append('"');
+    const char* data = utf8.constData();
+    int size = utf8.size();
+    int start = 0;
+    for (int i = 0; i < size; ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+
+        // 批量追加无需转义的连续字节
+        buffer.append(data + start, i - start);
+        start = i + 1;
+        switch (c) {
+        case '"': buffer.append("\\\""); break;
+        case '\\': buffer.append("\\\\"); break;
+        case '\b': buffer.append("\\b"); break;
+        case '\f': buffer.append("\\f"); break;
+        case '\n': buffer.append("\\n"); break;
+        case '\r': buffer.append("\\r"); break;
+        case '\t': buffer.append("\\t"); break;
+        default:
+            buffer.append("\\u00");
+            buffer.append(hexDigits[c >> 4]);
+            buffer.append(hexDigits[c & 0xF]);
+            break;
+        }
+    }
+    buffer.append(data + start, size - start);
+    buffer.append('"');
+}
+
+/**
+ * @brief 追加一个数字
+ *
+ * 整数值按整数输出，其他值使用可往返的最短表示，非有限值输出null
+ * @param value 数值
+ */
+void ProductJsonWriter::appendNumber(double value) {
+    if (!std::isfinite(value)) {
+        buffer.append("null");
+    } else if (value == std::floor(value) && std::fabs(value) < 9007199254740992.0) {
+        buffer.append(QByteArray::number(static_cast<qint64>(value)));
+    } else {
+        buffer.append(QByteArray::number(value, 'g', QLocale::FloatingPointShortest));
+    }
+}
+
+/**
+ * @brief 缓冲区超过阈值时写入设备
+ * @return 写入成功返回true，否则返回false
+ */
+bool ProductJsonWriter::flushIfFull() {
+    if (buffer.size() < bufferSize) {
+        return true;
+    }
+    return flushBuffer();
+}
+
+/**
+ * @brief 把缓冲区写入设备并清空缓冲区
+ * @return 写入成功返回true，否则返回false
+ */
+bool ProductJsonWriter::flushBuffer() {
+    if (buffer.isEmpty()) {
+        return true;
+    }
+
+    bool ok = device->write(buffer) == buffer.size();
+    buffer.resize(0);
+    return ok;
+}
\ No newline at end of file
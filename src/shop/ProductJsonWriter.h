@@ -0,0 +1,83 @@
+#ifndef PRODUCTJSONWRITER_H
+#define PRODUCTJSONWRITER_H
+
+#include "Product.h"
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+
+/**
+ * @brief 商品JSON流式写入类
+ *
+ * ProductJsonWriter类把商品逐个序列化为紧凑JSON，追加到一个复用的缓冲区中，
+ * 缓冲区写满后直接写入设备。保存期间不会构建QJsonArray或整份文档，
+ * 内存占用与商品总数无关。输出与QJsonDocument的紧凑格式一致，可被ProductJsonReader读取
+ */
+class ProductJsonWriter {
+public:
+    static constexpr int kDefaultBufferSize = 64 * 1024; ///< 默认缓冲区大小
+
+    /**
+     * @brief 构造函数
+     * @param device 已以只写方式打开的输出设备
+     * @param bufferSize 缓冲区达到该大小时写入设备
+     */
+    explicit ProductJsonWriter(QIODevice* device, int bufferSize = kDefaultBufferSize);
+
+    /**
+     * @brief 开始写入商品数组
+     * @return 写入成功返回true，否则返回false
+     */
+    bool begin();
+
+    /**
+     * @brief 写入一个商品
+     * @param product 商品对象
+     * @return 写入成功返回true，否则返回false
+     */
+    bool write(const Product& product);
+
+    /**
+     * @brief 结束商品数组并写出缓冲区中剩余的数据
+     * @return 写入成功返回true，否则返回false
+     */
+    bool end();
+
+    /**
+     * @brief 获取已写入的商品数
+     * @return 商品数
+     */
+    int productCount() const;
+
+private:
+    /**
+     * @brief 追加一个带引号并转义的字符串
+     * @param value 字符串
+     */
+    void appendString(const QString& value);
+
+    /**
+     * @brief 追加一个数字
+     * @param value 数值
+     */
+    void appendNumber(double value);
+
+    /**
+     * @brief 缓冲区超过阈值时写入设备
+     * @return 写入成功返回true，否则返回false
+     */
+    bool flushIfFull();
+
+    /**
+     * @brief 把缓冲区写入设备并清空缓冲区，保留已分配的容量
+     * @return 写入成功返回true，否则返回false
+     */
+    bool flushBuffer();
+
+    QIODevice* device; ///< 输出设备
+    int bufferSize;    ///< 缓冲区写出阈值
+    QByteArray buffer; ///< 复用的序列化缓冲区
+    int products;      ///< 已写入的商品数
+};
+
+#endif // PRODUCTJSONWRITER_H
\ No newline at end of file
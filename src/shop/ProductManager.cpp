@@ -1,4 +1,5 @@
 #include "ProductManager.h"
+#include "SearchCriteria.h"
 
 /**
  * @brief ProductManager构造函数
@@ -7,15 +8,26 @@
  */
 ProductManager::ProductManager(ProductRepository& productRepo, UserRepository& userRepo)
     : productRepository(productRepo), userRepository(userRepo) {
+    changeListenerId = productRepository.addChangeListener([this](const Product& previous, const Product& current) {
+        searchCache.invalidate(previous, current);
+    });
+}
+
+/**
+ * @brief ProductManager析构函数
+ */
+ProductManager::~ProductManager() {
+    productRepository.removeChangeListener(changeListenerId);
 }
 
 /**
  * @brief 发布商品
- * @param product 商品对象
+ * @param product 商品对象，商品ID为0时分配新的ID
  * @param userId 用户ID
+ * @param productId 不为空时输出发布的商品ID
  * @return 发布成功返回true，否则返回false
  */
-bool ProductManager::publishProduct(const Product& product, int userId) {
+bool ProductManager::publishProduct(const Product& product, int userId, int* productId) {
     if (!checkPublishPermission(userId)) {
         return false;
     }
@@ -35,7 +47,7 @@ bool ProductManager::publishProduct(const Product& product, int userId) {
         product.getStatus()
     );
     
-    return productRepository.save(newProduct);
+    return productRepository.save(newProduct, productId);
 }
 
 /**
@@ -96,6 +108,131 @@ QList<Product> ProductManager::getAllProducts() const {
     return productRepository.getAllProducts();
 }
 
+/**
+ * @brief 搜索商品
+ * @param criteria 搜索条件
+ * @param facets 不为空时输出全部命中商品的分面统计
+ * @return 按搜索条件的排序方式排列并分页的商品列表
+ */
+QList<Product> ProductManager::searchProducts(const SearchCriteria& criteria, SearchFacets* facets) const {
+    // 分面统计不缓存
+    if (facets) {
+        return productRepository.search(criteria, facets);
+    }
+
+    // 与searchProductPage()共用缓存，因此同时保存下一页的游标
+    QList<Product> products;
+    if (!searchCache.lookup(criteria, products)) {
+        ProductPage page = productRepository.searchPage(criteria);
+        searchCache.insert(criteria, page.getProducts(), page.getNextCursor());
+        products = page.getProducts();
+    }
+    return products;
+}
+
+/**
+ * @brief 按条件搜索一页商品
+ * @param criteria 搜索条件
+ * @param facets 不为空时输出全部命中商品的分面统计
+ * @return 本页商品和下一页的游标
+ */
+ProductPage ProductManager::searchProductPage(const SearchCriteria& criteria, SearchFacets* facets) const {
+    if (facets) {
+        return productRepository.searchPage(criteria, facets);
+    }
+
+    QList<Product> products;
+    QString nextCursor;
+    if (!searchCache.lookup(criteria, products, &nextCursor)) {
+        ProductPage page = productRepository.searchPage(criteria);
+        searchCache.insert(criteria, page.getProducts(), page.getNextCursor());
+        return page;
+    }
+    return ProductPage(products, nextCursor);
+}
+
+/**
+ * @brief 说明按条件搜索时选用的查询计划
+ * @param criteria 搜索条件
+ * @return 每行一项的查询计划说明
+ */
+QString ProductManager::explainSearch(const SearchCriteria& criteria) const {
+    return productRepository.explain(criteria);
+}
+
+/**
+ * @brief 按商品ID顺序获取一页商品
+ * @param cursor 上一页给出的游标，空表示第一页
+ * @param pageSize 页大小
+ * @return 本页商品和下一页的游标
+ */
+ProductPage ProductManager::getProductPage(const QString& cursor, int pageSize) const {
+    SearchCriteria criteria;
+    criteria.setPage(0, pageSize);
+    criteria.setCursor(cursor);
+    return searchProductPage(criteria);
+}
+
+/**
+ * @brief 获取最新发布的商品
+ * @param limit 最多返回的商品数
+ * @return 按发布时间从新到旧排列的商品列表
+ */
+QList<Product> ProductManager::getLatestProducts(int limit) const {
+    SearchCriteria criteria;
+    criteria.setSortOrder(SearchCriteria::SortByNewest);
+    criteria.setPage(0, limit);
+    return searchProducts(criteria);
+}
+
+/**
+ * @brief 获取分类中最新发布的商品
+ * @param categoryId 分类ID
+ * @param limit 最多返回的商品数
+ * @return 按发布时间从新到旧排列的商品列表
+ */
+QList<Product> ProductManager::getLatestProducts(int categoryId, int limit) const {
+    SearchCriteria criteria;
+    criteria.setCategoryId(categoryId);
+    criteria.setSortOrder(SearchCriteria::SortByNewest);
+    criteria.setPage(0, limit);
+    return searchProducts(criteria);
+}
+
+/**
+ * @brief 获取每个标签的商品数
+ * @return 标签到商品数的映射
+ */
+QHash<QString, int> ProductManager::getTagCounts() const {
+    return productRepository.tagCounts();
+}
+
+/**
+ * @brief 获取搜索框的补全建议
+ * @param prefix 已输入的前缀
+ * @param limit 最多返回的建议数
+ * @return 按热度从高到低排列的建议
+ */
+QStringList ProductManager::getSearchSuggestions(const QString& prefix, int limit) const {
+    return productRepository.suggest(prefix, limit);
+}
+
+/**
+ * @brief 获取搜索结果缓存
+ * @return 搜索结果缓存
+ */
+const SearchResultCache& ProductManager::getSearchCache() const {
+    return searchCache;
+}
+
+/**
+ * @brief 设置搜索结果缓存的内存预算
+ * @param bytes 内存预算（字节）
+ */
+void ProductManager::setSearchCacheBudget(int bytes) {
+    searchCache.setMemoryBudget(bytes);
+}
+
 /**
  * @brief 根据ID获取商品
  * @param productId 商品ID
@@ -3,17 +3,19 @@
 
 #include "Product.h"
 #include "ProductRepository.h"
+#include "SearchResultCache.h"
 #include "UserRepository.h"
 #include <QList>
-
-// Forward declarations for SearchCriteria
-class SearchCriteria;
+#include <QHash>
+#include <QString>
+#include <QStringList>
 
 /**
  * @brief 商品管理器类
  * 
  * ProductManager类提供商品管理的核心业务逻辑，
- * 包括发布商品、编辑商品、删除商品、获取商品和搜索商品等功能
+ * 包括发布商品、编辑商品、删除商品、获取商品和搜索商品等功能。
+ * 搜索结果按规范化的搜索条件缓存，商品仓库中的商品变更时只淘汰受影响的结果
  */
 class ProductManager {
 public:
@@ -24,13 +26,22 @@ public:
      */
     ProductManager(ProductRepository& productRepo, UserRepository& userRepo);
 
+    /**
+     * @brief 析构函数，注销商品仓库的变更回调
+     */
+    ~ProductManager();
+
+    ProductManager(const ProductManager&) = delete;
+    ProductManager& operator=(const ProductManager&) = delete;
+
     /**
      * @brief 发布商品
-     * @param product 商品对象
+     * @param product 商品对象，商品ID为0时分配新的ID
      * @param userId 用户ID
+     * @param productId 不为空时输出发布的商品ID
      * @return 发布成功返回true，否则返回false
      */
-    bool publishProduct(const Product& product, int userId);
+    bool publishProduct(const Product& product, int userId, int* productId = nullptr);
 
     /**
      * @brief 编辑商品
@@ -64,10 +75,81 @@ public:
 
     /**
      * @brief 搜索商品
+     *
+     * 由商品仓库的搜索索引求交得到结果，未设置任何条件时返回全部商品
      * @param criteria 搜索条件
-     * @return 商品列表
+     * @param facets 不为空时输出全部命中商品按分类、状态、地址和标签的统计
+     * @return 按搜索条件的排序方式排列并分页的商品列表
+     */
+    QList<Product> searchProducts(const SearchCriteria& criteria, SearchFacets* facets = nullptr) const;
+
+    /**
+     * @brief 按条件搜索一页商品
+     * @param criteria 搜索条件，页大小取limit，游标取上一页给出的值
+     * @param facets 不为空时输出全部命中商品的分面统计
+     * @return 本页商品和下一页的游标
+     */
+    ProductPage searchProductPage(const SearchCriteria& criteria, SearchFacets* facets = nullptr) const;
+
+    /**
+     * @brief 说明按条件搜索时选用的查询计划，用于排查慢查询
+     * @param criteria 搜索条件
+     * @return 每行一项的查询计划说明
+     */
+    QString explainSearch(const SearchCriteria& criteria) const;
+
+    /**
+     * @brief 按商品ID顺序获取一页商品
+     *
+     * 用于替代getAllProducts()逐页浏览全部商品
+     * @param cursor 上一页给出的游标，空表示第一页
+     * @param pageSize 页大小
+     * @return 本页商品和下一页的游标
+     */
+    ProductPage getProductPage(const QString& cursor, int pageSize) const;
+
+    /**
+     * @brief 获取最新发布的商品
+     *
+     * 沿发布时间索引从新到旧读取，耗时与limit成正比
+     * @param limit 最多返回的商品数
+     * @return 按发布时间从新到旧排列的商品列表
+     */
+    QList<Product> getLatestProducts(int limit) const;
+
+    /**
+     * @brief 获取分类中最新发布的商品
+     * @param categoryId 分类ID
+     * @param limit 最多返回的商品数
+     * @return 按发布时间从新到旧排列的商品列表
+     */
+    QList<Product> getLatestProducts(int categoryId, int limit) const;
+
+    /**
+     * @brief 获取每个标签的商品数，用于标签云
+     * @return 标签到商品数的映射
+     */
+    QHash<QString, int> getTagCounts() const;
+
+    /**
+     * @brief 获取搜索框边输入边显示的补全建议
+     * @param prefix 已输入的前缀
+     * @param limit 最多返回的建议数
+     * @return 按热度从高到低排列的建议
+     */
+    QStringList getSearchSuggestions(const QString& prefix, int limit) const;
+
+    /**
+     * @brief 获取搜索结果缓存，用于查看命中率和内存占用
+     * @return 搜索结果缓存
+     */
+    const SearchResultCache& getSearchCache() const;
+
+    /**
+     * @brief 设置搜索结果缓存的内存预算
+     * @param bytes 内存预算（字节），0表示不缓存
      */
-    QList<Product> searchProducts(const SearchCriteria& criteria) const;
+    void setSearchCacheBudget(int bytes);
 
 private:
     /**
@@ -85,8 +167,10 @@ private:
      */
     bool checkPublishPermission(int userId) const;
 
-    ProductRepository& productRepository; ///< 商品仓库引用
+    ProductRepository& productRepository;  ///< 商品仓库引用
     UserRepository& userRepository;        ///< 用户仓库引用
+    mutable SearchResultCache searchCache; ///< 搜索结果缓存
+    int changeListenerId;                  ///< 在商品仓库注册的变更回调ID
 };
 
 #endif // PRODUCTMANAGER_H
\ No newline at end of file
@@ -0,0 +1,40 @@
+#include "ProductPage.h"
+
+/**
+ * @brief ProductPage默认构造函数
+ */
+ProductPage::ProductPage() {
+}
+
+/**
+ * @brief ProductPage构造函数
+ * @param products 本页商品
+ * @param nextCursor 下一页的游标
+ */
+ProductPage::ProductPage(const QList<Product>& products, const QString& nextCursor)
+    : products(products), nextCursor(nextCursor) {
+}
+
+/**
+ * @brief 获取本页商品
+ * @return 商品列表
+ */
+QList<Product> ProductPage::getProducts() const {
+    return products;
+}
+
+/**
+ * @brief 获取下一页的游标
+ * @return 游标，没有下一页时为空字符串
+ */
+QString ProductPage::getNextCursor() const {
+    return nextCursor;
+}
+
+/**
+ * @brief 是否还有下一页
+ * @return 有返回true，否则返回false
+ */
+bool ProductPage::hasNextPage() const {
+    return !nextCursor.isEmpty();
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef PRODUCTPAGE_H
+#define PRODUCTPAGE_H
+
+#include "Product.h"
+#include <QList>
+#include <QString>
+
+/**
+ * @brief 商品分页结果类
+ *
+ * ProductPage保存一页商品和取下一页所需的游标。游标对调用方不透明，
+ * 原样通过SearchCriteria::setCursor()传回即可得到下一页
+ */
+class ProductPage {
+public:
+    /**
+     * @brief 默认构造函数，创建空页
+     */
+    ProductPage();
+
+    /**
+     * @brief 构造函数
+     * @param products 本页商品
+     * @param nextCursor 下一页的游标，没有下一页时为空字符串
+     */
+    ProductPage(const QList<Product>& products, const QString& nextCursor);
+
+    /**
+     * @brief 获取本页商品
+     * @return 商品列表
+     */
+    QList<Product> getProducts() const;
+
+    /**
+     * @brief 获取下一页的游标
+     * @return 游标，没有下一页时为空字符串
+     */
+    QString getNextCursor() const;
+
+    /**
+     * @brief 是否还有下一页
+     * @return 有返回true，否则返回false
+     */
+    bool hasNextPage() const;
+
+private:
+    QList<Product> products; ///< 本页商品
+    QString nextCursor;      ///< 下一页的游标
+};
+
+#endif // PRODUCTPAGE_H
\ No newline at end of file
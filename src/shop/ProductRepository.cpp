@@ -1,20 +1,55 @@
 #include "ProductRepository.h"
 #include "ConfigManager.h"
-#include <QFile>
-#include <QJsonDocument>
-#include <QJsonArray>
-#include <QJsonObject>
+#include "FileProductStore.h"
+#include "ProductJsonReader.h"
+#include "ProductJsonWriter.h"
+#include "SqliteProductStore.h"
+#include <QBuffer>
+#include <QThread>
 #include <QDateTime>
 #include <QDebug>
 
+namespace {
+
+/**
+ * @brief 根据配置创建存储后端
+ * @return 存储后端
+ */
+std::unique_ptr<ProductStore> createConfiguredStore() {
+    if (ConfigManager::getStorageBackend() == "sqlite") {
+        return std::unique_ptr<ProductStore>(new SqliteProductStore(ConfigManager::getDatabaseFile()));
+    }
+    return std::unique_ptr<ProductStore>(new FileProductStore());
+}
+
+} // namespace
+
 /**
- * @brief ProductRepository默认构造函数
+ * @brief ProductRepository默认构造函数，使用配置的存储后端
  */
-ProductRepository::ProductRepository() : nextId(1) {
-    // 尝试从文件加载数据
+ProductRepository::ProductRepository() : ProductRepository(createConfiguredStore()) {
+}
+
+/**
+ * @brief 使用指定存储后端的构造函数
+ * @param store 存储后端，由仓库接管
+ */
+ProductRepository::ProductRepository(std::unique_ptr<ProductStore> store)
+    : backend(std::move(store)), nextId(1), committer([this]() { return backend->commit(); }),
+      loadThreads(QThread::idealThreadCount()), scanThreads(QThread::idealThreadCount()), nextListenerId(1) {
+    // 尝试从存储后端加载数据
     loadFromFile();
 }
 
+/**
+ * @brief ProductRepository析构函数
+ */
+ProductRepository::~ProductRepository() {
+    if (!flush()) {
+        qDebug() << "Failed to flush pending product changes";
+    }
+}
+
 /**
  * @brief 生成下一个可用的商品ID
  * @return 下一个商品ID
@@ -25,25 +60,28 @@ int ProductRepository::generateNextId() {
 
 /**
  * @brief 保存商品
- * @param product 商品对象
+ * @param product 商品对象，商品ID为0时分配新的ID
+ * @param productId 不为空时输出保存的商品ID
  * @return 保存成功返回true，否则返回false
  */
-bool ProductRepository::save(const Product& product) {
+bool ProductRepository::save(const Product& product, int* productId) {
+    Product stored = product;
     // 如果商品ID为0，则分配新的ID
-    if (product.getProductId() == 0) {
-        Product newProduct = product;
-        // 注意：在实际实现中，需要修改Product对象的ID
-        // 但由于Product的ID没有setter方法，这里简化处理
-        products.insert(nextId++, product);
-    } else {
-        products.insert(product.getProductId(), product);
-        if (product.getProductId() >= nextId) {
-            nextId = product.getProductId() + 1;
-        }
+    if (stored.getProductId() == 0) {
+        stored.setProductId(generateNextId());
+    } else if (stored.getProductId() >= nextId) {
+        nextId = stored.getProductId() + 1;
     }
     
-    // 保存到文件
-    return saveToFile();
+    Product previous = previousVersion(stored.getProductId());
+    if (!backend->save(stored)) {
+        return false;
+    }
+    if (productId) {
+        *productId = stored.getProductId();
+    }
+    reindex(previous, stored);
+    return committer.notifyMutation();
 }
 
 /**
@@ -52,11 +90,8 @@ bool ProductRepository::save(const Product& product) {
  * @return 商品对象
  */
 Product ProductRepository::findById(int productId) const {
-    if (products.contains(productId)) {
-        return products.value(productId);
-    }
-    // 如果未找到，返回默认构造的Product对象
-    return Product();
+    // 如果未找到，存储后端返回默认构造的Product对象
+    return backend->find(productId);
 }
 
 /**
@@ -69,8 +104,12 @@ bool ProductRepository::update(const Product& product) {
         return false;
     }
     
-    products.insert(product.getProductId(), product);
-    return saveToFile();
+    Product previous = previousVersion(product.getProductId());
+    if (!backend->save(product)) {
+        return false;
+    }
+    reindex(previous, product);
+    return committer.notifyMutation();
 }
 
 /**
@@ -79,11 +118,69 @@ bool ProductRepository::update(const Product& product) {
  * @return 删除成功返回true，否则返回false
  */
 bool ProductRepository::remove(int productId) {
-    bool result = products.remove(productId) > 0;
-    if (result) {
-        return saveToFile();
+    Product previous = previousVersion(productId);
+    if (!backend->remove(productId)) {
+        return false;
     }
-    return result;
+    reindex(previous, Product());
+    return committer.notifyMutation();
+}
+
+/**
+ * @brief 获取变更前的商品，供同步搜索索引使用
+ * @param productId 商品ID
+ * @return 搜索索引已建立时返回存储中的商品，否则返回默认构造的Product对象
+ */
+Product ProductRepository::previousVersion(int productId) const {
+    // 索引尚未建立且没有变更回调时无需读取旧版本，建立索引时会读取最新数据
+    return index || !changeListeners.isEmpty() ? backend->find(productId) : Product();
+}
+
+/**
+ * @brief 存储后端的一次变更成功后同步搜索索引
+ * @param previous 变更前的商品，新增时为默认构造的Product对象
+ * @param current 变更后的商品，删除时为默认构造的Product对象
+ */
+void ProductRepository::reindex(const Product& previous, const Product& current) {
+    if (index) {
+        if (previous.getProductId() != 0) {
+            index->remove(previous);
+        }
+        if (current.getProductId() != 0) {
+            index->insert(current);
+        }
+    }
+    notifyChange(previous, current);
+}
+
+/**
+ * @brief 调用全部变更回调
+ * @param previous 变更前的商品
+ * @param current 变更后的商品
+ */
+void ProductRepository::notifyChange(const Product& previous, const Product& current) {
+    for (const ChangeListener& listener : changeListeners) {
+        listener(previous, current);
+    }
+}
+
+/**
+ * @brief 注册商品变更回调
+ * @param listener 回调
+ * @return 回调ID，用于注销
+ */
+int ProductRepository::addChangeListener(ChangeListener listener) {
+    const int listenerId = nextListenerId++;
+    changeListeners.insert(listenerId, std::move(listener));
+    return listenerId;
+}
+
+/**
+ * @brief 注销商品变更回调
+ * @param listenerId addChangeListener()返回的回调ID
+ */
+void ProductRepository::removeChangeListener(int listenerId) {
+    changeListeners.remove(listenerId);
 }
 
 /**
@@ -92,21 +189,163 @@ bool ProductRepository::remove(int productId) {
  * @return 商品列表
  */
 QList<Product> ProductRepository::findBySellerId(int sellerId) const {
+    return backend->findBySellerId(sellerId);
+}
+
+/**
+ * @brief 按条件搜索商品
+ * @param criteria 搜索条件
+ * @param facets 不为空时输出全部命中商品的分面统计
+ * @return 按搜索条件的排序方式排列并分页的商品列表
+ */
+QList<Product> ProductRepository::search(const SearchCriteria& criteria, SearchFacets* facets) const {
+    const QList<int> productIds = searchIndex().search(criteria, nullptr, facets);
     QList<Product> result;
-    for (const Product& product : products) {
-        if (product.getSellerId() == sellerId) {
-            result.append(product);
-        }
+    result.reserve(productIds.size());
+    for (int productId : productIds) {
+        result.append(backend->find(productId));
     }
     return result;
 }
 
+/**
+ * @brief 按条件搜索一页商品
+ * @param criteria 搜索条件
+ * @param facets 不为空时输出全部命中商品的分面统计
+ * @return 本页商品和下一页的游标
+ */
+ProductPage ProductRepository::searchPage(const SearchCriteria& criteria, SearchFacets* facets) const {
+    QString nextCursor;
+    const QList<int> productIds = searchIndex().search(criteria, &nextCursor, facets);
+    QList<Product> products;
+    products.reserve(productIds.size());
+    for (int productId : productIds) {
+        products.append(backend->find(productId));
+    }
+    return ProductPage(products, nextCursor);
+}
+
+/**
+ * @brief 说明按条件搜索时选用的查询计划
+ * @param criteria 搜索条件
+ * @return 每行一项的查询计划说明
+ */
+QString ProductRepository::explain(const SearchCriteria& criteria) const {
+    return searchIndex().explain(criteria);
+}
+
+/**
+ * @brief 获取每个标签的商品数
+ * @return 标签到商品数的映射
+ */
+QHash<QString, int> ProductRepository::tagCounts() const {
+    return searchIndex().tagCounts();
+}
+
+/**
+ * @brief 获取搜索框的补全建议
+ * @param prefix 已输入的前缀
+ * @param limit 最多返回的建议数
+ * @return 按热度从高到低排列的建议
+ */
+QStringList ProductRepository::suggest(const QString& prefix, int limit) const {
+    return searchIndex().suggest(prefix, limit);
+}
+
+/**
+ * @brief 获取搜索建议索引估算占用的内存
+ * @return 字节数
+ */
+qint64 ProductRepository::suggestionMemoryUsage() const {
+    return searchIndex().suggestionMemoryUsage();
+}
+
+/**
+ * @brief 获取搜索索引，第一次调用时从存储后端建立
+ * @return 搜索索引
+ */
+const ProductSearchIndex& ProductRepository::searchIndex() const {
+    if (!index) {
+        const ProductStore* store = backend.get();
+        index.reset(new ProductSearchIndex([store](int productId) {
+            return store->find(productId);
+        }, &categories));
+        index->setScanThreadCount(backend->supportsConcurrentFind() ? scanThreads : 1);
+        backend->forEach([this](const Product& product) {
+            index->insert(product);
+        });
+    }
+    return *index;
+}
+
+/**
+ * @brief 新增分类并写出分类树
+ * @param categoryId 分类ID
+ * @param name 名称
+ * @param parentId 上级分类ID
+ * @return 新增并写出成功返回true，否则返回false
+ */
+bool ProductRepository::addCategory(int categoryId, const QString& name, int parentId) {
+    CategoryTree updated = categories;
+    return updated.add(categoryId, name, parentId) && saveCategories(updated);
+}
+
+/**
+ * @brief 移动分类并写出分类树
+ * @param categoryId 分类ID
+ * @param parentId 新的上级分类ID
+ * @return 移动并写出成功返回true，否则返回false
+ */
+bool ProductRepository::moveCategory(int categoryId, int parentId) {
+    CategoryTree updated = categories;
+    return updated.move(categoryId, parentId) && saveCategories(updated);
+}
+
+/**
+ * @brief 删除分类并写出分类树
+ * @param categoryId 分类ID
+ * @return 删除并写出成功返回true，否则返回false
+ */
+bool ProductRepository::removeCategory(int categoryId) {
+    CategoryTree updated = categories;
+    return updated.remove(categoryId) && saveCategories(updated);
+}
+
+/**
+ * @brief 获取分类树
+ * @return 分类树
+ */
+const CategoryTree& ProductRepository::categoryTree() const {
+    return categories;
+}
+
+/**
+ * @brief 写出修改后的分类树，成功后替换内存中的分类树并通知变更回调
+ *
+ * 搜索索引只保存商品的分类ID，查询时才读取分类树，不需要重建
+ * @param updated 修改后的分类树
+ * @return 写出成功返回true，否则返回false
+ */
+bool ProductRepository::saveCategories(const CategoryTree& updated) {
+    if (!backend->saveCategories(updated.toJson())) {
+        return false;
+    }
+    categories = updated;
+    notifyChange(Product(), Product());
+    return true;
+}
+
 /**
  * @brief 获取所有商品
  * @return 商品列表
  */
 QList<Product> ProductRepository::getAllProducts() const {
-    return products.values();
+    QList<Product> result;
+    result.reserve(backend->count());
+    backend->forEach([&result](const Product& product) {
+        result.append(product);
+    });
+    return result;
 }
 
 /**
@@ -114,68 +353,239 @@ QList<Product> ProductRepository::getAllProducts() const {
  * @return 加载成功返回true，否则返回false
  */
 bool ProductRepository::loadFromFile() {
-    QString fileName = ConfigManager::getProductDataFile();
-    QFile file(fileName);
-    
-    if (!file.open(QIODevice::ReadOnly)) {
-        qDebug() << "Cannot open file for reading:" << fileName;
-        return false;
+    bool loaded = backend->load();
+    if (!categories.loadFromJson(backend->loadCategories())) {
+        qDebug() << "Ignoring invalid category tree";
     }
+    index.reset();
+    notifyChange(Product(), Product());
     
-    QByteArray data = file.readAll();
-    file.close();
-    
-    QJsonParseError error;
-    QJsonDocument doc = QJsonDocument::fromJson(data, &error);
-    
-    if (error.error != QJsonParseError::NoError) {
-        qDebug() << "Error parsing JSON:" << error.errorString();
-        return false;
+    // 更新nextId
+    if (backend->maxProductId() >= nextId) {
+        nextId = backend->maxProductId() + 1;
     }
+    return loaded;
+}
+
+/**
+ * @brief 从JSON字符串加载商品信息
+ * @param json JSON字符串
+ * @return 加载成功返回true，否则返回false
+ */
+bool ProductRepository::loadFromJson(const QString& json) {
+    return loadFromData(json.toUtf8());
+}
+
+/**
+ * @brief 多线程加载内存中的商品数组
+ *
+ * 解析全部成功后才合并到仓库中，解析失败时仓库保持不变
+ * @param data 完整的JSON文档
+ * @return 加载成功返回true，否则返回false
+ */
+bool ProductRepository::loadFromData(const QByteArray& data) {
+    QHash<int, Product> loaded;
+    int maxId = 0;
+    QString error;
+    bool ok = ProductJsonReader::readParallel(data, loadThreads, [&loaded, &maxId](const Product& product) {
+        loaded.insert(product.getProductId(), product);
+        maxId = qMax(maxId, product.getProductId());
+    }, &error);
     
-    if (!doc.isArray()) {
-        qDebug() << "Invalid JSON format: not an array";
+    if (!ok) {
+        qDebug() << "Error parsing JSON:" << error;
         return false;
     }
     
-    QJsonArray array = doc.array();
-    for (const QJsonValue& value : array) {
-        if (value.isObject()) {
-            QJsonObject obj = value.toObject();
-            Product product = Product::fromJson(obj);
-            products.insert(product.getProductId(), product);
-            
-            // 更新nextId
-            if (product.getProductId() >= nextId) {
-                nextId = product.getProductId() + 1;
-            }
-        }
+    return mergeLoaded(loaded, maxId);
+}
+
+/**
+ * @brief 把加载的商品合并到仓库中
+ * @param loaded 加载的商品，合并后内容未定义
+ * @param maxId 加载的商品中的最大ID
+ * @return 合并成功返回true，否则返回false
+ */
+bool ProductRepository::mergeLoaded(QHash<int, Product>& loaded, int maxId) {
+    // 更新nextId
+    if (maxId >= nextId) {
+        nextId = maxId + 1;
     }
     
-    return true;
+    // 批量导入后在下一次搜索时重建索引
+    index.reset();
+    const bool imported = backend->import(loaded);
+    notifyChange(Product(), Product());
+    // 存储后端已落盘导入的商品，计入组提交使flush()同时覆盖此前缓存的变更
+    return imported && committer.notifyMutation();
+}
+
+/**
+ * @brief 将商品信息导出为JSON字符串
+ * @return JSON字符串
+ */
+QString ProductRepository::dumpToJson() const {
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    writeToDevice(&buffer);
+    buffer.close();
+    return QString::fromUtf8(data);
 }
 
 /**
  * @brief 保存数据到文件
+ *
+ * 对存储后端做一次检查点，之前组提交中尚未落盘的变更也随之写出
  * @return 保存成功返回true，否则返回false
  */
 bool ProductRepository::saveToFile() {
-    QString fileName = ConfigManager::getProductDataFile();
-    QFile file(fileName);
-    
-    if (!file.open(QIODevice::WriteOnly)) {
-        qDebug() << "Cannot open file for writing:" << fileName;
+    return backend->checkpoint();
+}
+
+/**
+ * @brief 将全部商品以紧凑JSON数组流式写入输出设备
+ * @param device 已打开的输出设备
+ * @return 写入成功返回true，否则返回false
+ */
+bool ProductRepository::writeToDevice(QIODevice* device) const {
+    ProductJsonWriter writer(device);
+    if (!writer.begin()) {
         return false;
     }
     
-    QJsonArray array;
-    for (const Product& product : products) {
-        array.append(Product::toJson(product));
-    }
-    
-    QJsonDocument doc(array);
-    file.write(doc.toJson());
-    file.close();
+    bool ok = true;
+    backend->forEach([&writer, &ok](const Product& product) {
+        ok = ok && writer.write(product);
+    });
     
-    return true;
+    return ok && writer.end();
+}
+
+/**
+ * @brief 设置是否启用日志模式
+ * @param enabled 是否启用
+ */
+void ProductRepository::setJournalEnabled(bool enabled) {
+    flush();
+    if (FileProductStore* file = fileStore()) {
+        file->setJournalEnabled(enabled);
+    }
+}
+
+/**
+ * @brief 设置加载JSON时使用的线程数
+ * @param threadCount 线程数，1表示单线程加载
+ */
+void ProductRepository::setLoadThreadCount(int threadCount) {
+    loadThreads = qMax(1, threadCount);
+}
+
+/**
+ * @brief 获取加载JSON时使用的线程数
+ * @return 线程数
+ */
+int ProductRepository::loadThreadCount() const {
+    return loadThreads;
+}
+
+/**
+ * @brief 设置搜索时并行过滤候选商品使用的线程数
+ * @param threadCount 线程数
+ */
+void ProductRepository::setScanThreadCount(int threadCount) {
+    scanThreads = qMax(1, threadCount);
+    if (index) {
+        index->setScanThreadCount(backend->supportsConcurrentFind() ? scanThreads : 1);
+    }
+}
+
+/**
+ * @brief 获取搜索时并行过滤候选商品使用的线程数
+ * @return 线程数
+ */
+int ProductRepository::scanThreadCount() const {
+    return scanThreads;
+}
+
+/**
+ * @brief 是否启用日志模式
+ * @return 启用返回true，否则返回false
+ */
+bool ProductRepository::isJournalEnabled() const {
+    FileProductStore* file = fileStore();
+    return file && file->isJournalEnabled();
+}
+
+/**
+ * @brief 获取自上次检查点以来的日志记录数
+ * @return 日志记录数
+ */
+int ProductRepository::journalEntryCount() const {
+    FileProductStore* file = fileStore();
+    return file ? file->journalEntryCount() : 0;
+}
+
+/**
+ * @brief 获取存储后端
+ * @return 存储后端
+ */
+ProductStore& ProductRepository::store() const {
+    return *backend;
+}
+
+/**
+ * @brief 获取文件存储后端
+ * @return 使用文件存储时返回其指针，否则返回nullptr
+ */
+FileProductStore* ProductRepository::fileStore() const {
+    return dynamic_cast<FileProductStore*>(backend.get());
+}
+
+/**
+ * @brief 落盘屏障：立即写出所有未落盘的变更
+ * @return 写出成功返回true，否则返回false
+ */
+bool ProductRepository::flush() {
+    return committer.flush();
+}
+
+/**
+ * @brief 设置组提交的落盘策略
+ * @param policy 落盘策略
+ */
+void ProductRepository::setFlushPolicy(const FlushPolicy& policy) {
+    committer.setPolicy(policy);
+}
+
+/**
+ * @brief 获取组提交的落盘策略
+ * @return 落盘策略
+ */
+FlushPolicy ProductRepository::flushPolicy() const {
+    return committer.policy();
+}
+
+/**
+ * @brief 获取尚未落盘的变更数
+ * @return 变更数
+ */
+int ProductRepository::pendingMutationCount() const {
+    return committer.pendingCount();
+}
+
+/**
+ * @brief 获取已执行的落盘次数
+ * @return 落盘次数
+ */
+int ProductRepository::flushCount() const {
+    return committer.flushCount();
+}
+
+/**
+ * @brief 获取失败的落盘次数
+ * @return 落盘失败次数
+ */
+int ProductRepository::failedFlushCount() const {
+    return committer.failedFlushCount();
 }
\ No newline at end of file
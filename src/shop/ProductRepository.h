@@ -2,18 +2,38 @@
 #define PRODUCTREPOSITORY_H
 
 #include "Product.h"
+#include "CategoryTree.h"
+#include "GroupCommitter.h"
+#include "ProductPage.h"
+#include "ProductSearchIndex.h"
+#include "ProductStore.h"
+#include "SearchCriteria.h"
 #include <QList>
 #include <QHash>
+#include <QMap>
 #include <QString>
+#include <QStringList>
+#include <QIODevice>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <functional>
+#include <memory>
+
+class FileProductStore;
 
 /**
  * @brief 商品仓库类
  * 
  * ProductRepository类负责商品数据的持久化操作，
- * 提供保存、查找、更新、删除以及JSON序列化等功能
+ * 提供保存、查找、更新、删除以及JSON序列化等功能。
+ * 数据的读写委托给ProductStore存储后端，默认是快照文件加变更日志的FileProductStore，
+ * 也可以使用SQLite数据库（见ConfigManager::getStorageBackend()）。
+ * 变更按FlushPolicy组提交，调用flush()或析构时保证全部落盘。
+ * 第一次搜索时建立内存中的搜索索引，之后随每次保存、更新和删除同步维护；
+ * 使用SQLite后端时搜索索引同样保存在内存中，按卖家查询则直接由存储后端完成。
+ * 分类树与商品保存在同一个存储后端中，随仓库加载，每次修改后立即写出。
+ * JSON只作为导入导出格式（loadFromJson/dumpToJson）
  */
 class ProductRepository {
 public:
@@ -22,12 +42,48 @@ public:
      */
     ProductRepository();
 
+    /**
+     * @brief 使用指定存储后端的构造函数
+     * @param store 存储后端，由仓库接管
+     */
+    explicit ProductRepository(std::unique_ptr<ProductStore> store);
+
+    /**
+     * @brief 析构函数，写出所有未落盘的变更
+     */
+    ~ProductRepository();
+
+    ProductRepository(const ProductRepository&) = delete;
+    ProductRepository& operator=(const ProductRepository&) = delete;
+
+    /**
+     * @brief 商品变更回调
+     *
+     * 参数依次为变更前和变更后的商品，新增时前者、删除时后者为默认构造的Product对象；
+     * 批量加载后两者都为默认构造的Product对象，表示任何商品都可能已改变
+     */
+    using ChangeListener = std::function<void(const Product&, const Product&)>;
+
+    /**
+     * @brief 注册商品变更回调，每次保存、更新、删除成功和批量加载后调用
+     * @param listener 回调
+     * @return 回调ID，用于注销
+     */
+    int addChangeListener(ChangeListener listener);
+
+    /**
+     * @brief 注销商品变更回调
+     * @param listenerId addChangeListener()返回的回调ID
+     */
+    void removeChangeListener(int listenerId);
+
     /**
      * @brief 保存商品
-     * @param product 商品对象
+     * @param product 商品对象，商品ID为0时分配新的ID
+     * @param productId 不为空时输出保存的商品ID
      * @return 保存成功返回true，否则返回false
      */
-    bool save(const Product& product);
+    bool save(const Product& product, int* productId = nullptr);
 
     /**
      * @brief 根据ID查找商品
@@ -58,11 +114,97 @@ public:
 
     /**
      * @brief 根据卖家ID查找商品列表
+     *
+     * 由存储后端的卖家索引完成，耗时与该卖家的商品数成正比，与商品总数无关
      * @param sellerId 卖家ID
-     * @return 商品列表
+     * @return 按商品ID升序排列的商品列表
      */
     QList<Product> findBySellerId(int sellerId) const;
 
+    /**
+     * @brief 按条件搜索商品
+     *
+     * 使用搜索索引求交，只在没有可用索引时过滤扫描全部商品
+     * @param criteria 搜索条件
+     * @param facets 不为空时输出全部命中商品的分面统计，与匹配在同一遍中完成
+     * @return 按搜索条件的排序方式排列并分页的商品列表
+     */
+    QList<Product> search(const SearchCriteria& criteria, SearchFacets* facets = nullptr) const;
+
+    /**
+     * @brief 按条件搜索一页商品
+     *
+     * 页大小取搜索条件的limit，下一页从本页最后一个商品的排序键之后开始，
+     * 深翻页与第一页的耗时相同，也不会复制全部商品
+     * @param criteria 搜索条件，游标为空时从第一页开始
+     * @param facets 不为空时输出全部命中商品的分面统计，不受游标影响
+     * @return 本页商品和下一页的游标
+     */
+    ProductPage searchPage(const SearchCriteria& criteria, SearchFacets* facets = nullptr) const;
+
+    /**
+     * @brief 说明按条件搜索时选用的查询计划
+     * @param criteria 搜索条件
+     * @return 每行一项的查询计划说明，包括取得方式、过滤顺序、选择率和估计代价
+     */
+    QString explain(const SearchCriteria& criteria) const;
+
+    /**
+     * @brief 获取每个标签的商品数
+     *
+     * 直接读取标签位图中维护的计数，不遍历商品
+     * @return 标签到商品数的映射
+     */
+    QHash<QString, int> tagCounts() const;
+
+    /**
+     * @brief 获取搜索框的补全建议
+     *
+     * 建议来自商品标题中的单词、标签和地址，按含有它的商品数排序，随每次保存、更新和删除同步维护
+     * @param prefix 已输入的前缀，不区分大小写
+     * @param limit 最多返回的建议数，不超过SuggestionIndex::kTopK
+     * @return 按热度从高到低排列的建议
+     */
+    QStringList suggest(const QString& prefix, int limit = SuggestionIndex::kTopK) const;
+
+    /**
+     * @brief 获取搜索建议索引估算占用的内存
+     * @return 字节数
+     */
+    qint64 suggestionMemoryUsage() const;
+
+    /**
+     * @brief 新增分类并写出分类树
+     * @param categoryId 分类ID，必须为正且未被使用
+     * @param name 名称
+     * @param parentId 上级分类ID，CategoryTree::kRoot表示顶级分类
+     * @return 新增并写出成功返回true，否则返回false
+     */
+    bool addCategory(int categoryId, const QString& name, int parentId = CategoryTree::kRoot);
+
+    /**
+     * @brief 把分类连同其下级移动到另一个上级之下并写出分类树
+     *
+     * 只给被移动的子树重新编号，商品和搜索索引都不需要修改；包括下级分类的搜索结果随之改变
+     * @param categoryId 分类ID
+     * @param parentId 新的上级分类ID，不能是该分类本身或其下级
+     * @return 移动并写出成功返回true，否则返回false
+     */
+    bool moveCategory(int categoryId, int parentId);
+
+    /**
+     * @brief 删除没有下级的分类并写出分类树，该分类的商品不受影响
+     * @param categoryId 分类ID
+     * @return 删除并写出成功返回true，否则返回false
+     */
+    bool removeCategory(int categoryId);
+
+    /**
+     * @brief 获取分类树
+     * @return 分类树
+     */
+    const CategoryTree& categoryTree() const;
+
     /**
      * @brief 从JSON字符串加载商品信息
      * @param json JSON字符串
@@ -84,10 +226,104 @@ public:
 
     /**
      * @brief 保存数据到文件
+     *
+     * 对存储后端做一次检查点。文件存储写出二进制全量快照并清空变更日志，
+     * 快照先写入临时文件再原子地替换原文件
      * @return 保存成功返回true，否则返回false
      */
     bool saveToFile();
 
+    /**
+     * @brief 设置是否启用日志模式
+     *
+     * 仅对文件存储有效。关闭日志模式时会先做一次检查点，之后每次变更都重写整个数据文件
+     * @param enabled 是否启用
+     */
+    void setJournalEnabled(bool enabled);
+
+    /**
+     * @brief 设置加载JSON时使用的线程数
+     *
+     * 较大的JSON文档在顶层对象边界处切分后并行解析，结果与单线程加载完全一致
+     * @param threadCount 线程数，1表示单线程加载
+     */
+    void setLoadThreadCount(int threadCount);
+
+    /**
+     * @brief 获取加载JSON时使用的线程数
+     * @return 线程数，默认为CPU核心数
+     */
+    int loadThreadCount() const;
+
+    /**
+     * @brief 设置搜索时并行过滤候选商品使用的线程数
+     *
+     * 没有可用索引、需要逐个过滤大量商品的搜索（例如核对描述原文）分批在多个线程中过滤，结果顺序与单线程相同。
+     * 存储后端不支持多线程读取时（见ProductStore::supportsConcurrentFind()）始终单线程过滤
+     * @param threadCount 线程数，1表示单线程过滤
+     */
+    void setScanThreadCount(int threadCount);
+
+    /**
+     * @brief 获取搜索时并行过滤候选商品使用的线程数
+     * @return 线程数，默认为CPU核心数
+     */
+    int scanThreadCount() const;
+
+    /**
+     * @brief 是否启用日志模式
+     * @return 文件存储启用日志模式时返回true，否则返回false
+     */
+    bool isJournalEnabled() const;
+
+    /**
+     * @brief 获取自上次检查点以来的日志记录数
+     * @return 日志记录数，非文件存储时返回0
+     */
+    int journalEntryCount() const;
+
+    /**
+     * @brief 获取存储后端
+     * @return 存储后端
+     */
+    ProductStore& store() const;
+
+    /**
+     * @brief 落盘屏障：立即写出所有未落盘的变更
+     * @return 写出成功返回true，否则返回false
+     */
+    bool flush();
+
+    /**
+     * @brief 设置组提交的落盘策略
+     * @param policy 落盘策略
+     */
+    void setFlushPolicy(const FlushPolicy& policy);
+
+    /**
+     * @brief 获取组提交的落盘策略
+     * @return 落盘策略
+     */
+    FlushPolicy flushPolicy() const;
+
+    /**
+     * @brief 获取尚未落盘的变更数
+     * @return 变更数
+     */
+    int pendingMutationCount() const;
+
+    /**
+     * @brief 获取已执行的落盘次数
+     * @return 落盘次数
+     */
+    int flushCount() const;
+
+    /**
+     * @brief 获取失败的落盘次数，包括定时器触发、没有调用者接收结果的落盘
+     * @return 落盘失败次数
+     */
+    int failedFlushCount() const;
+
     /**
      * @brief 从JSON对象创建商品
      * @param obj JSON对象
@@ -109,8 +345,81 @@ public:
     int generateNextId();
 
 private:
-    QHash<int, Product> products; ///< 商品存储哈希表，键为商品ID
-    int nextId;                   ///< 下一个可用的商品ID
+    /**
+     * @brief 获取文件存储后端
+     * @return 使用文件存储时返回其指针，否则返回nullptr
+     */
+    FileProductStore* fileStore() const;
+
+    /**
+     * @brief 获取搜索索引，第一次调用时从存储后端建立
+     * @return 搜索索引
+     */
+    const ProductSearchIndex& searchIndex() const;
+
+    /**
+     * @brief 存储后端的一次变更成功后同步搜索索引并通知变更回调
+     * @param previous 变更前的商品，新增时为默认构造的Product对象
+     * @param current 变更后的商品，删除时为默认构造的Product对象
+     */
+    void reindex(const Product& previous, const Product& current);
+
+    /**
+     * @brief 调用全部变更回调
+     * @param previous 变更前的商品
+     * @param current 变更后的商品
+     */
+    void notifyChange(const Product& previous, const Product& current);
+
+    /**
+     * @brief 获取变更前的商品，供同步搜索索引和变更回调使用
+     * @param productId 商品ID
+     * @return 搜索索引已建立或注册了变更回调时返回存储中的商品，否则返回默认构造的Product对象
+     */
+    Product previousVersion(int productId) const;
+
+    /**
+     * @brief 写出修改后的分类树，成功后替换内存中的分类树并通知变更回调
+     *
+     * 写出失败时内存中的分类树保持不变。
+     * 分类的上下级关系决定包括下级分类的搜索条件命中哪些商品，以默认构造的Product对象通知，
+     * 表示任何商品都可能受影响
+     * @param updated 修改后的分类树
+     * @return 写出成功返回true，否则返回false
+     */
+    bool saveCategories(const CategoryTree& updated);
+
+    /**
+     * @brief 多线程加载内存中的商品数组
+     * @param data 完整的JSON文档
+     * @return 加载成功返回true，否则返回false
+     */
+    bool loadFromData(const QByteArray& data);
+
+    /**
+     * @brief 把加载的商品合并到仓库中
+     * @param loaded 加载的商品
+     * @param maxId 加载的商品中的最大ID
+     * @return 合并成功返回true，否则返回false
+     */
+    bool mergeLoaded(QHash<int, Product>& loaded, int maxId);
+
+    /**
+     * @brief 将全部商品以紧凑JSON数组流式写入输出设备
+     * @param device 已打开的输出设备
+     * @return 写入成功返回true，否则返回false
+     */
+    bool writeToDevice(QIODevice* device) const;
+
+    std::unique_ptr<ProductStore> backend;             ///< 存储后端
+    int nextId;                                        ///< 下一个可用的商品ID
+    GroupCommitter committer;                          ///< 组提交器
+    int loadThreads;                                   ///< 加载JSON时使用的线程数
+    int scanThreads;                                   ///< 搜索时并行过滤使用的线程数
+    CategoryTree categories;                           ///< 分类树
+    mutable std::unique_ptr<ProductSearchIndex> index; ///< 搜索索引，第一次搜索时建立
+    QMap<int, ChangeListener> changeListeners;         ///< 回调ID到商品变更回调的映射
+    int nextListenerId;                                ///< 下一个可用的回调ID
 };
 
 #endif // PRODUCTREPOSITORY_H
\ No newline at end of file
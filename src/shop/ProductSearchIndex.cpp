@@ -0,0 +1,1080 @@
+#include "ProductSearchIndex.h"
+#include "ParallelFilter.h"
+#include <QDebug>
+#include <QStringList>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+/**
+ * @brief ProductSearchIndex构造函数
+ * @param loader 根据商品ID加载商品的回调
+ * @param categories 分类树
+ */
+ProductSearchIndex::ProductSearchIndex(ProductLoader loader, const CategoryTree* categories)
+    : loader(std::move(loader)), categories(categories), scanThreads(1) {
+}
+
+/**
+ * @brief 设置过滤候选槽位时使用的线程数
+ *
+ * 加载回调会在多个线程中同时调用，只有加载回调线程安全时才能设为大于1
+ * @param threadCount 线程数，1表示在调用线程上逐个过滤
+ */
+void ProductSearchIndex::setScanThreadCount(int threadCount) {
+    scanThreads = qMax(1, threadCount);
+}
+
+/**
+ * @brief 获取过滤候选槽位时使用的线程数
+ * @return 线程数
+ */
+int ProductSearchIndex::scanThreadCount() const {
+    return scanThreads;
+}
+
+/**
+ * @brief 把商品加入索引，商品ID已在索引中时忽略
+ * @param product 商品对象
+ */
+void ProductSearchIndex::insert(const Product& product) {
+    const int productId = product.getProductId();
+    if (productId == 0 || slotById.contains(productId)) {
+        return;
+    }
+
+    // 优先复用空闲槽位，保持槽位号紧凑
+    quint32 slot;
+    if (!freeSlots.isEmpty()) {
+        slot = freeSlots.takeLast();
+    } else {
+        slot = columns.append();
+        tagsBySlot.append(QVector<quint32>());
+    }
+    columns.assign(slot, product, facetCode(product.getStatus()), facetCode(product.getLocation()));
+    QVector<quint32> tagCodes;
+    for (const QString& tag : product.getTags()) {
+        const quint32 code = facetCode(tag);
+        if (!tagCodes.contains(code)) {
+            tagCodes.append(code);
+        }
+    }
+    tagsBySlot[int(slot)] = tagCodes;
+    slotById.insert(productId, slot);
+    priceIndex.insert(slot, productId, product.getPrice());
+    recencyIndex.insert(slot, productId, product.getCategoryId(), columns.timeKeys().at(int(slot)));
+
+    addPosting(sellerPostings, product.getSellerId(), slot);
+    addPosting(categoryPostings, product.getCategoryId(), slot);
+    addPosting(statusPostings, product.getStatus(), slot);
+    addPosting(locationPostings, product.getLocation(), slot);
+    locationIndex.insert(slot, product.getLocation());
+    tagIndex.insert(slot, product.getTags());
+    textIndex.insert(slot, indexedText(product));
+    relevanceIndex.insert(slot, product.getTitle(), product.getDescription(), product.getTags());
+    trigramIndex.insert(slot, product.getTitle());
+    pinyinIndex.insert(slot, product.getTitle());
+    suggestionIndex.insert(product.getTitle(), product.getTags(), product.getLocation());
+}
+
+/**
+ * @brief 从索引中移除商品
+ * @param product 索引中的商品版本
+ */
+void ProductSearchIndex::remove(const Product& product) {
+    auto it = slotById.find(product.getProductId());
+    if (it == slotById.end()) {
+        return;
+    }
+
+    const quint32 slot = it.value();
+    slotById.erase(it);
+    columns.release(slot);
+    tagsBySlot[int(slot)].clear();
+    freeSlots.append(slot);
+    priceIndex.remove(slot, product.getProductId(), columns.prices().at(int(slot)));
+    recencyIndex.remove(slot, product.getProductId(), product.getCategoryId(), columns.timeKeys().at(int(slot)));
+
+    removePosting(sellerPostings, product.getSellerId(), slot);
+    removePosting(categoryPostings, product.getCategoryId(), slot);
+    removePosting(statusPostings, product.getStatus(), slot);
+    removePosting(locationPostings, product.getLocation(), slot);
+    locationIndex.remove(slot, product.getLocation());
+    tagIndex.remove(slot, product.getTags());
+    textIndex.remove(slot, indexedText(product));
+    relevanceIndex.remove(slot);
+    trigramIndex.remove(slot, product.getTitle());
+    pinyinIndex.remove(slot);
+    suggestionIndex.remove(product.getTitle(), product.getTags(), product.getLocation());
+}
+
+/**
+ * @brief 获取索引中的商品数
+ * @return 商品数
+ */
+int ProductSearchIndex::size() const {
+    return slotById.size();
+}
+
+/**
+ * @brief 获取带有指定标签的商品数
+ * @param tag 标签
+ * @return 商品数
+ */
+int ProductSearchIndex::tagCount(const QString& tag) const {
+    return tagIndex.count(tag);
+}
+
+/**
+ * @brief 获取每个标签的商品数
+ * @return 标签到商品数的映射
+ */
+QHash<QString, int> ProductSearchIndex::tagCounts() const {
+    return tagIndex.counts();
+}
+
+/**
+ * @brief 获取以指定前缀开头的搜索建议
+ * @param prefix 前缀
+ * @param limit 最多返回的建议数
+ * @return 按热度从高到低排列的建议
+ */
+QStringList ProductSearchIndex::suggest(const QString& prefix, int limit) const {
+    return suggestionIndex.suggest(prefix, limit);
+}
+
+/**
+ * @brief 获取搜索建议索引估算占用的内存
+ * @return 字节数
+ */
+qint64 ProductSearchIndex::suggestionMemoryUsage() const {
+    return suggestionIndex.memoryUsage();
+}
+
+/**
+ * @brief 按条件搜索商品
+ *
+ * 由plan()选出代价最小的取得方式：沿结果顺序对应的有序索引（商品ID、价格或发布时间）输出时，
+ * 从游标处开始，取满一页即停止；其余方式先求出全部命中，只对命中的商品排序。
+ * 需要分面统计时在同一遍匹配中计数：沿有序索引输出时不再取满一页就停止，而是遍历完全部命中；
+ * 没有任何筛选条件时直接读取各索引集合的大小。
+ * 按相关度排序时没有对应的有序索引，求出全部命中后只为命中的槽位打分，用堆选出前几页所需的部分
+ * @param criteria 搜索条件
+ * @param nextCursor 不为空时输出下一页的游标，没有下一页时为空字符串
+ * @param facets 不为空时输出全部命中商品的分面统计，不受分页和游标影响
+ * @return 满足条件的商品ID，按搜索条件的排序方式排列并分页
+ */
+QList<int> ProductSearchIndex::search(const SearchCriteria& criteria, QString* nextCursor, SearchFacets* facets) const {
+    QList<int> result;
+    if (nextCursor) {
+        nextCursor->clear();
+    }
+    if (facets) {
+        *facets = SearchFacets();
+    }
+
+    const SearchCriteria::SortOrder sortOrder = criteria.getSortOrder();
+    SortKey cursor = {0.0, 0};
+    const bool hasCursor = criteria.hasCursor();
+    if (hasCursor && !decodeCursor(criteria.getCursor(), sortOrder, cursor)) {
+        qDebug() << "无效的搜索游标:" << criteria.getCursor();
+        return result;
+    }
+
+    if (facets && criteria.isEmpty()) {
+        indexFacets(*facets);
+    }
+    // 有筛选条件时在匹配的同一遍中统计分面，游标之前的命中也要计数，数据源因此从头开始
+    const bool countInPass = facets && !criteria.isEmpty();
+    // 相关度不能沿索引输出，需要先求出全部命中，游标在打分后才能比较
+    const bool ranked = sortOrder == SearchCriteria::SortByRelevance;
+    const bool resume = hasCursor && !countInPass && !ranked;
+
+    // 需要的命中数，多取一个用来判断是否还有下一页；-1表示不限
+    const qint64 wanted = criteria.hasLimit() ? qint64(criteria.getOffset()) + criteria.getLimit() + 1 : -1;
+
+    const Plan plan = this->plan(criteria, wanted, countInPass || ranked);
+    if (plan.empty || (criteria.getLimit() == 0 && !countInPass)) {
+        return result;
+    }
+
+    const double minPrice = criteria.hasMinPrice() ? criteria.getMinPrice() : -std::numeric_limits<double>::infinity();
+    const double maxPrice = criteria.hasMaxPrice() ? criteria.getMaxPrice() : std::numeric_limits<double>::infinity();
+
+    QVector<quint32> matched;
+    QVector<SortKey> rankedKeys;
+    FacetHistogram histogram;
+    const bool stream = plan.access == Access::OrderedScan && !ranked;
+    // 候选槽位较多时过滤条件在线程池中分批求值，命中仍按数据源的顺序输出
+    const int threads = plan.probes.isEmpty() ? 1 : scanThreads;
+    auto predicate = [this, &plan, &criteria](quint32 slot) {
+        return matches(slot, plan, criteria);
+    };
+    if (stream) {
+        // 按结果顺序输出，从游标处开始，取满一页即停止
+        auto consume = [&](quint32 slot) {
+            if (countInPass) {
+                countFacets(slot, histogram);
+            }
+            const bool full = wanted >= 0 && matched.size() >= wanted;
+            if (!full && (!hasCursor || resume || precedes(cursor, sortKey(slot, sortOrder), sortOrder))) {
+                matched.append(slot);
+            }
+            return countInPass || wanted < 0 || matched.size() < wanted;
+        };
+        ParallelFilter filter(threads, predicate, consume);
+        auto visitor = [&filter](quint32 slot) {
+            return filter.push(slot);
+        };
+        switch (sortOrder) {
+        case SearchCriteria::SortByPriceAscending:
+        case SearchCriteria::SortByPriceDescending: {
+            const bool descending = sortOrder == SearchCriteria::SortByPriceDescending;
+            if (resume) {
+                priceIndex.scanAfter(cursor.value, cursor.productId, minPrice, maxPrice, descending, visitor);
+            } else {
+                priceIndex.scan(minPrice, maxPrice, descending, visitor);
+            }
+            break;
+        }
+        case SearchCriteria::SortByNewest: {
+            const qint64 time = qint64(cursor.value);
+            const bool exactCategory = criteria.hasCategoryId() && !criteria.includesSubcategories();
+            if (exactCategory && resume) {
+                recencyIndex.scanOlderThan(criteria.getCategoryId(), time, cursor.productId, visitor);
+            } else if (exactCategory) {
+                recencyIndex.scanNewest(criteria.getCategoryId(), visitor);
+            } else if (resume) {
+                recencyIndex.scanOlderThan(time, cursor.productId, visitor);
+            } else {
+                recencyIndex.scanNewest(visitor);
+            }
+            break;
+        }
+        default:
+            for (auto it = resume ? slotById.upperBound(cursor.productId) : slotById.constBegin();
+                 it != slotById.constEnd(); ++it) {
+                if (!visitor(it.value())) {
+                    break;
+                }
+            }
+            break;
+        }
+        filter.finish();
+    } else {
+        ParallelFilter filter(threads, predicate, [&matched](quint32 slot) {
+            matched.append(slot);
+            return true;
+        });
+        auto collect = [&filter](quint32 slot) {
+            return filter.push(slot);
+        };
+        switch (plan.access) {
+        case Access::PriceRange:
+            priceIndex.scan(minPrice, maxPrice, false, collect);
+            break;
+        case Access::SetScan:
+            for (quint32 slot : *plan.driverSet) {
+                collect(slot);
+            }
+            break;
+        case Access::OrderedScan:
+            for (quint32 slot : slotById) {
+                collect(slot);
+            }
+            break;
+        default:
+            for (quint32 slot : plan.driverSlots) {
+                collect(slot);
+            }
+            break;
+        }
+        filter.finish();
+        if (countInPass) {
+            for (quint32 slot : matched) {
+                countFacets(slot, histogram);
+            }
+        }
+
+        // 只对命中的商品排序，再丢弃游标之前的部分
+        if (ranked) {
+            rank(matched, rankedKeys, criteria, wanted, hasCursor ? &cursor : nullptr);
+        } else {
+            std::sort(matched.begin(), matched.end(), [this, sortOrder](quint32 a, quint32 b) {
+                return precedes(sortKey(a, sortOrder), sortKey(b, sortOrder), sortOrder);
+            });
+        }
+        if (hasCursor && !ranked) {
+            auto first = std::partition_point(matched.begin(), matched.end(), [this, &cursor, sortOrder](quint32 slot) {
+                return !precedes(cursor, sortKey(slot, sortOrder), sortOrder);
+            });
+            matched.erase(matched.begin(), first);
+        }
+    }
+    if (countInPass) {
+        exportFacets(histogram, *facets);
+    }
+
+    const int offset = qMin(criteria.getOffset(), matched.size());
+    const int end = criteria.hasLimit() ? int(qMin(qint64(matched.size()), qint64(offset) + criteria.getLimit()))
+                                        : matched.size();
+    result.reserve(end - offset);
+    for (int i = offset; i < end; ++i) {
+        result.append(columns.productIds().at(int(matched.at(i))));
+    }
+    if (nextCursor && end < matched.size() && end > 0) {
+        const SortKey last = ranked ? rankedKeys.at(end - 1) : sortKey(matched.at(end - 1), sortOrder);
+        *nextCursor = encodeCursor(sortOrder, last);
+    }
+    return result;
+}
+
+/**
+ * @brief 说明按条件搜索时选用的查询计划
+ * @param criteria 搜索条件
+ * @return 每行一项的查询计划说明
+ */
+QString ProductSearchIndex::explain(const SearchCriteria& criteria) const {
+    const bool ranked = criteria.getSortOrder() == SearchCriteria::SortByRelevance;
+    const qint64 wanted = criteria.hasLimit() ? qint64(criteria.getOffset()) + criteria.getLimit() + 1 : -1;
+    const Plan plan = this->plan(criteria, wanted, ranked);
+    if (plan.empty) {
+        return QString("结果为空：%1").arg(plan.emptyReason);
+    }
+
+    QStringList lines;
+    lines << QString("估计命中：%1 / %2").arg(qRound64(plan.estimatedRows)).arg(size());
+    lines << QString("取得：%1，约%2项").arg(plan.accessLabel).arg(qRound64(plan.accessRows));
+    for (const Probe& probe : plan.probes) {
+        lines << QString("过滤：%1，选择率%2").arg(probe.label).arg(probe.selectivity, 0, 'f', 3);
+    }
+    if (scanThreads > 1 && !plan.probes.isEmpty() && plan.accessRows >= ParallelFilter::kMinParallelSlots) {
+        lines << QString("并行：逐个过滤%1项后分批在%2个线程中过滤，结果顺序不变")
+                     .arg(ParallelFilter::kMinParallelSlots)
+                     .arg(scanThreads);
+    }
+    if (ranked) {
+        lines << (wanted >= 0 ? QString("排序：按相关度打分，用大小为%1的堆选出排在最前的商品").arg(wanted)
+                              : QString("排序：按相关度打分后排序"));
+    } else {
+        lines << (plan.access == Access::OrderedScan ? QString("排序：沿有序索引输出，取满一页即停止")
+                                                     : QString("排序：对命中的商品排序后分页"));
+    }
+    lines << QString("估计代价：%1").arg(plan.cost, 0, 'f', 1);
+    return lines.join('\n');
+}
+
+/**
+ * @brief 把一个命中的槽位计入分面直方图
+ *
+ * 只读取槽位中保存的分类和字典编码，不加载商品
+ * @param slot 槽位号
+ * @param histogram 分面直方图
+ */
+void ProductSearchIndex::countFacets(quint32 slot, FacetHistogram& histogram) const {
+    if (histogram.statusCounts.isEmpty()) {
+        histogram.statusCounts.fill(0, textByCode.size());
+        histogram.locationCounts.fill(0, textByCode.size());
+        histogram.tagCounts.fill(0, textByCode.size());
+    }
+    ++histogram.total;
+    histogram.prices.add(columns.prices().at(int(slot)));
+    ++histogram.categoryCounts[columns.categoryIds().at(int(slot))];
+    ++histogram.statusCounts[int(columns.statusCodes().at(int(slot)))];
+    ++histogram.locationCounts[int(columns.locationCodes().at(int(slot)))];
+    for (quint32 code : tagsBySlot.at(int(slot))) {
+        ++histogram.tagCounts[int(code)];
+    }
+}
+
+/**
+ * @brief 把分面直方图转换为分面统计，省略计数为0的项
+ * @param histogram 分面直方图
+ * @param facets 输出参数，分面统计
+ */
+void ProductSearchIndex::exportFacets(const FacetHistogram& histogram, SearchFacets& facets) const {
+    auto toHash = [this](const QVector<int>& counts) {
+        QHash<QString, int> result;
+        for (int code = 0; code < counts.size(); ++code) {
+            if (counts.at(code) > 0) {
+                result.insert(textByCode.at(code), counts.at(code));
+            }
+        }
+        return result;
+    };
+    facets.setTotal(histogram.total);
+    facets.setCategoryCounts(histogram.categoryCounts);
+    facets.setStatusCounts(toHash(histogram.statusCounts));
+    facets.setLocationCounts(toHash(histogram.locationCounts));
+    facets.setTagCounts(toHash(histogram.tagCounts));
+    facets.setPriceStatistics(histogram.prices.min, histogram.prices.max, histogram.prices.average());
+}
+
+/**
+ * @brief 由索引中维护的集合大小得到全部商品的分面统计
+ *
+ * 没有筛选条件时每个分面值的命中数就是对应槽位集合的大小，不必遍历商品；价格统计顺序扫描价格列
+ * @param facets 输出参数，分面统计
+ */
+void ProductSearchIndex::indexFacets(SearchFacets& facets) const {
+    auto sizes = [](const auto& map, auto& result) {
+        for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+            result.insert(it.key(), it.value().size());
+        }
+    };
+    QHash<int, int> categoryCounts;
+    QHash<QString, int> statusCounts;
+    QHash<QString, int> locationCounts;
+    sizes(categoryPostings, categoryCounts);
+    sizes(statusPostings, statusCounts);
+    sizes(locationPostings, locationCounts);
+    facets.setTotal(slotById.size());
+    facets.setCategoryCounts(categoryCounts);
+    facets.setStatusCounts(statusCounts);
+    facets.setLocationCounts(locationCounts);
+    facets.setTagCounts(tagIndex.counts());
+    const ProductColumns::PriceSummary prices = columns.summarizePrices();
+    facets.setPriceStatistics(prices.min, prices.max, prices.average());
+}
+
+/**
+ * @brief 获取字符串的字典编码，不存在时分配新编码
+ *
+ * 字典只增不减，已删除商品用过的编码在统计时计数为0
+ * @param text 状态、地址或标签
+ * @return 字典编码
+ */
+quint32 ProductSearchIndex::facetCode(const QString& text) {
+    auto it = codeByText.constFind(text);
+    if (it != codeByText.constEnd()) {
+        return it.value();
+    }
+    const quint32 code = quint32(textByCode.size());
+    codeByText.insert(text, code);
+    textByCode.append(text);
+    return code;
+}
+
+/**
+ * @brief 获取槽位的排序键
+ * @param slot 槽位号
+ * @param sortOrder 排序方式
+ * @return 排序键
+ */
+ProductSearchIndex::SortKey ProductSearchIndex::sortKey(quint32 slot, SearchCriteria::SortOrder sortOrder) const {
+    SortKey key = {0.0, columns.productIds().at(int(slot))};
+    switch (sortOrder) {
+    case SearchCriteria::SortByPriceAscending:
+    case SearchCriteria::SortByPriceDescending:
+        key.value = columns.prices().at(int(slot));
+        break;
+    case SearchCriteria::SortByNewest:
+        key.value = double(columns.timeKeys().at(int(slot)));
+        break;
+    default:
+        break;
+    }
+    return key;
+}
+
+/**
+ * @brief 按排序方式比较两个排序键
+ *
+ * 与商品ID、价格和发布时间索引的遍历顺序一致，排序值相同时按商品ID排序；相关度从高到低，相同时按商品ID升序
+ * @param a 排序键
+ * @param b 排序键
+ * @param sortOrder 排序方式
+ * @return a排在b之前返回true，否则返回false
+ */
+bool ProductSearchIndex::precedes(const SortKey& a, const SortKey& b, SearchCriteria::SortOrder sortOrder) {
+    switch (sortOrder) {
+    case SearchCriteria::SortByPriceAscending:
+        return a.value != b.value ? a.value < b.value : a.productId < b.productId;
+    case SearchCriteria::SortByPriceDescending:
+    case SearchCriteria::SortByNewest:
+        return a.value != b.value ? a.value > b.value : a.productId > b.productId;
+    case SearchCriteria::SortByRelevance:
+        return a.value != b.value ? a.value > b.value : a.productId < b.productId;
+    default:
+        return a.productId < b.productId;
+    }
+}
+
+/**
+ * @brief 按相关度为命中的槽位打分并选出排在最前的部分
+ *
+ * 得分为关键词的BM25F得分（没有关键词时为1），设置了半衰期时再乘以0.5^(距索引中最新商品的天数/半衰期)，
+ * 发布时间未知的商品不衰减。打分只读取相关度索引中的词频，不加载商品；
+ * 维护一个按排序顺序最差者在堆顶的大小为wanted的堆，命中n项时代价为O(n log wanted)，最后只对堆中的槽位排序
+ * @param matched 命中的槽位，输出时替换为选出的槽位，按相关度从高到低
+ * @param keys 输出参数，选出的槽位对应的排序键
+ * @param criteria 搜索条件
+ * @param wanted 需要的命中数，-1表示不限
+ * @param after 不为空时只保留排在该排序键之后的槽位
+ */
+void ProductSearchIndex::rank(QVector<quint32>& matched, QVector<SortKey>& keys, const SearchCriteria& criteria,
+                              qint64 wanted, const SortKey* after) const {
+    const SearchCriteria::SortOrder sortOrder = SearchCriteria::SortByRelevance;
+    const RelevanceIndex::Query query = relevanceIndex.prepare(criteria.getKeyword());
+    const bool scored = criteria.hasKeyword();
+
+    qint64 newest = std::numeric_limits<qint64>::min();
+    if (criteria.hasRecencyDecay()) {
+        recencyIndex.scanNewest([this, &newest](quint32 slot) {
+            newest = columns.timeKeys().at(int(slot));
+            return false;
+        });
+    }
+    const double msPerHalfLife = criteria.getRecencyHalfLife() * 24.0 * 60.0 * 60.0 * 1000.0;
+    const qint64 unknown = std::numeric_limits<qint64>::min();
+
+    struct Ranked {
+        SortKey key;
+        quint32 slot;
+    };
+    auto earlier = [sortOrder](const Ranked& a, const Ranked& b) {
+        return precedes(a.key, b.key, sortOrder);
+    };
+    std::vector<Ranked> heap;
+    heap.reserve(size_t(wanted >= 0 ? qMin(qint64(matched.size()), wanted) : matched.size()));
+    for (quint32 slot : matched) {
+        double value = scored ? relevanceIndex.score(slot, query) : 1.0;
+        const qint64 time = columns.timeKeys().at(int(slot));
+        if (newest != unknown && time != unknown) {
+            value *= std::exp2(-double(newest - time) / msPerHalfLife);
+        }
+        const Ranked entry = {{value, columns.productIds().at(int(slot))}, slot};
+        if (after && !precedes(*after, entry.key, sortOrder)) {
+            continue;
+        }
+        if (wanted < 0 || qint64(heap.size()) < wanted) {
+            heap.push_back(entry);
+            std::push_heap(heap.begin(), heap.end(), earlier);
+        } else if (wanted > 0 && precedes(entry.key, heap.front().key, sortOrder)) {
+            std::pop_heap(heap.begin(), heap.end(), earlier);
+            heap.back() = entry;
+            std::push_heap(heap.begin(), heap.end(), earlier);
+        }
+    }
+    std::sort_heap(heap.begin(), heap.end(), earlier);
+
+    matched.resize(int(heap.size()));
+    keys.resize(int(heap.size()));
+    for (int i = 0; i < int(heap.size()); ++i) {
+        matched[i] = heap.at(size_t(i)).slot;
+        keys[i] = heap.at(size_t(i)).key;
+    }
+}
+
+/**
+ * @brief 把排序键编码为游标
+ *
+ * 游标记录排序方式、排序值和商品ID，用URL安全的Base64编码，调用方只需原样传回
+ * @param sortOrder 排序方式
+ * @param key 上一页最后一个商品的排序键
+ * @return 游标
+ */
+QString ProductSearchIndex::encodeCursor(SearchCriteria::SortOrder sortOrder, const SortKey& key) {
+    const QString text = QString("%1:%2:%3").arg(int(sortOrder)).arg(key.value, 0, 'g', 17).arg(key.productId);
+    return QString::fromLatin1(text.toUtf8().toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals));
+}
+
+/**
+ * @brief 把游标解码为排序键
+ * @param cursor 游标
+ * @param sortOrder 当前搜索的排序方式，与游标记录的不一致时视为无效
+ * @param key 输出参数，排序键
+ * @return 游标有效返回true，否则返回false
+ */
+bool ProductSearchIndex::decodeCursor(const QString& cursor, SearchCriteria::SortOrder sortOrder, SortKey& key) {
+    const QByteArray decoded = QByteArray::fromBase64(cursor.toLatin1(), QByteArray::Base64UrlEncoding);
+    const QStringList parts = QString::fromUtf8(decoded).split(':');
+    if (parts.size() != 3) {
+        return false;
+    }
+    bool orderOk = false;
+    bool valueOk = false;
+    bool idOk = false;
+    const int order = parts.at(0).toInt(&orderOk);
+    key.value = parts.at(1).toDouble(&valueOk);
+    key.productId = parts.at(2).toInt(&idOk);
+    return orderOk && valueOk && idOk && order == int(sortOrder);
+}
+
+/**
+ * @brief 根据索引的基数统计选择代价最小的查询计划
+ *
+ * 每个条件的选择率取自对应索引的基数：槽位集合和标签位图的大小、关键词最短倒排表的长度、价格区间内的商品数，
+ * 估计命中数时假设各条件相互独立。候选的取得方式有沿有序索引输出、价格区间、最小的槽位集合、标签位图和关键词倒排表，
+ * 代价为取得候选槽位的代价加上逐个过滤的期望代价，不沿有序索引输出时再加上排序的代价。
+ * 其余条件按“代价/(1-选择率)”升序执行，使选择性强、探测便宜的条件先淘汰候选；
+ * 关键词不驱动时比较逐个在倒排表中查找和先解码整个倒排表的代价，宽泛的关键词配合很窄的卖家条件时只做少量查找。
+ * 模糊匹配的关键词先由三元组索引求出全部相近的槽位，之后与解码后的关键词槽位一样二分查找
+ * @param criteria 搜索条件
+ * @param wanted 需要的命中数，-1表示不限
+ * @param exhaustive 是否必须遍历全部命中（统计分面时）
+ * @return 查询计划
+ */
+ProductSearchIndex::Plan ProductSearchIndex::plan(const SearchCriteria& criteria, qint64 wanted, bool exhaustive) const {
+    Plan plan;
+    const double total = qMax(1, slotById.size());
+    QVector<Probe> filters;
+    auto addFilter = [&filters, total](Probe::Kind kind, double rows, double cost, const QString& label) {
+        Probe probe;
+        probe.kind = kind;
+        probe.selectivity = qBound(0.0, rows / total, 1.0);
+        probe.cost = cost;
+        probe.label = label;
+        filters.append(probe);
+    };
+    auto useIndex = [&](const auto& map, const auto& key, ProductColumns::Column column, qint64 value,
+                        const QString& label) -> const QSet<quint32>* {
+        auto it = map.constFind(key);
+        if (it == map.constEnd()) {
+            plan.empty = true;
+            plan.emptyReason = QString("%1没有商品").arg(label);
+            return nullptr;
+        }
+        addFilter(Probe::SetProbe, it.value().size(), kColumnProbeCost,
+                  QString("%1（%2项）").arg(label).arg(it.value().size()));
+        filters.last().set = &it.value();
+        filters.last().column = column;
+        filters.last().value = value;
+        return &it.value();
+    };
+
+    const QSet<quint32>* categorySet = nullptr;
+    if (criteria.hasSellerId()) {
+        useIndex(sellerPostings, criteria.getSellerId(), ProductColumns::SellerColumn, criteria.getSellerId(),
+                 QString("卖家=%1").arg(criteria.getSellerId()));
+    }
+    const bool subtree = criteria.includesSubcategories();
+    if (criteria.hasCategoryId() && !subtree) {
+        categorySet = useIndex(categoryPostings, criteria.getCategoryId(), ProductColumns::CategoryColumn,
+                               criteria.getCategoryId(), QString("分类=%1").arg(criteria.getCategoryId()));
+    }
+    if (criteria.hasStatus()) {
+        useIndex(statusPostings, criteria.getStatus(), ProductColumns::StatusColumn,
+                 codeByText.value(criteria.getStatus()), QString("状态=%1").arg(criteria.getStatus()));
+    }
+    if (criteria.hasLocation()) {
+        useIndex(locationPostings, criteria.getLocation(), ProductColumns::LocationColumn,
+                 codeByText.value(criteria.getLocation()), QString("地址=%1").arg(criteria.getLocation()));
+    }
+    const SlotBitmap* region = nullptr;
+    QString regionLabel;
+    if (criteria.hasRegion()) {
+        regionLabel = QString("地区=%1").arg(LocationIndex::displayName(criteria.getRegion()));
+        region = locationIndex.lookup(criteria.getRegion());
+        if (!region) {
+            plan.empty = true;
+            plan.emptyReason = QString("%1没有商品").arg(regionLabel);
+        } else {
+            regionLabel = QString("%1（%2项）").arg(regionLabel).arg(region->cardinality());
+            addFilter(Probe::RegionProbe, region->cardinality(), kProbeCost, regionLabel);
+            filters.last().bitmap = region;
+        }
+    }
+
+    // 分类子树只在分类树中取一段先序区间，不递归展开；候选数为子树中各分类的槽位集合大小之和
+    QVector<const QSet<quint32>*> subtreeSets;
+    QString subtreeLabel;
+    int subtreeRows = 0;
+    if (subtree) {
+        const int root = criteria.getCategoryId();
+        const QList<int> members = categories && categories->contains(root) ? categories->subtree(root) : QList<int>{root};
+        for (int member : members) {
+            auto it = categoryPostings.constFind(member);
+            if (it != categoryPostings.constEnd()) {
+                subtreeSets.append(&it.value());
+                subtreeRows += it.value().size();
+            }
+        }
+        subtreeLabel = QString("分类子树=%1（%2个分类，%3项）").arg(root).arg(members.size()).arg(subtreeRows);
+        if (subtreeRows == 0) {
+            plan.empty = true;
+            plan.emptyReason = QString("分类子树=%1没有商品").arg(root);
+        } else {
+            addFilter(Probe::SubtreeProbe, subtreeRows, kProbeCost, subtreeLabel);
+            plan.subtreeRoot = root;
+        }
+    }
+
+    // 标签的“与”、“或”在位图上完成，排除标签直接从结果中减去；只有排除标签时改为逐个排除
+    const SlotBitmap excluded = tagIndex.matchAny(criteria.getExcludedTags());
+    if (!criteria.getTags().isEmpty() || !criteria.getAnyTags().isEmpty()) {
+        SlotBitmap tagged = criteria.getTags().isEmpty() ? tagIndex.matchAny(criteria.getAnyTags())
+                                                         : tagIndex.matchAll(criteria.getTags());
+        if (!criteria.getTags().isEmpty() && !criteria.getAnyTags().isEmpty()) {
+            tagged = SlotBitmap::intersect(tagged, tagIndex.matchAny(criteria.getAnyTags()));
+        }
+        if (!excluded.isEmpty()) {
+            tagged = SlotBitmap::subtract(tagged, excluded);
+        }
+        if (tagged.isEmpty()) {
+            plan.empty = true;
+            plan.emptyReason = QString("标签条件没有商品");
+        }
+        addFilter(Probe::TagProbe, tagged.cardinality(), kProbeCost, QString("标签（%1项）").arg(tagged.cardinality()));
+        plan.tags = tagged;
+    } else if (!excluded.isEmpty()) {
+        addFilter(Probe::ExcludedProbe, total - excluded.cardinality(), kProbeCost,
+                  QString("排除标签（%1项）").arg(excluded.cardinality()));
+        plan.excluded = excluded;
+    }
+
+    // 关键词无法切分出词项（例如只有标点）时只能逐个核对原文
+    bool verify = criteria.hasKeyword();
+    double decodeCost = 0.0;
+    const bool hasTerms = !TextIndex::queryTerms(criteria.getKeyword()).isEmpty();
+    const bool fuzzy = criteria.isFuzzy() && hasTerms;
+    const bool pinyin = criteria.isPinyinMatching() && hasTerms;
+    const bool approximate = fuzzy || pinyin;
+    const QString approximateKind = fuzzy && pinyin ? QString("模糊和拼音") : fuzzy ? QString("模糊") : QString("拼音");
+    if (approximate) {
+        // 模糊匹配和拼音匹配：标题中拼写相近或拼音相符的槽位并上精确匹配的候选，只有不在前者中的精确候选需要核对原文
+        QStringList modes;
+        if (fuzzy) {
+            plan.titleSlots = trigramIndex.lookup(criteria.getKeyword(), criteria.getFuzzyDistance());
+            modes << QString("编辑距离%1").arg(criteria.getFuzzyDistance());
+        }
+        if (pinyin) {
+            const QVector<quint32> spelled = pinyinIndex.lookup(criteria.getKeyword());
+            QVector<quint32> merged;
+            std::set_union(plan.titleSlots.cbegin(), plan.titleSlots.cend(), spelled.cbegin(), spelled.cend(),
+                           std::back_inserter(merged));
+            plan.titleSlots = merged;
+            modes << QString("全拼或首字母");
+        }
+        QVector<quint32> exact;
+        textIndex.lookup(criteria.getKeyword(), exact);
+        verify = TextIndex::needsVerification(criteria.getKeyword()) && !exact.isEmpty();
+        std::set_union(plan.titleSlots.cbegin(), plan.titleSlots.cend(), exact.cbegin(), exact.cend(),
+                       std::back_inserter(plan.keywordSlots));
+        if (plan.keywordSlots.isEmpty()) {
+            plan.empty = true;
+            plan.emptyReason = QString("关键词“%1”没有相近的商品").arg(criteria.getKeyword());
+        } else {
+            addFilter(Probe::KeywordProbe, plan.keywordSlots.size(), kProbeCost,
+                      QString("%1关键词“%2”（%3，%4项）")
+                          .arg(approximateKind)
+                          .arg(criteria.getKeyword())
+                          .arg(modes.join("、"))
+                          .arg(plan.keywordSlots.size()));
+        }
+    } else if (criteria.hasKeyword() && textIndex.termPostings(criteria.getKeyword(), plan.terms)) {
+        verify = TextIndex::needsVerification(criteria.getKeyword());
+        if (plan.terms.isEmpty()) {
+            plan.empty = true;
+            plan.emptyReason = QString("关键词“%1”没有商品").arg(criteria.getKeyword());
+        } else {
+            for (const PostingList* list : plan.terms) {
+                decodeCost += list->size() * kDecodeCost;
+            }
+            addFilter(Probe::TermProbe, plan.terms.first()->size(), plan.terms.size() * kTermProbeCost,
+                      QString("关键词“%1”（%2个词项，最短%3项）")
+                          .arg(criteria.getKeyword())
+                          .arg(plan.terms.size())
+                          .arg(plan.terms.first()->size()));
+        }
+    }
+
+    const bool priceFiltered = criteria.hasMinPrice() || criteria.hasMaxPrice();
+    const double minPrice = criteria.hasMinPrice() ? criteria.getMinPrice() : -std::numeric_limits<double>::infinity();
+    const double maxPrice = criteria.hasMaxPrice() ? criteria.getMaxPrice() : std::numeric_limits<double>::infinity();
+    const int priceRows = priceFiltered ? priceIndex.count(minPrice, maxPrice) : priceIndex.size();
+    if (priceFiltered) {
+        if (priceRows == 0) {
+            plan.empty = true;
+            plan.emptyReason = QString("价格区间内没有商品");
+        }
+        addFilter(Probe::PriceProbe, priceRows, kColumnProbeCost, QString("价格区间（%1项）").arg(priceRows));
+    }
+    if (plan.empty) {
+        return plan;
+    }
+
+    plan.estimatedRows = slotById.size();
+    for (const Probe& filter : filters) {
+        plan.estimatedRows *= filter.selectivity;
+    }
+
+    // 按“代价/(1-选择率)”排列过滤条件，得出每个候选槽位的期望过滤代价
+    auto arrange = [](QVector<Probe> probes, double& perRow) {
+        auto rank = [](const Probe& probe) {
+            return probe.selectivity >= 1.0 ? std::numeric_limits<double>::infinity()
+                                            : probe.cost / (1.0 - probe.selectivity);
+        };
+        std::stable_sort(probes.begin(), probes.end(), [&rank](const Probe& a, const Probe& b) {
+            return rank(a) < rank(b);
+        });
+        perRow = 0.0;
+        double passed = 1.0;
+        for (const Probe& probe : probes) {
+            perRow += passed * probe.cost;
+            passed *= probe.selectivity;
+        }
+        return probes;
+    };
+
+    // 逐个评估取得方式，covers给出取得方式本身已经满足、不必再过滤的条件
+    bool chosen = false;
+    bool decodeKeyword = false;
+    const double sortCost = plan.estimatedRows * std::log2(plan.estimatedRows + 2.0) * kSortCost;
+    auto consider = [&](Access access, double rows, double fetchCost, bool sorted,
+                        const std::function<bool(const Probe&)>& covers, const QString& label) {
+        QVector<Probe> rest;
+        for (const Probe& filter : filters) {
+            if (!covers(filter)) {
+                rest.append(filter);
+            }
+        }
+        double perRow = 0.0;
+        QVector<Probe> probes = arrange(rest, perRow);
+        double cost = fetchCost + rows * perRow;
+
+        // 关键词也可以先解码整个倒排表，再对每个候选二分查找
+        bool decode = false;
+        for (int i = 0; i < rest.size(); ++i) {
+            if (rest.at(i).kind == Probe::TermProbe) {
+                rest[i].kind = Probe::KeywordProbe;
+                rest[i].cost = kProbeCost;
+                double decodedPerRow = 0.0;
+                QVector<Probe> decoded = arrange(rest, decodedPerRow);
+                if (decodeCost + rows * decodedPerRow < rows * perRow) {
+                    probes = decoded;
+                    cost = fetchCost + decodeCost + rows * decodedPerRow;
+                    decode = true;
+                }
+                break;
+            }
+        }
+        if (!sorted) {
+            cost += sortCost;
+        }
+        if (chosen && cost >= plan.cost) {
+            return;
+        }
+        chosen = true;
+        decodeKeyword = decode;
+        plan.access = access;
+        plan.accessRows = rows;
+        plan.accessLabel = label;
+        plan.cost = cost;
+        plan.probes = probes;
+    };
+
+    // 沿结果顺序对应的有序索引输出：分页时假设其余条件与排序键无关，按命中率折算需要访问的项数
+    double sourceRows = slotById.size();
+    std::function<bool(const Probe&)> sourceCovers = [](const Probe&) { return false; };
+    QString sourceLabel = QString("商品ID顺序");
+    switch (criteria.getSortOrder()) {
+    case SearchCriteria::SortByPriceAscending:
+    case SearchCriteria::SortByPriceDescending:
+        sourceRows = priceRows;
+        sourceCovers = [](const Probe& probe) { return probe.kind == Probe::PriceProbe; };
+        sourceLabel = criteria.getSortOrder() == SearchCriteria::SortByPriceAscending ? QString("价格索引，从低到高")
+                                                                                      : QString("价格索引，从高到低");
+        break;
+    case SearchCriteria::SortByNewest:
+        sourceRows = categorySet ? recencyIndex.size(criteria.getCategoryId()) : recencyIndex.size();
+        sourceCovers = [categorySet](const Probe& probe) { return categorySet && probe.set == categorySet; };
+        sourceLabel = categorySet ? QString("分类内的发布时间索引，从新到旧") : QString("发布时间索引，从新到旧");
+        break;
+    default:
+        break;
+    }
+    double visited = sourceRows;
+    if (!exhaustive && wanted > 0 && plan.estimatedRows > 0.0) {
+        visited = qMin(sourceRows, wanted * sourceRows / plan.estimatedRows);
+    }
+    consider(Access::OrderedScan, visited, visited * kProbeCost, criteria.getSortOrder() != SearchCriteria::SortByRelevance,
+             sourceCovers, sourceLabel);
+
+    const bool priceSorted = criteria.getSortOrder() == SearchCriteria::SortByPriceAscending
+                             || criteria.getSortOrder() == SearchCriteria::SortByPriceDescending;
+    if (priceFiltered && !priceSorted) {
+        consider(Access::PriceRange, priceRows, priceRows * kProbeCost, false,
+                 [](const Probe& probe) { return probe.kind == Probe::PriceProbe; }, QString("价格区间"));
+    }
+
+    const Probe* smallest = nullptr;
+    for (const Probe& filter : filters) {
+        if (filter.kind == Probe::SetProbe && (!smallest || filter.set->size() < smallest->set->size())) {
+            smallest = &filter;
+        }
+    }
+    if (smallest) {
+        const QSet<quint32>* set = smallest->set;
+        consider(Access::SetScan, set->size(), set->size() * kProbeCost, false,
+                 [set](const Probe& probe) { return probe.set == set; }, smallest->label);
+        if (plan.access == Access::SetScan) {
+            plan.driverSet = set;
+        }
+    }
+
+    if (!criteria.getTags().isEmpty() || !criteria.getAnyTags().isEmpty()) {
+        const int rows = plan.tags.cardinality();
+        consider(Access::TagScan, rows, rows * kProbeCost, false,
+                 [](const Probe& probe) { return probe.kind == Probe::TagProbe; }, QString("标签位图"));
+    }
+    if (region) {
+        const int rows = region->cardinality();
+        consider(Access::RegionScan, rows, rows * kProbeCost, false,
+                 [](const Probe& probe) { return probe.kind == Probe::RegionProbe; }, regionLabel);
+    }
+
+    if (!subtreeSets.isEmpty()) {
+        consider(Access::SubtreeScan, subtreeRows, subtreeRows * kProbeCost, false,
+                 [](const Probe& probe) { return probe.kind == Probe::SubtreeProbe; }, subtreeLabel);
+    }
+
+    if (!plan.terms.isEmpty()) {
+        const int rows = plan.terms.first()->size();
+        consider(Access::KeywordScan, rows, decodeCost + rows * kProbeCost, false,
+                 [](const Probe& probe) { return probe.kind == Probe::TermProbe; }, QString("关键词倒排表"));
+    }
+    if (approximate) {
+        const int rows = plan.keywordSlots.size();
+        consider(Access::KeywordScan, rows, rows * kProbeCost, false,
+                 [](const Probe& probe) { return probe.kind == Probe::KeywordProbe; }, approximateKind + "关键词槽位");
+    }
+
+    // 按选定的方式取出候选槽位
+    auto decodeTerms = [&plan]() {
+        QVector<quint32> matches = plan.terms.first()->decode();
+        for (int i = 1; i < plan.terms.size() && !matches.isEmpty(); ++i) {
+            matches = PostingList::intersect(matches, plan.terms.at(i)->decode());
+        }
+        return matches;
+    };
+    if (plan.access == Access::TagScan) {
+        plan.driverSlots = plan.tags.toVector();
+    } else if (plan.access == Access::RegionScan) {
+        plan.driverSlots = region->toVector();
+    } else if (plan.access == Access::SubtreeScan) {
+        SlotBitmap merged;
+        for (const QSet<quint32>* set : subtreeSets) {
+            for (quint32 slot : *set) {
+                merged.add(slot);
+            }
+        }
+        plan.driverSlots = merged.toVector();
+    } else if (plan.access == Access::KeywordScan) {
+        plan.driverSlots = approximate ? plan.keywordSlots : decodeTerms();
+    }
+    if (decodeKeyword) {
+        plan.keywordSlots = decodeTerms();
+    }
+    if (verify) {
+        Probe probe;
+        probe.kind = Probe::VerifyProbe;
+        probe.cost = kVerifyCost;
+        probe.label = QString("核对关键词“%1”原文").arg(criteria.getKeyword());
+        plan.probes.append(probe);
+    }
+    return plan;
+}
+
+/**
+ * @brief 槽位是否通过查询计划中的全部过滤条件
+ *
+ * 按计划中的顺序探测，遇到不满足的条件立即返回；只有最后的原文核对需要加载商品
+ * @param slot 槽位号
+ * @param plan 查询计划
+ * @param criteria 搜索条件
+ * @return 通过返回true，否则返回false
+ */
+bool ProductSearchIndex::matches(quint32 slot, const Plan& plan, const SearchCriteria& criteria) const {
+    for (const Probe& probe : plan.probes) {
+        bool passed = true;
+        switch (probe.kind) {
+        case Probe::SetProbe:
+            passed = columns.equals(probe.column, slot, probe.value);
+            break;
+        case Probe::TagProbe:
+            passed = plan.tags.contains(slot);
+            break;
+        case Probe::RegionProbe:
+            passed = probe.bitmap->contains(slot);
+            break;
+        case Probe::SubtreeProbe: {
+            const int categoryId = columns.categoryIds().at(int(slot));
+            passed = categoryId == plan.subtreeRoot || (categories && categories->isWithin(plan.subtreeRoot, categoryId));
+            break;
+        }
+        case Probe::ExcludedProbe:
+            passed = !plan.excluded.contains(slot);
+            break;
+        case Probe::TermProbe:
+            passed = std::all_of(plan.terms.cbegin(), plan.terms.cend(), [slot](const PostingList* list) {
+                return list->contains(slot);
+            });
+            break;
+        case Probe::KeywordProbe:
+            passed = std::binary_search(plan.keywordSlots.cbegin(), plan.keywordSlots.cend(), slot);
+            break;
+        case Probe::PriceProbe: {
+            const double price = columns.prices().at(int(slot));
+            passed = !(criteria.hasMinPrice() && price < criteria.getMinPrice())
+                     && !(criteria.hasMaxPrice() && price > criteria.getMaxPrice());
+            break;
+        }
+        case Probe::VerifyProbe: {
+            if (std::binary_search(plan.titleSlots.cbegin(), plan.titleSlots.cend(), slot)) {
+                break;
+            }
+            const Product product = loader(columns.productIds().at(int(slot)));
+            passed = product.getTitle().contains(criteria.getKeyword(), Qt::CaseInsensitive)
+                     || product.getDescription().contains(criteria.getKeyword(), Qt::CaseInsensitive);
+            break;
+        }
+        }
+        if (!passed) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 获取商品参与全文索引的文本
+ *
+ * 用换行分隔标题和描述，避免两者首尾的文字拼成跨字段的二元组
+ * @param product 商品对象
+ * @return 标题和描述，以换行分隔
+ */
+QString ProductSearchIndex::indexedText(const Product& product) {
+    return product.getTitle() + QLatin1Char('\n') + product.getDescription();
+}
+
+/**
+ * @brief 把槽位登记到键对应的集合中
+ * @param map 索引
+ * @param key 键
+ * @param slot 槽位号
+ */
+template <typename Key>
+void ProductSearchIndex::addPosting(PostingMap<Key>& map, const Key& key, quint32 slot) {
+    map[key].insert(slot);
+}
+
+/**
+ * @brief 从键对应的集合中移除槽位，集合为空时删除该键
+ * @param map 索引
+ * @param key 键
+ * @param slot 槽位号
+ */
+template <typename Key>
+void ProductSearchIndex::removePosting(PostingMap<Key>& map, const Key& key, quint32 slot) {
+    auto it = map.find(key);
+    if (it == map.end()) {
+        return;
+    }
+    it.value().remove(slot);
+    if (it.value().isEmpty()) {
+        map.erase(it);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,374 @@
+#ifndef PRODUCTSEARCHINDEX_H
+#define PRODUCTSEARCHINDEX_H
+
+#include "CategoryTree.h"
+#include "LocationIndex.h"
+#include "PinyinIndex.h"
+#include "PriceIndex.h"
+#include "ProductColumns.h"
+#include "Product.h"
+#include "RecencyIndex.h"
+#include "RelevanceIndex.h"
+#include "SearchCriteria.h"
+#include "SearchFacets.h"
+#include "SuggestionIndex.h"
+#include "TagIndex.h"
+#include "TextIndex.h"
+#include "TrigramIndex.h"
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+/**
+ * @brief 商品搜索索引类
+ *
+ * ProductSearchIndex为商品维护内存中的二级索引，供ProductRepository::search()使用。
+ * 每个商品占用一个紧凑的槽位号，各索引只保存键和槽位，需要商品原文时通过加载回调取回
+ */
+class ProductSearchIndex {
+public:
+    /**
+     * @brief 根据商品ID加载商品的回调
+     */
+    using ProductLoader = std::function<Product(int)>;
+
+    /**
+     * @brief 构造函数
+     * @param loader 根据商品ID加载商品的回调
+     * @param categories 分类树，查询时读取，为空时包括下级分类的分类条件只匹配分类本身
+     */
+    explicit ProductSearchIndex(ProductLoader loader, const CategoryTree* categories = nullptr);
+
+    /**
+     * @brief 设置过滤候选槽位时使用的线程数
+     *
+     * 候选槽位很多时（例如没有可用索引的原文核对）由ParallelFilter分批并行过滤，结果顺序不变；
+     * 大于1时加载回调会在多个线程中同时调用
+     * @param threadCount 线程数，1表示在调用线程上逐个过滤
+     */
+    void setScanThreadCount(int threadCount);
+
+    /**
+     * @brief 获取过滤候选槽位时使用的线程数
+     * @return 线程数，默认为1
+     */
+    int scanThreadCount() const;
+
+    /**
+     * @brief 把商品加入索引
+     *
+     * 定长字段按列写入槽位，卖家、分类、状态和地址登记到槽位集合，
+     * 标签、地区、全文、模糊匹配、拼音、价格、发布时间和相关度由各自的索引保存。
+     * 商品ID已在索引中时忽略本次调用，更新商品时调用者必须先用remove()移除旧版本
+     * @param product 商品对象
+     */
+    void insert(const Product& product);
+
+    /**
+     * @brief 从索引中移除商品
+     * @param product 索引中的商品版本
+     */
+    void remove(const Product& product);
+
+    /**
+     * @brief 获取索引中的商品数
+     * @return 商品数
+     */
+    int size() const;
+
+    /**
+     * @brief 获取带有指定标签的商品数
+     * @param tag 标签
+     * @return 商品数
+     */
+    int tagCount(const QString& tag) const;
+
+    /**
+     * @brief 获取每个标签的商品数
+     * @return 标签到商品数的映射
+     */
+    QHash<QString, int> tagCounts() const;
+
+    /**
+     * @brief 获取以指定前缀开头的搜索建议
+     * @param prefix 前缀，不区分大小写
+     * @param limit 最多返回的建议数
+     * @return 按热度从高到低排列的标题单词、标签和地址
+     */
+    QStringList suggest(const QString& prefix, int limit) const;
+
+    /**
+     * @brief 获取搜索建议索引估算占用的内存
+     * @return 字节数
+     */
+    qint64 suggestionMemoryUsage() const;
+
+    /**
+     * @brief 按条件搜索商品
+     *
+     * 由plan()根据各索引的基数估算每个条件的选择率，选出代价最小的候选取得方式，
+     * 其余条件按选择率和探测代价排序后逐个过滤。包括下级分类的分类条件按分类树的区间检查过滤，
+     * 或合并子树中各分类的槽位集合取得候选。
+     * 搜索条件中的游标无效或与排序方式不一致时返回空列表
+     * @param criteria 搜索条件
+     * @param nextCursor 不为空时输出下一页的游标，没有下一页时为空字符串
+     * @param facets 不为空时输出全部命中商品的分面统计，不受分页和游标影响
+     * @return 满足条件的商品ID，按搜索条件的排序方式排列并分页
+     */
+    QList<int> search(const SearchCriteria& criteria, QString* nextCursor = nullptr, SearchFacets* facets = nullptr) const;
+
+    /**
+     * @brief 说明按条件搜索时选用的查询计划
+     *
+     * 列出估计命中数、候选槽位的取得方式、依次执行的过滤条件及其选择率和估计代价，用于排查慢查询
+     * @param criteria 搜索条件
+     * @return 每行一项的查询计划说明
+     */
+    QString explain(const SearchCriteria& criteria) const;
+
+private:
+    /**
+     * @brief 从键到槽位集合的索引
+     */
+    template <typename Key>
+    using PostingMap = QHash<Key, QSet<quint32>>;
+
+    /**
+     * @brief 把槽位登记到键对应的集合中
+     * @param map 索引
+     * @param key 键
+     * @param slot 槽位号
+     */
+    template <typename Key>
+    static void addPosting(PostingMap<Key>& map, const Key& key, quint32 slot);
+
+    /**
+     * @brief 从键对应的集合中移除槽位，集合为空时删除该键
+     * @param map 索引
+     * @param key 键
+     * @param slot 槽位号
+     */
+    template <typename Key>
+    static void removePosting(PostingMap<Key>& map, const Key& key, quint32 slot);
+
+    static constexpr double kProbeCost = 1.0;       ///< 探测一次槽位集合或位图的代价，作为代价单位
+    static constexpr double kColumnProbeCost = 0.5; ///< 读取槽位中价格、卖家、分类、状态或地址一列的代价
+    static constexpr double kTermProbeCost = 8.0;   ///< 借助跳跃点在一个倒排表中查找的代价
+    static constexpr double kDecodeCost = 0.25;     ///< 解码倒排表中一项的代价
+    static constexpr double kVerifyCost = 50.0;     ///< 加载商品核对关键词原文的代价
+    static constexpr double kSortCost = 0.5;        ///< 排序时一次比较的代价
+
+    /**
+     * @brief 查询计划中的一个过滤条件
+     */
+    struct Probe {
+        /**
+         * @brief 过滤条件的种类
+         */
+        enum Kind {
+            SetProbe,      ///< 卖家、分类、状态或地址，比较槽位中的列，槽位集合用于取得候选
+            TagProbe,      ///< 标签的与、或、非条件求出的位图
+            RegionProbe,   ///< 地区及其下级地区的槽位位图
+            SubtreeProbe,  ///< 分类是否在分类子树中的区间检查
+            ExcludedProbe, ///< 只有排除标签时需要排除的位图
+            TermProbe,     ///< 在关键词各词项的倒排表中逐个查找
+            KeywordProbe,  ///< 在解码后或模糊、拼音匹配求出的关键词槽位数组中二分查找
+            PriceProbe,    ///< 读取槽位中的价格
+            VerifyProbe    ///< 加载商品核对关键词原文
+        };
+
+        Kind kind = SetProbe;               ///< 种类
+        const QSet<quint32>* set = nullptr; ///< SetProbe对应的槽位集合
+        ProductColumns::Column column = {}; ///< SetProbe比较的列
+        qint64 value = 0;                   ///< SetProbe比较的值，状态和地址为字典编码
+        const SlotBitmap* bitmap = nullptr; ///< RegionProbe探测的槽位位图
+        double selectivity = 1.0;           ///< 估计通过的比例
+        double cost = 0.0;                  ///< 探测一个槽位的代价
+        QString label;                      ///< explain()中显示的名称
+    };
+
+    /**
+     * @brief 候选槽位的取得方式
+     */
+    enum class Access {
+        OrderedScan, ///< 沿结果顺序对应的有序索引输出，可以从游标处开始并提前停止
+        PriceRange,  ///< 遍历价格索引中的区间
+        SetScan,     ///< 遍历最小的槽位集合
+        TagScan,     ///< 遍历标签位图
+        RegionScan,  ///< 遍历地区位图
+        SubtreeScan, ///< 遍历分类子树中各分类的槽位集合合并成的位图
+        KeywordScan  ///< 解码关键词各词项的倒排表求交后遍历
+    };
+
+    /**
+     * @brief 查询计划，保存选定的取得方式和按顺序执行的过滤条件
+     */
+    struct Plan {
+        bool empty = false;                       ///< 是否已确定结果为空
+        QString emptyReason;                      ///< 结果为空的原因
+        double estimatedRows = 0.0;               ///< 估计命中数
+        Access access = Access::OrderedScan;      ///< 候选槽位的取得方式
+        QString accessLabel;                      ///< explain()中显示的取得方式
+        double accessRows = 0.0;                  ///< 估计取得的候选槽位数
+        double cost = 0.0;                        ///< 估计总代价
+        const QSet<quint32>* driverSet = nullptr; ///< SetScan遍历的槽位集合
+        QVector<quint32> driverSlots;             ///< TagScan、RegionScan、SubtreeScan和KeywordScan遍历的槽位，升序
+        int subtreeRoot = 0;                      ///< SubtreeProbe检查的子树根分类ID
+        QVector<Probe> probes;                    ///< 候选槽位依次经过的过滤条件
+        SlotBitmap tags;                          ///< 标签条件求出的位图
+        SlotBitmap excluded;                      ///< 只有排除标签时需要排除的槽位
+        QList<const PostingList*> terms;          ///< 关键词各词项的倒排表，按长度升序
+        QVector<quint32> keywordSlots;            ///< 解码后的关键词槽位，升序
+        QVector<quint32> titleSlots;              ///< 标题模糊匹配或拼音匹配关键词的槽位，升序，不必核对原文
+    };
+
+    /**
+     * @brief 根据索引的基数统计选择代价最小的查询计划
+     *
+     * 候选可以来自有序索引、价格区间、最小的槽位集合、标签位图、地区位图或关键词倒排表
+     * @param criteria 搜索条件
+     * @param wanted 需要的命中数，-1表示不限
+     * @param exhaustive 是否必须遍历全部命中（统计分面时）
+     * @return 查询计划
+     */
+    Plan plan(const SearchCriteria& criteria, qint64 wanted, bool exhaustive) const;
+
+    /**
+     * @brief 槽位是否通过查询计划中的全部过滤条件
+     * @param slot 槽位号
+     * @param plan 查询计划
+     * @param criteria 搜索条件
+     * @return 通过返回true，否则返回false
+     */
+    bool matches(quint32 slot, const Plan& plan, const SearchCriteria& criteria) const;
+
+    /**
+     * @brief 分面直方图，状态、地址和标签按字典编码计数
+     */
+    struct FacetHistogram {
+        int total = 0;                       ///< 命中的商品总数
+        QHash<int, int> categoryCounts;      ///< 每个分类的命中数
+        QVector<int> statusCounts;           ///< 每个状态编码的命中数
+        QVector<int> locationCounts;         ///< 每个地址编码的命中数
+        QVector<int> tagCounts;              ///< 每个标签编码的命中数
+        ProductColumns::PriceSummary prices; ///< 命中商品的价格聚合
+    };
+
+    /**
+     * @brief 把一个命中的槽位计入分面直方图
+     * @param slot 槽位号
+     * @param histogram 分面直方图
+     */
+    void countFacets(quint32 slot, FacetHistogram& histogram) const;
+
+    /**
+     * @brief 把分面直方图转换为分面统计
+     * @param histogram 分面直方图
+     * @param facets 输出参数，分面统计
+     */
+    void exportFacets(const FacetHistogram& histogram, SearchFacets& facets) const;
+
+    /**
+     * @brief 由索引中维护的集合大小得到全部商品的分面统计
+     * @param facets 输出参数，分面统计
+     */
+    void indexFacets(SearchFacets& facets) const;
+
+    /**
+     * @brief 获取字符串的字典编码，不存在时分配新编码
+     * @param text 状态、地址或标签
+     * @return 字典编码
+     */
+    quint32 facetCode(const QString& text);
+
+    /**
+     * @brief 排序键，由排序值和商品ID组成
+     */
+    struct SortKey {
+        double value;  ///< 价格或发布时间键，按商品ID排序时为0
+        int productId; ///< 商品ID
+    };
+
+    /**
+     * @brief 获取槽位的排序键
+     * @param slot 槽位号
+     * @param sortOrder 排序方式
+     * @return 排序键
+     */
+    SortKey sortKey(quint32 slot, SearchCriteria::SortOrder sortOrder) const;
+
+    /**
+     * @brief 按排序方式比较两个排序键
+     * @param a 排序键
+     * @param b 排序键
+     * @param sortOrder 排序方式
+     * @return a排在b之前返回true，否则返回false
+     */
+    static bool precedes(const SortKey& a, const SortKey& b, SearchCriteria::SortOrder sortOrder);
+
+    /**
+     * @brief 按相关度为命中的槽位打分并选出排在最前的部分
+     *
+     * 用大小为wanted的堆做部分选择，只对选出的槽位排序
+     * @param matched 命中的槽位，输出时替换为选出的槽位，按相关度从高到低
+     * @param keys 输出参数，选出的槽位对应的排序键
+     * @param criteria 搜索条件
+     * @param wanted 需要的命中数，-1表示不限
+     * @param after 不为空时只保留排在该排序键之后的槽位
+     */
+    void rank(QVector<quint32>& matched, QVector<SortKey>& keys, const SearchCriteria& criteria, qint64 wanted,
+              const SortKey* after) const;
+
+    /**
+     * @brief 把排序键编码为游标
+     * @param sortOrder 排序方式
+     * @param key 上一页最后一个商品的排序键
+     * @return 游标
+     */
+    static QString encodeCursor(SearchCriteria::SortOrder sortOrder, const SortKey& key);
+
+    /**
+     * @brief 把游标解码为排序键
+     * @param cursor 游标
+     * @param sortOrder 当前搜索的排序方式
+     * @param key 输出参数，排序键
+     * @return 游标有效返回true，否则返回false
+     */
+    static bool decodeCursor(const QString& cursor, SearchCriteria::SortOrder sortOrder, SortKey& key);
+
+    /**
+     * @brief 获取商品参与全文索引的文本
+     * @param product 商品对象
+     * @return 标题和描述，以换行分隔
+     */
+    static QString indexedText(const Product& product);
+
+    ProductLoader loader;                 ///< 加载商品的回调
+    const CategoryTree* categories;       ///< 分类树，可以为空
+    int scanThreads;                      ///< 过滤候选槽位时使用的线程数
+    QMap<int, quint32> slotById;          ///< 商品ID到槽位号的映射
+    QVector<quint32> freeSlots;           ///< 可复用的空闲槽位
+    ProductColumns columns;               ///< 每个槽位的商品ID、价格、分类、卖家、状态、地址和发布时间，按列保存
+    QVector<QVector<quint32>> tagsBySlot; ///< 每个槽位的标签编码
+    QHash<QString, quint32> codeByText;   ///< 状态、地址和标签的字典
+    QVector<QString> textByCode;          ///< 字典编码到字符串的映射
+    PostingMap<int> sellerPostings;       ///< 卖家ID索引
+    PostingMap<int> categoryPostings;     ///< 分类ID索引
+    PostingMap<QString> statusPostings;   ///< 状态索引
+    PostingMap<QString> locationPostings; ///< 地址索引
+    LocationIndex locationIndex;          ///< 按行政区划的地区位图索引
+    TagIndex tagIndex;                    ///< 标签位图索引
+    PriceIndex priceIndex;                ///< 价格有序索引
+    RecencyIndex recencyIndex;            ///< 发布时间索引
+    TextIndex textIndex;                  ///< 标题和描述的全文索引
+    RelevanceIndex relevanceIndex;        ///< 标题、描述和标签的相关度评分索引
+    TrigramIndex trigramIndex;            ///< 标题单词的模糊匹配索引
+    PinyinIndex pinyinIndex;              ///< 标题的全拼和拼音首字母索引
+    SuggestionIndex suggestionIndex;      ///< 标题单词、标签和地址的搜索建议索引
+};
+
+#endif // PRODUCTSEARCHINDEX_H
\ No newline at end of file
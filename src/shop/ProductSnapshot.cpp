@@ -0,0 +1,596 @@
+#include "ProductSnapshot.h"
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QVector>
+#include <QDebug>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+namespace {
+
+const char kMagic[8] = {'P', 'R', 'O', 'D', 'S', 'N', 'A', 'P'}; ///< 快照文件标识
+const quint32 kByteOrderMark = 0x01020304;                        ///< 按本机字节序写入，用于检测字节序
+const qint64 kNullTime = std::numeric_limits<qint64>::min();       ///< 无效发布时间
+
+/**
+ * @brief 字符串堆中的一段字节
+ */
+struct StringRef {
+    quint32 offset; ///< 在字符串堆中的偏移
+    quint32 size;   ///< 字节数
+};
+
+/**
+ * @brief ID索引表项
+ */
+struct IndexEntry {
+    qint32 productId; ///< 商品ID
+    quint32 record;   ///< 记录序号
+};
+
+/**
+ * @brief 定长商品记录
+ */
+struct SnapshotRecord {
+    qint32 productId;      ///< 商品ID
+    qint32 categoryId;     ///< 分类ID
+    qint32 sellerId;       ///< 卖家ID
+    quint32 tagCount;      ///< 标签数
+    double price;          ///< 价格
+    qint64 publicTime;     ///< 发布时间（毫秒时间戳），kNullTime表示无效
+    StringRef title;       ///< 标题
+    StringRef description; ///< 描述
+    StringRef location;    ///< 地址
+    StringRef status;      ///< 状态
+    quint32 tags;          ///< 标签引用数组在字符串堆中的偏移
+    quint32 reserved;      ///< 保留，写为0
+};
+
+/**
+ * @brief 卖家表项，按（卖家ID，商品ID）升序排列
+ */
+struct SellerEntry {
+    qint32 sellerId;  ///< 卖家ID
+    qint32 productId; ///< 商品ID
+};
+
+/**
+ * @brief 第2版起紧挨在文件尾之前的扩展字段
+ */
+struct SnapshotExtension {
+    quint64 sellersOffset; ///< 卖家表偏移
+};
+
+/**
+ * @brief 文件尾，描述各段在文件中的位置
+ */
+struct SnapshotTrailer {
+    quint64 stringsOffset; ///< 字符串堆偏移
+    quint64 stringsSize;   ///< 字符串堆字节数
+    quint64 indexOffset;   ///< ID索引表偏移
+    quint64 recordsOffset; ///< 定长记录偏移
+    qint32 recordCount;    ///< 记录数
+    quint32 recordSize;    ///< 单条记录字节数
+    quint32 version;       ///< 格式版本
+    quint32 byteOrder;     ///< 字节序标记
+    char magic[8];         ///< 文件标识
+};
+
+static_assert(sizeof(StringRef) == 8, "unexpected StringRef layout");
+static_assert(sizeof(IndexEntry) == 8, "unexpected IndexEntry layout");
+static_assert(sizeof(SnapshotRecord) == 72, "unexpected SnapshotRecord layout");
+static_assert(sizeof(SellerEntry) == 8, "unexpected SellerEntry layout");
+static_assert(sizeof(SnapshotExtension) == 8, "unexpected SnapshotExtension layout");
+static_assert(sizeof(SnapshotTrailer) == 56, "unexpected SnapshotTrailer layout");
+
+/**
+ * @brief 从任意地址读取一个结构
+ * @param source 源地址
+ * @return 结构副本
+ */
+template <typename T>
+T load(const uchar* source) {
+    T value;
+    std::memcpy(&value, source, sizeof(T));
+    return value;
+}
+
+/**
+ * @brief 字符串堆写入器
+ *
+ * 顺序写出字符串堆，低基数的字段（地址、状态、标签）只写一份
+ */
+class HeapWriter {
+public:
+    explicit HeapWriter(QIODevice* device) : device(device), size(0), failed(false) {
+        buffer.reserve(kBufferSize + 1024);
+    }
+
+    /**
+     * @brief 追加一段字节
+     * @param bytes 字节
+     * @param length 字节数
+     * @return 字节在堆中的引用，堆超过4GB时标记失败
+     */
+    StringRef append(const char* bytes, int length) {
+        StringRef ref = {quint32(size), quint32(length)};
+        if (size + quint64(length) > std::numeric_limits<quint32>::max()) {
+            failed = true;
+            return StringRef{0, 0};
+        }
+        buffer.append(bytes, length);
+        size += quint64(length);
+        if (buffer.size() >= kBufferSize) {
+            flush();
+        }
+        return ref;
+    }
+
+    /**
+     * @brief 追加一个字符串
+     * @param value 字符串
+     * @return 字符串在堆中的引用
+     */
+    StringRef appendString(const QString& value) {
+        QByteArray utf8 = value.toUtf8();
+        return append(utf8.constData(), utf8.size());
+    }
+
+    /**
+     * @brief 追加一个可共享的字符串，相同内容只写一份
+     * @param value 字符串
+     * @return 字符串在堆中的引用
+     */
+    StringRef appendShared(const QString& value) {
+        auto it = shared.constFind(value);
+        if (it != shared.constEnd()) {
+            return it.value();
+        }
+        StringRef ref = appendString(value);
+        shared.insert(value, ref);
+        return ref;
+    }
+
+    /**
+     * @brief 补齐到8字节边界
+     */
+    void align() {
+        static const char zeros[8] = {};
+        int padding = int((8 - size % 8) % 8);
+        if (padding > 0) {
+            append(zeros, padding);
+        }
+    }
+
+    /**
+     * @brief 写出缓冲区
+     * @return 写入成功返回true，否则返回false
+     */
+    bool flush() {
+        if (!buffer.isEmpty() && device->write(buffer) != buffer.size()) {
+            failed = true;
+        }
+        buffer.resize(0);
+        return !failed;
+    }
+
+    quint64 bytesWritten() const { return size; }
+    bool hasFailed() const { return failed; }
+
+private:
+    static const int kBufferSize = 64 * 1024;
+
+    QIODevice* device;
+    QByteArray buffer;
+    QHash<QString, StringRef> shared;
+    quint64 size;
+    bool failed;
+};
+
+} // namespace
+
+/**
+ * @brief ProductSnapshot默认构造函数
+ */
+ProductSnapshot::ProductSnapshot()
+    : file(new QFile), data(nullptr), dataSize(0), strings(nullptr), stringsSize(0),
+      index(nullptr), records(nullptr), sellers(nullptr), recordCount(0) {
+}
+
+/**
+ * @brief ProductSnapshot析构函数
+ */
+ProductSnapshot::~ProductSnapshot() {
+    close();
+}
+
+/**
+ * @brief 以内存映射方式打开快照文件
+ * @param fileName 快照文件路径
+ * @return 打开成功返回true，否则返回false
+ */
+bool ProductSnapshot::open(const QString& fileName) {
+    close();
+
+    file->setFileName(fileName);
+    if (!file->open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    qint64 size = file->size();
+    if (size < qint64(sizeof(SnapshotTrailer))) {
+        qDebug() << "Snapshot too small:" << fileName;
+        close();
+        return false;
+    }
+
+    data = file->map(0, size);
+    if (!data) {
+        qDebug() << "Cannot map snapshot:" << fileName;
+        close();
+        return false;
+    }
+
+    SnapshotTrailer trailer = load<SnapshotTrailer>(data + size - sizeof(SnapshotTrailer));
+    quint64 body = quint64(size) - sizeof(SnapshotTrailer);
+    quint64 count = trailer.recordCount >= 0 ? quint64(trailer.recordCount) : 0;
+
+    // 第1版没有卖家表，仍可读取，由FileProductStore在加载后重写为当前版本
+    SnapshotExtension extension = {0};
+    bool hasExtension = trailer.version >= 2 && body >= sizeof(SnapshotExtension);
+    if (hasExtension) {
+        body -= sizeof(SnapshotExtension);
+        extension = load<SnapshotExtension>(data + body);
+    }
+
+    bool valid = std::memcmp(trailer.magic, kMagic, sizeof(kMagic)) == 0
+                 && trailer.byteOrder == kByteOrderMark
+                 && (trailer.version == 1 || (trailer.version == kVersion && hasExtension))
+                 && trailer.recordSize == sizeof(SnapshotRecord)
+                 && trailer.recordCount >= 0
+                 && trailer.stringsOffset <= body
+                 && trailer.stringsSize <= body - trailer.stringsOffset
+                 && trailer.indexOffset <= body
+                 && count * sizeof(IndexEntry) <= body - trailer.indexOffset
+                 && trailer.recordsOffset <= body
+                 && count * sizeof(SnapshotRecord) <= body - trailer.recordsOffset
+                 && (!hasExtension || (extension.sellersOffset <= body
+                                       && count * sizeof(SellerEntry) <= body - extension.sellersOffset));
+    if (!valid) {
+        qDebug() << "Invalid or incompatible snapshot:" << fileName;
+        close();
+        return false;
+    }
+
+    dataSize = size;
+    strings = data + trailer.stringsOffset;
+    stringsSize = trailer.stringsSize;
+    index = data + trailer.indexOffset;
+    records = data + trailer.recordsOffset;
+    sellers = hasExtension ? data + extension.sellersOffset : nullptr;
+    recordCount = trailer.recordCount;
+    return true;
+}
+
+/**
+ * @brief 关闭快照并解除内存映射
+ */
+void ProductSnapshot::close() {
+    if (data) {
+        file->unmap(const_cast<uchar*>(data));
+    }
+    file->close();
+    data = nullptr;
+    dataSize = 0;
+    strings = nullptr;
+    stringsSize = 0;
+    index = nullptr;
+    records = nullptr;
+    sellers = nullptr;
+    recordCount = 0;
+}
+
+/**
+ * @brief 与另一个快照交换映射的文件
+ *
+ * 映射属于打开它的QFile，文件对象随映射一起交换
+ * @param other 另一个快照
+ */
+void ProductSnapshot::swap(ProductSnapshot& other) {
+    std::swap(file, other.file);
+    std::swap(data, other.data);
+    std::swap(dataSize, other.dataSize);
+    std::swap(strings, other.strings);
+    std::swap(stringsSize, other.stringsSize);
+    std::swap(index, other.index);
+    std::swap(records, other.records);
+    std::swap(sellers, other.sellers);
+    std::swap(recordCount, other.recordCount);
+}
+
+/**
+ * @brief 快照是否已打开
+ * @return 已打开返回true，否则返回false
+ */
+bool ProductSnapshot::isOpen() const {
+    return data != nullptr;
+}
+
+/**
+ * @brief 获取快照中的商品数
+ * @return 商品数
+ */
+int ProductSnapshot::count() const {
+    return recordCount;
+}
+
+/**
+ * @brief 获取快照中的最大商品ID
+ * @return 最大商品ID
+ */
+int ProductSnapshot::maxProductId() const {
+    return recordCount > 0 ? productIdAt(recordCount - 1) : 0;
+}
+
+/**
+ * @brief 快照中是否包含指定商品
+ * @param productId 商品ID
+ * @return 包含返回true，否则返回false
+ */
+bool ProductSnapshot::contains(int productId) const {
+    return indexOf(productId) >= 0;
+}
+
+/**
+ * @brief 根据ID查找并解码商品
+ * @param productId 商品ID
+ * @return 商品对象
+ */
+Product ProductSnapshot::find(int productId) const {
+    int position = indexOf(productId);
+    if (position < 0) {
+        return Product();
+    }
+    return productAt(position);
+}
+
+/**
+ * @brief 获取第index条记录的商品ID
+ * @param index 记录序号
+ * @return 商品ID
+ */
+int ProductSnapshot::productIdAt(int index) const {
+    return load<IndexEntry>(this->index + quint64(index) * sizeof(IndexEntry)).productId;
+}
+
+/**
+ * @brief 获取第index条记录的卖家ID，不解码整条记录
+ * @param index 记录序号
+ * @return 卖家ID
+ */
+int ProductSnapshot::sellerIdAt(int index) const {
+    IndexEntry entry = load<IndexEntry>(this->index + quint64(index) * sizeof(IndexEntry));
+    if (entry.record >= quint32(recordCount)) {
+        return 0;
+    }
+    return load<qint32>(records + quint64(entry.record) * sizeof(SnapshotRecord) + offsetof(SnapshotRecord, sellerId));
+}
+
+/**
+ * @brief 快照中是否有按卖家排序的卖家表
+ * @return 有返回true，第1版快照返回false
+ */
+bool ProductSnapshot::hasSellerTable() const {
+    return sellers != nullptr;
+}
+
+/**
+ * @brief 获取卖家在快照中的商品ID
+ *
+ * 在卖家表中二分查找该卖家的区间，耗时与该卖家的商品数成正比；
+ * 第1版快照没有卖家表，退化为逐条读取记录中的卖家ID
+ * @param sellerId 卖家ID
+ * @return 按升序排列的商品ID
+ */
+QList<int> ProductSnapshot::productIdsBySeller(int sellerId) const {
+    QList<int> productIds;
+    if (!sellers) {
+        for (int i = 0; i < recordCount; ++i) {
+            if (sellerIdAt(i) == sellerId) {
+                productIds.append(productIdAt(i));
+            }
+        }
+        return productIds;
+    }
+
+    // 找到第一个卖家ID不小于sellerId的表项
+    int low = 0;
+    int high = recordCount;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        if (load<SellerEntry>(sellers + quint64(middle) * sizeof(SellerEntry)).sellerId < sellerId) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    for (int i = low; i < recordCount; ++i) {
+        SellerEntry entry = load<SellerEntry>(sellers + quint64(i) * sizeof(SellerEntry));
+        if (entry.sellerId != sellerId) {
+            break;
+        }
+        productIds.append(entry.productId);
+    }
+    return productIds;
+}
+
+/**
+ * @brief 解码第index条记录
+ * @param index 记录序号
+ * @return 商品对象
+ */
+Product ProductSnapshot::productAt(int index) const {
+    IndexEntry entry = load<IndexEntry>(this->index + quint64(index) * sizeof(IndexEntry));
+    if (entry.record >= quint32(recordCount)) {
+        return Product();
+    }
+
+    SnapshotRecord record = load<SnapshotRecord>(records + quint64(entry.record) * sizeof(SnapshotRecord));
+    QList<QString> tags;
+    if (quint64(record.tags) + quint64(record.tagCount) * sizeof(StringRef) <= stringsSize) {
+        tags.reserve(int(record.tagCount));
+        for (quint32 i = 0; i < record.tagCount; ++i) {
+            StringRef tag = load<StringRef>(strings + record.tags + quint64(i) * sizeof(StringRef));
+            tags.append(stringAt(tag.offset, tag.size));
+        }
+    }
+
+    QDateTime publicTime;
+    if (record.publicTime != kNullTime) {
+        publicTime = QDateTime::fromMSecsSinceEpoch(record.publicTime);
+    }
+
+    return Product(record.productId,
+                   stringAt(record.title.offset, record.title.size),
+                   record.categoryId,
+                   stringAt(record.description.offset, record.description.size),
+                   record.price,
+                   record.sellerId,
+                   stringAt(record.location.offset, record.location.size),
+                   tags,
+                   publicTime,
+                   stringAt(record.status.offset, record.status.size));
+}
+
+/**
+ * @brief 将商品写成二进制快照
+ *
+ * 字符串堆边生成边写出，内存中只保留每个商品72字节的定长记录和8字节的索引项
+ * @param device 已以只写方式打开的输出设备
+ * @param productIds 按升序排列且不重复的商品ID
+ * @param productById 根据ID取得商品的回调
+ * @return 写入成功返回true，否则返回false
+ */
+bool ProductSnapshot::write(QIODevice* device, const QList<int>& productIds,
+                            const std::function<Product(int)>& productById) {
+    HeapWriter heap(device);
+    QByteArray indexData;
+    QByteArray recordData;
+    QVector<SellerEntry> sellerEntries;
+    indexData.reserve(productIds.size() * int(sizeof(IndexEntry)));
+    recordData.reserve(productIds.size() * int(sizeof(SnapshotRecord)));
+    sellerEntries.reserve(productIds.size());
+
+    for (int i = 0; i < productIds.size(); ++i) {
+        Product product = productById(productIds.at(i));
+
+        // 标签内容先写入堆，随后是按8字节对齐的标签引用数组
+        QList<QString> tags = product.getTags();
+        QList<StringRef> tagRefs;
+        tagRefs.reserve(tags.size());
+        for (const QString& tag : tags) {
+            tagRefs.append(heap.appendShared(tag));
+        }
+        heap.align();
+
+        SnapshotRecord record;
+        std::memset(&record, 0, sizeof(record));
+        record.productId = product.getProductId();
+        record.categoryId = product.getCategoryId();
+        record.sellerId = product.getSellerId();
+        record.tagCount = quint32(tagRefs.size());
+        record.price = product.getPrice();
+        record.publicTime = product.getPublicTime().isValid()
+                            ? product.getPublicTime().toMSecsSinceEpoch() : kNullTime;
+        record.tags = quint32(heap.bytesWritten());
+        for (const StringRef& ref : tagRefs) {
+            heap.append(reinterpret_cast<const char*>(&ref), int(sizeof(ref)));
+        }
+        record.title = heap.appendString(product.getTitle());
+        record.description = heap.appendString(product.getDescription());
+        record.location = heap.appendShared(product.getLocation());
+        record.status = heap.appendShared(product.getStatus());
+
+        IndexEntry entry = {record.productId, quint32(i)};
+        indexData.append(reinterpret_cast<const char*>(&entry), int(sizeof(entry)));
+        recordData.append(reinterpret_cast<const char*>(&record), int(sizeof(record)));
+        sellerEntries.append(SellerEntry{record.sellerId, record.productId});
+
+        if (heap.hasFailed()) {
+            qDebug() << "Snapshot string heap overflow or write error";
+            return false;
+        }
+    }
+
+    heap.align();
+    if (!heap.flush()) {
+        return false;
+    }
+
+    // 卖家表按（卖家ID，商品ID）排序，打开快照后无需再建立卖家索引
+    std::sort(sellerEntries.begin(), sellerEntries.end(), [](const SellerEntry& a, const SellerEntry& b) {
+        return a.sellerId != b.sellerId ? a.sellerId < b.sellerId : a.productId < b.productId;
+    });
+
+    SnapshotTrailer trailer;
+    std::memset(&trailer, 0, sizeof(trailer));
+    trailer.stringsOffset = 0;
+    trailer.stringsSize = heap.bytesWritten();
+    trailer.indexOffset = trailer.stringsSize;
+    trailer.recordsOffset = trailer.indexOffset + quint64(indexData.size());
+    trailer.recordCount = productIds.size();
+    trailer.recordSize = sizeof(SnapshotRecord);
+    trailer.version = kVersion;
+    trailer.byteOrder = kByteOrderMark;
+    std::memcpy(trailer.magic, kMagic, sizeof(kMagic));
+
+    SnapshotExtension extension;
+    extension.sellersOffset = trailer.recordsOffset + quint64(recordData.size());
+
+    const qint64 sellersSize = qint64(sellerEntries.size()) * qint64(sizeof(SellerEntry));
+    return device->write(indexData) == indexData.size()
+           && device->write(recordData) == recordData.size()
+           && device->write(reinterpret_cast<const char*>(sellerEntries.constData()), sellersSize) == sellersSize
+           && device->write(reinterpret_cast<const char*>(&extension), sizeof(extension)) == qint64(sizeof(extension))
+           && device->write(reinterpret_cast<const char*>(&trailer), sizeof(trailer)) == qint64(sizeof(trailer));
+}
+
+/**
+ * @brief 二分查找商品ID对应的记录序号
+ * @param productId 商品ID
+ * @return 记录序号，未找到时返回-1
+ */
+int ProductSnapshot::indexOf(int productId) const {
+    int low = 0;
+    int high = recordCount - 1;
+    while (low <= high) {
+        int middle = low + (high - low) / 2;
+        int middleId = productIdAt(middle);
+        if (middleId == productId) {
+            return middle;
+        }
+        if (middleId < productId) {
+            low = middle + 1;
+        } else {
+            high = middle - 1;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 从字符串堆中取出字符串
+ * @param offset 字符串在堆中的偏移
+ * @param size 字符串的字节数
+ * @return 字符串，引用越界时返回空字符串
+ */
+QString ProductSnapshot::stringAt(quint32 offset, quint32 size) const {
+    if (quint64(offset) + size > stringsSize) {
+        return QString();
+    }
+    return QString::fromUtf8(reinterpret_cast<const char*>(strings + offset), int(size));
+}
\ No newline at end of file
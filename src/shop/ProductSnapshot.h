@@ -0,0 +1,164 @@
+#ifndef PRODUCTSNAPSHOT_H
+#define PRODUCTSNAPSHOT_H
+
+#include "Product.h"
+#include <QFile>
+#include <QIODevice>
+#include <QList>
+#include <QString>
+#include <functional>
+#include <memory>
+
+/**
+ * @brief 商品二进制快照类
+ *
+ * ProductSnapshot类读写带版本号的商品二进制快照文件，文件布局为：
+ * 字符串堆 | ID索引表 | 定长记录 | 卖家表 | 扩展字段 | 文件尾。
+ * 记录按商品ID升序排列，字符串和标签列表以（偏移，长度）引用字符串堆；
+ * 描述各段位置的文件尾最后写入，写了一半的快照因文件尾无效而不会被打开。
+ * 打开快照只做内存映射和文件尾校验，耗时与商品数量无关；
+ * 商品在find()时才从映射的记录中解码
+ */
+class ProductSnapshot {
+public:
+    static constexpr quint32 kVersion = 2; ///< 当前快照格式版本，第2版增加卖家表
+
+    /**
+     * @brief 默认构造函数
+     */
+    ProductSnapshot();
+
+    /**
+     * @brief 析构函数，解除内存映射
+     */
+    ~ProductSnapshot();
+
+    ProductSnapshot(const ProductSnapshot&) = delete;
+    ProductSnapshot& operator=(const ProductSnapshot&) = delete;
+
+    /**
+     * @brief 以内存映射方式打开快照文件
+     *
+     * 文件不存在、版本或字节序不匹配、各段越界时返回false，此时快照为空
+     * @param fileName 快照文件路径
+     * @return 打开成功返回true，否则返回false
+     */
+    bool open(const QString& fileName);
+
+    /**
+     * @brief 关闭快照并解除内存映射
+     */
+    void close();
+
+    /**
+     * @brief 与另一个快照交换映射的文件
+     *
+     * 用于先打开新快照、确认可用后再替换旧快照
+     * @param other 另一个快照
+     */
+    void swap(ProductSnapshot& other);
+
+    /**
+     * @brief 快照是否已打开
+     * @return 已打开返回true，否则返回false
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief 获取快照中的商品数
+     * @return 商品数
+     */
+    int count() const;
+
+    /**
+     * @brief 获取快照中的最大商品ID
+     * @return 最大商品ID，快照为空时返回0
+     */
+    int maxProductId() const;
+
+    /**
+     * @brief 快照中是否包含指定商品
+     * @param productId 商品ID
+     * @return 包含返回true，否则返回false
+     */
+    bool contains(int productId) const;
+
+    /**
+     * @brief 根据ID查找并解码商品
+     * @param productId 商品ID
+     * @return 商品对象，未找到时返回默认构造的Product对象
+     */
+    Product find(int productId) const;
+
+    /**
+     * @brief 获取第index条记录的商品ID（按ID升序）
+     * @param index 记录序号
+     * @return 商品ID
+     */
+    int productIdAt(int index) const;
+
+    /**
+     * @brief 获取第index条记录的卖家ID，不解码整条记录
+     * @param index 记录序号
+     * @return 卖家ID
+     */
+    int sellerIdAt(int index) const;
+
+    /**
+     * @brief 快照中是否有按卖家排序的卖家表
+     * @return 有返回true，第1版快照返回false
+     */
+    bool hasSellerTable() const;
+
+    /**
+     * @brief 获取卖家在快照中的商品ID，不解码记录
+     * @param sellerId 卖家ID
+     * @return 按升序排列的商品ID
+     */
+    QList<int> productIdsBySeller(int sellerId) const;
+
+    /**
+     * @brief 二分查找商品ID对应的记录序号
+     * @param productId 商品ID
+     * @return 记录序号，未找到时返回-1
+     */
+    int indexOf(int productId) const;
+
+    /**
+     * @brief 解码第index条记录
+     * @param index 记录序号
+     * @return 商品对象
+     */
+    Product productAt(int index) const;
+
+    /**
+     * @brief 将商品写成二进制快照
+     * @param device 已以只写方式打开的输出设备，只顺序写入
+     * @param productIds 按升序排列且不重复的商品ID
+     * @param productById 根据ID取得商品的回调
+     * @return 写入成功返回true，否则返回false
+     */
+    static bool write(QIODevice* device, const QList<int>& productIds,
+                      const std::function<Product(int)>& productById);
+
+private:
+    /**
+     * @brief 从字符串堆中取出字符串
+     * @param offset 字符串在堆中的偏移
+     * @param size 字符串的字节数
+     * @return 字符串
+     */
+    QString stringAt(quint32 offset, quint32 size) const;
+
+    std::unique_ptr<QFile> file; ///< 快照文件，交换快照时随映射一起交换
+    const uchar* data;           ///< 映射的文件内容
+    qint64 dataSize;             ///< 映射的字节数
+    const uchar* strings;        ///< 字符串堆起始位置
+    quint64 stringsSize;         ///< 字符串堆字节数
+    const uchar* index;          ///< ID索引表起始位置
+    const uchar* records;        ///< 定长记录起始位置
+    const uchar* sellers;        ///< 卖家表起始位置，第1版快照为nullptr
+    int recordCount;             ///< 记录数
+};
+
+#endif // PRODUCTSNAPSHOT_H
\ No newline at end of file
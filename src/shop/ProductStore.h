@@ -0,0 +1,126 @@
+#ifndef PRODUCTSTORE_H
+#define PRODUCTSTORE_H
+
+#include "Product.h"
+#include <QHash>
+#include <QJsonArray>
+#include <QList>
+#include <functional>
+
+/**
+ * @brief 商品存储后端接口
+ *
+ * ProductStore定义ProductRepository委托的持久化操作。后端按行读写商品：
+ * save()/remove()记录一次单行变更，commit()把自上次提交以来的变更一次性落盘，
+ * 由ProductRepository的组提交器调用；checkpoint()把存储整理为紧凑的全量形式。
+ * 分类树（见CategoryTree）与商品保存在同一个存储中，每次修改后整体写出。
+ * 目前有基于快照文件和变更日志的FileProductStore，以及基于SQLite的SqliteProductStore
+ */
+class ProductStore {
+public:
+    /**
+     * @brief 虚析构函数
+     */
+    virtual ~ProductStore() = default;
+
+    /**
+     * @brief 打开存储并加载已持久化的数据
+     * @return 存在已持久化的数据并加载成功返回true，否则返回false
+     */
+    virtual bool load() = 0;
+
+    /**
+     * @brief 存储中是否存在指定商品
+     * @param productId 商品ID
+     * @return 存在返回true，否则返回false
+     */
+    virtual bool contains(int productId) const = 0;
+
+    /**
+     * @brief 根据ID查找商品
+     * @param productId 商品ID
+     * @return 商品对象，未找到时返回默认构造的Product对象
+     */
+    virtual Product find(int productId) const = 0;
+
+    /**
+     * @brief find()能否在多个线程中同时调用
+     * @return 能返回true，否则返回false
+     */
+    virtual bool supportsConcurrentFind() const = 0;
+
+    /**
+     * @brief 依次访问存储中的每个商品
+     * @param visit 访问回调
+     */
+    virtual void forEach(const std::function<void(const Product&)>& visit) const = 0;
+
+    /**
+     * @brief 根据卖家ID查找商品列表
+     * @param sellerId 卖家ID
+     * @return 商品列表
+     */
+    virtual QList<Product> findBySellerId(int sellerId) const = 0;
+
+    /**
+     * @brief 获取存储中的商品数
+     * @return 商品数
+     */
+    virtual int count() const = 0;
+
+    /**
+     * @brief 获取存储中出现过的最大商品ID
+     * @return 最大商品ID，存储为空时返回0
+     */
+    virtual int maxProductId() const = 0;
+
+    /**
+     * @brief 保存一个商品（新增或覆盖），在下一次commit()时落盘
+     * @param product 已分配ID的商品对象
+     * @return 保存成功返回true，否则返回false
+     */
+    virtual bool save(const Product& product) = 0;
+
+    /**
+     * @brief 删除一个商品，在下一次commit()时落盘
+     * @param productId 商品ID
+     * @return 删除成功返回true，否则返回false
+     */
+    virtual bool remove(int productId) = 0;
+
+    /**
+     * @brief 批量导入商品并立即落盘，已存在的商品被覆盖
+     * @param loaded 导入的商品，导入后内容未定义
+     * @return 导入并落盘成功返回true，否则返回false
+     */
+    virtual bool import(QHash<int, Product>& loaded) = 0;
+
+    /**
+     * @brief 把自上次提交以来的变更落盘
+     * @return 落盘成功返回true，否则返回false
+     */
+    virtual bool commit() = 0;
+
+    /**
+     * @brief 把全部数据写成紧凑的全量形式
+     * @return 写出成功返回true，否则返回false
+     */
+    virtual bool checkpoint() = 0;
+
+    /**
+     * @brief 加载已持久化的分类树
+     *
+     * 在load()之后调用
+     * @return CategoryTree::toJson()格式的JSON数组，没有分类树时为空
+     */
+    virtual QJsonArray loadCategories() const = 0;
+
+    /**
+     * @brief 立即写出分类树，替换已持久化的分类树
+     * @param categories CategoryTree::toJson()格式的JSON数组
+     * @return 写出成功返回true，否则返回false
+     */
+    virtual bool saveCategories(const QJsonArray& categories) = 0;
+};
+
+#endif // PRODUCTSTORE_H
\ No newline at end of file
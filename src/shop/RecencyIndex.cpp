@@ -0,0 +1,165 @@
+#include "RecencyIndex.h"
+#include <algorithm>
+#include <limits>
+
+/**
+ * @brief 按（发布时间，商品ID）比较
+ * @param other 另一个索引项
+ * @return 排在other之前返回true，否则返回false
+ */
+bool RecencyIndex::Entry::operator<(const Entry& other) const {
+    if (time != other.time) {
+        return time < other.time;
+    }
+    return productId < other.productId;
+}
+
+/**
+ * @brief 把发布时间转为索引使用的键
+ * @param publicTime 发布时间
+ * @return 毫秒时间戳，无效时间排在最早
+ */
+qint64 RecencyIndex::timeKey(const QDateTime& publicTime) {
+    return publicTime.isValid() ? publicTime.toMSecsSinceEpoch() : std::numeric_limits<qint64>::min();
+}
+
+/**
+ * @brief 登记商品
+ * @param slot 槽位号
+ * @param productId 商品ID
+ * @param categoryId 分类ID
+ * @param time 发布时间键
+ */
+void RecencyIndex::insert(quint32 slot, int productId, int categoryId, qint64 time) {
+    const Entry entry = {time, productId, slot};
+    add(all, entry);
+    add(byCategory[categoryId], entry);
+}
+
+/**
+ * @brief 移除商品，分类列表为空时删除该分类
+ * @param slot 槽位号
+ * @param productId 商品ID
+ * @param categoryId 登记时的分类ID
+ * @param time 登记时的发布时间键
+ */
+void RecencyIndex::remove(quint32 slot, int productId, int categoryId, qint64 time) {
+    const Entry entry = {time, productId, slot};
+    erase(all, entry);
+    auto it = byCategory.find(categoryId);
+    if (it != byCategory.end() && erase(it.value(), entry) && it.value().isEmpty()) {
+        byCategory.erase(it);
+    }
+}
+
+/**
+ * @brief 获取索引中的商品数
+ * @return 商品数
+ */
+int RecencyIndex::size() const {
+    return all.size();
+}
+
+/**
+ * @brief 获取分类中的商品数
+ * @param categoryId 分类ID
+ * @return 商品数
+ */
+int RecencyIndex::size(int categoryId) const {
+    auto it = byCategory.constFind(categoryId);
+    return it == byCategory.constEnd() ? 0 : it.value().size();
+}
+
+/**
+ * @brief 从最新的商品开始遍历
+ * @param visitor 接收槽位的回调，返回false时停止
+ */
+void RecencyIndex::scanNewest(const Visitor& visitor) const {
+    scan(all, nullptr, visitor);
+}
+
+/**
+ * @brief 从分类中最新的商品开始遍历
+ * @param categoryId 分类ID
+ * @param visitor 接收槽位的回调，返回false时停止
+ */
+void RecencyIndex::scanNewest(int categoryId, const Visitor& visitor) const {
+    auto it = byCategory.constFind(categoryId);
+    if (it != byCategory.constEnd()) {
+        scan(it.value(), nullptr, visitor);
+    }
+}
+
+/**
+ * @brief 从比指定商品更早的商品开始遍历
+ * @param time 上一页最后一个商品的发布时间键
+ * @param productId 上一页最后一个商品的ID
+ * @param visitor 接收槽位的回调，返回false时停止
+ */
+void RecencyIndex::scanOlderThan(qint64 time, int productId, const Visitor& visitor) const {
+    const Entry end = {time, productId, 0};
+    scan(all, &end, visitor);
+}
+
+/**
+ * @brief 从分类中比指定商品更早的商品开始遍历
+ * @param categoryId 分类ID
+ * @param time 上一页最后一个商品的发布时间键
+ * @param productId 上一页最后一个商品的ID
+ * @param visitor 接收槽位的回调，返回false时停止
+ */
+void RecencyIndex::scanOlderThan(int categoryId, qint64 time, int productId, const Visitor& visitor) const {
+    auto it = byCategory.constFind(categoryId);
+    if (it != byCategory.constEnd()) {
+        const Entry end = {time, productId, 0};
+        scan(it.value(), &end, visitor);
+    }
+}
+
+/**
+ * @brief 把索引项加入列表
+ *
+ * 比末尾更新的项直接追加，迟到的项用二分查找定位后插入
+ * @param timeline 列表
+ * @param entry 索引项
+ */
+void RecencyIndex::add(Timeline& timeline, const Entry& entry) {
+    if (timeline.isEmpty() || timeline.last() < entry) {
+        timeline.append(entry);
+        return;
+    }
+    timeline.insert(std::upper_bound(timeline.begin(), timeline.end(), entry), entry);
+}
+
+/**
+ * @brief 从列表中删除索引项
+ * @param timeline 列表
+ * @param entry 索引项
+ * @return 删除返回true，不存在返回false
+ */
+bool RecencyIndex::erase(Timeline& timeline, const Entry& entry) {
+    auto it = std::lower_bound(timeline.begin(), timeline.end(), entry);
+    if (it == timeline.end() || it->productId != entry.productId || it->time != entry.time) {
+        return false;
+    }
+    timeline.erase(it);
+    return true;
+}
+
+/**
+ * @brief 从列表末尾或指定项之前向前遍历
+ *
+ * 起点由二分查找定位，深翻页与第一页的耗时相同
+ * @param timeline 列表
+ * @param end 只遍历排在该项之前的项，为空时从末尾开始
+ * @param visitor 接收槽位的回调，返回false时停止
+ */
+void RecencyIndex::scan(const Timeline& timeline, const Entry* end, const Visitor& visitor) {
+    const int first = end ? int(std::lower_bound(timeline.cbegin(), timeline.cend(), *end) - timeline.cbegin())
+                          : timeline.size();
+    for (int i = first - 1; i >= 0; --i) {
+        if (!visitor(timeline.at(i).slot)) {
+            return;
+        }
+    }
+}
\ No newline at end of file
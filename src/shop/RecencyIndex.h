@@ -0,0 +1,140 @@
+#ifndef RECENCYINDEX_H
+#define RECENCYINDEX_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QVector>
+#include <functional>
+
+/**
+ * @brief 发布时间索引类
+ *
+ * RecencyIndex按（发布时间，商品ID）的顺序保存商品槽位，另外为每个分类维护一份同样的列表。
+ * 新发布的商品几乎总是最新的，直接追加到列表末尾；发布时间较早的迟到商品用二分查找插入。
+ * 最新商品从列表末尾向前读取，取一页的耗时与页大小成正比，不需要对全部商品排序
+ */
+class RecencyIndex {
+public:
+    /**
+     * @brief 逐个接收槽位的回调，返回false时停止遍历
+     */
+    using Visitor = std::function<bool(quint32)>;
+
+    /**
+     * @brief 把发布时间转为索引使用的键
+     * @param publicTime 发布时间
+     * @return 毫秒时间戳，无效时间排在最早
+     */
+    static qint64 timeKey(const QDateTime& publicTime);
+
+    /**
+     * @brief 登记商品
+     * @param slot 槽位号
+     * @param productId 商品ID，发布时间相同时按商品ID排序
+     * @param categoryId 分类ID
+     * @param time 由timeKey()得到的发布时间键
+     */
+    void insert(quint32 slot, int productId, int categoryId, qint64 time);
+
+    /**
+     * @brief 移除商品
+     * @param slot 槽位号
+     * @param productId 商品ID
+     * @param categoryId 登记时的分类ID
+     * @param time 登记时的发布时间键
+     */
+    void remove(quint32 slot, int productId, int categoryId, qint64 time);
+
+    /**
+     * @brief 获取索引中的商品数
+     * @return 商品数
+     */
+    int size() const;
+
+    /**
+     * @brief 获取分类中的商品数
+     * @param categoryId 分类ID
+     * @return 商品数
+     */
+    int size(int categoryId) const;
+
+    /**
+     * @brief 从最新的商品开始遍历
+     * @param visitor 接收槽位的回调，返回false时停止
+     */
+    void scanNewest(const Visitor& visitor) const;
+
+    /**
+     * @brief 从分类中最新的商品开始遍历
+     * @param categoryId 分类ID
+     * @param visitor 接收槽位的回调，返回false时停止
+     */
+    void scanNewest(int categoryId, const Visitor& visitor) const;
+
+    /**
+     * @brief 从比指定商品更早的商品开始遍历，用于游标分页
+     * @param time 上一页最后一个商品的发布时间键
+     * @param productId 上一页最后一个商品的ID
+     * @param visitor 接收槽位的回调，返回false时停止
+     */
+    void scanOlderThan(qint64 time, int productId, const Visitor& visitor) const;
+
+    /**
+     * @brief 从分类中比指定商品更早的商品开始遍历
+     * @param categoryId 分类ID
+     * @param time 上一页最后一个商品的发布时间键
+     * @param productId 上一页最后一个商品的ID
+     * @param visitor 接收槽位的回调，返回false时停止
+     */
+    void scanOlderThan(int categoryId, qint64 time, int productId, const Visitor& visitor) const;
+
+private:
+    /**
+     * @brief 索引项
+     */
+    struct Entry {
+        qint64 time;   ///< 发布时间键
+        int productId; ///< 商品ID
+        quint32 slot;  ///< 槽位号
+
+        /**
+         * @brief 按（发布时间，商品ID）比较
+         * @param other 另一个索引项
+         * @return 排在other之前返回true，否则返回false
+         */
+        bool operator<(const Entry& other) const;
+    };
+
+    /**
+     * @brief 按时间排序的索引项列表
+     */
+    using Timeline = QVector<Entry>;
+
+    /**
+     * @brief 把索引项加入列表，比末尾更新时直接追加
+     * @param timeline 列表
+     * @param entry 索引项
+     */
+    static void add(Timeline& timeline, const Entry& entry);
+
+    /**
+     * @brief 从列表中删除索引项
+     * @param timeline 列表
+     * @param entry 索引项
+     * @return 删除返回true，不存在返回false
+     */
+    static bool erase(Timeline& timeline, const Entry& entry);
+
+    /**
+     * @brief 从列表末尾向前遍历
+     * @param timeline 列表
+     * @param end 只遍历排在该项之前的项，为空时从末尾开始
+     * @param visitor 接收槽位的回调，返回false时停止
+     */
+    static void scan(const Timeline& timeline, const Entry* end, const Visitor& visitor);
+
+    Timeline all;                    ///< 全部商品
+    QHash<int, Timeline> byCategory; ///< 每个分类的商品
+};
+
+#endif // RECENCYINDEX_H
\ No newline at end of file
@@ -0,0 +1,638 @@
+#include "RegionTable.h"
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+namespace {
+
+/**
+ * @brief 一个地区
+ */
+struct RegionEntry {
+    int depth;          ///< 层级，0为省级
+    const char* name;   ///< 简称
+    const char* suffix; ///< 简称之后的部分，与简称合起来是全称
+};
+
+// 先序排列，下级紧跟在上级之后
+const RegionEntry kRegions[] = {
+    {0, "北京", "市"},
+    {1, "东城", "区"},
+    {1, "西城", "区"},
+    {1, "朝阳", "区"},
+    {1, "丰台", "区"},
+    {1, "石景山", "区"},
+    {1, "海淀", "区"},
+    {1, "门头沟", "区"},
+    {1, "房山", "区"},
+    {1, "通州", "区"},
+    {1, "顺义", "区"},
+    {1, "昌平", "区"},
+    {1, "大兴", "区"},
+    {1, "怀柔", "区"},
+    {1, "平谷", "区"},
+    {1, "密云", "区"},
+    {1, "延庆", "区"},
+    {0, "天津", "市"},
+    {1, "和平", "区"},
+    {1, "河东", "区"},
+    {1, "河西", "区"},
+    {1, "南开", "区"},
+    {1, "河北", "区"},
+    {1, "红桥", "区"},
+    {1, "东丽", "区"},
+    {1, "西青", "区"},
+    {1, "津南", "区"},
+    {1, "北辰", "区"},
+    {1, "武清", "区"},
+    {1, "宝坻", "区"},
+    {1, "滨海", "新区"},
+    {1, "宁河", "区"},
+    {1, "静海", "区"},
+    {1, "蓟州", "区"},
+    {0, "河北", "省"},
+    {1, "石家庄", "市"},
+    {1, "唐山", "市"},
+    {1, "秦皇岛", "市"},
+    {1, "邯郸", "市"},
+    {1, "邢台", "市"},
+    {1, "保定", "市"},
+    {1, "张家口", "市"},
+    {1, "承德", "市"},
+    {1, "沧州", "市"},
+    {1, "廊坊", "市"},
+    {1, "衡水", "市"},
+    {0, "山西", "省"},
+    {1, "太原", "市"},
+    {1, "大同", "市"},
+    {1, "阳泉", "市"},
+    {1, "长治", "市"},
+    {1, "晋城", "市"},
+    {1, "朔州", "市"},
+    {1, "晋中", "市"},
+    {1, "运城", "市"},
+    {1, "忻州", "市"},
+    {1, "临汾", "市"},
+    {1, "吕梁", "市"},
+    {0, "内蒙古", "自治区"},
+    {1, "呼和浩特", "市"},
+    {1, "包头", "市"},
+    {1, "乌海", "市"},
+    {1, "赤峰", "市"},
+    {1, "通辽", "市"},
+    {1, "鄂尔多斯", "市"},
+    {1, "呼伦贝尔", "市"},
+    {1, "巴彦淖尔", "市"},
+    {1, "乌兰察布", "市"},
+    {1, "兴安", "盟"},
+    {1, "锡林郭勒", "盟"},
+    {1, "阿拉善", "盟"},
+    {0, "辽宁", "省"},
+    {1, "沈阳", "市"},
+    {1, "大连", "市"},
+    {1, "鞍山", "市"},
+    {1, "抚顺", "市"},
+    {1, "本溪", "市"},
+    {1, "丹东", "市"},
+    {1, "锦州", "市"},
+    {1, "营口", "市"},
+    {1, "阜新", "市"},
+    {1, "辽阳", "市"},
+    {1, "盘锦", "市"},
+    {1, "铁岭", "市"},
+    {1, "朝阳", "市"},
+    {1, "葫芦岛", "市"},
+    {0, "吉林", "省"},
+    {1, "长春", "市"},
+    {1, "吉林", "市"},
+    {1, "四平", "市"},
+    {1, "辽源", "市"},
+    {1, "通化", "市"},
+    {1, "白山", "市"},
+    {1, "松原", "市"},
+    {1, "白城", "市"},
+    {1, "延边", "朝鲜族自治州"},
+    {0, "黑龙江", "省"},
+    {1, "哈尔滨", "市"},
+    {1, "齐齐哈尔", "市"},
+    {1, "鸡西", "市"},
+    {1, "鹤岗", "市"},
+    {1, "双鸭山", "市"},
+    {1, "大庆", "市"},
+    {1, "伊春", "市"},
+    {1, "佳木斯", "市"},
+    {1, "七台河", "市"},
+    {1, "牡丹江", "市"},
+    {1, "黑河", "市"},
+    {1, "绥化", "市"},
+    {1, "大兴安岭", "地区"},
+    {0, "上海", "市"},
+    {1, "黄浦", "区"},
+    {1, "徐汇", "区"},
+    {1, "长宁", "区"},
+    {1, "静安", "区"},
+    {1, "普陀", "区"},
+    {1, "虹口", "区"},
+    {1, "杨浦", "区"},
+    {1, "闵行", "区"},
+    {1, "宝山", "区"},
+    {1, "嘉定", "区"},
+    {1, "浦东", "新区"},
+    {1, "金山", "区"},
+    {1, "松江", "区"},
+    {1, "青浦", "区"},
+    {1, "奉贤", "区"},
+    {1, "崇明", "区"},
+    {0, "江苏", "省"},
+    {1, "南京", "市"},
+    {1, "无锡", "市"},
+    {1, "徐州", "市"},
+    {1, "常州", "市"},
+    {1, "苏州", "市"},
+    {1, "南通", "市"},
+    {1, "连云港", "市"},
+    {1, "淮安", "市"},
+    {1, "盐城", "市"},
+    {1, "扬州", "市"},
+    {1, "镇江", "市"},
+    {1, "泰州", "市"},
+    {1, "宿迁", "市"},
+    {0, "浙江", "省"},
+    {1, "杭州", "市"},
+    {1, "宁波", "市"},
+    {1, "温州", "市"},
+    {1, "嘉兴", "市"},
+    {1, "湖州", "市"},
+    {1, "绍兴", "市"},
+    {1, "金华", "市"},
+    {1, "衢州", "市"},
+    {1, "舟山", "市"},
+    {1, "台州", "市"},
+    {1, "丽水", "市"},
+    {0, "安徽", "省"},
+    {1, "合肥", "市"},
+    {1, "芜湖", "市"},
+    {1, "蚌埠", "市"},
+    {1, "淮南", "市"},
+    {1, "马鞍山", "市"},
+    {1, "淮北", "市"},
+    {1, "铜陵", "市"},
+    {1, "安庆", "市"},
+    {1, "黄山", "市"},
+    {1, "滁州", "市"},
+    {1, "阜阳", "市"},
+    {1, "宿州", "市"},
+    {1, "六安", "市"},
+    {1, "亳州", "市"},
+    {1, "池州", "市"},
+    {1, "宣城", "市"},
+    {0, "福建", "省"},
+    {1, "福州", "市"},
+    {1, "厦门", "市"},
+    {1, "莆田", "市"},
+    {1, "三明", "市"},
+    {1, "泉州", "市"},
+    {1, "漳州", "市"},
+    {1, "南平", "市"},
+    {1, "龙岩", "市"},
+    {1, "宁德", "市"},
+    {0, "江西", "省"},
+    {1, "南昌", "市"},
+    {1, "景德镇", "市"},
+    {1, "萍乡", "市"},
+    {1, "九江", "市"},
+    {1, "新余", "市"},
+    {1, "鹰潭", "市"},
+    {1, "赣州", "市"},
+    {1, "吉安", "市"},
+    {1, "宜春", "市"},
+    {1, "抚州", "市"},
+    {1, "上饶", "市"},
+    {0, "山东", "省"},
+    {1, "济南", "市"},
+    {1, "青岛", "市"},
+    {1, "淄博", "市"},
+    {1, "枣庄", "市"},
+    {1, "东营", "市"},
+    {1, "烟台", "市"},
+    {1, "潍坊", "市"},
+    {1, "济宁", "市"},
+    {1, "泰安", "市"},
+    {1, "威海", "市"},
+    {1, "日照", "市"},
+    {1, "临沂", "市"},
+    {1, "德州", "市"},
+    {1, "聊城", "市"},
+    {1, "滨州", "市"},
+    {1, "菏泽", "市"},
+    {0, "河南", "省"},
+    {1, "郑州", "市"},
+    {1, "开封", "市"},
+    {1, "洛阳", "市"},
+    {1, "平顶山", "市"},
+    {1, "安阳", "市"},
+    {1, "鹤壁", "市"},
+    {1, "新乡", "市"},
+    {1, "焦作", "市"},
+    {1, "濮阳", "市"},
+    {1, "许昌", "市"},
+    {1, "漯河", "市"},
+    {1, "三门峡", "市"},
+    {1, "南阳", "市"},
+    {1, "商丘", "市"},
+    {1, "信阳", "市"},
+    {1, "周口", "市"},
+    {1, "驻马店", "市"},
+    {0, "湖北", "省"},
+    {1, "武汉", "市"},
+    {1, "黄石", "市"},
+    {1, "十堰", "市"},
+    {1, "宜昌", "市"},
+    {1, "襄阳", "市"},
+    {1, "鄂州", "市"},
+    {1, "荆门", "市"},
+    {1, "孝感", "市"},
+    {1, "荆州", "市"},
+    {1, "黄冈", "市"},
+    {1, "咸宁", "市"},
+    {1, "随州", "市"},
+    {1, "恩施", "土家族苗族自治州"},
+    {0, "湖南", "省"},
+    {1, "长沙", "市"},
+    {1, "株洲", "市"},
+    {1, "湘潭", "市"},
+    {1, "衡阳", "市"},
+    {1, "邵阳", "市"},
+    {1, "岳阳", "市"},
+    {1, "常德", "市"},
+    {1, "张家界", "市"},
+    {1, "益阳", "市"},
+    {1, "郴州", "市"},
+    {1, "永州", "市"},
+    {1, "怀化", "市"},
+    {1, "娄底", "市"},
+    {1, "湘西", "土家族苗族自治州"},
+    {0, "广东", "省"},
+    {1, "广州", "市"},
+    {1, "韶关", "市"},
+    {1, "深圳", "市"},
+    {1, "珠海", "市"},
+    {1, "汕头", "市"},
+    {1, "佛山", "市"},
+    {1, "江门", "市"},
+    {1, "湛江", "市"},
+    {1, "茂名", "市"},
+    {1, "肇庆", "市"},
+    {1, "惠州", "市"},
+    {1, "梅州", "市"},
+    {1, "汕尾", "市"},
+    {1, "河源", "市"},
+    {1, "阳江", "市"},
+    {1, "清远", "市"},
+    {1, "东莞", "市"},
+    {1, "中山", "市"},
+    {1, "潮州", "市"},
+    {1, "揭阳", "市"},
+    {1, "云浮", "市"},
+    {0, "广西", "壮族自治区"},
+    {1, "南宁", "市"},
+    {1, "柳州", "市"},
+    {1, "桂林", "市"},
+    {1, "梧州", "市"},
+    {1, "北海", "市"},
+    {1, "防城港", "市"},
+    {1, "钦州", "市"},
+    {1, "贵港", "市"},
+    {1, "玉林", "市"},
+    {1, "百色", "市"},
+    {1, "贺州", "市"},
+    {1, "河池", "市"},
+    {1, "来宾", "市"},
+    {1, "崇左", "市"},
+    {0, "海南", "省"},
+    {1, "海口", "市"},
+    {1, "三亚", "市"},
+    {1, "三沙", "市"},
+    {1, "儋州", "市"},
+    {0, "重庆", "市"},
+    {1, "万州", "区"},
+    {1, "涪陵", "区"},
+    {1, "渝中", "区"},
+    {1, "大渡口", "区"},
+    {1, "江北", "区"},
+    {1, "沙坪坝", "区"},
+    {1, "九龙坡", "区"},
+    {1, "南岸", "区"},
+    {1, "北碚", "区"},
+    {1, "綦江", "区"},
+    {1, "大足", "区"},
+    {1, "渝北", "区"},
+    {1, "巴南", "区"},
+    {1, "黔江", "区"},
+    {1, "长寿", "区"},
+    {1, "江津", "区"},
+    {1, "合川", "区"},
+    {1, "永川", "区"},
+    {1, "南川", "区"},
+    {1, "璧山", "区"},
+    {1, "铜梁", "区"},
+    {1, "潼南", "区"},
+    {1, "荣昌", "区"},
+    {1, "开州", "区"},
+    {1, "梁平", "区"},
+    {1, "武隆", "区"},
+    {1, "城口", "县"},
+    {1, "丰都", "县"},
+    {1, "垫江", "县"},
+    {1, "忠县", ""},
+    {1, "云阳", "县"},
+    {1, "奉节", "县"},
+    {1, "巫山", "县"},
+    {1, "巫溪", "县"},
+    {1, "石柱", "土家族自治县"},
+    {1, "秀山", "土家族苗族自治县"},
+    {1, "酉阳", "土家族苗族自治县"},
+    {1, "彭水", "苗族土家族自治县"},
+    {0, "四川", "省"},
+    {1, "成都", "市"},
+    {1, "自贡", "市"},
+    {1, "攀枝花", "市"},
+    {1, "泸州", "市"},
+    {1, "德阳", "市"},
+    {1, "绵阳", "市"},
+    {1, "广元", "市"},
+    {1, "遂宁", "市"},
+    {1, "内江", "市"},
+    {1, "乐山", "市"},
+    {1, "南充", "市"},
+    {1, "眉山", "市"},
+    {1, "宜宾", "市"},
+    {1, "广安", "市"},
+    {1, "达州", "市"},
+    {1, "雅安", "市"},
+    {1, "巴中", "市"},
+    {1, "资阳", "市"},
+    {1, "阿坝", "藏族羌族自治州"},
+    {1, "甘孜", "藏族自治州"},
+    {1, "凉山", "彝族自治州"},
+    {0, "贵州", "省"},
+    {1, "贵阳", "市"},
+    {1, "六盘水", "市"},
+    {1, "遵义", "市"},
+    {1, "安顺", "市"},
+    {1, "毕节", "市"},
+    {1, "铜仁", "市"},
+    {1, "黔西南", "布依族苗族自治州"},
+    {1, "黔东南", "苗族侗族自治州"},
+    {1, "黔南", "布依族苗族自治州"},
+    {0, "云南", "省"},
+    {1, "昆明", "市"},
+    {1, "曲靖", "市"},
+    {1, "玉溪", "市"},
+    {1, "保山", "市"},
+    {1, "昭通", "市"},
+    {1, "丽江", "市"},
+    {1, "普洱", "市"},
+    {1, "临沧", "市"},
+    {1, "楚雄", "彝族自治州"},
+    {1, "红河", "哈尼族彝族自治州"},
+    {1, "文山", "壮族苗族自治州"},
+    {1, "西双版纳", "傣族自治州"},
+    {1, "大理", "白族自治州"},
+    {1, "德宏", "傣族景颇族自治州"},
+    {1, "怒江", "傈僳族自治州"},
+    {1, "迪庆", "藏族自治州"},
+    {0, "西藏", "自治区"},
+    {1, "拉萨", "市"},
+    {1, "日喀则", "市"},
+    {1, "昌都", "市"},
+    {1, "林芝", "市"},
+    {1, "山南", "市"},
+    {1, "那曲", "市"},
+    {1, "阿里", "地区"},
+    {0, "陕西", "省"},
+    {1, "西安", "市"},
+    {1, "铜川", "市"},
+    {1, "宝鸡", "市"},
+    {1, "咸阳", "市"},
+    {1, "渭南", "市"},
+    {1, "延安", "市"},
+    {1, "汉中", "市"},
+    {1, "榆林", "市"},
+    {1, "安康", "市"},
+    {1, "商洛", "市"},
+    {0, "甘肃", "省"},
+    {1, "兰州", "市"},
+    {1, "嘉峪关", "市"},
+    {1, "金昌", "市"},
+    {1, "白银", "市"},
+    {1, "天水", "市"},
+    {1, "武威", "市"},
+    {1, "张掖", "市"},
+    {1, "平凉", "市"},
+    {1, "酒泉", "市"},
+    {1, "庆阳", "市"},
+    {1, "定西", "市"},
+    {1, "陇南", "市"},
+    {1, "临夏", "回族自治州"},
+    {1, "甘南", "藏族自治州"},
+    {0, "青海", "省"},
+    {1, "西宁", "市"},
+    {1, "海东", "市"},
+    {1, "海北", "藏族自治州"},
+    {1, "黄南", "藏族自治州"},
+    {1, "海南", "藏族自治州"},
+    {1, "果洛", "藏族自治州"},
+    {1, "玉树", "藏族自治州"},
+    {1, "海西", "蒙古族藏族自治州"},
+    {0, "宁夏", "回族自治区"},
+    {1, "银川", "市"},
+    {1, "石嘴山", "市"},
+    {1, "吴忠", "市"},
+    {1, "固原", "市"},
+    {1, "中卫", "市"},
+    {0, "新疆", "维吾尔自治区"},
+    {1, "乌鲁木齐", "市"},
+    {1, "克拉玛依", "市"},
+    {1, "吐鲁番", "市"},
+    {1, "哈密", "市"},
+    {1, "昌吉", "回族自治州"},
+    {1, "博尔塔拉", "蒙古自治州"},
+    {1, "巴音郭楞", "蒙古自治州"},
+    {1, "克孜勒苏", "柯尔克孜自治州"},
+    {1, "伊犁", "哈萨克自治州"},
+    {1, "阿克苏", "地区"},
+    {1, "喀什", "地区"},
+    {1, "和田", "地区"},
+    {1, "塔城", "地区"},
+    {1, "阿勒泰", "地区"},
+    {0, "台湾", "省"},
+    {0, "香港", "特别行政区"},
+    {0, "澳门", "特别行政区"},
+};
+
+/**
+ * @brief 展开后的行政区划表
+ */
+struct ExpandedTable {
+    QVector<QString> names;    ///< 每个地区的简称
+    QVector<QString> suffixes; ///< 每个地区简称之后的部分
+    QVector<int> parents;      ///< 每个地区的上级，省级为RegionTable::kUnknown
+    QVector<int> ends;         ///< 每个地区的编码区间末尾
+    QVector<int> nameCounts;   ///< 每个地区的简称在全国出现的次数
+
+    ExpandedTable() {
+        QVector<int> stack;
+        QHash<QString, int> counts;
+        for (const RegionEntry& entry : kRegions) {
+            while (stack.size() > entry.depth) {
+                ends[stack.last()] = names.size();
+                stack.removeLast();
+            }
+            parents.append(stack.isEmpty() ? RegionTable::kUnknown : stack.last());
+            stack.append(names.size());
+            names.append(QString::fromUtf8(entry.name));
+            suffixes.append(QString::fromUtf8(entry.suffix));
+            ends.append(0);
+            ++counts[names.last()];
+        }
+        for (int code : stack) {
+            ends[code] = names.size();
+        }
+        for (const QString& name : names) {
+            nameCounts.append(counts.value(name));
+        }
+    }
+
+    /**
+     * @brief 从指定位置匹配地区的简称或全称
+     * @param text 去掉空白和标点的地址
+     * @param position 开始位置
+     * @param code 地区编码
+     * @return 匹配部分的末尾，不匹配时返回position
+     */
+    int matchAt(const QString& text, int position, int code) const {
+        const QString& name = names.at(code);
+        if (text.mid(position, name.size()) != name) {
+            return position;
+        }
+        int end = position + name.size();
+        const QString& suffix = suffixes.at(code);
+        if (!suffix.isEmpty()) {
+            // 全称，或只写后缀的最后一个字（“延边州”“广西区”）
+            if (text.mid(end, suffix.size()) == suffix) {
+                end += suffix.size();
+            } else if (end < text.size() && text.at(end) == suffix.at(suffix.size() - 1)) {
+                ++end;
+            }
+        }
+        return end;
+    }
+};
+
+/**
+ * @brief 获取展开后的行政区划表，第一次调用时展开
+ * @return 行政区划表
+ */
+const ExpandedTable& expandedTable() {
+    static const ExpandedTable table;
+    return table;
+}
+
+} // namespace
+
+/**
+ * @brief 把地址规范化为地区编码
+ *
+ * 每一步在候选地区中取匹配最长的一个，长度相同时取编码较小（层级较高）的一个。
+ * 第一步的候选是全部省级地区和简称全国唯一的地区，之后是上一步所得地区的直接下级
+ * @param location 地址
+ * @return 地区编码
+ */
+int RegionTable::find(const QString& location) {
+    const ExpandedTable& table = expandedTable();
+    QString text;
+    text.reserve(location.size());
+    for (QChar ch : location) {
+        if (ch.isLetterOrNumber()) {
+            text += ch;
+        }
+    }
+
+    int current = kUnknown;
+    int position = 0;
+    while (position < text.size()) {
+        int best = kUnknown;
+        int bestEnd = position;
+        const int first = current == kUnknown ? 0 : current + 1;
+        const int last = current == kUnknown ? table.names.size() : table.ends.at(current);
+        for (int code = first; code < last; ++code) {
+            if (table.parents.at(code) != current && !(current == kUnknown && table.nameCounts.at(code) == 1)) {
+                continue;
+            }
+            const int end = table.matchAt(text, position, code);
+            if (end > bestEnd) {
+                best = code;
+                bestEnd = end;
+            }
+        }
+        if (best == kUnknown) {
+            break;
+        }
+        current = best;
+        position = bestEnd;
+    }
+    return current;
+}
+
+/**
+ * @brief 获取上级地区
+ * @param code 地区编码
+ * @return 上级地区的编码
+ */
+int RegionTable::parent(int code) {
+    return expandedTable().parents.at(code);
+}
+
+/**
+ * @brief 获取地区及其全部下级的编码区间的末尾
+ * @param code 地区编码
+ * @return 编码区间的末尾
+ */
+int RegionTable::subtreeEnd(int code) {
+    return expandedTable().ends.at(code);
+}
+
+/**
+ * @brief 地区是否在另一个地区之内
+ *
+ * 先序编码下只需比较区间
+ * @param region 范围地区的编码
+ * @param code 地区编码
+ * @return 在范围之内返回true，否则返回false
+ */
+bool RegionTable::contains(int region, int code) {
+    return region != kUnknown && code >= region && code < subtreeEnd(region);
+}
+
+/**
+ * @brief 获取地区的完整路径
+ * @param code 地区编码
+ * @return 各级简称
+ */
+QString RegionTable::path(int code) {
+    const ExpandedTable& table = expandedTable();
+    QStringList parts;
+    for (int current = code; current != kUnknown; current = table.parents.at(current)) {
+        parts.prepend(table.names.at(current));
+    }
+    return parts.join('/');
+}
+
+/**
+ * @brief 获取地区数
+ * @return 地区数
+ */
+int RegionTable::size() {
+    return expandedTable().names.size();
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#ifndef REGIONTABLE_H
+#define REGIONTABLE_H
+
+#include <QString>
+
+/**
+ * @brief 行政区划表类
+ *
+ * RegionTable内置省级和地级行政区划，直辖市下收录到区县。地区按先序排列，
+ * 地区编码就是先序中的下标，因此一个地区及其全部下级的编码是连续区间[code, subtreeEnd(code))。
+ * 第一次使用时建立名称索引，之后只读，可以在多个线程中同时使用
+ */
+class RegionTable {
+public:
+    static constexpr int kUnknown = -1; ///< 无法识别的地址
+
+    /**
+     * @brief 把地址规范化为地区编码
+     *
+     * 地址从省级开始逐级匹配，每级接受简称或全称（“北京”“北京市”），也可以省略上级直接写全国唯一的简称（“海淀”）；
+     * 空白和标点被忽略，末尾无法识别的部分（街道、门牌号等）不影响结果
+     * @param location 地址
+     * @return 能识别的最深一级地区的编码，无法识别时返回kUnknown
+     */
+    static int find(const QString& location);
+
+    /**
+     * @brief 获取上级地区
+     * @param code 地区编码
+     * @return 上级地区的编码，省级地区返回kUnknown
+     */
+    static int parent(int code);
+
+    /**
+     * @brief 获取地区及其全部下级的编码区间的末尾
+     * @param code 地区编码
+     * @return 最后一个下级地区的编码加1
+     */
+    static int subtreeEnd(int code);
+
+    /**
+     * @brief 地区是否在另一个地区之内
+     * @param region 范围地区的编码
+     * @param code 地区编码
+     * @return code是region本身或其下级时返回true，否则返回false
+     */
+    static bool contains(int region, int code);
+
+    /**
+     * @brief 获取地区的完整路径
+     * @param code 地区编码
+     * @return 以“/”连接的各级简称，例如“北京/海淀”
+     */
+    static QString path(int code);
+
+    /**
+     * @brief 获取地区数
+     * @return 地区数，地区编码小于该值
+     */
+    static int size();
+};
+
+#endif // REGIONTABLE_H
\ No newline at end of file
@@ -0,0 +1,178 @@
+#include "RelevanceIndex.h"
+#include "TextIndex.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief RelevanceIndex默认构造函数
+ */
+RelevanceIndex::RelevanceIndex() : documentTotal(0), lengthTotals{0, 0, 0} {
+}
+
+/**
+ * @brief 登记槽位的字段
+ *
+ * 统计三个字段的词频后按词项编号合并为一个有序数组，并累加文档频率和字段长度
+ * @param slot 槽位号，已登记时先调用remove()
+ * @param title 标题
+ * @param description 描述
+ * @param tags 标签
+ */
+void RelevanceIndex::insert(quint32 slot, const QString& title, const QString& description, const QList<QString>& tags) {
+    if (int(slot) >= documents.size()) {
+        documents.resize(int(slot) + 1);
+    }
+    if (documents.at(int(slot)).present) {
+        remove(slot);
+    }
+
+    QHash<QString, int> fields[FieldCount];
+    fields[TitleField] = TextIndex::termFrequencies(title);
+    fields[DescriptionField] = TextIndex::termFrequencies(description);
+    for (const QString& tag : tags) {
+        const QHash<QString, int> frequencies = TextIndex::termFrequencies(tag);
+        for (auto it = frequencies.constBegin(); it != frequencies.constEnd(); ++it) {
+            fields[TagField][it.key()] += it.value();
+        }
+    }
+
+    QHash<quint32, int> positions;
+    Document& document = documents[int(slot)];
+    document.postings.clear();
+    for (int field = 0; field < FieldCount; ++field) {
+        int length = 0;
+        for (auto it = fields[field].constBegin(); it != fields[field].constEnd(); ++it) {
+            const quint32 id = termId(it.key());
+            auto position = positions.constFind(id);
+            if (position == positions.constEnd()) {
+                position = positions.insert(id, document.postings.size());
+                document.postings.append(Posting{id, {0, 0, 0}});
+            }
+            document.postings[position.value()].frequencies[field] = quint16(qMin(it.value(), 0xFFFF));
+            length += it.value();
+        }
+        document.lengths[field] = quint16(qMin(length, 0xFFFF));
+        lengthTotals[field] += document.lengths[field];
+    }
+    std::sort(document.postings.begin(), document.postings.end(), [](const Posting& a, const Posting& b) {
+        return a.termId < b.termId;
+    });
+    for (const Posting& posting : document.postings) {
+        ++documentFrequencies[int(posting.termId)];
+    }
+    document.present = true;
+    ++documentTotal;
+}
+
+/**
+ * @brief 移除槽位的字段
+ * @param slot 槽位号
+ */
+void RelevanceIndex::remove(quint32 slot) {
+    if (int(slot) >= documents.size() || !documents.at(int(slot)).present) {
+        return;
+    }
+    Document& document = documents[int(slot)];
+    for (const Posting& posting : document.postings) {
+        --documentFrequencies[int(posting.termId)];
+    }
+    for (int field = 0; field < FieldCount; ++field) {
+        lengthTotals[field] -= document.lengths[field];
+    }
+    document.postings.clear();
+    document.present = false;
+    --documentTotal;
+}
+
+/**
+ * @brief 把关键词切分为查询词项并求出逆文档频率
+ *
+ * 词项与TextIndex::queryTerms()相同，不在索引中的词项对任何槽位都不贡献得分，直接忽略
+ * @param keyword 关键词
+ * @return 按词项编号升序的查询
+ */
+RelevanceIndex::Query RelevanceIndex::prepare(const QString& keyword) const {
+    QVector<quint32> ids;
+    for (const QString& term : TextIndex::queryTerms(keyword)) {
+        auto it = termIds.constFind(term);
+        if (it != termIds.constEnd() && documentFrequencies.at(int(it.value())) > 0) {
+            ids.append(it.value());
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+
+    Query query;
+    for (quint32 id : ids) {
+        const double df = documentFrequencies.at(int(id));
+        query.termIds.append(id);
+        query.weights.append(std::log(1.0 + (documentTotal - df + 0.5) / (df + 0.5)));
+    }
+    return query;
+}
+
+/**
+ * @brief 按BM25F计算槽位对查询的得分
+ *
+ * 各字段的词频按该字段的平均长度归一化后乘以字段权重再相加，合并后的词频只做一次饱和处理，
+ * 标题里出现一次的词项因此比描述里重复多次的词项得分更高
+ * @param slot 槽位号
+ * @param query prepare()求出的查询
+ * @return 得分，不含任何查询词项时为0
+ */
+double RelevanceIndex::score(quint32 slot, const Query& query) const {
+    if (int(slot) >= documents.size() || !documents.at(int(slot)).present || documentTotal == 0) {
+        return 0.0;
+    }
+    static constexpr double boosts[FieldCount] = {kTitleBoost, kDescriptionBoost, kTagBoost};
+    const Document& document = documents.at(int(slot));
+    double norms[FieldCount];
+    for (int field = 0; field < FieldCount; ++field) {
+        const double average = double(lengthTotals[field]) / documentTotal;
+        norms[field] = average > 0.0 ? 1.0 - kB + kB * document.lengths[field] / average : 1.0;
+    }
+
+    double total = 0.0;
+    auto posting = document.postings.cbegin();
+    for (int i = 0; i < query.termIds.size(); ++i) {
+        posting = std::lower_bound(posting, document.postings.cend(), query.termIds.at(i),
+                                   [](const Posting& p, quint32 id) { return p.termId < id; });
+        if (posting == document.postings.cend()) {
+            break;
+        }
+        if (posting->termId != query.termIds.at(i)) {
+            continue;
+        }
+        double frequency = 0.0;
+        for (int field = 0; field < FieldCount; ++field) {
+            frequency += boosts[field] * posting->frequencies[field] / norms[field];
+        }
+        total += query.weights.at(i) * frequency / (kK1 + frequency);
+    }
+    return total;
+}
+
+/**
+ * @brief 获取登记的槽位数
+ * @return 槽位数
+ */
+int RelevanceIndex::documentCount() const {
+    return documentTotal;
+}
+
+/**
+ * @brief 获取词项编号，不存在时分配新编号
+ *
+ * 词典只增不减，已删除槽位用过的词项文档频率为0
+ * @param term 词项
+ * @return 词项编号
+ */
+quint32 RelevanceIndex::termId(const QString& term) {
+    auto it = termIds.constFind(term);
+    if (it != termIds.constEnd()) {
+        return it.value();
+    }
+    const quint32 id = quint32(documentFrequencies.size());
+    termIds.insert(term, id);
+    documentFrequencies.append(0);
+    return id;
+}
\ No newline at end of file
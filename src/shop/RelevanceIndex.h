@@ -0,0 +1,116 @@
+#ifndef RELEVANCEINDEX_H
+#define RELEVANCEINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief 相关度评分索引类
+ *
+ * RelevanceIndex为每个槽位保存标题、描述和标签三个字段中各词项的词频及字段长度，
+ * 并统计每个词项的文档频率，按BM25F为关键词和槽位打分：各字段词频先按字段长度归一化并乘以字段权重，
+ * 合并后再做BM25的饱和处理，乘以词项的逆文档频率后求和。
+ * 词项切分规则与TextIndex相同；词频按槽位正排保存，评分时只需对候选槽位二分查找，不加载商品
+ */
+class RelevanceIndex {
+public:
+    /**
+     * @brief 参与评分的字段
+     */
+    enum Field {
+        TitleField,       ///< 标题
+        DescriptionField, ///< 描述
+        TagField,         ///< 标签
+        FieldCount        ///< 字段数
+    };
+
+    static constexpr double kK1 = 1.2;               ///< BM25的词频饱和参数
+    static constexpr double kB = 0.75;               ///< BM25的长度归一化参数
+    static constexpr double kTitleBoost = 3.0;       ///< 标题字段的权重
+    static constexpr double kDescriptionBoost = 1.0; ///< 描述字段的权重
+    static constexpr double kTagBoost = 2.0;         ///< 标签字段的权重
+
+    /**
+     * @brief 预先求出的查询，保存查询词项的编号和逆文档频率
+     */
+    struct Query {
+        QVector<quint32> termIds; ///< 索引中存在的查询词项编号
+        QVector<double> weights;  ///< 对应词项的逆文档频率
+    };
+
+    /**
+     * @brief 默认构造函数，创建空索引
+     */
+    RelevanceIndex();
+
+    /**
+     * @brief 登记槽位的字段
+     * @param slot 槽位号，已登记时先调用remove()
+     * @param title 标题
+     * @param description 描述
+     * @param tags 标签
+     */
+    void insert(quint32 slot, const QString& title, const QString& description, const QList<QString>& tags);
+
+    /**
+     * @brief 移除槽位的字段
+     * @param slot 槽位号
+     */
+    void remove(quint32 slot);
+
+    /**
+     * @brief 把关键词切分为查询词项并求出逆文档频率
+     * @param keyword 关键词
+     * @return 查询
+     */
+    Query prepare(const QString& keyword) const;
+
+    /**
+     * @brief 按BM25F计算槽位对查询的得分
+     * @param slot 槽位号
+     * @param query prepare()求出的查询
+     * @return 得分，不含任何查询词项时为0
+     */
+    double score(quint32 slot, const Query& query) const;
+
+    /**
+     * @brief 获取登记的槽位数
+     * @return 槽位数
+     */
+    int documentCount() const;
+
+private:
+    /**
+     * @brief 一个槽位中一个词项在各字段的词频
+     */
+    struct Posting {
+        quint32 termId;                  ///< 词项编号
+        quint16 frequencies[FieldCount]; ///< 各字段的词频
+    };
+
+    /**
+     * @brief 一个槽位的正排数据
+     */
+    struct Document {
+        QVector<Posting> postings;   ///< 词项的词频，按词项编号升序
+        quint16 lengths[FieldCount]; ///< 各字段的词项总数
+        bool present = false;        ///< 槽位是否已登记
+    };
+
+    /**
+     * @brief 获取词项编号，不存在时分配新编号
+     * @param term 词项
+     * @return 词项编号
+     */
+    quint32 termId(const QString& term);
+
+    QHash<QString, quint32> termIds;  ///< 词项到编号的映射
+    QVector<int> documentFrequencies; ///< 每个词项编号出现的槽位数
+    QVector<Document> documents;      ///< 每个槽位的正排数据
+    int documentTotal;                ///< 登记的槽位数
+    qint64 lengthTotals[FieldCount];  ///< 各字段的词项总数之和
+};
+
+#endif // RELEVANCEINDEX_H
\ No newline at end of file
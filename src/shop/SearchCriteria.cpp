@@ -0,0 +1,530 @@
+#include "SearchCriteria.h"
+#include "RegionTable.h"
+#include <QStringList>
+#include <algorithm>
+
+/**
+ * @brief SearchCriteria默认构造函数
+ */
+SearchCriteria::SearchCriteria()
+    : categoryId(0), categorySet(false), minPrice(0.0), minPriceSet(false),
+      maxPrice(0.0), maxPriceSet(false), sellerId(0), sellerSet(false),
+      sortOrder(SortByProductId), offset(0), limit(-1), recencyHalfLife(0.0),
+      fuzzyDistance(0), pinyinMatching(false), subcategories(false) {
+}
+
+/**
+ * @brief 设置关键词，首尾空白会被去掉
+ *
+ * 关键词匹配标题或描述，不区分大小写
+ * @param keyword 关键词
+ */
+void SearchCriteria::setKeyword(const QString& keyword) {
+    this->keyword = keyword.trimmed();
+}
+
+/**
+ * @brief 设置分类
+ * @param categoryId 分类ID
+ */
+void SearchCriteria::setCategoryId(int categoryId) {
+    this->categoryId = categoryId;
+    categorySet = true;
+}
+
+/**
+ * @brief 设置价格区间（闭区间）
+ * @param minPrice 最低价格
+ * @param maxPrice 最高价格
+ */
+void SearchCriteria::setPriceRange(double minPrice, double maxPrice) {
+    setMinPrice(minPrice);
+    setMaxPrice(maxPrice);
+}
+
+/**
+ * @brief 设置最低价格
+ * @param minPrice 最低价格（含）
+ */
+void SearchCriteria::setMinPrice(double minPrice) {
+    this->minPrice = minPrice;
+    minPriceSet = true;
+}
+
+/**
+ * @brief 设置最高价格
+ * @param maxPrice 最高价格（含）
+ */
+void SearchCriteria::setMaxPrice(double maxPrice) {
+    this->maxPrice = maxPrice;
+    maxPriceSet = true;
+}
+
+/**
+ * @brief 设置必须全部包含的标签
+ * @param tags 标签列表
+ */
+void SearchCriteria::setTags(const QList<QString>& tags) {
+    this->tags = tags;
+}
+
+/**
+ * @brief 设置至少包含其一的标签
+ * @param anyTags 标签列表
+ */
+void SearchCriteria::setAnyTags(const QList<QString>& anyTags) {
+    this->anyTags = anyTags;
+}
+
+/**
+ * @brief 设置不能包含的标签
+ * @param excludedTags 标签列表
+ */
+void SearchCriteria::setExcludedTags(const QList<QString>& excludedTags) {
+    this->excludedTags = excludedTags;
+}
+
+/**
+ * @brief 设置地址，按完整字符串匹配
+ * @param location 地址
+ */
+void SearchCriteria::setLocation(const QString& location) {
+    this->location = location;
+}
+
+/**
+ * @brief 设置地区
+ *
+ * 与setLocation()的精确匹配不同，地区按行政区划匹配：“北京”命中“北京市海淀区”和“海淀”，
+ * “北京/海淀”只命中海淀区；无法识别的地区退化为精确匹配地址
+ * @param region 地区
+ */
+void SearchCriteria::setRegion(const QString& region) {
+    this->region = region;
+}
+
+/**
+ * @brief 设置状态，按完整字符串匹配
+ * @param status 状态
+ */
+void SearchCriteria::setStatus(const QString& status) {
+    this->status = status;
+}
+
+/**
+ * @brief 设置卖家
+ * @param sellerId 卖家ID
+ */
+void SearchCriteria::setSellerId(int sellerId) {
+    this->sellerId = sellerId;
+    sellerSet = true;
+}
+
+/**
+ * @brief 设置排序方式，默认按商品ID升序
+ * @param sortOrder 排序方式
+ */
+void SearchCriteria::setSortOrder(SortOrder sortOrder) {
+    this->sortOrder = sortOrder;
+}
+
+/**
+ * @brief 设置分页
+ * @param offset 跳过的商品数，负数按0处理
+ * @param limit 最多返回的商品数，负数表示不限
+ */
+void SearchCriteria::setPage(int offset, int limit) {
+    this->offset = qMax(0, offset);
+    this->limit = limit;
+}
+
+/**
+ * @brief 设置游标
+ *
+ * 游标记录上一页最后一个商品的排序键，下一页从该键之后开始，翻到多深都不需要跳过前面的商品
+ * @param cursor 上一页结果给出的游标，空表示从头开始
+ */
+void SearchCriteria::setCursor(const QString& cursor) {
+    this->cursor = cursor;
+}
+
+/**
+ * @brief 设置相关度按发布时间衰减的半衰期
+ *
+ * 只在按相关度排序时生效，比索引中最新的商品早一个半衰期发布的商品得分减半
+ * @param days 半衰期（天），不大于0表示不衰减
+ */
+void SearchCriteria::setRecencyHalfLife(double days) {
+    recencyHalfLife = days > 0.0 ? days : 0.0;
+}
+
+/**
+ * @brief 设置关键词模糊匹配标题时允许的编辑距离
+ *
+ * 关键词的每个单词与标题中某个单词的编辑距离不超过该值即算命中，较短的单词另有更严的上限，
+ * 精确包含关键词的标题和描述仍然命中
+ * @param distance 编辑距离，不大于0表示精确匹配
+ */
+void SearchCriteria::setFuzzyDistance(int distance) {
+    fuzzyDistance = qMax(0, distance);
+}
+
+/**
+ * @brief 设置关键词是否按拼音匹配标题
+ *
+ * 启用后关键词的每个单词是标题全拼或拼音首字母的子串即算命中，例如“shouji”和“sj”都命中“手机”，
+ * 精确包含关键词的标题和描述仍然命中
+ * @param enabled 是否启用
+ */
+void SearchCriteria::setPinyinMatching(bool enabled) {
+    pinyinMatching = enabled;
+}
+
+/**
+ * @brief 设置分类条件是否包括下级分类
+ *
+ * 启用后分类属于所设分类的子树（分类本身或其任意一级下级）的商品都命中，分类不在分类树中时只匹配分类本身
+ * @param enabled 是否启用
+ */
+void SearchCriteria::setIncludeSubcategories(bool enabled) {
+    subcategories = enabled;
+}
+
+/**
+ * @brief 获取关键词
+ * @return 关键词
+ */
+QString SearchCriteria::getKeyword() const {
+    return keyword;
+}
+
+/**
+ * @brief 获取分类ID
+ * @return 分类ID
+ */
+int SearchCriteria::getCategoryId() const {
+    return categoryId;
+}
+
+/**
+ * @brief 获取最低价格
+ * @return 最低价格
+ */
+double SearchCriteria::getMinPrice() const {
+    return minPrice;
+}
+
+/**
+ * @brief 获取最高价格
+ * @return 最高价格
+ */
+double SearchCriteria::getMaxPrice() const {
+    return maxPrice;
+}
+
+/**
+ * @brief 获取标签列表
+ * @return 标签列表
+ */
+QList<QString> SearchCriteria::getTags() const {
+    return tags;
+}
+
+/**
+ * @brief 获取至少包含其一的标签列表
+ * @return 标签列表
+ */
+QList<QString> SearchCriteria::getAnyTags() const {
+    return anyTags;
+}
+
+/**
+ * @brief 获取不能包含的标签列表
+ * @return 标签列表
+ */
+QList<QString> SearchCriteria::getExcludedTags() const {
+    return excludedTags;
+}
+
+/**
+ * @brief 获取地址
+ * @return 地址
+ */
+QString SearchCriteria::getLocation() const {
+    return location;
+}
+
+/**
+ * @brief 获取地区
+ * @return 地区
+ */
+QString SearchCriteria::getRegion() const {
+    return region;
+}
+
+/**
+ * @brief 获取状态
+ * @return 状态
+ */
+QString SearchCriteria::getStatus() const {
+    return status;
+}
+
+/**
+ * @brief 获取卖家ID
+ * @return 卖家ID
+ */
+int SearchCriteria::getSellerId() const {
+    return sellerId;
+}
+
+/**
+ * @brief 获取排序方式
+ * @return 排序方式
+ */
+SearchCriteria::SortOrder SearchCriteria::getSortOrder() const {
+    return sortOrder;
+}
+
+/**
+ * @brief 获取跳过的商品数
+ * @return 跳过的商品数
+ */
+int SearchCriteria::getOffset() const {
+    return offset;
+}
+
+/**
+ * @brief 获取最多返回的商品数
+ * @return 最多返回的商品数，负数表示不限
+ */
+int SearchCriteria::getLimit() const {
+    return limit;
+}
+
+/**
+ * @brief 获取游标
+ * @return 游标
+ */
+QString SearchCriteria::getCursor() const {
+    return cursor;
+}
+
+/**
+ * @brief 获取相关度按发布时间衰减的半衰期
+ * @return 半衰期（天），0表示不衰减
+ */
+double SearchCriteria::getRecencyHalfLife() const {
+    return recencyHalfLife;
+}
+
+/**
+ * @brief 获取关键词模糊匹配标题时允许的编辑距离
+ * @return 编辑距离，0表示精确匹配
+ */
+int SearchCriteria::getFuzzyDistance() const {
+    return fuzzyDistance;
+}
+
+/**
+ * @brief 关键词是否按拼音匹配标题
+ * @return 启用且有关键词时返回true，否则返回false
+ */
+bool SearchCriteria::isPinyinMatching() const {
+    return pinyinMatching && hasKeyword();
+}
+
+/**
+ * @brief 分类条件是否包括下级分类
+ * @return 启用且设置了分类时返回true，否则返回false
+ */
+bool SearchCriteria::includesSubcategories() const {
+    return subcategories && categorySet;
+}
+
+/**
+ * @brief 是否设置了关键词
+ * @return 设置了返回true，否则返回false
+ */
+bool SearchCriteria::hasKeyword() const {
+    return !keyword.isEmpty();
+}
+
+/**
+ * @brief 是否设置了分类
+ * @return 设置了返回true，否则返回false
+ */
+bool SearchCriteria::hasCategoryId() const {
+    return categorySet;
+}
+
+/**
+ * @brief 是否设置了最低价格
+ * @return 设置了返回true，否则返回false
+ */
+bool SearchCriteria::hasMinPrice() const {
+    return minPriceSet;
+}
+
+/**
+ * @brief 是否设置了最高价格
+ * @return 设置了返回true，否则返回false
+ */
+bool SearchCriteria::hasMaxPrice() const {
+    return maxPriceSet;
+}
+
+/**
+ * @brief 是否设置了地址
+ * @return 设置了返回true，否则返回false
+ */
+bool SearchCriteria::hasLocation() const {
+    return !location.isEmpty();
+}
+
+/**
+ * @brief 是否设置了地区
+ * @return 设置了返回true，否则返回false
+ */
+bool SearchCriteria::hasRegion() const {
+    return !region.isEmpty();
+}
+
+/**
+ * @brief 是否设置了状态
+ * @return 设置了返回true，否则返回false
+ */
+bool SearchCriteria::hasStatus() const {
+    return !status.isEmpty();
+}
+
+/**
+ * @brief 是否设置了卖家
+ * @return 设置了返回true，否则返回false
+ */
+bool SearchCriteria::hasSellerId() const {
+    return sellerSet;
+}
+
+/**
+ * @brief 是否限制了返回的商品数
+ * @return 限制了返回true，否则返回false
+ */
+bool SearchCriteria::hasLimit() const {
+    return limit >= 0;
+}
+
+/**
+ * @brief 是否设置了游标
+ * @return 设置了返回true，否则返回false
+ */
+bool SearchCriteria::hasCursor() const {
+    return !cursor.isEmpty();
+}
+
+/**
+ * @brief 按相关度排序时是否按发布时间衰减
+ * @return 设置了衰减半衰期返回true，否则返回false
+ */
+bool SearchCriteria::hasRecencyDecay() const {
+    return recencyHalfLife > 0.0;
+}
+
+/**
+ * @brief 关键词是否模糊匹配
+ * @return 设置了大于0的编辑距离且有关键词时返回true，否则返回false
+ */
+bool SearchCriteria::isFuzzy() const {
+    return fuzzyDistance > 0 && hasKeyword();
+}
+
+/**
+ * @brief 是否没有设置任何条件
+ * @return 没有任何条件返回true，否则返回false
+ */
+bool SearchCriteria::isEmpty() const {
+    return !hasKeyword() && !categorySet && !minPriceSet && !maxPriceSet && tags.isEmpty()
+           && anyTags.isEmpty() && excludedTags.isEmpty() && !hasLocation() && !hasRegion() && !hasStatus()
+           && !sellerSet;
+}
+
+/**
+ * @brief 获取规范化的键
+ *
+ * 每个已设置的条件占一段，字符串按长度前缀编码，避免不同条件拼接出相同的键
+ * @return 规范化的键
+ */
+QString SearchCriteria::normalizedKey() const {
+    auto text = [](const QString& value) {
+        return QString("%1:%2").arg(value.size()).arg(value);
+    };
+    auto tagSet = [&text](QList<QString> values) {
+        std::sort(values.begin(), values.end());
+        values.erase(std::unique(values.begin(), values.end()), values.end());
+        QString joined = QString::number(values.size());
+        for (const QString& value : values) {
+            joined += text(value);
+        }
+        return joined;
+    };
+
+    QStringList parts;
+    if (hasKeyword()) {
+        parts << "k" + text(keyword.toLower());
+    }
+    if (isFuzzy()) {
+        parts << "z" + QString::number(fuzzyDistance);
+    }
+    if (isPinyinMatching()) {
+        parts << "y";
+    }
+    if (categorySet) {
+        parts << "c" + QString::number(categoryId);
+    }
+    if (includesSubcategories()) {
+        parts << "d";
+    }
+    if (minPriceSet) {
+        parts << "p" + QString::number(minPrice, 'g', 17);
+    }
+    if (maxPriceSet) {
+        parts << "P" + QString::number(maxPrice, 'g', 17);
+    }
+    if (!tags.isEmpty()) {
+        parts << "t" + tagSet(tags);
+    }
+    if (!anyTags.isEmpty()) {
+        parts << "a" + tagSet(anyTags);
+    }
+    if (!excludedTags.isEmpty()) {
+        parts << "x" + tagSet(excludedTags);
+    }
+    if (hasLocation()) {
+        parts << "l" + text(location);
+    }
+    if (hasRegion()) {
+        // 可以识别的地区按地区编码区分，“北京”和“北京市”得到相同的键
+        const int code = RegionTable::find(region);
+        parts << "g" + (code != RegionTable::kUnknown ? QString::number(code) : text(region));
+    }
+    if (hasStatus()) {
+        parts << "s" + text(status);
+    }
+    if (sellerSet) {
+        parts << "u" + QString::number(sellerId);
+    }
+    parts << "o" + QString::number(int(sortOrder));
+    if (sortOrder == SortByRelevance && hasRecencyDecay()) {
+        parts << "h" + QString::number(recencyHalfLife, 'g', 17);
+    }
+    if (offset > 0) {
+        parts << "f" + QString::number(offset);
+    }
+    if (hasLimit()) {
+        parts << "n" + QString::number(limit);
+    }
+    if (hasCursor()) {
+        parts << "r" + text(cursor);
+    }
+    return parts.join('|');
+}
\ No newline at end of file
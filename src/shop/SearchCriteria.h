@@ -0,0 +1,197 @@
+#ifndef SEARCHCRITERIA_H
+#define SEARCHCRITERIA_H
+
+#include <QList>
+#include <QString>
+
+/**
+ * @brief 商品搜索条件类
+ *
+ * SearchCriteria描述一次商品搜索的过滤条件、排序方式和分页，未设置的条件不参与过滤，
+ * 所有已设置的条件之间是“与”的关系
+ */
+class SearchCriteria {
+public:
+    /**
+     * @brief 结果排序方式
+     */
+    enum SortOrder {
+        SortByProductId,       ///< 按商品ID升序
+        SortByPriceAscending,  ///< 按价格升序，价格相同时按商品ID升序
+        SortByPriceDescending, ///< 按价格降序，价格相同时按商品ID降序
+        SortByNewest,          ///< 按发布时间从新到旧，时间相同时按商品ID降序
+        SortByRelevance        ///< 按关键词相关度（BM25）从高到低，相关度相同时按商品ID升序
+    };
+
+    /**
+     * @brief 默认构造函数，不设置任何条件
+     */
+    SearchCriteria();
+
+    // Setters
+    void setKeyword(const QString& keyword);
+    void setCategoryId(int categoryId);
+    void setPriceRange(double minPrice, double maxPrice);
+    void setMinPrice(double minPrice);
+    void setMaxPrice(double maxPrice);
+    void setTags(const QList<QString>& tags);
+    void setAnyTags(const QList<QString>& anyTags);
+    void setExcludedTags(const QList<QString>& excludedTags);
+    void setLocation(const QString& location);
+    void setRegion(const QString& region);
+    void setStatus(const QString& status);
+    void setSellerId(int sellerId);
+    void setSortOrder(SortOrder sortOrder);
+    void setPage(int offset, int limit);
+    void setCursor(const QString& cursor);
+    void setRecencyHalfLife(double days);
+    void setFuzzyDistance(int distance);
+    void setPinyinMatching(bool enabled);
+    void setIncludeSubcategories(bool enabled);
+
+    // Getters
+    QString getKeyword() const;
+    int getCategoryId() const;
+    double getMinPrice() const;
+    double getMaxPrice() const;
+    QList<QString> getTags() const;
+    QList<QString> getAnyTags() const;
+    QList<QString> getExcludedTags() const;
+    QString getLocation() const;
+    QString getRegion() const;
+    QString getStatus() const;
+    int getSellerId() const;
+    SortOrder getSortOrder() const;
+    int getOffset() const;
+    int getLimit() const;
+    QString getCursor() const;
+    double getRecencyHalfLife() const;
+    int getFuzzyDistance() const;
+
+    /**
+     * @brief 是否设置了关键词
+     * @return 设置了返回true，否则返回false
+     */
+    bool hasKeyword() const;
+
+    /**
+     * @brief 是否设置了分类
+     * @return 设置了返回true，否则返回false
+     */
+    bool hasCategoryId() const;
+
+    /**
+     * @brief 是否设置了最低价格
+     * @return 设置了返回true，否则返回false
+     */
+    bool hasMinPrice() const;
+
+    /**
+     * @brief 是否设置了最高价格
+     * @return 设置了返回true，否则返回false
+     */
+    bool hasMaxPrice() const;
+
+    /**
+     * @brief 是否设置了地址
+     * @return 设置了返回true，否则返回false
+     */
+    bool hasLocation() const;
+
+    /**
+     * @brief 是否设置了地区
+     * @return 设置了返回true，否则返回false
+     */
+    bool hasRegion() const;
+
+    /**
+     * @brief 是否设置了状态
+     * @return 设置了返回true，否则返回false
+     */
+    bool hasStatus() const;
+
+    /**
+     * @brief 是否设置了卖家
+     * @return 设置了返回true，否则返回false
+     */
+    bool hasSellerId() const;
+
+    /**
+     * @brief 是否限制了返回的商品数
+     * @return 限制了返回true，否则返回false
+     */
+    bool hasLimit() const;
+
+    /**
+     * @brief 是否设置了游标
+     * @return 设置了返回true，否则返回false
+     */
+    bool hasCursor() const;
+
+    /**
+     * @brief 按相关度排序时是否按发布时间衰减
+     * @return 设置了衰减半衰期返回true，否则返回false
+     */
+    bool hasRecencyDecay() const;
+
+    /**
+     * @brief 关键词是否模糊匹配
+     * @return 设置了大于0的编辑距离且有关键词时返回true，否则返回false
+     */
+    bool isFuzzy() const;
+
+    /**
+     * @brief 关键词是否按拼音匹配标题
+     * @return 启用了拼音匹配且有关键词时返回true，否则返回false
+     */
+    bool isPinyinMatching() const;
+
+    /**
+     * @brief 分类条件是否包括下级分类
+     * @return 启用了包括下级分类且设置了分类时返回true，否则返回false
+     */
+    bool includesSubcategories() const;
+
+    /**
+     * @brief 是否没有设置任何条件
+     *
+     * 排序方式和分页不是过滤条件，不影响结果
+     * @return 没有任何条件返回true，否则返回false
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief 获取规范化的键，结果相同的搜索条件得到相同的键
+     *
+     * 关键词不区分大小写，标签与设置顺序和重复无关，未设置的条件不出现在键中
+     * @return 规范化的键
+     */
+    QString normalizedKey() const;
+
+private:
+    QString keyword;             ///< 关键词，空表示不限
+    int categoryId;              ///< 分类ID
+    bool categorySet;            ///< 是否设置了分类
+    double minPrice;             ///< 最低价格（含）
+    bool minPriceSet;            ///< 是否设置了最低价格
+    double maxPrice;             ///< 最高价格（含）
+    bool maxPriceSet;            ///< 是否设置了最高价格
+    QList<QString> tags;         ///< 必须全部包含的标签
+    QList<QString> anyTags;      ///< 至少包含其一的标签
+    QList<QString> excludedTags; ///< 不能包含的标签
+    QString location;            ///< 地址，空表示不限
+    QString region;              ///< 地区，包括其下级地区，空表示不限
+    QString status;              ///< 状态，空表示不限
+    int sellerId;                ///< 卖家ID
+    bool sellerSet;              ///< 是否设置了卖家
+    SortOrder sortOrder;         ///< 排序方式
+    int offset;                  ///< 跳过的商品数
+    int limit;                   ///< 最多返回的商品数，负数表示不限
+    QString cursor;              ///< 上一页给出的游标，空表示从头开始
+    double recencyHalfLife;      ///< 相关度按发布时间衰减的半衰期（天），0表示不衰减
+    int fuzzyDistance;           ///< 关键词模糊匹配标题时允许的编辑距离，0表示精确匹配
+    bool pinyinMatching;         ///< 关键词是否按拼音匹配标题
+    bool subcategories;          ///< 分类条件是否包括分类树中的下级分类
+};
+
+#endif // SEARCHCRITERIA_H
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "SearchFacets.h"
+
+/**
+ * @brief SearchFacets默认构造函数
+ */
+SearchFacets::SearchFacets() : total(0), minPrice(0.0), maxPrice(0.0), averagePrice(0.0) {
+}
+
+/**
+ * @brief 设置命中的商品总数
+ * @param total 商品总数
+ */
+void SearchFacets::setTotal(int total) {
+    this->total = total;
+}
+
+/**
+ * @brief 设置每个分类的命中数
+ * @param categoryCounts 分类ID到命中数的映射
+ */
+void SearchFacets::setCategoryCounts(const QHash<int, int>& categoryCounts) {
+    this->categoryCounts = categoryCounts;
+}
+
+/**
+ * @brief 设置每个状态的命中数
+ * @param statusCounts 状态到命中数的映射
+ */
+void SearchFacets::setStatusCounts(const QHash<QString, int>& statusCounts) {
+    this->statusCounts = statusCounts;
+}
+
+/**
+ * @brief 设置每个地址的命中数
+ * @param locationCounts 地址到命中数的映射
+ */
+void SearchFacets::setLocationCounts(const QHash<QString, int>& locationCounts) {
+    this->locationCounts = locationCounts;
+}
+
+/**
+ * @brief 设置每个标签的命中数
+ * @param tagCounts 标签到命中数的映射
+ */
+void SearchFacets::setTagCounts(const QHash<QString, int>& tagCounts) {
+    this->tagCounts = tagCounts;
+}
+
+/**
+ * @brief 设置命中商品的价格统计
+ * @param minPrice 最低价格
+ * @param maxPrice 最高价格
+ * @param averagePrice 平均价格
+ */
+void SearchFacets::setPriceStatistics(double minPrice, double maxPrice, double averagePrice) {
+    this->minPrice = minPrice;
+    this->maxPrice = maxPrice;
+    this->averagePrice = averagePrice;
+}
+
+/**
+ * @brief 获取命中的商品总数
+ * @return 商品总数
+ */
+int SearchFacets::getTotal() const {
+    return total;
+}
+
+/**
+ * @brief 获取每个分类的命中数
+ * @return 分类ID到命中数的映射
+ */
+QHash<int, int> SearchFacets::getCategoryCounts() const {
+    return categoryCounts;
+}
+
+/**
+ * @brief 获取每个状态的命中数
+ * @return 状态到命中数的映射
+ */
+QHash<QString, int> SearchFacets::getStatusCounts() const {
+    return statusCounts;
+}
+
+/**
+ * @brief 获取每个地址的命中数
+ * @return 地址到命中数的映射
+ */
+QHash<QString, int> SearchFacets::getLocationCounts() const {
+    return locationCounts;
+}
+
+/**
+ * @brief 获取每个标签的命中数
+ * @return 标签到命中数的映射
+ */
+QHash<QString, int> SearchFacets::getTagCounts() const {
+    return tagCounts;
+}
+
+/**
+ * @brief 获取命中商品的最低价格
+ * @return 最低价格，没有命中时为0
+ */
+double SearchFacets::getMinPrice() const {
+    return minPrice;
+}
+
+/**
+ * @brief 获取命中商品的最高价格
+ * @return 最高价格，没有命中时为0
+ */
+double SearchFacets::getMaxPrice() const {
+    return maxPrice;
+}
+
+/**
+ * @brief 获取命中商品的平均价格
+ * @return 平均价格，没有命中时为0
+ */
+double SearchFacets::getAveragePrice() const {
+    return averagePrice;
+}
\ No newline at end of file
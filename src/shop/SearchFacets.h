@@ -0,0 +1,49 @@
+#ifndef SEARCHFACETS_H
+#define SEARCHFACETS_H
+
+#include <QHash>
+#include <QString>
+
+/**
+ * @brief 搜索分面统计类
+ *
+ * SearchFacets保存一次搜索全部命中商品（不受分页和游标影响）按分类、状态、地址和标签的分布，
+ * 用于筛选侧栏显示每个选项下的商品数，以及命中商品的最低、最高和平均价格
+ */
+class SearchFacets {
+public:
+    /**
+     * @brief 默认构造函数，创建空统计
+     */
+    SearchFacets();
+
+    // Setters
+    void setTotal(int total);
+    void setCategoryCounts(const QHash<int, int>& categoryCounts);
+    void setStatusCounts(const QHash<QString, int>& statusCounts);
+    void setLocationCounts(const QHash<QString, int>& locationCounts);
+    void setTagCounts(const QHash<QString, int>& tagCounts);
+    void setPriceStatistics(double minPrice, double maxPrice, double averagePrice);
+
+    // Getters
+    int getTotal() const;
+    QHash<int, int> getCategoryCounts() const;
+    QHash<QString, int> getStatusCounts() const;
+    QHash<QString, int> getLocationCounts() const;
+    QHash<QString, int> getTagCounts() const;
+    double getMinPrice() const;
+    double getMaxPrice() const;
+    double getAveragePrice() const;
+
+private:
+    int total;                          ///< 命中的商品总数
+    QHash<int, int> categoryCounts;     ///< 每个分类的命中数
+    QHash<QString, int> statusCounts;   ///< 每个状态的命中数
+    QHash<QString, int> locationCounts; ///< 每个地址的命中数
+    QHash<QString, int> tagCounts;      ///< 每个标签的命中数
+    double minPrice;                    ///< 命中商品的最低价格，没有命中时为0
+    double maxPrice;                    ///< 命中商品的最高价格，没有命中时为0
+    double averagePrice;                ///< 命中商品的平均价格，没有命中时为0
+};
+
+#endif // SEARCHFACETS_H
\ No newline at end of file
@@ -0,0 +1,326 @@
+#include "SearchResultCache.h"
+#include "LocationIndex.h"
+#include "TextIndex.h"
+#include <iterator>
+#include <limits>
+
+/**
+ * @brief SearchResultCache构造函数
+ * @param memoryBudget 内存预算（字节）
+ */
+SearchResultCache::SearchResultCache(int memoryBudget)
+    : budget(memoryBudget), usage(0), hits(0), misses(0), invalidations(0) {
+}
+
+/**
+ * @brief 查找缓存的搜索结果，命中时将其标记为最近使用
+ * @param criteria 搜索条件
+ * @param products 输出参数，本页商品
+ * @param nextCursor 不为空时输出下一页的游标
+ * @return 命中返回true，否则返回false且不修改输出参数
+ */
+bool SearchResultCache::lookup(const SearchCriteria& criteria, QList<Product>& products, QString* nextCursor) {
+    auto it = byKey.constFind(criteria.normalizedKey());
+    if (it == byKey.constEnd()) {
+        ++misses;
+        return false;
+    }
+
+    ++hits;
+    entries.splice(entries.begin(), entries, it.value());
+    products = it.value()->products;
+    if (nextCursor) {
+        *nextCursor = it.value()->nextCursor;
+    }
+    return true;
+}
+
+/**
+ * @brief 缓存一次搜索的结果
+ * @param criteria 搜索条件
+ * @param products 本页商品
+ * @param nextCursor 下一页的游标
+ */
+void SearchResultCache::insert(const SearchCriteria& criteria, const QList<Product>& products,
+                               const QString& nextCursor) {
+    Entry entry = {criteria.normalizedKey(), criteria, products, nextCursor, 0};
+    entry.bytes = estimateBytes(entry);
+    auto existing = byKey.find(entry.key);
+    if (existing != byKey.end()) {
+        erase(existing.value());
+    }
+    if (entry.bytes > budget) {
+        return;
+    }
+
+    entries.push_front(entry);
+    byKey.insert(entry.key, entries.begin());
+    registerEntry(entries.front(), true);
+    usage += entry.bytes;
+    evict();
+}
+
+/**
+ * @brief 商品变更后淘汰受影响的结果
+ *
+ * 结果中含有该商品的直接淘汰；其余只检查按商品变更前后的分类、标签登记的结果和没有这两类条件的结果，
+ * 变更前或变更后的商品可能满足其条件时淘汰。按相关度排序的得分取决于全部商品的词频统计和最新的发布时间，
+ * 任何变更都可能改变其顺序，一律淘汰。
+ * 包括下级分类的结果不按分类登记，分类树的变化在这里看不到：它们依赖ProductRepository在分类树写出后
+ * 以两个默认构造的Product对象通知，清空全部结果
+ * @param previous 变更前的商品，新增时为默认构造的Product对象
+ * @param current 变更后的商品，删除时为默认构造的Product对象
+ */
+void SearchResultCache::invalidate(const Product& previous, const Product& current) {
+    // 批量加载和分类树变化都走这里；移动分类后包括下级分类的结果只能靠清空来淘汰
+    if (previous.getProductId() == 0 && current.getProductId() == 0) {
+        invalidations += qint64(entries.size());
+        clear();
+        return;
+    }
+
+    const int productId = current.getProductId() != 0 ? current.getProductId() : previous.getProductId();
+    QSet<QString> stale = byProduct.value(productId);
+    QSet<QString> candidates = unscoped;
+    for (const Product* product : {&previous, &current}) {
+        if (product->getProductId() == 0) {
+            continue;
+        }
+        candidates.unite(byCategory.value(product->getCategoryId()));
+        for (const QString& tag : product->getTags()) {
+            candidates.unite(byTag.value(tag));
+        }
+    }
+    for (const QString& key : candidates) {
+        if (stale.contains(key)) {
+            continue;
+        }
+        const SearchCriteria& criteria = byKey.value(key)->criteria;
+        if (criteria.getSortOrder() == SearchCriteria::SortByRelevance || mayMatch(criteria, previous)
+            || mayMatch(criteria, current)) {
+            stale.insert(key);
+        }
+    }
+
+    for (const QString& key : stale) {
+        auto it = byKey.find(key);
+        if (it != byKey.end()) {
+            erase(it.value());
+            ++invalidations;
+        }
+    }
+}
+
+/**
+ * @brief 清空全部结果，不重置计数
+ */
+void SearchResultCache::clear() {
+    entries.clear();
+    byKey.clear();
+    byProduct.clear();
+    byCategory.clear();
+    byTag.clear();
+    unscoped.clear();
+    usage = 0;
+}
+
+/**
+ * @brief 设置内存预算，超出时立即淘汰最久未使用的结果
+ * @param memoryBudget 内存预算（字节）
+ */
+void SearchResultCache::setMemoryBudget(int memoryBudget) {
+    budget = memoryBudget;
+    evict();
+}
+
+/**
+ * @brief 获取内存预算
+ * @return 内存预算（字节）
+ */
+int SearchResultCache::memoryBudget() const {
+    return budget;
+}
+
+/**
+ * @brief 获取缓存的结果估算占用的内存
+ * @return 字节数
+ */
+int SearchResultCache::memoryUsage() const {
+    return usage;
+}
+
+/**
+ * @brief 获取缓存的结果数
+ * @return 结果数
+ */
+int SearchResultCache::size() const {
+    return byKey.size();
+}
+
+/**
+ * @brief 获取命中次数
+ * @return 命中次数
+ */
+qint64 SearchResultCache::hitCount() const {
+    return hits;
+}
+
+/**
+ * @brief 获取未命中次数
+ * @return 未命中次数
+ */
+qint64 SearchResultCache::missCount() const {
+    return misses;
+}
+
+/**
+ * @brief 获取因商品变更而淘汰的结果数
+ * @return 结果数
+ */
+qint64 SearchResultCache::invalidationCount() const {
+    return invalidations;
+}
+
+/**
+ * @brief 估算一条结果占用的内存
+ *
+ * 按商品各字符串的长度估算，不考虑与存储后端共享的字符串数据，结果偏大
+ * @param entry 缓存的结果
+ * @return 字节数
+ */
+int SearchResultCache::estimateBytes(const Entry& entry) {
+    qint64 bytes = qint64(sizeof(Entry)) + (entry.key.size() + entry.nextCursor.size()) * qint64(sizeof(QChar));
+    for (const Product& product : entry.products) {
+        bytes += qint64(sizeof(Product))
+                 + (product.getTitle().size() + product.getDescription().size() + product.getLocation().size()
+                    + product.getStatus().size()) * qint64(sizeof(QChar));
+        for (const QString& tag : product.getTags()) {
+            bytes += qint64(sizeof(QString)) + tag.size() * qint64(sizeof(QChar));
+        }
+    }
+    return int(qMin(bytes, qint64(std::numeric_limits<int>::max())));
+}
+
+/**
+ * @brief 商品是否可能满足搜索条件
+ *
+ * 关键词能切分出词项时要求商品文本包含全部查询词项，与全文索引的匹配规则一致，
+ * 需要核对原文的长关键词也只比较词项，模糊匹配和拼音匹配的关键词以及包括下级分类的分类条件不检查，因此结果只会更宽
+ * @param criteria 搜索条件
+ * @param product 商品对象
+ * @return 可能满足返回true，否则返回false
+ */
+bool SearchResultCache::mayMatch(const SearchCriteria& criteria, const Product& product) {
+    if (product.getProductId() == 0) {
+        return false;
+    }
+    if ((criteria.hasSellerId() && product.getSellerId() != criteria.getSellerId())
+        || (criteria.hasCategoryId() && !criteria.includesSubcategories()
+            && product.getCategoryId() != criteria.getCategoryId())
+        || (criteria.hasStatus() && product.getStatus() != criteria.getStatus())
+        || (criteria.hasLocation() && product.getLocation() != criteria.getLocation())
+        || (criteria.hasRegion() && !LocationIndex::matches(criteria.getRegion(), product.getLocation()))
+        || (criteria.hasMinPrice() && product.getPrice() < criteria.getMinPrice())
+        || (criteria.hasMaxPrice() && product.getPrice() > criteria.getMaxPrice())) {
+        return false;
+    }
+
+    const QList<QString> tags = product.getTags();
+    for (const QString& tag : criteria.getTags()) {
+        if (!tags.contains(tag)) {
+            return false;
+        }
+    }
+    for (const QString& tag : criteria.getExcludedTags()) {
+        if (tags.contains(tag)) {
+            return false;
+        }
+    }
+    if (!criteria.getAnyTags().isEmpty()) {
+        bool any = false;
+        for (const QString& tag : criteria.getAnyTags()) {
+            any = any || tags.contains(tag);
+        }
+        if (!any) {
+            return false;
+        }
+    }
+
+    if (criteria.hasKeyword() && !criteria.isFuzzy() && !criteria.isPinyinMatching()) {
+        const QString text = product.getTitle() + QLatin1Char('\n') + product.getDescription();
+        const QStringList terms = TextIndex::queryTerms(criteria.getKeyword());
+        if (terms.isEmpty()) {
+            return text.contains(criteria.getKeyword(), Qt::CaseInsensitive);
+        }
+        const QStringList tokens = TextIndex::tokenize(text);
+        for (const QString& term : terms) {
+            if (!tokens.contains(term)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 移除一条结果及其登记
+ * @param it 结果在使用顺序链表中的位置
+ */
+void SearchResultCache::erase(EntryList::iterator it) {
+    registerEntry(*it, false);
+    usage -= it->bytes;
+    byKey.remove(it->key);
+    entries.erase(it);
+}
+
+/**
+ * @brief 按结果的条件登记或注销
+ *
+ * 结果中的每个商品都登记；条件部分优先按分类登记（包括下级分类的除外），其次按一个必须包含的标签或全部“至少其一”的标签登记，
+ * 这些商品不满足时其余商品也不可能满足；按相关度排序的结果受任何变更影响，不按条件登记
+ * @param entry 缓存的结果
+ * @param add 登记为true，注销为false
+ */
+void SearchResultCache::registerEntry(const Entry& entry, bool add) {
+    auto update = [&entry, add](auto& map, const auto& key) {
+        if (add) {
+            map[key].insert(entry.key);
+            return;
+        }
+        auto it = map.find(key);
+        if (it != map.end()) {
+            it.value().remove(entry.key);
+            if (it.value().isEmpty()) {
+                map.erase(it);
+            }
+        }
+    };
+
+    for (const Product& product : entry.products) {
+        update(byProduct, product.getProductId());
+    }
+    const SearchCriteria& criteria = entry.criteria;
+    const bool ranked = criteria.getSortOrder() == SearchCriteria::SortByRelevance;
+    if (!ranked && criteria.hasCategoryId() && !criteria.includesSubcategories()) {
+        update(byCategory, criteria.getCategoryId());
+    } else if (!ranked && !criteria.getTags().isEmpty()) {
+        update(byTag, criteria.getTags().first());
+    } else if (!ranked && !criteria.getAnyTags().isEmpty()) {
+        for (const QString& tag : criteria.getAnyTags()) {
+            update(byTag, tag);
+        }
+    } else if (add) {
+        unscoped.insert(entry.key);
+    } else {
+        unscoped.remove(entry.key);
+    }
+}
+
+/**
+ * @brief 淘汰最久未使用的结果直到不超过内存预算
+ */
+void SearchResultCache::evict() {
+    while (usage > budget && !entries.empty()) {
+        erase(std::prev(entries.end()));
+    }
+}
\ No newline at end of file
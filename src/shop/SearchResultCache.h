@@ -0,0 +1,170 @@
+#ifndef SEARCHRESULTCACHE_H
+#define SEARCHRESULTCACHE_H
+
+#include "Product.h"
+#include "SearchCriteria.h"
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <list>
+
+/**
+ * @brief 搜索结果缓存类
+ *
+ * SearchResultCache按规范化的搜索条件缓存一页搜索结果，容量以估算的内存字节数计，超出预算时淘汰最久未使用的结果。
+ * 商品变更时只淘汰可能受影响的结果：结果中含有该商品的，以及变更前或变更后的商品满足其条件的。
+ * 为避免逐个检查全部结果，带分类条件的结果按分类登记，带标签条件的结果按标签登记，
+ * 变更时只检查与商品的分类、标签相关的结果和没有这两类条件的结果
+ */
+class SearchResultCache {
+public:
+    static constexpr int kDefaultMemoryBudget = 8 * 1024 * 1024; ///< 默认内存预算（字节）
+
+    /**
+     * @brief 构造函数
+     * @param memoryBudget 内存预算（字节）
+     */
+    explicit SearchResultCache(int memoryBudget = kDefaultMemoryBudget);
+
+    SearchResultCache(const SearchResultCache&) = delete;
+    SearchResultCache& operator=(const SearchResultCache&) = delete;
+
+    /**
+     * @brief 查找缓存的搜索结果，命中时将其标记为最近使用
+     * @param criteria 搜索条件
+     * @param products 输出参数，本页商品
+     * @param nextCursor 不为空时输出下一页的游标
+     * @return 命中返回true，否则返回false且不修改输出参数
+     */
+    bool lookup(const SearchCriteria& criteria, QList<Product>& products, QString* nextCursor = nullptr);
+
+    /**
+     * @brief 缓存一次搜索的结果
+     *
+     * 单个结果超过内存预算时不缓存
+     * @param criteria 搜索条件
+     * @param products 本页商品
+     * @param nextCursor 下一页的游标
+     */
+    void insert(const SearchCriteria& criteria, const QList<Product>& products, const QString& nextCursor);
+
+    /**
+     * @brief 商品变更后淘汰受影响的结果
+     *
+     * 变更前后都为默认构造的Product对象时表示批量加载或分类树变化，清空全部结果
+     * @param previous 变更前的商品，新增时为默认构造的Product对象
+     * @param current 变更后的商品，删除时为默认构造的Product对象
+     */
+    void invalidate(const Product& previous, const Product& current);
+
+    /**
+     * @brief 清空全部结果，不重置计数
+     */
+    void clear();
+
+    /**
+     * @brief 设置内存预算，超出时立即淘汰最久未使用的结果
+     * @param memoryBudget 内存预算（字节）
+     */
+    void setMemoryBudget(int memoryBudget);
+
+    /**
+     * @brief 获取内存预算
+     * @return 内存预算（字节）
+     */
+    int memoryBudget() const;
+
+    /**
+     * @brief 获取缓存的结果估算占用的内存
+     * @return 字节数
+     */
+    int memoryUsage() const;
+
+    /**
+     * @brief 获取缓存的结果数
+     * @return 结果数
+     */
+    int size() const;
+
+    /**
+     * @brief 获取命中次数
+     * @return 命中次数
+     */
+    qint64 hitCount() const;
+
+    /**
+     * @brief 获取未命中次数
+     * @return 未命中次数
+     */
+    qint64 missCount() const;
+
+    /**
+     * @brief 获取因商品变更而淘汰的结果数
+     * @return 结果数
+     */
+    qint64 invalidationCount() const;
+
+private:
+    /**
+     * @brief 一条缓存的搜索结果
+     */
+    struct Entry {
+        QString key;             ///< 规范化的搜索条件
+        SearchCriteria criteria; ///< 搜索条件
+        QList<Product> products; ///< 本页商品
+        QString nextCursor;      ///< 下一页的游标
+        int bytes;               ///< 估算占用的内存
+    };
+
+    using EntryList = std::list<Entry>;
+
+    /**
+     * @brief 估算一条结果占用的内存
+     * @param entry 缓存的结果
+     * @return 字节数
+     */
+    static int estimateBytes(const Entry& entry);
+
+    /**
+     * @brief 商品是否可能满足搜索条件
+     *
+     * 关键词按全文索引的词项比较，结果只会比实际搜索宽，不会漏掉受影响的结果
+     * @param criteria 搜索条件
+     * @param product 商品对象
+     * @return 可能满足返回true，否则返回false
+     */
+    static bool mayMatch(const SearchCriteria& criteria, const Product& product);
+
+    /**
+     * @brief 移除一条结果及其登记
+     * @param it 结果在使用顺序链表中的位置
+     */
+    void erase(EntryList::iterator it);
+
+    /**
+     * @brief 按结果的条件登记或注销
+     * @param entry 缓存的结果
+     * @param add 登记为true，注销为false
+     */
+    void registerEntry(const Entry& entry, bool add);
+
+    /**
+     * @brief 淘汰最久未使用的结果直到不超过内存预算
+     */
+    void evict();
+
+    int budget;                                ///< 内存预算（字节）
+    int usage;                                 ///< 已用内存（字节）
+    qint64 hits;                               ///< 命中次数
+    qint64 misses;                             ///< 未命中次数
+    qint64 invalidations;                      ///< 因商品变更而淘汰的结果数
+    EntryList entries;                         ///< 全部结果，最近使用的在前
+    QHash<QString, EntryList::iterator> byKey; ///< 规范化的搜索条件到结果的映射
+    QHash<int, QSet<QString>> byProduct;       ///< 商品ID到结果中含有该商品的键
+    QHash<int, QSet<QString>> byCategory;      ///< 分类ID到带该分类条件的键
+    QHash<QString, QSet<QString>> byTag;       ///< 标签到带该标签条件的键
+    QSet<QString> unscoped;                    ///< 没有分类和标签条件的键
+};
+
+#endif // SEARCHRESULTCACHE_H
\ No newline at end of file
@@ -0,0 +1,407 @@
+#include "SlotBitmap.h"
+#include <QtAlgorithms>
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+const int ArrayLimit = 4096; ///< 数组容器的最大元素个数
+const int WordCount = 1024;  ///< 位图容器的64位字数
+
+/**
+ * @brief 统计一组字中置位的个数
+ * @param words 位图的字
+ * @return 置位个数
+ */
+int countBits(const QVector<quint64>& words) {
+    int count = 0;
+    for (quint64 word : words) {
+        count += int(qPopulationCount(word));
+    }
+    return count;
+}
+
+} // namespace
+
+/**
+ * @brief 是否为位图容器
+ * @return 是返回true，否则返回false
+ */
+bool SlotBitmap::Container::isBitmap() const {
+    return !words.isEmpty();
+}
+
+/**
+ * @brief 是否包含低16位
+ * @param low 低16位
+ * @return 包含返回true，否则返回false
+ */
+bool SlotBitmap::Container::contains(quint16 low) const {
+    if (isBitmap()) {
+        return (words.at(low >> 6) >> (low & 63)) & 1;
+    }
+    return std::binary_search(array.cbegin(), array.cend(), low);
+}
+
+/**
+ * @brief 按元素个数选择数组或位图表示
+ */
+void SlotBitmap::Container::normalize() {
+    if (isBitmap() && cardinality <= ArrayLimit) {
+        toArray();
+    } else if (!isBitmap() && cardinality > ArrayLimit) {
+        toBitmap();
+    }
+}
+
+/**
+ * @brief 转为位图表示
+ */
+void SlotBitmap::Container::toBitmap() {
+    words = QVector<quint64>(WordCount, 0);
+    for (quint16 low : array) {
+        words[low >> 6] |= quint64(1) << (low & 63);
+    }
+    array.clear();
+    array.squeeze();
+}
+
+/**
+ * @brief 转为数组表示
+ */
+void SlotBitmap::Container::toArray() {
+    array.clear();
+    array.reserve(cardinality);
+    for (int i = 0; i < words.size(); ++i) {
+        quint64 word = words.at(i);
+        while (word) {
+            array.append(quint16(i * 64 + int(qCountTrailingZeroBits(word))));
+            word &= word - 1;
+        }
+    }
+    words.clear();
+    words.squeeze();
+}
+
+/**
+ * @brief SlotBitmap默认构造函数
+ */
+SlotBitmap::SlotBitmap() : total(0) {
+}
+
+/**
+ * @brief 加入一个槽位
+ * @param slot 槽位号
+ * @return 原来不存在返回true，否则返回false
+ */
+bool SlotBitmap::add(quint32 slot) {
+    const quint16 key = quint16(slot >> 16);
+    const quint16 low = quint16(slot & 0xFFFF);
+    int index = findContainer(key);
+    if (index < 0) {
+        index = -index - 1;
+        Container container;
+        container.key = key;
+        container.cardinality = 0;
+        containers.insert(index, container);
+    }
+
+    Container& container = containers[index];
+    if (container.isBitmap()) {
+        quint64& word = container.words[low >> 6];
+        const quint64 bit = quint64(1) << (low & 63);
+        if (word & bit) {
+            return false;
+        }
+        word |= bit;
+    } else {
+        auto it = std::lower_bound(container.array.begin(), container.array.end(), low);
+        if (it != container.array.end() && *it == low) {
+            return false;
+        }
+        container.array.insert(it, low);
+    }
+    ++container.cardinality;
+    ++total;
+    container.normalize();
+    return true;
+}
+
+/**
+ * @brief 移除一个槽位，容器为空时删除容器
+ * @param slot 槽位号
+ * @return 原来存在返回true，否则返回false
+ */
+bool SlotBitmap::remove(quint32 slot) {
+    const int index = findContainer(quint16(slot >> 16));
+    if (index < 0) {
+        return false;
+    }
+
+    const quint16 low = quint16(slot & 0xFFFF);
+    Container& container = containers[index];
+    if (container.isBitmap()) {
+        quint64& word = container.words[low >> 6];
+        const quint64 bit = quint64(1) << (low & 63);
+        if (!(word & bit)) {
+            return false;
+        }
+        word &= ~bit;
+    } else {
+        auto it = std::lower_bound(container.array.begin(), container.array.end(), low);
+        if (it == container.array.end() || *it != low) {
+            return false;
+        }
+        container.array.erase(it);
+    }
+    --container.cardinality;
+    --total;
+    if (container.cardinality == 0) {
+        containers.remove(index);
+    } else {
+        container.normalize();
+    }
+    return true;
+}
+
+/**
+ * @brief 是否包含指定槽位
+ * @param slot 槽位号
+ * @return 包含返回true，否则返回false
+ */
+bool SlotBitmap::contains(quint32 slot) const {
+    const int index = findContainer(quint16(slot >> 16));
+    return index >= 0 && containers.at(index).contains(quint16(slot & 0xFFFF));
+}
+
+/**
+ * @brief 获取槽位数
+ * @return 槽位数
+ */
+int SlotBitmap::cardinality() const {
+    return total;
+}
+
+/**
+ * @brief 位图是否为空
+ * @return 为空返回true，否则返回false
+ */
+bool SlotBitmap::isEmpty() const {
+    return total == 0;
+}
+
+/**
+ * @brief 取出全部槽位
+ * @return 升序排列的槽位号
+ */
+QVector<quint32> SlotBitmap::toVector() const {
+    QVector<quint32> result;
+    result.reserve(total);
+    for (const Container& container : containers) {
+        const quint32 high = quint32(container.key) << 16;
+        if (!container.isBitmap()) {
+            for (quint16 low : container.array) {
+                result.append(high | low);
+            }
+            continue;
+        }
+        for (int i = 0; i < container.words.size(); ++i) {
+            quint64 word = container.words.at(i);
+            while (word) {
+                result.append(high | quint32(i * 64 + int(qCountTrailingZeroBits(word))));
+                word &= word - 1;
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief 获取位图占用的字节数
+ * @return 字节数
+ */
+int SlotBitmap::byteSize() const {
+    int bytes = containers.size() * int(sizeof(Container));
+    for (const Container& container : containers) {
+        bytes += container.array.size() * int(sizeof(quint16)) + container.words.size() * int(sizeof(quint64));
+    }
+    return bytes;
+}
+
+/**
+ * @brief 求交集，只有两边都有的容器才需要计算
+ * @param a 位图
+ * @param b 位图
+ * @return 同时在a和b中的槽位
+ */
+SlotBitmap SlotBitmap::intersect(const SlotBitmap& a, const SlotBitmap& b) {
+    SlotBitmap result;
+    int i = 0;
+    int j = 0;
+    while (i < a.containers.size() && j < b.containers.size()) {
+        const Container& left = a.containers.at(i);
+        const Container& right = b.containers.at(j);
+        if (left.key < right.key) {
+            ++i;
+        } else if (right.key < left.key) {
+            ++j;
+        } else {
+            Container container = combine(left, right, Operation::Intersect);
+            if (container.cardinality > 0) {
+                result.total += container.cardinality;
+                result.containers.append(container);
+            }
+            ++i;
+            ++j;
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief 求并集
+ * @param a 位图
+ * @param b 位图
+ * @return 在a或b中的槽位
+ */
+SlotBitmap SlotBitmap::unite(const SlotBitmap& a, const SlotBitmap& b) {
+    SlotBitmap result;
+    int i = 0;
+    int j = 0;
+    while (i < a.containers.size() || j < b.containers.size()) {
+        if (j == b.containers.size() || (i < a.containers.size() && a.containers.at(i).key < b.containers.at(j).key)) {
+            result.containers.append(a.containers.at(i++));
+        } else if (i == a.containers.size() || b.containers.at(j).key < a.containers.at(i).key) {
+            result.containers.append(b.containers.at(j++));
+        } else {
+            result.containers.append(combine(a.containers.at(i++), b.containers.at(j++), Operation::Unite));
+        }
+        result.total += result.containers.last().cardinality;
+    }
+    return result;
+}
+
+/**
+ * @brief 求差集
+ * @param a 位图
+ * @param b 位图
+ * @return 在a中但不在b中的槽位
+ */
+SlotBitmap SlotBitmap::subtract(const SlotBitmap& a, const SlotBitmap& b) {
+    SlotBitmap result;
+    int j = 0;
+    for (const Container& left : a.containers) {
+        while (j < b.containers.size() && b.containers.at(j).key < left.key) {
+            ++j;
+        }
+        Container container = j < b.containers.size() && b.containers.at(j).key == left.key
+                                  ? combine(left, b.containers.at(j), Operation::Subtract)
+                                  : left;
+        if (container.cardinality > 0) {
+            result.total += container.cardinality;
+            result.containers.append(container);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief 查找键对应的容器下标
+ * @param key 高16位
+ * @return 找到时返回下标，否则返回应插入位置取负再减一
+ */
+int SlotBitmap::findContainer(quint16 key) const {
+    auto it = std::lower_bound(containers.cbegin(), containers.cend(), key, [](const Container& container, quint16 value) {
+        return container.key < value;
+    });
+    const int index = int(it - containers.cbegin());
+    if (it != containers.cend() && it->key == key) {
+        return index;
+    }
+    return -index - 1;
+}
+
+/**
+ * @brief 对两个键相同的容器做集合运算
+ *
+ * 两个位图容器按字计算；含数组容器时遍历数组并探测另一边，耗时与数组长度成正比
+ * @param a 容器
+ * @param b 容器
+ * @param operation 集合运算
+ * @return 运算结果
+ */
+SlotBitmap::Container SlotBitmap::combine(const Container& a, const Container& b, Operation operation) {
+    Container result;
+    result.key = a.key;
+    result.cardinality = 0;
+
+    if (a.isBitmap() && b.isBitmap()) {
+        result.words = QVector<quint64>(WordCount, 0);
+        for (int i = 0; i < WordCount; ++i) {
+            const quint64 left = a.words.at(i);
+            const quint64 right = b.words.at(i);
+            switch (operation) {
+            case Operation::Intersect:
+                result.words[i] = left & right;
+                break;
+            case Operation::Unite:
+                result.words[i] = left | right;
+                break;
+            case Operation::Subtract:
+                result.words[i] = left & ~right;
+                break;
+            }
+        }
+        result.cardinality = countBits(result.words);
+        result.normalize();
+        return result;
+    }
+
+    switch (operation) {
+    case Operation::Intersect: {
+        // 遍历较小的数组容器，探测另一边
+        const Container& small = a.isBitmap() ? b : a;
+        const Container& other = a.isBitmap() ? a : b;
+        for (quint16 low : small.array) {
+            if (other.contains(low)) {
+                result.array.append(low);
+            }
+        }
+        result.cardinality = result.array.size();
+        break;
+    }
+    case Operation::Unite:
+        if (a.isBitmap() || b.isBitmap()) {
+            const Container& bitmap = a.isBitmap() ? a : b;
+            const Container& array = a.isBitmap() ? b : a;
+            result.words = bitmap.words;
+            for (quint16 low : array.array) {
+                result.words[low >> 6] |= quint64(1) << (low & 63);
+            }
+            result.cardinality = countBits(result.words);
+        } else {
+            std::set_union(a.array.cbegin(), a.array.cend(), b.array.cbegin(), b.array.cend(),
+                           std::back_inserter(result.array));
+            result.cardinality = result.array.size();
+        }
+        break;
+    case Operation::Subtract:
+        if (a.isBitmap()) {
+            result.words = a.words;
+            for (quint16 low : b.array) {
+                result.words[low >> 6] &= ~(quint64(1) << (low & 63));
+            }
+            result.cardinality = countBits(result.words);
+        } else {
+            for (quint16 low : a.array) {
+                if (!b.contains(low)) {
+                    result.array.append(low);
+                }
+            }
+            result.cardinality = result.array.size();
+        }
+        break;
+    }
+    result.normalize();
+    return result;
+}
\ No newline at end of file
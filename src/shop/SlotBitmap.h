@@ -0,0 +1,158 @@
+#ifndef SLOTBITMAP_H
+#define SLOTBITMAP_H
+
+#include <QVector>
+
+/**
+ * @brief 压缩槽位位图类
+ *
+ * SlotBitmap按Roaring位图的思路保存槽位号集合：槽位号的高16位选出一个容器，
+ * 容器内元素不超过4096个时用有序的16位数组保存，超过后换成65536位的位图。
+ * 稀疏集合每个元素约占2字节，稠密集合每个元素不到1位，
+ * 位图容器之间的交、并、差按64位字逐字计算。元素个数随增删维护，读取为O(1)
+ */
+class SlotBitmap {
+public:
+    /**
+     * @brief 默认构造函数，创建空位图
+     */
+    SlotBitmap();
+
+    /**
+     * @brief 加入一个槽位
+     * @param slot 槽位号
+     * @return 原来不存在返回true，否则返回false
+     */
+    bool add(quint32 slot);
+
+    /**
+     * @brief 移除一个槽位
+     * @param slot 槽位号
+     * @return 原来存在返回true，否则返回false
+     */
+    bool remove(quint32 slot);
+
+    /**
+     * @brief 是否包含指定槽位
+     * @param slot 槽位号
+     * @return 包含返回true，否则返回false
+     */
+    bool contains(quint32 slot) const;
+
+    /**
+     * @brief 获取槽位数
+     * @return 槽位数
+     */
+    int cardinality() const;
+
+    /**
+     * @brief 位图是否为空
+     * @return 为空返回true，否则返回false
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief 取出全部槽位
+     * @return 升序排列的槽位号
+     */
+    QVector<quint32> toVector() const;
+
+    /**
+     * @brief 获取位图占用的字节数（不含对象本身）
+     * @return 字节数
+     */
+    int byteSize() const;
+
+    /**
+     * @brief 求交集
+     * @param a 位图
+     * @param b 位图
+     * @return 同时在a和b中的槽位
+     */
+    static SlotBitmap intersect(const SlotBitmap& a, const SlotBitmap& b);
+
+    /**
+     * @brief 求并集
+     * @param a 位图
+     * @param b 位图
+     * @return 在a或b中的槽位
+     */
+    static SlotBitmap unite(const SlotBitmap& a, const SlotBitmap& b);
+
+    /**
+     * @brief 求差集
+     * @param a 位图
+     * @param b 位图
+     * @return 在a中但不在b中的槽位
+     */
+    static SlotBitmap subtract(const SlotBitmap& a, const SlotBitmap& b);
+
+private:
+    /**
+     * @brief 集合运算
+     */
+    enum class Operation {
+        Intersect, ///< 交集
+        Unite,     ///< 并集
+        Subtract   ///< 差集
+    };
+
+    /**
+     * @brief 容器，保存高16位相同的槽位的低16位
+     */
+    struct Container {
+        quint16 key;            ///< 槽位号的高16位
+        int cardinality;        ///< 元素个数
+        QVector<quint16> array; ///< 数组容器的元素，升序
+        QVector<quint64> words; ///< 位图容器的1024个字，为空表示数组容器
+
+        /**
+         * @brief 是否为位图容器
+         * @return 是返回true，否则返回false
+         */
+        bool isBitmap() const;
+
+        /**
+         * @brief 是否包含低16位
+         * @param low 低16位
+         * @return 包含返回true，否则返回false
+         */
+        bool contains(quint16 low) const;
+
+        /**
+         * @brief 按元素个数选择数组或位图表示
+         */
+        void normalize();
+
+        /**
+         * @brief 转为位图表示
+         */
+        void toBitmap();
+
+        /**
+         * @brief 转为数组表示
+         */
+        void toArray();
+    };
+
+    /**
+     * @brief 查找键对应的容器下标
+     * @param key 高16位
+     * @return 找到时返回下标，否则返回应插入位置取负再减一
+     */
+    int findContainer(quint16 key) const;
+
+    /**
+     * @brief 对两个容器做集合运算
+     * @param a 容器
+     * @param b 容器
+     * @param operation 集合运算
+     * @return 运算结果
+     */
+    static Container combine(const Container& a, const Container& b, Operation operation);
+
+    QVector<Container> containers; ///< 按键升序排列的容器
+    int total;                     ///< 全部元素个数
+};
+
+#endif // SLOTBITMAP_H
\ No newline at end of file
@@ -0,0 +1,446 @@
+#include "SqliteProductStore.h"
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSqlError>
+#include <QVariant>
+#include <QDebug>
+
+namespace {
+
+/// 查询商品时的列顺序，与productFromQuery()一致
+const char* const kColumns =
+    "productId, title, categoryId, description, price, sellerId, location, tags, publicTime, status";
+
+/**
+ * @brief 把标签列表编码为紧凑JSON数组
+ * @param tags 标签列表
+ * @return JSON文本
+ */
+QString encodeTags(const QList<QString>& tags) {
+    QJsonArray array;
+    for (const QString& tag : tags) {
+        array.append(tag);
+    }
+    return QString::fromUtf8(QJsonDocument(array).toJson(QJsonDocument::Compact));
+}
+
+/**
+ * @brief 从JSON数组文本解码标签列表
+ * @param text JSON文本
+ * @return 标签列表
+ */
+QList<QString> decodeTags(const QString& text) {
+    QList<QString> tags;
+    const QJsonArray array = QJsonDocument::fromJson(text.toUtf8()).array();
+    for (const QJsonValue& value : array) {
+        tags.append(value.toString());
+    }
+    return tags;
+}
+
+} // namespace
+
+/**
+ * @brief SqliteProductStore构造函数
+ * @param databaseFile 数据库文件路径
+ */
+SqliteProductStore::SqliteProductStore(const QString& databaseFile)
+    : connectionName(QString("products-%1").arg(reinterpret_cast<quintptr>(this))),
+      inTransaction(false) {
+    db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    db.setDatabaseName(databaseFile);
+}
+
+/**
+ * @brief SqliteProductStore析构函数
+ *
+ * 未提交的变更由ProductRepository在析构时flush()，这里只回滚残留的事务
+ */
+SqliteProductStore::~SqliteProductStore() {
+    if (inTransaction) {
+        db.rollback();
+    }
+    // 连接被移除前必须释放全部查询和数据库句柄
+    upsertQuery.reset();
+    deleteQuery.reset();
+    selectQuery.reset();
+    existsQuery.reset();
+    sellerQuery.reset();
+    db.close();
+    db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+/**
+ * @brief 打开数据库，按需建表和索引
+ * @return 数据库中已有商品返回true，否则返回false
+ */
+bool SqliteProductStore::load() {
+    if (!db.isOpen() && !db.open()) {
+        qDebug() << "Cannot open database:" << db.databaseName() << db.lastError().text();
+        return false;
+    }
+    if (!prepareSchema()) {
+        return false;
+    }
+    return count() > 0;
+}
+
+/**
+ * @brief 建表、建索引并预编译语句
+ * @return 成功返回true，否则返回false
+ */
+bool SqliteProductStore::prepareSchema() {
+    const char* const statements[] = {
+        "CREATE TABLE IF NOT EXISTS products ("
+        "productId INTEGER PRIMARY KEY, title TEXT NOT NULL, categoryId INTEGER NOT NULL, "
+        "description TEXT NOT NULL, price REAL NOT NULL, sellerId INTEGER NOT NULL, "
+        "location TEXT NOT NULL, tags TEXT NOT NULL, publicTime TEXT NOT NULL, status TEXT NOT NULL)",
+        "CREATE INDEX IF NOT EXISTS products_sellerId ON products(sellerId)",
+        "CREATE INDEX IF NOT EXISTS products_categoryId ON products(categoryId)",
+        "CREATE INDEX IF NOT EXISTS products_price ON products(price)",
+        "CREATE TABLE IF NOT EXISTS categories ("
+        "id INTEGER PRIMARY KEY, name TEXT NOT NULL, parentId INTEGER NOT NULL, "
+        "low INTEGER NOT NULL, high INTEGER NOT NULL)",
+    };
+
+    QSqlQuery query(db);
+    for (const char* statement : statements) {
+        if (!query.exec(statement)) {
+            qDebug() << "Cannot create schema:" << query.lastError().text();
+            return false;
+        }
+    }
+
+    upsertQuery.reset(new QSqlQuery(db));
+    deleteQuery.reset(new QSqlQuery(db));
+    selectQuery.reset(new QSqlQuery(db));
+    existsQuery.reset(new QSqlQuery(db));
+    sellerQuery.reset(new QSqlQuery(db));
+    bool ok = upsertQuery->prepare(QString("INSERT OR REPLACE INTO products (%1) "
+                                           "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)").arg(kColumns))
+              && deleteQuery->prepare("DELETE FROM products WHERE productId = ?")
+              && selectQuery->prepare(QString("SELECT %1 FROM products WHERE productId = ?").arg(kColumns))
+              && existsQuery->prepare("SELECT 1 FROM products WHERE productId = ?")
+              && sellerQuery->prepare(QString("SELECT %1 FROM products WHERE sellerId = ? "
+                                              "ORDER BY productId").arg(kColumns));
+    if (!ok) {
+        qDebug() << "Cannot prepare statements:" << db.lastError().text();
+    }
+    return ok;
+}
+
+/**
+ * @brief 在第一个未提交的变更之前开启事务
+ * @return 成功返回true，否则返回false
+ */
+bool SqliteProductStore::beginTransaction() {
+    if (!upsertQuery) {
+        return false;
+    }
+    if (!inTransaction) {
+        inTransaction = db.transaction();
+    }
+    return inTransaction;
+}
+
+/**
+ * @brief 把当前结果行解码为商品
+ * @param query 已定位到结果行的查询
+ * @return 商品对象
+ */
+Product SqliteProductStore::productFromQuery(const QSqlQuery& query) {
+    return Product(query.value(0).toInt(), query.value(1).toString(), query.value(2).toInt(),
+                   query.value(3).toString(), query.value(4).toDouble(), query.value(5).toInt(),
+                   query.value(6).toString(), decodeTags(query.value(7).toString()),
+                   QDateTime::fromString(query.value(8).toString(), Qt::ISODate),
+                   query.value(9).toString());
+}
+
+/**
+ * @brief 存储中是否存在指定商品
+ * @param productId 商品ID
+ * @return 存在返回true，否则返回false
+ */
+bool SqliteProductStore::contains(int productId) const {
+    if (!existsQuery) {
+        return false;
+    }
+
+    existsQuery->addBindValue(productId);
+    bool found = existsQuery->exec() && existsQuery->next();
+    existsQuery->finish();
+    return found;
+}
+
+/**
+ * @brief 按主键查找商品
+ * @param productId 商品ID
+ * @return 商品对象，未找到时返回默认构造的Product对象
+ */
+Product SqliteProductStore::find(int productId) const {
+    if (!selectQuery) {
+        return Product();
+    }
+
+    selectQuery->addBindValue(productId);
+    Product product;
+    if (selectQuery->exec() && selectQuery->next()) {
+        product = productFromQuery(*selectQuery);
+    }
+    // 结束语句，否则未读完的查询会阻止事务提交
+    selectQuery->finish();
+    return product;
+}
+
+/**
+ * @brief 按ID顺序依次访问每个商品
+ * @param visit 访问回调
+ */
+void SqliteProductStore::forEach(const std::function<void(const Product&)>& visit) const {
+    if (!db.isOpen()) {
+        return;
+    }
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!query.exec(QString("SELECT %1 FROM products ORDER BY productId").arg(kColumns))) {
+        qDebug() << "Cannot read products:" << query.lastError().text();
+        return;
+    }
+    while (query.next()) {
+        visit(productFromQuery(query));
+    }
+}
+
+/**
+ * @brief 通过sellerId索引查找卖家的商品
+ * @param sellerId 卖家ID
+ * @return 商品列表
+ */
+QList<Product> SqliteProductStore::findBySellerId(int sellerId) const {
+    QList<Product> result;
+    if (!sellerQuery) {
+        return result;
+    }
+
+    sellerQuery->addBindValue(sellerId);
+    if (sellerQuery->exec()) {
+        while (sellerQuery->next()) {
+            result.append(productFromQuery(*sellerQuery));
+        }
+    }
+    sellerQuery->finish();
+    return result;
+}
+
+/**
+ * @brief find()能否在多个线程中同时调用
+ * @return false
+ */
+bool SqliteProductStore::supportsConcurrentFind() const {
+    return false;
+}
+
+/**
+ * @brief 获取存储中的商品数
+ * @return 商品数
+ */
+int SqliteProductStore::count() const {
+    if (!db.isOpen()) {
+        return 0;
+    }
+
+    QSqlQuery query(db);
+    if (query.exec("SELECT COUNT(*) FROM products") && query.next()) {
+        return query.value(0).toInt();
+    }
+    return 0;
+}
+
+/**
+ * @brief 获取存储中的最大商品ID
+ * @return 最大商品ID，存储为空时返回0
+ */
+int SqliteProductStore::maxProductId() const {
+    if (!db.isOpen()) {
+        return 0;
+    }
+
+    QSqlQuery query(db);
+    if (query.exec("SELECT MAX(productId) FROM products") && query.next()) {
+        return query.value(0).toInt();
+    }
+    return 0;
+}
+
+/**
+ * @brief 插入或替换一行
+ * @param product 已分配ID的商品对象
+ * @return 保存成功返回true，否则返回false
+ */
+bool SqliteProductStore::save(const Product& product) {
+    if (!beginTransaction()) {
+        return false;
+    }
+
+    upsertQuery->addBindValue(product.getProductId());
+    upsertQuery->addBindValue(product.getTitle());
+    upsertQuery->addBindValue(product.getCategoryId());
+    upsertQuery->addBindValue(product.getDescription());
+    upsertQuery->addBindValue(product.getPrice());
+    upsertQuery->addBindValue(product.getSellerId());
+    upsertQuery->addBindValue(product.getLocation());
+    upsertQuery->addBindValue(encodeTags(product.getTags()));
+    upsertQuery->addBindValue(product.getPublicTime().toString(Qt::ISODate));
+    upsertQuery->addBindValue(product.getStatus());
+    if (!upsertQuery->exec()) {
+        qDebug() << "Cannot save product:" << upsertQuery->lastError().text();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 删除一行
+ * @param productId 商品ID
+ * @return 删除成功返回true，商品不存在或删除失败返回false
+ */
+bool SqliteProductStore::remove(int productId) {
+    if (!beginTransaction()) {
+        return false;
+    }
+
+    deleteQuery->addBindValue(productId);
+    if (!deleteQuery->exec()) {
+        qDebug() << "Cannot remove product:" << deleteQuery->lastError().text();
+        return false;
+    }
+    return deleteQuery->numRowsAffected() > 0;
+}
+
+/**
+ * @brief 在一个事务中批量导入商品
+ *
+ * 先提交此前未提交的变更，导入失败时回滚的只是本次导入，不会在之后的提交中留下导入了一半的商品
+ * @param loaded 导入的商品
+ * @return 导入成功返回true，否则返回false
+ */
+bool SqliteProductStore::import(QHash<int, Product>& loaded) {
+    if (!commit()) {
+        return false;
+    }
+    for (auto it = loaded.constBegin(); it != loaded.constEnd(); ++it) {
+        if (!save(it.value())) {
+            rollback();
+            return false;
+        }
+    }
+    return commit();
+}
+
+/**
+ * @brief 提交当前事务
+ * @return 没有未提交的事务或提交成功返回true，否则返回false
+ */
+bool SqliteProductStore::commit() {
+    if (!inTransaction) {
+        return true;
+    }
+
+    if (!db.commit()) {
+        qDebug() << "Cannot commit transaction:" << db.lastError().text();
+        return false;
+    }
+    inTransaction = false;
+    return true;
+}
+
+/**
+ * @brief 回滚当前事务
+ */
+void SqliteProductStore::rollback() {
+    if (inTransaction) {
+        db.rollback();
+        inTransaction = false;
+    }
+}
+
+/**
+ * @brief 提交未完成的事务
+ * @return 提交成功返回true，否则返回false
+ */
+bool SqliteProductStore::checkpoint() {
+    return commit();
+}
+
+/**
+ * @brief 按先序读取categories表
+ *
+ * 按区间起点排序即为先序，与CategoryTree::toJson()的顺序一致
+ * @return 分类树的JSON数组
+ */
+QJsonArray SqliteProductStore::loadCategories() const {
+    QJsonArray categories;
+    if (!db.isOpen()) {
+        return categories;
+    }
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT id, name, parentId, low, high FROM categories ORDER BY low")) {
+        qDebug() << "Cannot read categories:" << query.lastError().text();
+        return categories;
+    }
+    while (query.next()) {
+        QJsonObject object;
+        object["id"] = query.value(0).toInt();
+        object["name"] = query.value(1).toString();
+        object["parentId"] = query.value(2).toInt();
+        object["low"] = QString::number(query.value(3).toLongLong());
+        object["high"] = QString::number(query.value(4).toLongLong());
+        categories.append(object);
+    }
+    return categories;
+}
+
+/**
+ * @brief 在一个事务中替换categories表的全部行并提交
+ *
+ * 先提交此前未提交的商品变更，写出失败时回滚，categories表保持原样
+ * @param categories 分类树的JSON数组
+ * @return 写出成功返回true，否则返回false
+ */
+bool SqliteProductStore::saveCategories(const QJsonArray& categories) {
+    if (!commit() || !beginTransaction()) {
+        return false;
+    }
+
+    QSqlQuery query(db);
+    if (!query.exec("DELETE FROM categories")) {
+        qDebug() << "Cannot save categories:" << query.lastError().text();
+        rollback();
+        return false;
+    }
+    if (!query.prepare("INSERT INTO categories (id, name, parentId, low, high) VALUES (?, ?, ?, ?, ?)")) {
+        qDebug() << "Cannot save categories:" << query.lastError().text();
+        rollback();
+        return false;
+    }
+    for (const QJsonValue& value : categories) {
+        const QJsonObject object = value.toObject();
+        query.addBindValue(object["id"].toInt());
+        query.addBindValue(object["name"].toString());
+        query.addBindValue(object["parentId"].toInt());
+        query.addBindValue(object["low"].toString().toLongLong());
+        query.addBindValue(object["high"].toString().toLongLong());
+        if (!query.exec()) {
+            qDebug() << "Cannot save categories:" << query.lastError().text();
+            rollback();
+            return false;
+        }
+    }
+    return commit();
+}
\ No newline at end of file
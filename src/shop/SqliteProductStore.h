@@ -0,0 +1,119 @@
+#ifndef SQLITEPRODUCTSTORE_H
+#define SQLITEPRODUCTSTORE_H
+
+#include "ProductStore.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <memory>
+
+/**
+ * @brief 基于SQLite的商品存储后端
+ *
+ * SqliteProductStore通过QtSql把商品逐行保存在嵌入式SQLite数据库中，
+ * sellerId、categoryId和price列上建有索引。所有读写都使用预编译语句，
+ * 单个商品的增删改只是一次B树上的O(log n)操作，商品不必全部常驻内存。
+ * 分类树逐行保存在同一数据库的categories表中。
+ * 两次commit()之间的变更处于同一个事务中，组提交的一批变更对应一次事务提交
+ */
+class SqliteProductStore : public ProductStore {
+public:
+    /**
+     * @brief 构造函数
+     * @param databaseFile 数据库文件路径
+     */
+    explicit SqliteProductStore(const QString& databaseFile);
+
+    /**
+     * @brief 析构函数，回滚未提交的事务并关闭数据库连接
+     */
+    ~SqliteProductStore() override;
+
+    SqliteProductStore(const SqliteProductStore&) = delete;
+    SqliteProductStore& operator=(const SqliteProductStore&) = delete;
+
+    /**
+     * @brief 打开数据库，按需建表和索引
+     * @return 数据库中已有商品返回true，否则返回false
+     */
+    bool load() override;
+    bool contains(int productId) const override;
+    Product find(int productId) const override;
+
+    /**
+     * @brief 数据库连接和预编译语句只能在创建它们的线程中使用
+     * @return false
+     */
+    bool supportsConcurrentFind() const override;
+    void forEach(const std::function<void(const Product&)>& visit) const override;
+
+    /**
+     * @brief 通过sellerId索引查找卖家的商品
+     * @param sellerId 卖家ID
+     * @return 商品列表
+     */
+    QList<Product> findBySellerId(int sellerId) const override;
+    int count() const override;
+    int maxProductId() const override;
+    bool save(const Product& product) override;
+    bool remove(int productId) override;
+    bool import(QHash<int, Product>& loaded) override;
+    bool commit() override;
+
+    /**
+     * @brief 提交未完成的事务
+     *
+     * 数据库本身已是全量形式，检查点只需提交事务
+     * @return 提交成功返回true，否则返回false
+     */
+    bool checkpoint() override;
+
+    /**
+     * @brief 按先序读取categories表
+     * @return 分类树的JSON数组
+     */
+    QJsonArray loadCategories() const override;
+
+    /**
+     * @brief 在一个事务中替换categories表的全部行并提交
+     * @param categories 分类树的JSON数组
+     * @return 写出成功返回true，否则返回false
+     */
+    bool saveCategories(const QJsonArray& categories) override;
+
+private:
+    /**
+     * @brief 建表、建索引并预编译语句
+     * @return 成功返回true，否则返回false
+     */
+    bool prepareSchema();
+
+    /**
+     * @brief 在第一个未提交的变更之前开启事务
+     * @return 成功返回true，否则返回false
+     */
+    bool beginTransaction();
+
+    /**
+     * @brief 回滚当前事务，丢弃其中全部未提交的变更
+     */
+    void rollback();
+
+    /**
+     * @brief 把当前结果行解码为商品
+     * @param query 已定位到结果行的查询，列顺序与kColumns一致
+     * @return 商品对象
+     */
+    static Product productFromQuery(const QSqlQuery& query);
+
+    QString connectionName;                     ///< QtSql连接名
+    QSqlDatabase db;                            ///< 数据库连接
+    bool inTransaction;                         ///< 是否有未提交的事务
+    std::unique_ptr<QSqlQuery> upsertQuery;     ///< 预编译的插入或替换语句
+    std::unique_ptr<QSqlQuery> deleteQuery;     ///< 预编译的删除语句
+    std::unique_ptr<QSqlQuery> selectQuery;     ///< 预编译的按ID查询语句
+    std::unique_ptr<QSqlQuery> existsQuery;     ///< 预编译的按ID判断存在的语句
+    std::unique_ptr<QSqlQuery> sellerQuery;     ///< 预编译的按卖家查询语句
+};
+
+#endif // SQLITEPRODUCTSTORE_H
\ No newline at end of file
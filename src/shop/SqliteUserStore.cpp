@@ -0,0 +1,115 @@
+#include "SqliteUserStore.h"
+#include "UserRepository.h"
+#include <QJsonObject>
+#include <QSqlError>
+#include <QVariant>
+#include <QDebug>
+
+/**
+ * @brief SqliteUserStore构造函数
+ * @param databaseFile 数据库文件路径
+ */
+SqliteUserStore::SqliteUserStore(const QString& databaseFile)
+    : connectionName(QString("users-%1").arg(reinterpret_cast<quintptr>(this))),
+      inTransaction(false) {
+    db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    db.setDatabaseName(databaseFile);
+}
+
+/**
+ * @brief SqliteUserStore析构函数
+ */
+SqliteUserStore::~SqliteUserStore() {
+    if (inTransaction) {
+        db.rollback();
+    }
+    // 连接被移除前必须释放全部查询和数据库句柄
+    upsertQuery.reset();
+    db.close();
+    db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+/**
+ * @brief 打开数据库，按需建表，并逐个创建已保存的用户
+ * @param onUser 每创建一个用户调用一次
+ * @return 加载成功返回true，否则返回false
+ */
+bool SqliteUserStore::load(const std::function<void(User*)>& onUser) {
+    if (!db.isOpen() && !db.open()) {
+        qDebug() << "Cannot open database:" << db.databaseName() << db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(db);
+    if (!query.exec("CREATE TABLE IF NOT EXISTS users ("
+                    "userId INTEGER PRIMARY KEY, roleId INTEGER NOT NULL, "
+                    "username TEXT NOT NULL, password TEXT NOT NULL)")) {
+        qDebug() << "Cannot create schema:" << query.lastError().text();
+        return false;
+    }
+
+    upsertQuery.reset(new QSqlQuery(db));
+    if (!upsertQuery->prepare("INSERT OR REPLACE INTO users (userId, roleId, username, password) "
+                              "VALUES (?, ?, ?, ?)")) {
+        qDebug() << "Cannot prepare statements:" << upsertQuery->lastError().text();
+        return false;
+    }
+
+    if (!query.exec("SELECT userId, roleId, username, password FROM users ORDER BY userId")) {
+        qDebug() << "Cannot read users:" << query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        // 与JSON存储共用同一个按角色创建用户的工厂
+        QJsonObject obj;
+        obj["userId"] = query.value(0).toInt();
+        obj["roleId"] = query.value(1).toInt();
+        obj["username"] = query.value(2).toString();
+        obj["password"] = query.value(3).toString();
+        onUser(UserRepository::createUserFromJson(obj));
+    }
+    return true;
+}
+
+/**
+ * @brief 插入或替换一行
+ * @param user 用户对象
+ * @return 保存成功返回true，否则返回false
+ */
+bool SqliteUserStore::save(const User& user) {
+    if (!upsertQuery) {
+        return false;
+    }
+    if (!inTransaction && !(inTransaction = db.transaction())) {
+        qDebug() << "Cannot begin transaction:" << db.lastError().text();
+        return false;
+    }
+
+    upsertQuery->addBindValue(user.getUserId());
+    upsertQuery->addBindValue(user.getRoleId());
+    upsertQuery->addBindValue(user.getUsername());
+    upsertQuery->addBindValue(user.getPassword());
+    if (!upsertQuery->exec()) {
+        qDebug() << "Cannot save user:" << upsertQuery->lastError().text();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 提交当前事务
+ * @return 没有未提交的事务或提交成功返回true，否则返回false
+ */
+bool SqliteUserStore::commit() {
+    if (!inTransaction) {
+        return true;
+    }
+
+    if (!db.commit()) {
+        qDebug() << "Cannot commit transaction:" << db.lastError().text();
+        return false;
+    }
+    inTransaction = false;
+    return true;
+}
\ No newline at end of file
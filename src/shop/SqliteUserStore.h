@@ -0,0 +1,48 @@
+#ifndef SQLITEUSERSTORE_H
+#define SQLITEUSERSTORE_H
+
+#include "UserStore.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <memory>
+
+/**
+ * @brief 基于SQLite的用户存储后端
+ *
+ * SqliteUserStore通过QtSql把用户逐行保存在users表中，写入使用预编译语句，
+ * 两次commit()之间的写入处于同一个事务中
+ */
+class SqliteUserStore : public UserStore {
+public:
+    /**
+     * @brief 构造函数
+     * @param databaseFile 数据库文件路径
+     */
+    explicit SqliteUserStore(const QString& databaseFile);
+
+    /**
+     * @brief 析构函数，回滚未提交的事务并关闭数据库连接
+     */
+    ~SqliteUserStore() override;
+
+    SqliteUserStore(const SqliteUserStore&) = delete;
+    SqliteUserStore& operator=(const SqliteUserStore&) = delete;
+
+    /**
+     * @brief 打开数据库，按需建表，并逐个创建已保存的用户
+     * @param onUser 每创建一个用户调用一次
+     * @return 加载成功返回true，否则返回false
+     */
+    bool load(const std::function<void(User*)>& onUser) override;
+    bool save(const User& user) override;
+    bool commit() override;
+
+private:
+    QString connectionName;                 ///< QtSql连接名
+    QSqlDatabase db;                        ///< 数据库连接
+    bool inTransaction;                     ///< 是否有未提交的事务
+    std::unique_ptr<QSqlQuery> upsertQuery; ///< 预编译的插入或替换语句
+};
+
+#endif // SQLITEUSERSTORE_H
\ No newline at end of file
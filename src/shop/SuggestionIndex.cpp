@@ -0,0 +1,339 @@
+#include "SuggestionIndex.h"
+#include "TextIndex.h"
+#include <algorithm>
+
+/**
+ * @brief SuggestionIndex默认构造函数，只有根节点
+ */
+SuggestionIndex::SuggestionIndex() : liveCount(0) {
+    nodes.append(Node());
+}
+
+/**
+ * @brief 登记一个商品的标题、标签和地址
+ *
+ * 同一个商品中重复出现的字符串只计一次热度
+ * @param title 标题
+ * @param tags 标签
+ * @param location 地址
+ */
+void SuggestionIndex::insert(const QString& title, const QList<QString>& tags, const QString& location) {
+    for (const QString& key : keys(title, tags, location)) {
+        adjust(key, 1);
+    }
+}
+
+/**
+ * @brief 移除一个商品登记时使用的标题、标签和地址
+ *
+ * 热度降为0的节点积累到现存字符串数的kCompactionFactor倍时重建整棵树，
+ * 重建的耗时由此前的删除分摊
+ * @param title 标题
+ * @param tags 标签
+ * @param location 地址
+ */
+void SuggestionIndex::remove(const QString& title, const QList<QString>& tags, const QString& location) {
+    for (const QString& key : keys(title, tags, location)) {
+        adjust(key, -1);
+    }
+    if (nodes.size() > kMinCompactionNodes && qint64(nodes.size()) > qint64(kCompactionFactor) * liveCount) {
+        compact();
+    }
+}
+
+/**
+ * @brief 获取以指定前缀开头的热门字符串
+ *
+ * 沿前缀走到对应节点后直接读取其缓存的建议，只为返回的建议拼出字符串
+ * @param prefix 前缀
+ * @param limit 最多返回的建议数
+ * @return 按热度从高到低排列的建议
+ */
+QStringList SuggestionIndex::suggest(const QString& prefix, int limit) const {
+    QStringList result;
+    quint32 node = 0;
+    if (limit <= 0 || !find(prefix.trimmed().toLower(), node)) {
+        return result;
+    }
+    const QVector<Entry>& top = nodes.at(int(node)).top;
+    for (int i = 0; i < top.size() && i < limit; ++i) {
+        result.append(text(top.at(i).node));
+    }
+    return result;
+}
+
+/**
+ * @brief 获取字符串的热度
+ * @param text 字符串
+ * @return 含有该字符串的商品数
+ */
+int SuggestionIndex::popularity(const QString& text) const {
+    const QString key = text.trimmed().toLower();
+    quint32 node = 0;
+    if (key.isEmpty() || !find(key, node) || this->text(node).size() != key.size()) {
+        return 0;
+    }
+    return int(nodes.at(int(node)).count);
+}
+
+/**
+ * @brief 获取索引估算占用的内存
+ * @return 字节数
+ */
+qint64 SuggestionIndex::memoryUsage() const {
+    qint64 bytes = qint64(labels.size()) * qint64(sizeof(QChar)) + qint64(nodes.size()) * qint64(sizeof(Node));
+    for (const Node& node : nodes) {
+        bytes += qint64(node.children.size()) * qint64(sizeof(quint32));
+        bytes += qint64(node.top.size()) * qint64(sizeof(Entry));
+    }
+    return bytes;
+}
+
+/**
+ * @brief 求出一个商品参与建议的字符串
+ *
+ * 标题按TextIndex::words()拆成单词，标签和地址整体作为一个字符串，都去掉首尾空白并转为小写
+ * @param title 标题
+ * @param tags 标签
+ * @param location 地址
+ * @return 规范化并去重后的字符串
+ */
+QSet<QString> SuggestionIndex::keys(const QString& title, const QList<QString>& tags, const QString& location) {
+    QSet<QString> result;
+    for (const QString& word : TextIndex::words(title)) {
+        result.insert(word);
+    }
+    for (const QString& tag : tags) {
+        result.insert(tag.trimmed().toLower());
+    }
+    result.insert(location.trimmed().toLower());
+    result.remove(QString());
+    return result;
+}
+
+/**
+ * @brief 调整字符串的热度，必要时插入节点
+ *
+ * 插入时沿公共前缀下行，入边只匹配一部分时在分叉处分裂出中间节点，剩余部分追加到字符池作为新叶子的入边。
+ * 热度变化后自下而上更新路径上每个节点缓存的建议，子节点总是先于父节点更新
+ * @param key 规范化的字符串
+ * @param delta 热度的变化量，降低时为-1
+ */
+void SuggestionIndex::adjust(const QString& key, int delta) {
+    quint32 node = 0;
+    int pos = 0;
+    while (pos < key.size()) {
+        const int index = childIndex(node, key.at(pos));
+        const QVector<quint32>& children = nodes.at(int(node)).children;
+        if (index == children.size() || labels.at(int(nodes.at(int(children.at(index))).labelOffset)) != key.at(pos)) {
+            if (delta < 0) {
+                return;
+            }
+            Node leaf;
+            leaf.labelOffset = quint32(labels.size());
+            leaf.labelLength = quint32(key.size() - pos);
+            leaf.parent = node;
+            labels += key.mid(pos);
+            const quint32 created = quint32(nodes.size());
+            nodes.append(leaf);
+            nodes[int(node)].children.insert(index, created);
+            node = created;
+            break;
+        }
+
+        quint32 child = children.at(index);
+        const int common = commonPrefix(child, key, pos);
+        if (common < int(nodes.at(int(child)).labelLength)) {
+            if (delta < 0) {
+                return;
+            }
+            // 分裂：中间节点取入边的前一段，原节点保留后一段，两者共用字符池中的文字
+            Node middle;
+            middle.labelOffset = nodes.at(int(child)).labelOffset;
+            middle.labelLength = quint32(common);
+            middle.parent = node;
+            middle.children.append(child);
+            middle.top = nodes.at(int(child)).top;
+            const quint32 created = quint32(nodes.size());
+            nodes.append(middle);
+            nodes[int(child)].labelOffset += quint32(common);
+            nodes[int(child)].labelLength -= quint32(common);
+            nodes[int(child)].parent = created;
+            nodes[int(node)].children[index] = created;
+            child = created;
+        }
+        node = child;
+        pos += common;
+    }
+
+    Node& terminal = nodes[int(node)];
+    if (delta < 0 && terminal.count == 0) {
+        return;
+    }
+    const bool wasLive = terminal.count > 0;
+    terminal.count = quint32(qint64(terminal.count) + delta);
+    liveCount += int(terminal.count > 0) - int(wasLive);
+    for (quint32 current = node;; current = nodes.at(int(current)).parent) {
+        updateTop(current, node, delta < 0);
+        if (current == 0) {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief 只用现存的字符串重建整棵树
+ *
+ * 按原来的节点顺序重新插入，热度相同的建议按重建后的节点顺序排列
+ */
+void SuggestionIndex::compact() {
+    SuggestionIndex rebuilt;
+    for (int node = 1; node < nodes.size(); ++node) {
+        if (nodes.at(node).count > 0) {
+            rebuilt.adjust(text(quint32(node)), int(nodes.at(node).count));
+        }
+    }
+    labels = rebuilt.labels;
+    nodes = rebuilt.nodes;
+    liveCount = rebuilt.liveCount;
+}
+
+/**
+ * @brief 字符串热度变化后更新一个节点缓存的建议
+ *
+ * 热度升高时只可能挤进建议或在其中前移；已缓存的字符串热度降低时，
+ * 缓存已满则可能有未缓存的字符串超过它，需要由子节点重新求出
+ * @param node 路径上的节点
+ * @param terminal 字符串结尾的节点
+ * @param decreased 热度是否降低
+ */
+void SuggestionIndex::updateTop(quint32 node, quint32 terminal, bool decreased) {
+    QVector<Entry>& top = nodes[int(node)].top;
+    const Entry entry = {terminal, nodes.at(int(terminal)).count};
+    auto it = std::find_if(top.begin(), top.end(), [terminal](const Entry& e) { return e.node == terminal; });
+    if (it != top.end()) {
+        if (decreased && top.size() >= kTopK) {
+            recomputeTop(node);
+            return;
+        }
+        if (entry.count == 0) {
+            top.erase(it);
+        } else {
+            it->count = entry.count;
+        }
+    } else {
+        if (entry.count == 0 || (top.size() >= kTopK && !ranksBefore(entry, top.last()))) {
+            return;
+        }
+        top.append(entry);
+    }
+    std::sort(top.begin(), top.end(), ranksBefore);
+    if (top.size() > kTopK) {
+        top.resize(kTopK);
+    }
+}
+
+/**
+ * @brief 由子节点缓存的建议重新求出节点的建议
+ *
+ * 子树中热度最高的kTopK个字符串必然在节点自身和各子节点缓存的建议之中
+ * @param node 节点
+ */
+void SuggestionIndex::recomputeTop(quint32 node) {
+    QVector<Entry> candidates;
+    const Node& current = nodes.at(int(node));
+    if (current.count > 0) {
+        candidates.append(Entry{node, current.count});
+    }
+    for (quint32 child : current.children) {
+        candidates += nodes.at(int(child)).top;
+    }
+    std::sort(candidates.begin(), candidates.end(), ranksBefore);
+    if (candidates.size() > kTopK) {
+        candidates.resize(kTopK);
+    }
+    nodes[int(node)].top = candidates;
+}
+
+/**
+ * @brief 沿前缀查找节点
+ *
+ * 前缀可以在某条入边的中间结束，此时返回该入边指向的节点
+ * @param prefix 规范化的前缀
+ * @param node 输出参数，前缀结束处所在的节点
+ * @return 找到返回true，否则返回false
+ */
+bool SuggestionIndex::find(const QString& prefix, quint32& node) const {
+    node = 0;
+    int pos = 0;
+    while (pos < prefix.size()) {
+        const int index = childIndex(node, prefix.at(pos));
+        const QVector<quint32>& children = nodes.at(int(node)).children;
+        if (index == children.size()) {
+            return false;
+        }
+        const quint32 child = children.at(index);
+        const int common = commonPrefix(child, prefix, pos);
+        if (common == 0 || (pos + common < prefix.size() && common < int(nodes.at(int(child)).labelLength))) {
+            return false;
+        }
+        node = child;
+        pos += common;
+    }
+    return true;
+}
+
+/**
+ * @brief 在子节点中查找入边以指定字符开头的子节点
+ * @param node 节点
+ * @param first 首字符
+ * @return 子节点在children中的位置，不存在时为应插入的位置
+ */
+int SuggestionIndex::childIndex(quint32 node, QChar first) const {
+    const QVector<quint32>& children = nodes.at(int(node)).children;
+    auto it = std::lower_bound(children.cbegin(), children.cend(), first, [this](quint32 child, QChar ch) {
+        return labels.at(int(nodes.at(int(child)).labelOffset)) < ch;
+    });
+    return int(it - children.cbegin());
+}
+
+/**
+ * @brief 求入边文字与字符串从指定位置开始的公共前缀长度
+ * @param node 节点
+ * @param key 字符串
+ * @param pos 起始位置
+ * @return 公共前缀长度
+ */
+int SuggestionIndex::commonPrefix(quint32 node, const QString& key, int pos) const {
+    const Node& current = nodes.at(int(node));
+    int length = 0;
+    while (length < int(current.labelLength) && pos + length < key.size()
+           && labels.at(int(current.labelOffset) + length) == key.at(pos + length)) {
+        ++length;
+    }
+    return length;
+}
+
+/**
+ * @brief 拼出从根到节点的字符串
+ * @param node 节点
+ * @return 字符串
+ */
+QString SuggestionIndex::text(quint32 node) const {
+    QStringList parts;
+    for (quint32 current = node; current != 0; current = nodes.at(int(current)).parent) {
+        const Node& n = nodes.at(int(current));
+        parts.prepend(labels.mid(int(n.labelOffset), int(n.labelLength)));
+    }
+    return parts.join(QString());
+}
+
+/**
+ * @brief 比较两条建议的先后
+ * @param a 建议
+ * @param b 建议
+ * @return a排在b之前返回true，否则返回false
+ */
+bool SuggestionIndex::ranksBefore(const Entry& a, const Entry& b) {
+    return a.count != b.count ? a.count > b.count : a.node < b.node;
+}
\ No newline at end of file
@@ -0,0 +1,169 @@
+#ifndef SUGGESTIONINDEX_H
+#define SUGGESTIONINDEX_H
+
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief 搜索建议索引类
+ *
+ * SuggestionIndex用基数树（压缩前缀树）保存商品标题中的单词、标签和地址，供搜索框边输入边给出补全建议。
+ * 每个字符串的热度是含有它的商品数。所有边上的文字存放在同一个字符池中，节点只记录偏移和长度，
+ * 分裂节点时两段共用原来的文字，相同前缀只存一次。每个节点缓存子树中热度最高的kTopK个字符串，
+ * 查询时沿前缀走到对应节点即可直接给出结果，耗时只与前缀长度有关；
+ * 商品变更时只更新从字符串对应节点到根的路径。热度降为0的字符串不再出现在建议中，
+ * 节点数超过现存字符串数的kCompactionFactor倍时重建整棵树，回收其节点和字符池中的文字
+ */
+class SuggestionIndex {
+public:
+    static constexpr int kTopK = 10;                 ///< 每个节点缓存的建议数，也是一次最多返回的建议数
+    static constexpr int kCompactionFactor = 4;      ///< 节点数超过现存字符串数的该倍数时重建
+    static constexpr int kMinCompactionNodes = 1024; ///< 节点数不超过该值时不重建
+
+    /**
+     * @brief 默认构造函数，创建空索引
+     */
+    SuggestionIndex();
+
+    /**
+     * @brief 登记一个商品的标题、标签和地址
+     * @param title 标题
+     * @param tags 标签
+     * @param location 地址
+     */
+    void insert(const QString& title, const QList<QString>& tags, const QString& location);
+
+    /**
+     * @brief 移除一个商品登记时使用的标题、标签和地址
+     * @param title 标题
+     * @param tags 标签
+     * @param location 地址
+     */
+    void remove(const QString& title, const QList<QString>& tags, const QString& location);
+
+    /**
+     * @brief 获取以指定前缀开头的热门字符串
+     * @param prefix 前缀，不区分大小写，空前缀返回全部字符串中最热门的部分
+     * @param limit 最多返回的建议数，不超过kTopK
+     * @return 按热度从高到低排列的建议，英文字母为小写
+     */
+    QStringList suggest(const QString& prefix, int limit) const;
+
+    /**
+     * @brief 获取字符串的热度
+     * @param text 字符串，不区分大小写
+     * @return 含有该字符串的商品数
+     */
+    int popularity(const QString& text) const;
+
+    /**
+     * @brief 获取索引估算占用的内存
+     * @return 字节数，包括节点、字符池和缓存的建议
+     */
+    qint64 memoryUsage() const;
+
+private:
+    /**
+     * @brief 缓存的一条建议
+     */
+    struct Entry {
+        quint32 node;  ///< 字符串结尾的节点
+        quint32 count; ///< 热度
+    };
+
+    /**
+     * @brief 基数树的节点
+     */
+    struct Node {
+        quint32 labelOffset = 0;   ///< 入边文字在字符池中的偏移
+        quint32 labelLength = 0;   ///< 入边文字的长度
+        quint32 parent = 0;        ///< 父节点，根节点为0
+        quint32 count = 0;         ///< 以该节点结尾的字符串的热度
+        QVector<quint32> children; ///< 子节点，按入边首字符升序
+        QVector<Entry> top;        ///< 子树中热度最高的字符串，按热度降序
+    };
+
+    /**
+     * @brief 求出一个商品参与建议的字符串
+     * @param title 标题
+     * @param tags 标签
+     * @param location 地址
+     * @return 规范化并去重后的字符串
+     */
+    static QSet<QString> keys(const QString& title, const QList<QString>& tags, const QString& location);
+
+    /**
+     * @brief 调整字符串的热度，必要时插入节点
+     * @param key 规范化的字符串
+     * @param delta 热度的变化量，降低时为-1
+     */
+    void adjust(const QString& key, int delta);
+
+    /**
+     * @brief 只用现存的字符串重建整棵树，丢弃热度为0的节点和字符池中不再引用的文字
+     */
+    void compact();
+
+    /**
+     * @brief 字符串热度变化后更新一个节点缓存的建议
+     * @param node 路径上的节点
+     * @param terminal 字符串结尾的节点
+     * @param decreased 热度是否降低
+     */
+    void updateTop(quint32 node, quint32 terminal, bool decreased);
+
+    /**
+     * @brief 由子节点缓存的建议重新求出节点的建议
+     * @param node 节点
+     */
+    void recomputeTop(quint32 node);
+
+    /**
+     * @brief 沿前缀查找节点
+     * @param prefix 规范化的前缀
+     * @param node 输出参数，前缀结束处所在的节点
+     * @return 找到返回true，否则返回false
+     */
+    bool find(const QString& prefix, quint32& node) const;
+
+    /**
+     * @brief 在子节点中查找入边以指定字符开头的子节点
+     * @param node 节点
+     * @param first 首字符
+     * @return 子节点在children中的位置，不存在时为应插入的位置
+     */
+    int childIndex(quint32 node, QChar first) const;
+
+    /**
+     * @brief 求入边文字与字符串从指定位置开始的公共前缀长度
+     * @param node 节点
+     * @param key 字符串
+     * @param pos 起始位置
+     * @return 公共前缀长度
+     */
+    int commonPrefix(quint32 node, const QString& key, int pos) const;
+
+    /**
+     * @brief 拼出从根到节点的字符串
+     * @param node 节点
+     * @return 字符串
+     */
+    QString text(quint32 node) const;
+
+    /**
+     * @brief 比较两条建议的先后，热度高的在前，相同时先插入的在前
+     * @param a 建议
+     * @param b 建议
+     * @return a排在b之前返回true，否则返回false
+     */
+    static bool ranksBefore(const Entry& a, const Entry& b);
+
+    QString labels;      ///< 全部入边文字的字符池
+    QVector<Node> nodes; ///< 节点，0号为根节点
+    int liveCount;       ///< 热度大于0的字符串数
+};
+
+#endif // SUGGESTIONINDEX_H
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "TagIndex.h"
+#include <algorithm>
+
+/**
+ * @brief 登记槽位的标签
+ * @param slot 槽位号
+ * @param tags 标签列表
+ */
+void TagIndex::insert(quint32 slot, const QList<QString>& tags) {
+    for (const QString& tag : tags) {
+        bitmaps[tag].add(slot);
+    }
+}
+
+/**
+ * @brief 移除槽位的标签，位图为空时从字典中删除该标签
+ * @param slot 槽位号
+ * @param tags 登记时使用的标签列表
+ */
+void TagIndex::remove(quint32 slot, const QList<QString>& tags) {
+    for (const QString& tag : tags) {
+        auto it = bitmaps.find(tag);
+        if (it == bitmaps.end()) {
+            continue;
+        }
+        it.value().remove(slot);
+        if (it.value().isEmpty()) {
+            bitmaps.erase(it);
+        }
+    }
+}
+
+/**
+ * @brief 获取带有指定标签的商品数
+ * @param tag 标签
+ * @return 商品数
+ */
+int TagIndex::count(const QString& tag) const {
+    auto it = bitmaps.constFind(tag);
+    return it == bitmaps.constEnd() ? 0 : it.value().cardinality();
+}
+
+/**
+ * @brief 获取每个标签的商品数
+ * @return 标签到商品数的映射
+ */
+QHash<QString, int> TagIndex::counts() const {
+    QHash<QString, int> result;
+    result.reserve(bitmaps.size());
+    for (auto it = bitmaps.constBegin(); it != bitmaps.constEnd(); ++it) {
+        result.insert(it.key(), it.value().cardinality());
+    }
+    return result;
+}
+
+/**
+ * @brief 获取同时带有全部指定标签的槽位
+ *
+ * 从商品最少的标签开始求交，结果为空时提前结束
+ * @param tags 标签列表，不能为空
+ * @return 槽位位图
+ */
+SlotBitmap TagIndex::matchAll(const QList<QString>& tags) const {
+    QList<const SlotBitmap*> operands;
+    for (const QString& tag : tags) {
+        auto it = bitmaps.constFind(tag);
+        if (it == bitmaps.constEnd()) {
+            return SlotBitmap();
+        }
+        operands.append(&it.value());
+    }
+    if (operands.isEmpty()) {
+        return SlotBitmap();
+    }
+    std::sort(operands.begin(), operands.end(), [](const SlotBitmap* a, const SlotBitmap* b) {
+        return a->cardinality() < b->cardinality();
+    });
+
+    SlotBitmap result = *operands.first();
+    for (int i = 1; i < operands.size() && !result.isEmpty(); ++i) {
+        result = SlotBitmap::intersect(result, *operands.at(i));
+    }
+    return result;
+}
+
+/**
+ * @brief 获取带有任一指定标签的槽位
+ * @param tags 标签列表
+ * @return 槽位位图
+ */
+SlotBitmap TagIndex::matchAny(const QList<QString>& tags) const {
+    SlotBitmap result;
+    for (const QString& tag : tags) {
+        auto it = bitmaps.constFind(tag);
+        if (it != bitmaps.constEnd()) {
+            result = SlotBitmap::unite(result, it.value());
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief 获取全部位图占用的字节数
+ * @return 字节数
+ */
+int TagIndex::byteSize() const {
+    int total = 0;
+    for (auto it = bitmaps.constBegin(); it != bitmaps.constEnd(); ++it) {
+        total += it.value().byteSize();
+    }
+    return total;
+}
\ No newline at end of file
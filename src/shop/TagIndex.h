@@ -0,0 +1,69 @@
+#ifndef TAGINDEX_H
+#define TAGINDEX_H
+
+#include "SlotBitmap.h"
+#include <QHash>
+#include <QList>
+#include <QString>
+
+/**
+ * @brief 标签索引类
+ *
+ * TagIndex是标签字典，每个不同的标签对应一个SlotBitmap，记录带有该标签的商品槽位。
+ * 多标签的“与”、“或”、“非”查询直接在位图上运算，不需要逐个检查商品；
+ * 每个标签的商品数由位图维护，可以O(1)读取，用于标签云等统计
+ */
+class TagIndex {
+public:
+    /**
+     * @brief 登记槽位的标签
+     * @param slot 槽位号
+     * @param tags 标签列表
+     */
+    void insert(quint32 slot, const QList<QString>& tags);
+
+    /**
+     * @brief 移除槽位的标签，位图为空时从字典中删除该标签
+     * @param slot 槽位号
+     * @param tags 登记时使用的标签列表
+     */
+    void remove(quint32 slot, const QList<QString>& tags);
+
+    /**
+     * @brief 获取带有指定标签的商品数
+     * @param tag 标签
+     * @return 商品数
+     */
+    int count(const QString& tag) const;
+
+    /**
+     * @brief 获取每个标签的商品数
+     * @return 标签到商品数的映射
+     */
+    QHash<QString, int> counts() const;
+
+    /**
+     * @brief 获取同时带有全部指定标签的槽位
+     * @param tags 标签列表，不能为空
+     * @return 槽位位图
+     */
+    SlotBitmap matchAll(const QList<QString>& tags) const;
+
+    /**
+     * @brief 获取带有任一指定标签的槽位
+     * @param tags 标签列表
+     * @return 槽位位图
+     */
+    SlotBitmap matchAny(const QList<QString>& tags) const;
+
+    /**
+     * @brief 获取全部位图占用的字节数
+     * @return 字节数
+     */
+    int byteSize() const;
+
+private:
+    QHash<QString, SlotBitmap> bitmaps; ///< 标签到槽位位图的映射
+};
+
+#endif // TAGINDEX_H
\ No newline at end of file
@@ -0,0 +1,230 @@
+#include "TextIndex.h"
+#include <QSet>
+#include <algorithm>
+
+namespace {
+
+/**
+ * @brief 字符是否属于中日韩文字
+ * @param ch 字符
+ * @return 属于返回true，否则返回false
+ */
+bool isCjk(QChar ch) {
+    const ushort u = ch.unicode();
+    return (u >= 0x4E00 && u <= 0x9FFF)    // 中日韩统一表意文字
+           || (u >= 0x3400 && u <= 0x4DBF) // 扩展A区
+           || (u >= 0xF900 && u <= 0xFAFF) // 兼容表意文字
+           || (u >= 0x3040 && u <= 0x30FF) // 平假名、片假名
+           || (u >= 0xAC00 && u <= 0xD7AF); // 谚文音节
+}
+
+/**
+ * @brief 把文本拆成中日韩片段和拉丁片段
+ * @param text 文本
+ * @param visit 对每个片段调用，参数为片段和是否为中日韩片段
+ */
+template <typename Visitor>
+void forEachRun(const QString& text, Visitor visit) {
+    int start = 0;
+    while (start < text.size()) {
+        const QChar ch = text.at(start);
+        if (isCjk(ch)) {
+            int end = start + 1;
+            while (end < text.size() && isCjk(text.at(end))) {
+                ++end;
+            }
+            visit(text.mid(start, end - start), true);
+            start = end;
+        } else if (ch.isLetterOrNumber()) {
+            int end = start + 1;
+            while (end < text.size() && text.at(end).isLetterOrNumber() && !isCjk(text.at(end))) {
+                ++end;
+            }
+            visit(text.mid(start, end - start).toLower(), false);
+            start = end;
+        } else {
+            ++start;
+        }
+    }
+}
+
+} // namespace
+
+/**
+ * @brief 把文本切分为索引词项
+ * @param text 文本
+ * @return 去重后的词项
+ */
+QStringList TextIndex::tokenize(const QString& text) {
+    return termFrequencies(text).keys();
+}
+
+/**
+ * @brief 统计文本中每个索引词项的出现次数
+ * @param text 文本
+ * @return 词项到出现次数的映射
+ */
+QHash<QString, int> TextIndex::termFrequencies(const QString& text) {
+    QHash<QString, int> frequencies;
+    forEachRun(text, [&frequencies](const QString& run, bool cjk) {
+        if (!cjk) {
+            ++frequencies[run];
+            return;
+        }
+        for (int i = 0; i < run.size(); ++i) {
+            ++frequencies[run.mid(i, 1)];
+            if (i + 1 < run.size()) {
+                ++frequencies[run.mid(i, 2)];
+            }
+        }
+    });
+    return frequencies;
+}
+
+/**
+ * @brief 把关键词切分为查询词项
+ * @param keyword 关键词
+ * @return 去重后的词项
+ */
+QStringList TextIndex::queryTerms(const QString& keyword) {
+    QSet<QString> terms;
+    forEachRun(keyword, [&terms](const QString& run, bool cjk) {
+        if (!cjk || run.size() == 1) {
+            terms.insert(run);
+            return;
+        }
+        for (int i = 0; i + 1 < run.size(); ++i) {
+            terms.insert(run.mid(i, 2));
+        }
+    });
+    return terms.values();
+}
+
+/**
+ * @brief 把文本拆成单词
+ * @param text 文本
+ * @return 按出现顺序排列的单词
+ */
+QStringList TextIndex::words(const QString& text) {
+    QStringList result;
+    forEachRun(text, [&result](const QString& run, bool) {
+        result.append(run);
+    });
+    return result;
+}
+
+/**
+ * @brief 关键词的倒排表交集是否可能包含误命中
+ * @param keyword 关键词
+ * @return 含有三个字以上的中日韩片段时返回true，否则返回false
+ */
+bool TextIndex::needsVerification(const QString& keyword) {
+    bool result = false;
+    forEachRun(keyword, [&result](const QString& run, bool cjk) {
+        result = result || (cjk && run.size() >= 3);
+    });
+    return result;
+}
+
+/**
+ * @brief 把文本登记到槽位
+ * @param slot 槽位号
+ * @param text 文本
+ */
+void TextIndex::insert(quint32 slot, const QString& text) {
+    const QStringList terms = tokenize(text);
+    for (const QString& term : terms) {
+        postings[term].add(slot);
+    }
+}
+
+/**
+ * @brief 从槽位移除文本，倒排表为空时删除该词项
+ * @param slot 槽位号
+ * @param text 登记时使用的文本
+ */
+void TextIndex::remove(quint32 slot, const QString& text) {
+    const QStringList terms = tokenize(text);
+    for (const QString& term : terms) {
+        auto it = postings.find(term);
+        if (it == postings.end()) {
+            continue;
+        }
+        it.value().remove(slot);
+        if (it.value().isEmpty()) {
+            postings.erase(it);
+        }
+    }
+}
+
+/**
+ * @brief 查找包含关键词全部词项的槽位
+ *
+ * 按倒排表长度从短到长依次求交，结果为空时提前结束
+ * @param keyword 关键词
+ * @param matches 输出参数，升序排列的槽位号
+ * @return 关键词能切分出词项时返回true，否则返回false
+ */
+bool TextIndex::lookup(const QString& keyword, QVector<quint32>& matches) const {
+    QList<const PostingList*> lists;
+    if (!termPostings(keyword, lists)) {
+        return false;
+    }
+    if (lists.isEmpty()) {
+        matches.clear();
+        return true;
+    }
+
+    matches = lists.first()->decode();
+    for (int i = 1; i < lists.size() && !matches.isEmpty(); ++i) {
+        matches = PostingList::intersect(matches, lists.at(i)->decode());
+    }
+    return true;
+}
+
+/**
+ * @brief 取出关键词各词项的倒排表
+ * @param keyword 关键词
+ * @param lists 输出参数，按长度升序排列的倒排表；有词项不在索引中时为空
+ * @return 关键词能切分出词项时返回true，否则返回false且不修改lists
+ */
+bool TextIndex::termPostings(const QString& keyword, QList<const PostingList*>& lists) const {
+    const QStringList terms = queryTerms(keyword);
+    if (terms.isEmpty()) {
+        return false;
+    }
+
+    lists.clear();
+    for (const QString& term : terms) {
+        auto it = postings.constFind(term);
+        if (it == postings.constEnd()) {
+            lists.clear();
+            return true;
+        }
+        lists.append(&it.value());
+    }
+    std::sort(lists.begin(), lists.end(), [](const PostingList* a, const PostingList* b) {
+        return a->size() < b->size();
+    });
+    return true;
+}
+
+/**
+ * @brief 获取词项数
+ * @return 词项数
+ */
+int TextIndex::termCount() const {
+    return postings.size();
+}
+
+/**
+ * @brief 获取全部倒排表占用的字节数
+ * @return 字节数
+ */
+int TextIndex::byteSize() const {
+    int total = 0;
+    for (auto it = postings.constBegin(); it != postings.constEnd(); ++it) {
+        total += it.value().byteSize();
+    }
+    return total;
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+#ifndef TEXTINDEX_H
+#define TEXTINDEX_H
+
+#include "PostingList.h"
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief 全文倒排索引类
+ *
+ * TextIndex为商品标题和描述建立倒排索引，词项到槽位号的倒排表使用PostingList压缩保存。
+ * 中日韩文字没有空格分词，连续的中日韩字符按单字和相邻两字（二元组）切分；
+ * 拉丁字母和数字按连续片段切成单词并转为小写，其余字符视为分隔符。
+ * 查询时把关键词按同样规则切分后求各倒排表的交集，
+ * 三个字以上的中日韩片段只能保证每个二元组都出现，需要调用方再核对原文
+ */
+class TextIndex {
+public:
+    /**
+     * @brief 把文本切分为索引词项
+     * @param text 文本
+     * @return 去重后的词项
+     */
+    static QStringList tokenize(const QString& text);
+
+    /**
+     * @brief 统计文本中每个索引词项的出现次数
+     *
+     * 词项与tokenize()相同，供相关度评分计算词频
+     * @param text 文本
+     * @return 词项到出现次数的映射
+     */
+    static QHash<QString, int> termFrequencies(const QString& text);
+
+    /**
+     * @brief 把关键词切分为查询词项
+     *
+     * 与tokenize()不同，长度不小于2的中日韩片段只产生二元组，单字词项只用于单字片段
+     * @param keyword 关键词
+     * @return 去重后的词项
+     */
+    static QStringList queryTerms(const QString& keyword);
+
+    /**
+     * @brief 把文本拆成单词
+     *
+     * 拉丁字母和数字的连续片段转为小写，连续的中日韩字符整体作为一个单词，供模糊匹配按单词比较
+     * @param text 文本
+     * @return 按出现顺序排列的单词，可能重复
+     */
+    static QStringList words(const QString& text);
+
+    /**
+     * @brief 关键词的倒排表交集是否可能包含误命中
+     * @param keyword 关键词
+     * @return 含有三个字以上的中日韩片段时返回true，否则返回false
+     */
+    static bool needsVerification(const QString& keyword);
+
+    /**
+     * @brief 把文本登记到槽位
+     * @param slot 槽位号
+     * @param text 文本
+     */
+    void insert(quint32 slot, const QString& text);
+
+    /**
+     * @brief 从槽位移除文本
+     * @param slot 槽位号
+     * @param text 登记时使用的文本
+     */
+    void remove(quint32 slot, const QString& text);
+
+    /**
+     * @brief 查找包含关键词全部词项的槽位
+     * @param keyword 关键词
+     * @param matches 输出参数，升序排列的槽位号
+     * @return 关键词能切分出词项时返回true，否则返回false且不修改matches
+     */
+    bool lookup(const QString& keyword, QVector<quint32>& matches) const;
+
+    /**
+     * @brief 取出关键词各词项的倒排表，供查询计划估算选择率或逐个探测
+     * @param keyword 关键词
+     * @param lists 输出参数，按长度升序排列的倒排表；有词项不在索引中时为空
+     * @return 关键词能切分出词项时返回true，否则返回false且不修改lists
+     */
+    bool termPostings(const QString& keyword, QList<const PostingList*>& lists) const;
+
+    /**
+     * @brief 获取词项数
+     * @return 词项数
+     */
+    int termCount() const;
+
+    /**
+     * @brief 获取全部倒排表占用的字节数
+     * @return 字节数
+     */
+    int byteSize() const;
+
+private:
+    QHash<QString, PostingList> postings; ///< 词项到倒排表的映射
+};
+
+#endif // TEXTINDEX_H
\ No newline at end of file
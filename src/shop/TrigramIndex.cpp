@@ -0,0 +1,239 @@
+#include "TrigramIndex.h"
+#include "TextIndex.h"
+#include <QPair>
+#include <QSet>
+#include <algorithm>
+
+/**
+ * @brief TrigramIndex默认构造函数
+ */
+TrigramIndex::TrigramIndex() {
+}
+
+/**
+ * @brief 把标题登记到槽位
+ *
+ * 第一次出现的单词加入词表并登记其三元组，单词编号递增，三元组倒排表只在末尾追加
+ * @param slot 槽位号
+ * @param title 标题
+ */
+void TrigramIndex::insert(quint32 slot, const QString& title) {
+    const QStringList titleWords = TextIndex::words(title);
+    for (const QString& word : QSet<QString>(titleWords.begin(), titleWords.end())) {
+        auto it = wordIds.constFind(word);
+        quint32 id;
+        if (it != wordIds.constEnd()) {
+            id = it.value();
+        } else {
+            id = quint32(vocabulary.size());
+            wordIds.insert(word, id);
+            vocabulary.append(word);
+            wordSlots.append(PostingList());
+            for (const QString& gram : trigrams(word)) {
+                gramWords[gram].add(id);
+            }
+        }
+        wordSlots[int(id)].add(slot);
+    }
+}
+
+/**
+ * @brief 从槽位移除标题
+ *
+ * 词表只增不减，不再出现的单词保留在词表中，查询时其槽位为空
+ * @param slot 槽位号
+ * @param title 登记时使用的标题
+ */
+void TrigramIndex::remove(quint32 slot, const QString& title) {
+    const QStringList titleWords = TextIndex::words(title);
+    for (const QString& word : QSet<QString>(titleWords.begin(), titleWords.end())) {
+        auto it = wordIds.constFind(word);
+        if (it != wordIds.constEnd()) {
+            wordSlots[int(it.value())].remove(slot);
+        }
+    }
+}
+
+/**
+ * @brief 查找标题模糊匹配关键词的槽位
+ *
+ * 逐个单词查找后求交集，从第一个单词开始，交集为空时提前结束
+ * @param keyword 关键词
+ * @param maxDistance 最大编辑距离
+ * @return 升序排列的槽位号
+ */
+QVector<quint32> TrigramIndex::lookup(const QString& keyword, int maxDistance) const {
+    QStringList queryWords = TextIndex::words(keyword);
+    queryWords.removeDuplicates();
+    QVector<quint32> matches;
+    for (int i = 0; i < queryWords.size(); ++i) {
+        const QVector<quint32> found = lookupWord(queryWords.at(i), maxDistance);
+        matches = i == 0 ? found : PostingList::intersect(matches, found);
+        if (matches.isEmpty()) {
+            break;
+        }
+    }
+    return matches;
+}
+
+/**
+ * @brief 获取单词按长度允许的最大编辑距离
+ * @param length 单词长度
+ * @return 最大编辑距离
+ */
+int TrigramIndex::allowedDistance(int length) {
+    if (length <= 2) {
+        return 0;
+    }
+    return length <= 5 ? 1 : kMaxDistance;
+}
+
+/**
+ * @brief 计算两个字符串的编辑距离，超过上界时提前结束
+ *
+ * 模式串的每个字符对应一个位，Pv/Mv记录当前列纵向差值为+1/-1的行，Ph/Mh为横向差值，
+ * 每读入文本的一个字符由这四个位向量推出下一列，最高位的横向差值累加得到最后一行的值。
+ * 第0行的值为列号（文本前缀全部插入），因此每列都向Ph移入1。
+ * 最后一行每列最多减1，剩余的列不足以降到上界以内时提前返回
+ * @param pattern 模式串
+ * @param text 文本
+ * @param bound 编辑距离上界
+ * @return 编辑距离，超过bound时返回bound + 1
+ */
+int TrigramIndex::boundedDistance(const QString& pattern, const QString& text, int bound) {
+    const int m = pattern.size();
+    const int n = text.size();
+    if (qAbs(m - n) > bound) {
+        return bound + 1;
+    }
+    if (m == 0) {
+        return n;
+    }
+    if (m > kMaxWordLength) {
+        return pattern == text ? 0 : bound + 1;
+    }
+
+    // 模式串中每个字符出现位置的位掩码
+    QVector<QPair<QChar, quint64>> peq;
+    for (int i = 0; i < m; ++i) {
+        auto it = std::find_if(peq.begin(), peq.end(), [&pattern, i](const QPair<QChar, quint64>& entry) {
+            return entry.first == pattern.at(i);
+        });
+        if (it == peq.end()) {
+            peq.append(qMakePair(pattern.at(i), quint64(0)));
+            it = peq.end() - 1;
+        }
+        it->second |= quint64(1) << i;
+    }
+
+    const quint64 last = quint64(1) << (m - 1);
+    quint64 pv = ~quint64(0);
+    quint64 mv = 0;
+    int score = m;
+    for (int j = 0; j < n; ++j) {
+        quint64 eq = 0;
+        for (const auto& entry : peq) {
+            if (entry.first == text.at(j)) {
+                eq = entry.second;
+                break;
+            }
+        }
+        const quint64 xv = eq | mv;
+        const quint64 xh = (((eq & pv) + pv) ^ pv) | eq;
+        quint64 ph = mv | ~(xh | pv);
+        quint64 mh = pv & xh;
+        if (ph & last) {
+            ++score;
+        } else if (mh & last) {
+            --score;
+        }
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+        if (score - (n - 1 - j) > bound) {
+            return bound + 1;
+        }
+    }
+    return qMin(score, bound + 1);
+}
+
+/**
+ * @brief 获取词表中的单词数
+ * @return 单词数，包括已不在任何标题中出现的单词
+ */
+int TrigramIndex::wordCount() const {
+    return vocabulary.size();
+}
+
+/**
+ * @brief 把单词补上边界符后切成三元组
+ *
+ * 首尾各补两个边界符，长度为n的单词得到n+2个三元组，短单词也至少有3个
+ * @param word 单词
+ * @return 去重后的三元组
+ */
+QVector<QString> TrigramIndex::trigrams(const QString& word) {
+    const QString padded = QString(2, QChar(0x1)) + word + QString(2, QChar(0x1));
+    QVector<QString> grams;
+    for (int i = 0; i + 3 <= padded.size(); ++i) {
+        const QString gram = padded.mid(i, 3);
+        if (!grams.contains(gram)) {
+            grams.append(gram);
+        }
+    }
+    return grams;
+}
+
+/**
+ * @brief 查找与单词相近的全部单词的槽位
+ *
+ * 一处编辑最多破坏3个三元组，共有的三元组数达到“三元组数-3k”的单词才需要计算编辑距离；
+ * 下限不大于0时无法筛选，检查整个词表
+ * @param word 查询单词
+ * @param maxDistance 最大编辑距离
+ * @return 升序排列的槽位号
+ */
+QVector<quint32> TrigramIndex::lookupWord(const QString& word, int maxDistance) const {
+    int distance = qBound(0, qMin(maxDistance, allowedDistance(word.size())), kMaxDistance);
+    if (word.size() > kMaxWordLength) {
+        distance = 0;
+    }
+    if (distance == 0) {
+        auto it = wordIds.constFind(word);
+        return it == wordIds.constEnd() ? QVector<quint32>() : wordSlots.at(int(it.value())).decode();
+    }
+
+    const QVector<QString> grams = trigrams(word);
+    const int threshold = grams.size() - 3 * distance;
+    QVector<quint32> candidates;
+    if (threshold > 0) {
+        QHash<quint32, int> shared;
+        for (const QString& gram : grams) {
+            auto it = gramWords.constFind(gram);
+            if (it == gramWords.constEnd()) {
+                continue;
+            }
+            for (quint32 id : it.value().decode()) {
+                if (++shared[id] == threshold) {
+                    candidates.append(id);
+                }
+            }
+        }
+    } else {
+        for (int id = 0; id < vocabulary.size(); ++id) {
+            candidates.append(quint32(id));
+        }
+    }
+
+    QVector<quint32> matches;
+    for (quint32 id : candidates) {
+        const PostingList& posting = wordSlots.at(int(id));
+        if (!posting.isEmpty() && boundedDistance(word, vocabulary.at(int(id)), distance) <= distance) {
+            matches += posting.decode();
+        }
+    }
+    std::sort(matches.begin(), matches.end());
+    matches.erase(std::unique(matches.begin(), matches.end()), matches.end());
+    return matches;
+}
\ No newline at end of file
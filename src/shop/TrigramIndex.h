@@ -0,0 +1,100 @@
+#ifndef TRIGRAMINDEX_H
+#define TRIGRAMINDEX_H
+
+#include "PostingList.h"
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief 标题模糊匹配索引类
+ *
+ * TrigramIndex把商品标题拆成单词（规则同TextIndex::words()），为标题中出现过的全部单词建立词表，
+ * 每个单词首尾各补两个边界符后切成三元组，三元组到单词编号、单词到槽位号的倒排表都使用PostingList保存。
+ * 模糊查询时先按三元组计数筛出候选单词：与查询词编辑距离不超过k的单词至少共有“查询词的三元组数-3k”个三元组，
+ * 再用Myers位并行算法对候选单词计算有上界的编辑距离。候选只来自词表，耗时与标题总数基本无关
+ */
+class TrigramIndex {
+public:
+    static constexpr int kMaxDistance = 2;    ///< 允许的最大编辑距离
+    static constexpr int kMaxWordLength = 64; ///< 位并行比较的最大单词长度，更长的单词只做精确比较
+
+    /**
+     * @brief 默认构造函数，创建空索引
+     */
+    TrigramIndex();
+
+    /**
+     * @brief 把标题登记到槽位
+     * @param slot 槽位号
+     * @param title 标题
+     */
+    void insert(quint32 slot, const QString& title);
+
+    /**
+     * @brief 从槽位移除标题
+     * @param slot 槽位号
+     * @param title 登记时使用的标题
+     */
+    void remove(quint32 slot, const QString& title);
+
+    /**
+     * @brief 查找标题模糊匹配关键词的槽位
+     *
+     * 关键词的每个单词都要与标题中的某个单词相近：编辑距离不超过maxDistance，
+     * 且不超过按单词长度允许的距离（见allowedDistance()）
+     * @param keyword 关键词
+     * @param maxDistance 最大编辑距离
+     * @return 升序排列的槽位号，关键词没有单词时为空
+     */
+    QVector<quint32> lookup(const QString& keyword, int maxDistance) const;
+
+    /**
+     * @brief 获取单词按长度允许的最大编辑距离
+     *
+     * 1~2个字符不允许错误，3~5个字符允许1处，更长允许2处，避免短词匹配到大量无关单词
+     * @param length 单词长度
+     * @return 最大编辑距离
+     */
+    static int allowedDistance(int length);
+
+    /**
+     * @brief 计算两个字符串的编辑距离，超过上界时提前结束
+     *
+     * 用Myers位并行算法逐列推进动态规划表，每个字符只需常数次64位运算
+     * @param pattern 模式串，不超过kMaxWordLength个字符
+     * @param text 文本
+     * @param bound 编辑距离上界
+     * @return 编辑距离，超过bound时返回bound + 1
+     */
+    static int boundedDistance(const QString& pattern, const QString& text, int bound);
+
+    /**
+     * @brief 获取词表中的单词数
+     * @return 单词数
+     */
+    int wordCount() const;
+
+private:
+    /**
+     * @brief 把单词补上边界符后切成三元组
+     * @param word 单词
+     * @return 去重后的三元组
+     */
+    static QVector<QString> trigrams(const QString& word);
+
+    /**
+     * @brief 查找与单词相近的全部单词的槽位
+     * @param word 查询单词
+     * @param maxDistance 最大编辑距离
+     * @return 升序排列的槽位号
+     */
+    QVector<quint32> lookupWord(const QString& word, int maxDistance) const;
+
+    QHash<QString, quint32> wordIds;       ///< 单词到编号的映射，只增不减
+    QVector<QString> vocabulary;           ///< 单词编号到单词的映射
+    QVector<PostingList> wordSlots;        ///< 每个单词出现的槽位
+    QHash<QString, PostingList> gramWords; ///< 三元组到单词编号的倒排表
+};
+
+#endif // TRIGRAMINDEX_H
\ No newline at end of file
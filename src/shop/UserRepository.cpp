@@ -3,18 +3,53 @@
 #include "User.h"
 #include "Administrator.h"
 #include "NormalUser.h"
-#include <QFile>
+#include "JsonUserStore.h"
+#include "SqliteUserStore.h"
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QDebug>
 
+namespace {
+
+/**
+ * @brief 根据配置创建存储后端
+ * @return 存储后端
+ */
+std::unique_ptr<UserStore> createConfiguredStore() {
+    if (ConfigManager::getStorageBackend() == "sqlite") {
+        return std::unique_ptr<UserStore>(new SqliteUserStore(ConfigManager::getDatabaseFile()));
+    }
+    return std::unique_ptr<UserStore>(new JsonUserStore());
+}
+
+} // namespace
+
 /**
- * @brief UserRepository默认构造函数
+ * @brief UserRepository默认构造函数，使用配置的存储后端
  */
-UserRepository::UserRepository() {
-    // 尝试从文件加载数据
-    loadFromJsonFile();
+UserRepository::UserRepository() : UserRepository(createConfiguredStore()) {
+}
+
+/**
+ * @brief 使用指定存储后端的构造函数
+ * @param store 存储后端，由仓库接管
+ */
+UserRepository::UserRepository(std::unique_ptr<UserStore> store)
+    : backend(std::move(store)), committer([this]() { return backend->commit(); }) {
+    // 尝试从存储后端加载数据
+    backend->load([this](User* user) {
+        users.insert(user->getUserId(), user);
+    });
+}
+
+/**
+ * @brief UserRepository析构函数
+ */
+UserRepository::~UserRepository() {
+    if (!flush()) {
+        qDebug() << "Failed to flush pending user changes";
+    }
 }
 
 /**
@@ -54,7 +89,9 @@ bool UserRepository::checkUserRole(int userId, const QString& role) const {
 void UserRepository::addUser(User* user) {
     if (user) {
         users.insert(user->getUserId(), user);
-        saveToJsonFile();
+        if (backend->save(*user)) {
+            committer.notifyMutation();
+        }
     }
 }
 
@@ -101,16 +138,23 @@ bool UserRepository::loadFromJson(const QString& json) {
     }
     
     QJsonArray array = doc.array();
+    bool imported = false;
     for (const QJsonValue& value : array) {
         if (value.isObject()) {
             QJsonObject obj = value.toObject();
             User* user = createUserFromJson(obj);
             if (user) {
                 users.insert(user->getUserId(), user);
+                imported = backend->save(*user) || imported;
             }
         }
     }
     
+    // 与商品导入一样，导入的用户作为一次变更立即落盘
+    if (imported) {
+        committer.notifyMutation();
+        return committer.flush();
+    }
     return true;
 }
 
@@ -153,7 +197,7 @@ User* UserRepository::createUserFromJson(const QJsonObject& obj) {
  * @param user 用户指针
  * @return JSON对象
  */
-QJsonObject UserRepository::userToJson(User* user) {
+QJsonObject UserRepository::userToJson(const User* user) {
     QJsonObject obj;
     obj["userId"] = user->getUserId();
     obj["roleId"] = user->getRoleId();
@@ -163,40 +207,33 @@ QJsonObject UserRepository::userToJson(User* user) {
 }
 
 /**
- * @brief 从JSON文件加载数据
- * @return 加载成功返回true，否则返回false
+ * @brief 落盘屏障：立即写出尚未落盘的用户
+ * @return 写出成功返回true，否则返回false
  */
-bool UserRepository::loadFromJsonFile() {
-    QString fileName = ConfigManager::getUserDataFile();
-    QFile file(fileName);
-    
-    if (!file.open(QIODevice::ReadOnly)) {
-        qDebug() << "Cannot open file for reading:" << fileName;
-        return false;
-    }
-    
-    QString json = file.readAll();
-    file.close();
-    
-    return loadFromJson(json);
+bool UserRepository::flush() {
+    return committer.flush();
 }
 
 /**
- * @brief 保存数据到JSON文件
- * @return 保存成功返回true，否则返回false
+ * @brief 设置组提交的落盘策略
+ * @param policy 落盘策略
  */
-bool UserRepository::saveToJsonFile() {
-    QString fileName = ConfigManager::getUserDataFile();
-    QFile file(fileName);
-    
-    if (!file.open(QIODevice::WriteOnly)) {
-        qDebug() << "Cannot open file for writing:" << fileName;
-        return false;
-    }
-    
-    QString json = dumpToJson();
-    file.write(json.toUtf8());
-    file.close();
-    
-    return true;
+void UserRepository::setFlushPolicy(const FlushPolicy& policy) {
+    committer.setPolicy(policy);
+}
+
+/**
+ * @brief 获取已执行的落盘次数
+ * @return 落盘次数
+ */
+int UserRepository::flushCount() const {
+    return committer.flushCount();
+}
+
+/**
+ * @brief 获取失败的落盘次数
+ * @return 落盘失败次数
+ */
+int UserRepository::failedFlushCount() const {
+    return committer.failedFlushCount();
 }
\ No newline at end of file
@@ -2,18 +2,23 @@
 #define USERREPOSITORY_H
 
 #include "User.h"
+#include "GroupCommitter.h"
+#include "UserStore.h"
 #include <QHash>
 #include <QList>
 #include <QString>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <memory>
 
 /**
  * @brief 用户仓库类
  * 
  * UserRepository类负责用户数据的持久化操作，
- * 提供查找用户、检查用户角色以及JSON序列化等方法
+ * 提供查找用户、检查用户角色以及JSON序列化等方法。
+ * 用户的读写委托给UserStore存储后端，默认是users.json文件，也可以使用SQLite数据库。
+ * 新增用户按FlushPolicy组提交，调用flush()或析构时保证全部落盘
  */
 class UserRepository {
 public:
@@ -22,6 +27,20 @@ public:
      */
     UserRepository();
 
+    /**
+     * @brief 使用指定存储后端的构造函数
+     * @param store 存储后端，由仓库接管
+     */
+    explicit UserRepository(std::unique_ptr<UserStore> store);
+
+    /**
+     * @brief 析构函数，写出尚未落盘的用户
+     */
+    ~UserRepository();
+
+    UserRepository(const UserRepository&) = delete;
+    UserRepository& operator=(const UserRepository&) = delete;
+
     /**
      * @brief 根据用户ID查找用户
      * @param userId 用户ID
@@ -82,22 +101,36 @@ public:
      * @param user 用户指针
      * @return JSON对象
      */
-    static QJsonObject userToJson(User* user);
+    static QJsonObject userToJson(const User* user);
 
     /**
-     * @brief 从JSON文件加载数据
-     * @return 加载成功返回true，否则返回false
+     * @brief 落盘屏障：立即写出尚未落盘的用户
+     * @return 写出成功返回true，否则返回false
+     */
+    bool flush();
+
+    /**
+     * @brief 设置组提交的落盘策略
+     * @param policy 落盘策略
+     */
+    void setFlushPolicy(const FlushPolicy& policy);
+
+    /**
+     * @brief 获取已执行的落盘次数
+     * @return 落盘次数
      */
-    bool loadFromJsonFile();
+    int flushCount() const;
 
     /**
-     * @brief 保存数据到JSON文件
-     * @return 保存成功返回true，否则返回false
+     * @brief 获取失败的落盘次数，包括定时器触发、没有调用者接收结果的落盘
+     * @return 落盘失败次数
      */
-    bool saveToJsonFile();
+    int failedFlushCount() const;
 
 private:
-    QHash<int, User*> users; ///< 用户存储哈希表，键为用户ID
+    QHash<int, User*> users;            ///< 用户存储哈希表，键为用户ID
+    std::unique_ptr<UserStore> backend; ///< 存储后端
+    GroupCommitter committer;           ///< 组提交器
 };
 
 #endif // USERREPOSITORY_H
\ No newline at end of file
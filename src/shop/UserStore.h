@@ -0,0 +1,41 @@
+#ifndef USERSTORE_H
+#define USERSTORE_H
+
+#include "User.h"
+#include <functional>
+
+/**
+ * @brief 用户存储后端接口
+ *
+ * UserStore定义UserRepository委托的持久化操作：load()逐个创建已持久化的用户，
+ * save()记录一次单行写入，commit()把自上次提交以来的写入一次性落盘
+ */
+class UserStore {
+public:
+    /**
+     * @brief 虚析构函数
+     */
+    virtual ~UserStore() = default;
+
+    /**
+     * @brief 打开存储并加载已持久化的用户
+     * @param onUser 每创建一个用户调用一次，用户的所有权转移给回调
+     * @return 加载成功返回true，否则返回false
+     */
+    virtual bool load(const std::function<void(User*)>& onUser) = 0;
+
+    /**
+     * @brief 保存一个用户（新增或覆盖），在下一次commit()时落盘
+     * @param user 用户对象
+     * @return 保存成功返回true，否则返回false
+     */
+    virtual bool save(const User& user) = 0;
+
+    /**
+     * @brief 把自上次提交以来的写入落盘
+     * @return 落盘成功返回true，否则返回false
+     */
+    virtual bool commit() = 0;
+};
+
+#endif // USERSTORE_H
\ No newline at end of file
@@ -3,10 +3,12 @@
 #include <QMenu>
 #include <QAction>
 #include <QMessageBox>
+#include <QTimer>
 #include <QVBoxLayout>
 #include <QWidget>
 #include "shop/ProductManager.h"
 #include "shop/ProductRepository.h"
+#include "shop/SearchCriteria.h"
 #include "shop/UserRepository.h"
 #include "shop/NormalUser.h"
 #include "shop/Administrator.h"
@@ -20,6 +22,7 @@ MainWindow::MainWindow(const QString& userType, int userId, QWidget* parent)
     , productManager(new ProductManager(*productRepository, *userRepository))
     , m_productListWidget(new ProductListWidget())
     , m_productEditWidget(nullptr)
+    , m_hasMoreProducts(true)
 {
     // 设置窗口标题
     setWindowTitle(QString("购物应用 - %1").arg(userType == "admin" ? "管理员" : "普通用户"));
@@ -70,16 +73,18 @@ MainWindow::MainWindow(const QString& userType, int userId, QWidget* parent)
         });
     }
 
-    // 加载商品数据
+    // 加载商品数据，滚动到底部时加载下一页
+    connect(m_productListWidget, &ProductListWidget::scrolledToEnd, this, &MainWindow::loadMoreProducts);
     loadProducts();
 }
 
 MainWindow::~MainWindow() 
 {
-    if (!productRepository->saveToFile())
+    // 落盘屏障：写出所有尚未组提交的变更
+    if (!productRepository->flush())
         qDebug() << "保存商品数据失败";
     
-    if (!userRepository->saveToJsonFile())
+    if (!userRepository->flush())
         qDebug() << "保存用户数据失败";
 
     qDebug() << "保存成功";
@@ -91,15 +96,35 @@ MainWindow::~MainWindow()
 
 void MainWindow::loadProducts()
 {
-    // 清空现有商品
+    // 清空现有商品，从第一页开始加载
     m_productListWidget->clearProducts();
-    
-    // 获取所有商品并添加到列表
-    QList<Product> products = productManager->getAllProducts();
-    
-    for (const Product& product : products) {
+    m_nextCursor.clear();
+    m_hasMoreProducts = true;
+    loadMoreProducts();
+}
+
+void MainWindow::loadMoreProducts()
+{
+    const int pageSize = 50;
+    if (!m_hasMoreProducts)
+        return;
+    
+    // 沿发布时间索引按从新到旧取下一页，只为本页商品创建控件
+    SearchCriteria newestFirst;
+    newestFirst.setSortOrder(SearchCriteria::SortByNewest);
+    newestFirst.setPage(0, pageSize);
+    newestFirst.setCursor(m_nextCursor);
+    ProductPage page = productManager->searchProductPage(newestFirst);
+    
+    for (const Product& product : page.getProducts()) {
         m_productListWidget->addProduct(product);
     }
+    m_nextCursor = page.getNextCursor();
+    m_hasMoreProducts = page.hasNextPage();
+    
+    // 本页没有填满列表时不会滚动，等布局更新滚动条后再检查一次，直到填满或没有下一页
+    if (m_hasMoreProducts)
+        QTimer::singleShot(0, m_productListWidget, &ProductListWidget::checkScrolledToEnd);
 }
 
 void MainWindow::onPublishProduct()
@@ -19,6 +19,7 @@ public:
 
 private slots:
     void onPublishProduct();
+    void loadMoreProducts();
 
 private:
     void loadProducts();
@@ -30,6 +31,8 @@ private:
     ProductManager* productManager;
     ProductListWidget* m_productListWidget;
     ProductEditWidget* m_productEditWidget;
+    QString m_nextCursor;
+    bool m_hasMoreProducts;
 };
 
 #endif // MAINWINDOW_H
\ No newline at end of file
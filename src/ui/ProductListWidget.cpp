@@ -8,6 +8,7 @@
 #include <QString>
 #include <QMouseEvent>
 #include <QScrollArea>
+#include <QScrollBar>
 #include <QStackedWidget>
 #include <QApplication>
 
@@ -24,6 +25,15 @@ ProductListWidget::ProductListWidget(QWidget *parent) :
     QWidget* contentWidget = new QWidget();
     contentWidget->setLayout(productListLayout);
     scrollArea->setWidget(contentWidget);
+    connect(scrollArea->verticalScrollBar(), &QScrollBar::valueChanged, this, [this](int value) {
+        if (value == scrollArea->verticalScrollBar()->maximum())
+            emit scrolledToEnd();
+    });
+    // 窗口变大或内容变少时滚动条的范围可能缩到当前位置，此时不会再有valueChanged
+    connect(scrollArea->verticalScrollBar(), &QScrollBar::rangeChanged, this, [this](int, int maximum) {
+        if (scrollArea->verticalScrollBar()->value() == maximum)
+            emit scrolledToEnd();
+    });
     
     // 创建页面布局
     QVBoxLayout* pageLayout = new QVBoxLayout();
@@ -65,6 +75,13 @@ void ProductListWidget::addProduct(const Product& product)
     productListLayout->addWidget(productWidget);
 }
 
+void ProductListWidget::checkScrolledToEnd()
+{
+    // 内容不足一屏时滚动条没有范围，范围保持为0也不会发出rangeChanged
+    if (scrollArea->verticalScrollBar()->value() == scrollArea->verticalScrollBar()->maximum())
+        emit scrolledToEnd();
+}
+
 void ProductListWidget::clearProducts()
 {
     // 清空布局中的所有控件
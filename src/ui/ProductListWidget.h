@@ -26,6 +26,13 @@ public:
     // 清空商品列表
     void clearProducts();
 
+    // 列表已在底部（包括内容不足一屏）时发出scrolledToEnd
+    void checkScrolledToEnd();
+
+signals:
+    // 列表滚动到底部，可以加载下一页
+    void scrolledToEnd();
+
 protected:
     // 事件过滤器
     bool eventFilter(QObject *obj, QEvent *event) override;
@@ -1,16 +1,24 @@
 #include <iostream>
+#include <memory>
 #include <gtest/gtest.h>
 #include <QList>
 #include <QString>
 #include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
 
 #include "ProductRepository.h"
 #include "UserRepository.h"
 #include "ProductManager.h"
+#include "SearchCriteria.h"
+#include "SearchFacets.h"
 #include "Product.h"
 #include "User.h"
 #include "Administrator.h"
 #include "NormalUser.h"
+#include "SqliteProductStore.h"
+#include "FileProductStore.h"
 
 /**
  * @brief 集成测试报告
@@ -24,6 +32,38 @@
  * 测试工具：Google Test框架
  */
 
+/**
+ * @brief 测试专用的数据目录
+ *
+ * 构造时创建临时目录，并通过SHOP_DATA_DIR让此后创建的仓库在其中读写数据文件；
+ * 析构时恢复原来的设置并删除目录。作为夹具的第一个成员，在所有仓库析构之后才删除
+ */
+class TemporaryDataDirectory {
+public:
+    TemporaryDataDirectory() : previous(qgetenv("SHOP_DATA_DIR")) {
+        qputenv("SHOP_DATA_DIR", directory.path().toUtf8());
+    }
+
+    ~TemporaryDataDirectory() {
+        if (previous.isEmpty()) {
+            qunsetenv("SHOP_DATA_DIR");
+        } else {
+            qputenv("SHOP_DATA_DIR", previous);
+        }
+    }
+
+    TemporaryDataDirectory(const TemporaryDataDirectory&) = delete;
+    TemporaryDataDirectory& operator=(const TemporaryDataDirectory&) = delete;
+
+    QString filePath(const QString& fileName) const {
+        return directory.filePath(fileName);
+    }
+
+private:
+    QTemporaryDir directory; ///< 临时目录
+    QByteArray previous;     ///< 原来的SHOP_DATA_DIR
+};
+
 // 第一组集成测试：ProductRepository 与 Product 的集成
 class ProductRepoIntegrationTest : public ::testing::Test {
 protected:
@@ -33,6 +73,7 @@ protected:
                               QList<QString>() << "测试" << "商品", QDateTime::currentDateTime(), "active");
     }
 
+    TemporaryDataDirectory dataDirectory;
     Product testProduct;
     ProductRepository repo;
 };
@@ -88,6 +129,332 @@ TEST_F(ProductRepoIntegrationTest, RemoveProduct) {
     EXPECT_EQ(verifyDeleted.getProductId(), 0) << "商品应该已被删除（ID为0）";
 }
 
+TEST_F(ProductRepoIntegrationTest, JournalReplayAfterRestart) {
+    // 变更只追加到日志，重新打开仓库时由日志重放恢复
+    Product journaled(90001, "日志商品", 1, "验证日志重放", 10.0, 1001, "北京",
+                      QList<QString>() << "日志", QDateTime::currentDateTime(), "active");
+    ASSERT_TRUE(repo.save(journaled));
+    journaled.setPrice(88.8);
+    ASSERT_TRUE(repo.update(journaled));
+    EXPECT_GT(repo.journalEntryCount(), 0) << "变更应该写入日志";
+    ASSERT_TRUE(repo.flush());
+    
+    {
+        ProductRepository reopened;
+        EXPECT_EQ(reopened.findById(90001).getPrice(), 88.8) << "重放日志后应得到最新价格";
+    }
+    
+    ASSERT_TRUE(repo.remove(90001));
+    ASSERT_TRUE(repo.flush());
+    ProductRepository reopened;
+    EXPECT_EQ(reopened.findById(90001).getProductId(), 0) << "删除记录也应该被重放";
+}
+
+TEST_F(ProductRepoIntegrationTest, CheckpointTruncatesJournal) {
+    Product checkpointed(90002, "快照商品", 1, "验证检查点", 20.0, 1001, "上海",
+                         QList<QString>(), QDateTime::currentDateTime(), "active");
+    repo.save(checkpointed);
+    
+    // 检查点写出快照并清空日志
+    ASSERT_TRUE(repo.saveToFile());
+    EXPECT_EQ(repo.journalEntryCount(), 0) << "检查点之后日志应该为空";
+    
+    {
+        ProductRepository reopened;
+        EXPECT_EQ(reopened.findById(90002).getTitle(), "快照商品") << "快照中应该包含已保存的商品";
+    }
+}
+
+TEST_F(ProductRepoIntegrationTest, BinarySnapshotOverlay) {
+    for (int i = 0; i < 3; ++i) {
+        Product product(92000 + i, QString("快照商品%1").arg(i), 1, "验证二进制快照", 10.0 + i, 1002, "广州",
+                        QList<QString>() << "快照", QDateTime::currentDateTime(), "active");
+        ASSERT_TRUE(repo.save(product));
+    }
+    ASSERT_TRUE(repo.saveToFile());
+    
+    {
+        // 重新打开时只映射快照，商品在查找时解码
+        ProductRepository reopened;
+        EXPECT_EQ(reopened.findById(92001).getTitle(), "快照商品1");
+        EXPECT_EQ(reopened.findBySellerId(1002).size(), 3);
+        
+        // 在快照之上修改和删除
+        Product changed = reopened.findById(92000);
+        changed.setTitle("已修改");
+        ASSERT_TRUE(reopened.update(changed));
+        ASSERT_TRUE(reopened.remove(92002));
+        EXPECT_FALSE(reopened.remove(92002)) << "已删除的快照商品不应再次删除";
+        EXPECT_EQ(reopened.findById(92000).getTitle(), "已修改");
+        EXPECT_EQ(reopened.findById(92002).getProductId(), 0);
+        EXPECT_EQ(reopened.findBySellerId(1002).size(), 2);
+        
+        // JSON导出包含快照和内存中的变更，并可重新导入
+        QString json = reopened.dumpToJson();
+        EXPECT_TRUE(json.contains("已修改"));
+        EXPECT_FALSE(json.contains("快照商品2"));
+        EXPECT_TRUE(reopened.loadFromJson(json));
+        EXPECT_EQ(reopened.findBySellerId(1002).size(), 2);
+        ASSERT_TRUE(reopened.flush());
+    }
+    
+    ProductRepository reopened;
+    EXPECT_EQ(reopened.findById(92000).getTitle(), "已修改") << "快照之上的日志应被重放";
+    EXPECT_EQ(reopened.findById(92002).getProductId(), 0);
+}
+
+TEST_F(ProductRepoIntegrationTest, ParallelJsonLoadIsIdentical) {
+    QList<QString> tags = QList<QString>() << "并行" << "加载";
+    QString json = "[";
+    for (int i = 0; i < 8000; ++i) {
+        Product product(93000 + i, QString("并行商品%1").arg(i), i % 5, QString(100, QChar('x')), i * 1.25, 1003, "深圳",
+                        tags, QDateTime::currentDateTime(), "active");
+        QJsonDocument doc(Product::toJson(product));
+        json += (i > 0 ? "," : "") + QString::fromUtf8(doc.toJson(QJsonDocument::Compact));
+    }
+    json += "]";
+    
+    ProductRepository sequential;
+    sequential.setLoadThreadCount(1);
+    ASSERT_TRUE(sequential.loadFromJson(json));
+    
+    ProductRepository parallel;
+    parallel.setLoadThreadCount(8);
+    ASSERT_TRUE(parallel.loadFromJson(json));
+    
+    EXPECT_EQ(parallel.dumpToJson(), sequential.dumpToJson()) << "多线程加载的结果应与单线程完全一致";
+    EXPECT_EQ(parallel.generateNextId(), sequential.generateNextId());
+    EXPECT_EQ(parallel.findBySellerId(1003).size(), 8000);
+}
+
+TEST_F(ProductRepoIntegrationTest, GroupCommitBatchesWrites) {
+    // 每100次变更才落盘一次，不按时间落盘
+    repo.setFlushPolicy(FlushPolicy::batched(100, 0));
+    int flushesBefore = repo.flushCount();
+    
+    for (int i = 0; i < 250; ++i) {
+        Product product(91000 + i, QString("批量商品%1").arg(i), 1, "验证组提交", 1.0 + i, 1001, "北京",
+                        QList<QString>(), QDateTime::currentDateTime(), "active");
+        ASSERT_TRUE(repo.save(product));
+    }
+    EXPECT_EQ(repo.flushCount() - flushesBefore, 2) << "250次保存应只落盘两次";
+    EXPECT_EQ(repo.pendingMutationCount(), 50) << "剩余变更应等待下一次落盘";
+    
+    // 显式屏障之后所有变更都应可见
+    ASSERT_TRUE(repo.flush());
+    EXPECT_EQ(repo.pendingMutationCount(), 0);
+    EXPECT_EQ(repo.failedFlushCount(), 0);
+    {
+        ProductRepository reopened;
+        EXPECT_EQ(reopened.findById(91249).getTitle(), "批量商品249");
+    }
+}
+
+TEST_F(ProductRepoIntegrationTest, SellerIndexTracksMutations) {
+    for (int i = 0; i < 6; ++i) {
+        Product product(94000 + i, QString("卖家商品%1").arg(i), 1, "卖家索引", 5.0, 3000 + i % 2, "南京",
+                        QList<QString>(), QDateTime::currentDateTime(), "active");
+        ASSERT_TRUE(repo.save(product));
+    }
+    ASSERT_TRUE(repo.saveToFile());
+    
+    // 快照中的商品改换卖家，随后删除一个
+    Product moved = repo.findById(94000);
+    moved.setSellerId(3001);
+    ASSERT_TRUE(repo.update(moved));
+    ASSERT_TRUE(repo.remove(94002));
+    
+    QList<Product> first = repo.findBySellerId(3000);
+    ASSERT_EQ(first.size(), 1);
+    EXPECT_EQ(first.at(0).getProductId(), 94004);
+    QList<Product> second = repo.findBySellerId(3001);
+    ASSERT_EQ(second.size(), 4);
+    EXPECT_EQ(second.at(0).getProductId(), 94000) << "结果应按商品ID升序排列";
+    EXPECT_TRUE(repo.findBySellerId(3002).isEmpty());
+    
+    NormalUser seller(3001, 2, "seller", "password");
+    EXPECT_EQ(seller.getOwnedProducts(repo).size(), 4);
+    
+    // 重新打开后快照中的商品由快照的卖家表查找，日志中的变更由内存索引查找
+    ASSERT_TRUE(repo.flush());
+    {
+        ProductRepository reopened;
+        EXPECT_EQ(reopened.findBySellerId(3000).size(), 1);
+        EXPECT_EQ(reopened.findBySellerId(3001).size(), 4);
+        
+        // 检查点之后全部由新快照的卖家表查找
+        ASSERT_TRUE(reopened.saveToFile());
+        EXPECT_EQ(reopened.journalEntryCount(), 0);
+        QList<Product> rewritten = reopened.findBySellerId(3001);
+        ASSERT_EQ(rewritten.size(), 4);
+        EXPECT_EQ(rewritten.at(0).getProductId(), 94000);
+        EXPECT_EQ(rewritten.at(3).getProductId(), 94005);
+    }
+    
+    // 卖家的商品全部删除后索引中不再有该卖家
+    for (int productId : {94000, 94001, 94003, 94005}) {
+        ASSERT_TRUE(repo.remove(productId));
+    }
+    EXPECT_TRUE(repo.findBySellerId(3001).isEmpty());
+}
+
+TEST_F(ProductRepoIntegrationTest, SqliteBackendPersistsRows) {
+    const QString databaseFile = dataDirectory.filePath("test_products.db");
+    {
+        ProductRepository sqliteRepo(std::unique_ptr<ProductStore>(new SqliteProductStore(databaseFile)));
+        sqliteRepo.setFlushPolicy(FlushPolicy::batched(10, 0));
+        for (int i = 0; i < 25; ++i) {
+            Product product(0, QString("数据库商品%1").arg(i), i % 3, "逐行写入", 10.0 + i, 2000 + i % 2, "杭州",
+                            QList<QString>() << "数据库" << "商品", QDateTime::currentDateTime(), "active");
+            ASSERT_TRUE(sqliteRepo.save(product));
+        }
+        EXPECT_EQ(sqliteRepo.pendingMutationCount(), 5) << "未提交的变更应处于同一事务中";
+        EXPECT_EQ(sqliteRepo.findById(25).getTitle(), "数据库商品24") << "事务内的写入应立即可见";
+        
+        Product changed = sqliteRepo.findById(3);
+        changed.setPrice(99.5);
+        ASSERT_TRUE(sqliteRepo.update(changed));
+        ASSERT_TRUE(sqliteRepo.remove(4));
+        EXPECT_FALSE(sqliteRepo.remove(4));
+        EXPECT_EQ(sqliteRepo.journalEntryCount(), 0);
+    }
+    
+    ProductRepository reopened(std::unique_ptr<ProductStore>(new SqliteProductStore(databaseFile)));
+    EXPECT_EQ(reopened.getAllProducts().size(), 24) << "析构时应提交剩余事务";
+    EXPECT_DOUBLE_EQ(reopened.findById(3).getPrice(), 99.5);
+    EXPECT_EQ(reopened.findById(3).getTags(), QList<QString>() << "数据库" << "商品");
+    EXPECT_EQ(reopened.findById(4).getProductId(), 0);
+    EXPECT_EQ(reopened.findBySellerId(2000).size(), 13);
+    EXPECT_EQ(reopened.generateNextId(), 26);
+}
+
+/**
+ * @brief 可以让分类树写出失败的文件存储
+ */
+class FailingCategoryStore : public FileProductStore {
+public:
+    explicit FailingCategoryStore(const bool* failWrites) : failWrites(failWrites) {
+    }
+
+    bool saveCategories(const QJsonArray& categories) override {
+        return !*failWrites && FileProductStore::saveCategories(categories);
+    }
+
+private:
+    const bool* failWrites; ///< 为true时写出失败
+};
+
+/**
+ * @brief 可以让提交失败的文件存储
+ */
+class FailingCommitStore : public FileProductStore {
+public:
+    explicit FailingCommitStore(const bool* failCommits) : failCommits(failCommits) {
+    }
+
+    bool commit() override {
+        return !*failCommits && FileProductStore::commit();
+    }
+
+private:
+    const bool* failCommits; ///< 为true时提交失败
+};
+
+TEST_F(ProductRepoIntegrationTest, FailedFlushesAreCounted) {
+    bool failCommits = true;
+    ProductRepository failing(std::unique_ptr<ProductStore>(new FailingCommitStore(&failCommits)));
+    failing.setFlushPolicy(FlushPolicy::batched(2, 0));
+    Product product(93500, "落盘失败", 1, "", 1.0, 1001, "北京", QList<QString>(), QDateTime::currentDateTime(),
+                    "active");
+    ASSERT_TRUE(failing.save(product));
+    product.setProductId(93501);
+    EXPECT_FALSE(failing.save(product)) << "第二次变更触发的落盘失败";
+    EXPECT_EQ(failing.failedFlushCount(), 1);
+    EXPECT_EQ(failing.pendingMutationCount(), 2) << "失败后变更仍等待落盘";
+    
+    failCommits = false;
+    ASSERT_TRUE(failing.flush());
+    EXPECT_EQ(failing.pendingMutationCount(), 0);
+    EXPECT_EQ(failing.failedFlushCount(), 1);
+}
+
+TEST_F(ProductRepoIntegrationTest, CategoryChangesAreTransactional) {
+    bool failWrites = false;
+    ProductRepository categories(std::unique_ptr<ProductStore>(new FailingCategoryStore(&failWrites)));
+    int notifications = 0;
+    categories.addChangeListener([&notifications](const Product&, const Product&) {
+        ++notifications;
+    });
+    ASSERT_TRUE(categories.addCategory(1, "电子产品"));
+    ASSERT_TRUE(categories.addCategory(2, "手机", 1));
+    ASSERT_TRUE(categories.addCategory(3, "配件"));
+    EXPECT_EQ(notifications, 3);
+    
+    // 写出失败时内存中的分类树保持不变，也不通知变更
+    failWrites = true;
+    EXPECT_FALSE(categories.addCategory(4, "电脑", 1));
+    EXPECT_FALSE(categories.moveCategory(2, 3));
+    EXPECT_FALSE(categories.removeCategory(3));
+    EXPECT_EQ(notifications, 3);
+    EXPECT_EQ(categories.categoryTree().size(), 3);
+    EXPECT_FALSE(categories.categoryTree().contains(4));
+    EXPECT_TRUE(categories.categoryTree().isWithin(1, 2));
+    EXPECT_TRUE(categories.categoryTree().contains(3));
+    
+    failWrites = false;
+    ASSERT_TRUE(categories.moveCategory(2, 3));
+    EXPECT_TRUE(categories.categoryTree().isWithin(3, 2));
+    EXPECT_EQ(notifications, 4);
+}
+
+TEST_F(ProductRepoIntegrationTest, ImportedDataSurvivesRestart) {
+    auto catalog = [](int firstId, int count) {
+        QString json = "[";
+        for (int i = 0; i < count; ++i) {
+            Product product(firstId + i, QString("导入商品%1").arg(i), 1, "验证导入落盘", 1.0 + i, 1004, "成都",
+                            QList<QString>(), QDateTime::currentDateTime(), "active");
+            json += (i > 0 ? "," : "") + QString::fromUtf8(QJsonDocument(Product::toJson(product)).toJson(QJsonDocument::Compact));
+        }
+        return json + "]";
+    };
+    const QString databaseFile = dataDirectory.filePath("import.db");
+    auto createStores = [&databaseFile]() {
+        std::vector<std::unique_ptr<ProductStore>> stores;
+        stores.emplace_back(new FileProductStore());
+        stores.emplace_back(new SqliteProductStore(databaseFile));
+        return stores;
+    };
+    
+    // 小批量导入写入日志，大批量导入直接写快照；两种存储后端重新打开后都能读到全部商品
+    {
+        std::vector<std::unique_ptr<ProductStore>> stores = createStores();
+        for (std::unique_ptr<ProductStore>& store : stores) {
+            ProductRepository imported(std::move(store));
+            imported.setFlushPolicy(FlushPolicy::batched(100000, 0));
+            ASSERT_TRUE(imported.loadFromJson(catalog(95000, 500)));
+            ASSERT_TRUE(imported.loadFromJson(catalog(96000, 1500)));
+            EXPECT_EQ(imported.journalEntryCount(), 0) << "大批量导入应该直接写出快照";
+        }
+    }
+    std::vector<std::unique_ptr<ProductStore>> stores = createStores();
+    for (std::unique_ptr<ProductStore>& store : stores) {
+        ProductRepository reopened(std::move(store));
+        EXPECT_EQ(reopened.getAllProducts().size(), 2000);
+        EXPECT_EQ(reopened.findById(95499).getTitle(), "导入商品499");
+        EXPECT_EQ(reopened.findBySellerId(1004).size(), 2000);
+        EXPECT_EQ(reopened.generateNextId(), 97500);
+    }
+    
+    // 导入的用户同样立即落盘
+    {
+        UserRepository users;
+        ASSERT_TRUE(users.loadFromJson("[{\"userId\":7,\"roleId\":2,\"username\":\"imported\",\"password\":\"pw\"}]"));
+    }
+    UserRepository users;
+    ASSERT_NE(users.findById(7), nullptr);
+    EXPECT_EQ(users.findById(7)->getUsername(), "imported");
+}
+
 // 第二组集成测试：ProductManager 与 ProductRepository、UserRepository 的集成
 class ProductManagerIntegrationTest : public ::testing::Test {
 protected:
@@ -100,11 +467,15 @@ protected:
     }
 
     void TearDown() override {
+        // 先落盘再释放用户对象，避免仓库析构时访问已释放的用户
+        userRepo.flush();
+        
         // 清理资源
         delete admin;
         delete normalUser;
     }
 
+    TemporaryDataDirectory dataDirectory;
     ProductRepository productRepo;
     UserRepository userRepo;
     ProductManager manager{productRepo, userRepo};
@@ -194,4 +565,921 @@ TEST_F(ProductManagerIntegrationTest, PermissionControl) {
     // 根据权限控制逻辑，这可能成功或失败，取决于具体实现
     // 假设只有商品所有者可以编辑，那么这个操作应该失败
     EXPECT_FALSE(unauthorizedEditResult) << "非商品所有者不应该能编辑商品";
-}
\ No newline at end of file
+}
+
+TEST_F(ProductManagerIntegrationTest, SearchProductsUsesIndexes) {
+    QDateTime now = QDateTime::currentDateTime();
+    QList<Product> listings;
+    listings << Product(0, "二手手机", 1, "九成新 iPhone", 1999.0, 0, "北京", QList<QString>() << "二手" << "数码", now, "active")
+             << Product(0, "全新手机", 1, "未拆封", 3999.0, 0, "上海", QList<QString>() << "数码", now, "active")
+             << Product(0, "二手自行车", 2, "通勤用 iphone支架", 299.0, 0, "北京", QList<QString>() << "二手", now, "sold")
+             << Product(0, "书桌", 3, "实木", 450.0, 0, "北京", QList<QString>(), now, "active");
+    QList<int> ids;
+    for (const Product& listing : listings) {
+        int productId = 0;
+        ASSERT_TRUE(manager.publishProduct(listing, 2, &productId));
+        ids.append(productId);
+    }
+    
+    SearchCriteria byCategory;
+    byCategory.setCategoryId(1);
+    EXPECT_EQ(manager.searchProducts(byCategory).size(), 2);
+    
+    SearchCriteria combined;
+    combined.setTags(QList<QString>() << "二手");
+    combined.setLocation("北京");
+    combined.setStatus("active");
+    QList<Product> found = manager.searchProducts(combined);
+    ASSERT_EQ(found.size(), 1);
+    EXPECT_EQ(found.at(0).getTitle(), "二手手机");
+    
+    // 关键词不区分大小写，匹配标题或描述；价格区间为闭区间
+    SearchCriteria byKeyword;
+    byKeyword.setKeyword("IPHONE");
+    byKeyword.setSellerId(2);
+    byKeyword.setPriceRange(299.0, 1999.0);
+    EXPECT_EQ(manager.searchProducts(byKeyword).size(), 2);
+    
+    // 只有价格条件时退化为过滤扫描
+    SearchCriteria byPrice;
+    byPrice.setMinPrice(3999.0);
+    byPrice.setMaxPrice(3999.0);
+    EXPECT_EQ(manager.searchProducts(byPrice).size(), 1);
+    
+    SearchCriteria missing;
+    missing.setTags(QList<QString>() << "二手" << "不存在的标签");
+    EXPECT_TRUE(manager.searchProducts(missing).isEmpty());
+    
+    // 编辑和删除之后索引同步更新
+    Product edited = listings.at(1);
+    edited.setCategoryId(2);
+    ASSERT_TRUE(manager.editProduct(ids.at(1), edited, 2));
+    EXPECT_EQ(manager.searchProducts(byCategory).size(), 1);
+    ASSERT_TRUE(manager.deleteProduct(ids.at(0), 2));
+    EXPECT_TRUE(manager.searchProducts(byCategory).isEmpty());
+    EXPECT_TRUE(manager.searchProducts(combined).isEmpty());
+}
+
+TEST_F(ProductManagerIntegrationTest, KeywordSearchUsesTextIndex) {
+    QDateTime now = QDateTime::currentDateTime();
+    QList<Product> listings;
+    listings << Product(0, "机械键盘青轴", 1, "宿舍自用 Cherry轴体", 260.0, 0, "北京", QList<QString>(), now, "active")
+             << Product(0, "键盘手托", 1, "配合机械键盘使用", 35.0, 0, "北京", QList<QString>(), now, "active")
+             << Product(0, "盘面清洁布", 1, "机械 键 专用", 9.9, 0, "北京", QList<QString>(), now, "active");
+    QList<int> ids;
+    for (const Product& listing : listings) {
+        int productId = 0;
+        ASSERT_TRUE(manager.publishProduct(listing, 2, &productId));
+        ids.append(productId);
+    }
+    
+    SearchCriteria criteria;
+    criteria.setCategoryId(1);
+    
+    // 中文按二元组检索，同时匹配标题和描述
+    criteria.setKeyword("机械键盘");
+    EXPECT_EQ(manager.searchProducts(criteria).size(), 2);
+    
+    // 二元组都出现但不相邻的商品不算命中
+    criteria.setKeyword("械键盘面");
+    EXPECT_TRUE(manager.searchProducts(criteria).isEmpty());
+    
+    // 单字检索
+    criteria.setKeyword("托");
+    EXPECT_EQ(manager.searchProducts(criteria).size(), 1);
+    
+    // 英文按单词检索，不区分大小写
+    criteria.setKeyword("cherry");
+    ASSERT_EQ(manager.searchProducts(criteria).size(), 1);
+    EXPECT_EQ(manager.searchProducts(criteria).at(0).getProductId(), ids.at(0));
+    
+    // 修改描述后旧词项失效
+    Product edited = listings.at(0);
+    edited.setDescription("宿舍自用 红轴");
+    ASSERT_TRUE(manager.editProduct(ids.at(0), edited, 2));
+    EXPECT_TRUE(manager.searchProducts(criteria).isEmpty());
+    criteria.setKeyword("红轴");
+    EXPECT_EQ(manager.searchProducts(criteria).size(), 1);
+}
+
+TEST_F(ProductManagerIntegrationTest, TagBitmapQueries) {
+    QDateTime now = QDateTime::currentDateTime();
+    QList<Product> listings;
+    listings << Product(0, "相机", 1, "", 800.0, 0, "北京", QList<QString>() << "标签甲" << "标签乙", now, "active")
+             << Product(0, "镜头", 1, "", 600.0, 0, "北京", QList<QString>() << "标签甲", now, "active")
+             << Product(0, "三脚架", 1, "", 90.0, 0, "北京", QList<QString>() << "标签乙" << "标签丙", now, "active")
+             << Product(0, "背包", 1, "", 120.0, 0, "北京", QList<QString>(), now, "active");
+    QList<int> ids;
+    for (const Product& listing : listings) {
+        int productId = 0;
+        ASSERT_TRUE(manager.publishProduct(listing, 2, &productId));
+        ids.append(productId);
+    }
+    
+    SearchCriteria both;
+    both.setTags(QList<QString>() << "标签甲" << "标签乙");
+    ASSERT_EQ(manager.searchProducts(both).size(), 1);
+    EXPECT_EQ(manager.searchProducts(both).at(0).getProductId(), ids.at(0));
+    
+    SearchCriteria either;
+    either.setAnyTags(QList<QString>() << "标签甲" << "标签丙");
+    EXPECT_EQ(manager.searchProducts(either).size(), 3);
+    
+    // “或”减去“非”
+    either.setExcludedTags(QList<QString>() << "标签乙");
+    ASSERT_EQ(manager.searchProducts(either).size(), 1);
+    EXPECT_EQ(manager.searchProducts(either).at(0).getProductId(), ids.at(1));
+    
+    // 只有排除标签时与其他条件组合
+    SearchCriteria withoutTag;
+    withoutTag.setCategoryId(1);
+    withoutTag.setExcludedTags(QList<QString>() << "标签甲" << "标签丙");
+    ASSERT_EQ(manager.searchProducts(withoutTag).size(), 1);
+    EXPECT_EQ(manager.searchProducts(withoutTag).at(0).getProductId(), ids.at(3));
+    
+    // 标签计数随增删更新
+    QHash<QString, int> counts = manager.getTagCounts();
+    EXPECT_EQ(counts.value("标签甲"), 2);
+    EXPECT_EQ(counts.value("标签乙"), 2);
+    EXPECT_EQ(counts.value("标签丙"), 1);
+    ASSERT_TRUE(manager.deleteProduct(ids.at(2), 2));
+    counts = manager.getTagCounts();
+    EXPECT_EQ(counts.value("标签乙"), 1);
+    EXPECT_FALSE(counts.contains("标签丙"));
+}
+
+TEST_F(ProductManagerIntegrationTest, PriceOrderedPages) {
+    QDateTime now = QDateTime::currentDateTime();
+    const QList<double> prices = QList<double>() << 50.0 << 10.0 << 30.0 << 30.0 << 70.0 << 20.0;
+    QList<int> ids;
+    for (double price : prices) {
+        Product listing(0, "价格测试", 1, "", price, 0, "北京", QList<QString>(), now, "active");
+        int productId = 0;
+        ASSERT_TRUE(manager.publishProduct(listing, 2, &productId));
+        ids.append(productId);
+    }
+    
+    SearchCriteria criteria;
+    criteria.setCategoryId(1);
+    criteria.setSortOrder(SearchCriteria::SortByPriceAscending);
+    QList<Product> ascending = manager.searchProducts(criteria);
+    ASSERT_EQ(ascending.size(), 6);
+    for (int i = 1; i < ascending.size(); ++i) {
+        EXPECT_LE(ascending.at(i - 1).getPrice(), ascending.at(i).getPrice());
+    }
+    // 价格相同时按商品ID排序
+    EXPECT_EQ(ascending.at(2).getProductId(), ids.at(2));
+    EXPECT_EQ(ascending.at(3).getProductId(), ids.at(3));
+    
+    // 降序分页
+    criteria.setSortOrder(SearchCriteria::SortByPriceDescending);
+    criteria.setPage(1, 2);
+    QList<Product> page = manager.searchProducts(criteria);
+    ASSERT_EQ(page.size(), 2);
+    EXPECT_EQ(page.at(0).getPrice(), 50.0);
+    EXPECT_EQ(page.at(1).getProductId(), ids.at(3));
+    
+    // 价格区间为闭区间，修改价格后索引同步更新
+    SearchCriteria range;
+    range.setCategoryId(1);
+    range.setPriceRange(20.0, 50.0);
+    EXPECT_EQ(manager.searchProducts(range).size(), 4);
+    Product edited = manager.getProduct(ids.at(4));
+    edited.setPrice(40.0);
+    ASSERT_TRUE(manager.editProduct(ids.at(4), edited, 2));
+    EXPECT_EQ(manager.searchProducts(range).size(), 5);
+    
+    // 只有价格条件时由价格索引驱动，结果仍按商品ID升序
+    SearchCriteria priceOnly;
+    priceOnly.setPriceRange(39.5, 40.5);
+    QList<Product> found = manager.searchProducts(priceOnly);
+    ASSERT_FALSE(found.isEmpty());
+    for (int i = 1; i < found.size(); ++i) {
+        EXPECT_LT(found.at(i - 1).getProductId(), found.at(i).getProductId());
+    }
+    
+    // 没有其他条件时按价格排序的分页沿价格索引输出
+    priceOnly.setSortOrder(SearchCriteria::SortByPriceDescending);
+    priceOnly.setPage(0, 1);
+    found = manager.searchProducts(priceOnly);
+    ASSERT_EQ(found.size(), 1);
+    EXPECT_GE(found.at(0).getPrice(), 40.0);
+}
+
+TEST_F(ProductManagerIntegrationTest, LatestProductsFeed) {
+    QDateTime base = QDateTime::currentDateTime().addDays(1800);
+    // 发布顺序与发布时间不一致，最后一个是迟到的旧商品
+    const QList<int> offsets = QList<int>() << 10 << 30 << 20 << 40 << 5;
+    QList<int> ids;
+    for (int i = 0; i < offsets.size(); ++i) {
+        Product listing(0, "时间测试", i % 2 == 0 ? 1 : 2, "", 1.0, 0, "北京", QList<QString>(),
+                        base.addSecs(offsets.at(i)), "active");
+        int productId = 0;
+        ASSERT_TRUE(manager.publishProduct(listing, 2, &productId));
+        ids.append(productId);
+    }
+    
+    QList<Product> latest = manager.getLatestProducts(3);
+    ASSERT_EQ(latest.size(), 3);
+    EXPECT_EQ(latest.at(0).getProductId(), ids.at(3));
+    EXPECT_EQ(latest.at(1).getProductId(), ids.at(1));
+    EXPECT_EQ(latest.at(2).getProductId(), ids.at(2));
+    
+    QList<Product> inCategory = manager.getLatestProducts(1, 10);
+    ASSERT_EQ(inCategory.size(), 3);
+    EXPECT_EQ(inCategory.at(0).getProductId(), ids.at(2));
+    EXPECT_EQ(inCategory.at(1).getProductId(), ids.at(0));
+    EXPECT_EQ(inCategory.at(2).getProductId(), ids.at(4));
+    
+    // 与其他条件组合时同样按从新到旧排列
+    SearchCriteria criteria;
+    criteria.setCategoryId(2);
+    criteria.setSortOrder(SearchCriteria::SortByNewest);
+    criteria.setSellerId(2);
+    QList<Product> found = manager.searchProducts(criteria);
+    ASSERT_EQ(found.size(), 2);
+    EXPECT_EQ(found.at(0).getProductId(), ids.at(3));
+    
+    ASSERT_TRUE(manager.deleteProduct(ids.at(3), 2));
+    latest = manager.getLatestProducts(1);
+    ASSERT_EQ(latest.size(), 1);
+    EXPECT_EQ(latest.at(0).getProductId(), ids.at(1));
+}
+
+TEST_F(ProductManagerIntegrationTest, CursorPagination) {
+    QDateTime now = QDateTime::currentDateTime();
+    const QList<double> prices = QList<double>() << 5.0 << 3.0 << 5.0 << 1.0 << 4.0 << 5.0 << 2.0;
+    for (double price : prices) {
+        Product listing(0, "游标测试", 1, "", price, 0, "北京", QList<QString>(), now, "active");
+        ASSERT_TRUE(manager.publishProduct(listing, 2));
+    }
+    
+    // 逐页读取，拼起来与一次取完的结果一致
+    const QList<SearchCriteria::SortOrder> orders = QList<SearchCriteria::SortOrder>()
+        << SearchCriteria::SortByProductId << SearchCriteria::SortByPriceAscending
+        << SearchCriteria::SortByPriceDescending << SearchCriteria::SortByNewest;
+    for (SearchCriteria::SortOrder order : orders) {
+        SearchCriteria criteria;
+        criteria.setCategoryId(1);
+        criteria.setSortOrder(order);
+        QList<Product> all = manager.searchProducts(criteria);
+        ASSERT_EQ(all.size(), 7);
+        
+        criteria.setPage(0, 3);
+        QList<int> paged;
+        int pages = 0;
+        do {
+            ProductPage page = manager.searchProductPage(criteria);
+            for (const Product& product : page.getProducts()) {
+                paged.append(product.getProductId());
+            }
+            criteria.setCursor(page.getNextCursor());
+            ++pages;
+        } while (criteria.hasCursor() && pages < 10);
+        EXPECT_EQ(pages, 3);
+        ASSERT_EQ(paged.size(), all.size());
+        for (int i = 0; i < all.size(); ++i) {
+            EXPECT_EQ(paged.at(i), all.at(i).getProductId());
+        }
+    }
+    
+    // 不带其他条件的全量浏览由商品ID索引驱动
+    ProductPage first = manager.getProductPage(QString(), 2);
+    ASSERT_EQ(first.getProducts().size(), 2);
+    ASSERT_TRUE(first.hasNextPage());
+    ProductPage second = manager.getProductPage(first.getNextCursor(), 2);
+    ASSERT_FALSE(second.getProducts().isEmpty());
+    EXPECT_GT(second.getProducts().first().getProductId(), first.getProducts().last().getProductId());
+    
+    // 游标与排序方式不一致时视为无效
+    SearchCriteria mismatched;
+    mismatched.setSortOrder(SearchCriteria::SortByPriceAscending);
+    mismatched.setCursor(first.getNextCursor());
+    EXPECT_TRUE(manager.searchProductPage(mismatched).getProducts().isEmpty());
+}
+
+TEST_F(ProductManagerIntegrationTest, SearchFacetCounts) {
+    QDateTime now = QDateTime::currentDateTime();
+    QList<int> ids;
+    auto publish = [&](double price, const QString& location, const QList<QString>& tags, const QString& status) {
+        Product listing(0, "分面测试", 1, "", price, 0, location, tags, now, status);
+        int productId = 0;
+        ASSERT_TRUE(manager.publishProduct(listing, 2, &productId));
+        ids.append(productId);
+    };
+    publish(10.0, "北京", QList<QString>() << "分面甲" << "分面乙", "active");
+    publish(20.0, "上海", QList<QString>() << "分面甲", "active");
+    publish(30.0, "北京", QList<QString>() << "分面乙", "sold");
+    publish(40.0, "广州", QList<QString>(), "active");
+    publish(50.0, "北京", QList<QString>() << "分面甲", "sold");
+    
+    // 统计覆盖全部命中，不受分页影响
+    SearchCriteria criteria;
+    criteria.setCategoryId(1);
+    criteria.setMaxPrice(45.0);
+    criteria.setSortOrder(SearchCriteria::SortByPriceAscending);
+    criteria.setPage(0, 2);
+    SearchFacets facets;
+    ProductPage page = manager.searchProductPage(criteria, &facets);
+    EXPECT_EQ(page.getProducts().size(), 2);
+    EXPECT_EQ(facets.getTotal(), 4);
+    EXPECT_EQ(facets.getCategoryCounts().value(1), 4);
+    EXPECT_EQ(facets.getStatusCounts().value("active"), 3);
+    EXPECT_EQ(facets.getStatusCounts().value("sold"), 1);
+    EXPECT_EQ(facets.getLocationCounts().value("北京"), 2);
+    EXPECT_EQ(facets.getLocationCounts().value("广州"), 1);
+    EXPECT_EQ(facets.getTagCounts().value("分面甲"), 2);
+    EXPECT_EQ(facets.getTagCounts().value("分面乙"), 2);
+    
+    // 翻页时统计不变，结果与不统计时一致
+    criteria.setCursor(page.getNextCursor());
+    SearchFacets nextFacets;
+    QList<Product> rest = manager.searchProducts(criteria, &nextFacets);
+    QList<Product> plain = manager.searchProducts(criteria);
+    EXPECT_EQ(nextFacets.getTotal(), 4);
+    ASSERT_EQ(rest.size(), 2);
+    ASSERT_EQ(plain.size(), 2);
+    EXPECT_EQ(rest.at(0).getProductId(), ids.at(2));
+    EXPECT_EQ(plain.at(0).getProductId(), ids.at(2));
+    
+    // 标签条件由位图驱动
+    SearchCriteria tagged;
+    tagged.setTags(QList<QString>() << "分面甲");
+    SearchFacets taggedFacets;
+    manager.searchProducts(tagged, &taggedFacets);
+    EXPECT_EQ(taggedFacets.getTotal(), 3);
+    EXPECT_EQ(taggedFacets.getStatusCounts().value("sold"), 1);
+    EXPECT_EQ(taggedFacets.getTagCounts().value("分面乙"), 1);
+    
+    // 没有筛选条件时直接取索引中的集合大小
+    SearchFacets allFacets;
+    manager.searchProducts(SearchCriteria(), &allFacets);
+    EXPECT_EQ(allFacets.getTotal(), manager.getAllProducts().size());
+    EXPECT_EQ(allFacets.getCategoryCounts().value(1), 5);
+    EXPECT_EQ(allFacets.getTagCounts(), manager.getTagCounts());
+}
+
+TEST_F(ProductManagerIntegrationTest, QueryPlannerChoosesSelectiveAccess) {
+    QDateTime now = QDateTime::currentDateTime();
+    QList<int> ids;
+    for (int i = 0; i < 300; ++i) {
+        const int sellerId = i % 100 == 0 ? 8710 : 8711;
+        Product listing(0, QString("plannerword 商品%1").arg(i), 1, "", 10.0 + i, sellerId,
+                        "北京", QList<QString>() << (i % 2 ? "计划甲" : "计划乙"), now, "active");
+        int productId = 0;
+        ASSERT_TRUE(productRepo.save(listing, &productId));
+        ids.append(productId);
+    }
+    
+    // 宽泛的关键词配合很窄的卖家条件：从卖家集合出发，关键词逐个探测
+    SearchCriteria narrow;
+    narrow.setKeyword("plannerword");
+    narrow.setSellerId(8710);
+    QString plan = manager.explainSearch(narrow);
+    EXPECT_TRUE(plan.contains("取得：卖家=8710")) << plan.toStdString();
+    QList<Product> found = manager.searchProducts(narrow);
+    ASSERT_EQ(found.size(), 3);
+    EXPECT_EQ(found.at(0).getProductId(), ids.at(0));
+    EXPECT_EQ(found.at(2).getProductId(), ids.at(200));
+    
+    // 按价格排序且只取一页时沿价格索引输出
+    SearchCriteria cheapest;
+    cheapest.setCategoryId(1);
+    cheapest.setSortOrder(SearchCriteria::SortByPriceAscending);
+    cheapest.setPage(0, 5);
+    plan = manager.explainSearch(cheapest);
+    EXPECT_TRUE(plan.contains("取得：价格索引")) << plan.toStdString();
+    found = manager.searchProducts(cheapest);
+    ASSERT_EQ(found.size(), 5);
+    EXPECT_EQ(found.at(0).getProductId(), ids.at(0));
+    
+    // 不同计划给出的结果一致
+    SearchCriteria tagged;
+    tagged.setKeyword("plannerword");
+    tagged.setTags(QList<QString>() << "计划甲");
+    tagged.setMaxPrice(60.0);
+    QList<Product> byTags = manager.searchProducts(tagged);
+    ASSERT_EQ(byTags.size(), 25);
+    for (const Product& product : byTags) {
+        EXPECT_TRUE(product.getTags().contains("计划甲"));
+        EXPECT_LE(product.getPrice(), 60.0);
+    }
+    
+    SearchCriteria missing;
+    missing.setSellerId(8719);
+    EXPECT_TRUE(manager.explainSearch(missing).startsWith("结果为空"));
+}
+
+TEST_F(ProductManagerIntegrationTest, SearchResultCacheInvalidation) {
+    QDateTime now = QDateTime::currentDateTime();
+    QList<int> ids;
+    for (int i = 0; i < 4; ++i) {
+        Product listing(0, "缓存测试", i < 2 ? 1 : 2, "", 10.0 + i, 0, "北京", QList<QString>() << "缓存标签", now,
+                        "active");
+        int productId = 0;
+        ASSERT_TRUE(manager.publishProduct(listing, 2, &productId));
+        ids.append(productId);
+    }
+    
+    SearchCriteria first;
+    first.setCategoryId(1);
+    SearchCriteria second;
+    second.setCategoryId(2);
+    const SearchResultCache& cache = manager.getSearchCache();
+    const qint64 misses = cache.missCount();
+    EXPECT_EQ(manager.searchProducts(first).size(), 2);
+    EXPECT_EQ(manager.searchProducts(second).size(), 2);
+    EXPECT_EQ(cache.missCount(), misses + 2);
+    
+    // 重复的搜索命中缓存，规范化后等价的条件共用一条结果
+    const qint64 hits = cache.hitCount();
+    EXPECT_EQ(manager.searchProducts(first).size(), 2);
+    SearchCriteria reordered;
+    reordered.setTags(QList<QString>() << "缓存标签" << "缓存标签");
+    reordered.setCategoryId(2);
+    SearchCriteria tagged;
+    tagged.setCategoryId(2);
+    tagged.setTags(QList<QString>() << "缓存标签");
+    manager.searchProducts(tagged);
+    EXPECT_EQ(manager.searchProducts(reordered).size(), 2);
+    EXPECT_EQ(cache.hitCount(), hits + 2);
+    
+    // 分类1中的新商品只淘汰分类1的结果
+    Product added(0, "缓存测试", 1, "", 20.0, 0, "北京", QList<QString>(), now, "active");
+    int productId = 0;
+    ASSERT_TRUE(manager.publishProduct(added, 2, &productId));
+    ids.append(productId);
+    const qint64 hitsBefore = cache.hitCount();
+    EXPECT_EQ(manager.searchProducts(first).size(), 3);
+    EXPECT_EQ(manager.searchProducts(second).size(), 2);
+    EXPECT_EQ(cache.hitCount(), hitsBefore + 1);
+    
+    // 直接通过仓库修改结果中的商品同样会淘汰
+    Product moved = productRepo.findById(ids.at(2));
+    moved.setPrice(99.0);
+    ASSERT_TRUE(productRepo.update(moved));
+    QList<Product> refreshed = manager.searchProducts(second);
+    ASSERT_EQ(refreshed.size(), 2);
+    EXPECT_DOUBLE_EQ(refreshed.at(0).getPrice(), 99.0);
+    
+    // 超出内存预算时淘汰最久未使用的结果
+    manager.setSearchCacheBudget(0);
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_EQ(cache.memoryUsage(), 0);
+    manager.setSearchCacheBudget(SearchResultCache::kDefaultMemoryBudget);
+}
+
+TEST_F(ProductManagerIntegrationTest, SubtreeSearchCacheFollowsCategoryMoves) {
+    // 电子产品(1)下有手机(2)，配件(3)是顶级分类
+    ASSERT_TRUE(productRepo.addCategory(1, "电子产品"));
+    ASSERT_TRUE(productRepo.addCategory(2, "手机", 1));
+    ASSERT_TRUE(productRepo.addCategory(3, "配件"));
+    QDateTime now = QDateTime::currentDateTime();
+    for (int categoryId = 1; categoryId <= 3; ++categoryId) {
+        Product listing(0, "子树缓存", categoryId, "", 10.0, 0, "杭州", QList<QString>(), now, "active");
+        ASSERT_TRUE(manager.publishProduct(listing, 2));
+    }
+    
+    SearchCriteria subtree;
+    subtree.setCategoryId(1);
+    subtree.setIncludeSubcategories(true);
+    const SearchResultCache& cache = manager.getSearchCache();
+    EXPECT_EQ(manager.searchProducts(subtree).size(), 2);
+    const qint64 hits = cache.hitCount();
+    EXPECT_EQ(manager.searchProducts(subtree).size(), 2);
+    EXPECT_EQ(cache.hitCount(), hits + 1);
+    
+    // 分类移动不经过商品变更，缓存的子树结果靠写出分类树后的清空淘汰
+    const qint64 invalidations = cache.invalidationCount();
+    ASSERT_TRUE(productRepo.moveCategory(3, 1));
+    EXPECT_GT(cache.invalidationCount(), invalidations);
+    EXPECT_EQ(manager.searchProducts(subtree).size(), 3);
+    ASSERT_TRUE(productRepo.moveCategory(2, 3));
+    EXPECT_EQ(manager.searchProducts(subtree).size(), 3) << "移到子树内部的分类仍在子树中";
+    ASSERT_TRUE(productRepo.moveCategory(3, CategoryTree::kRoot));
+    EXPECT_EQ(manager.searchProducts(subtree).size(), 1);
+}
+
+TEST_F(ProductManagerIntegrationTest, RelevanceRankingTopK) {
+    QDateTime now = QDateTime::currentDateTime();
+    QList<int> ids;
+    auto publish = [&](const QString& title, const QString& description, const QList<QString>& tags, const QDateTime& time) {
+        Product listing(0, title, 1, description, 10.0, 0, "北京", tags, time, "active");
+        int productId = 0;
+        EXPECT_TRUE(manager.publishProduct(listing, 2, &productId));
+        ids.append(productId);
+        return ids.last();
+    };
+    const int inDescription = publish("普通商品", "附带 relevword 配件", QList<QString>(), now);
+    const int inTitle = publish("relevword 耳机", "九成新", QList<QString>(), now);
+    const int tagged = publish("普通商品", "附带 relevword 配件", QList<QString>() << "relevword", now);
+    const int old = publish("relevword 旧款", "relevword 说明", QList<QString>(), now.addDays(-30));
+    publish("无关商品", "没有关键词", QList<QString>(), now);
+    
+    // 标题中的命中高于标签中的命中，标签中的命中高于只在描述中的命中
+    SearchCriteria criteria;
+    criteria.setKeyword("relevword");
+    criteria.setCategoryId(1);
+    criteria.setSortOrder(SearchCriteria::SortByRelevance);
+    QList<Product> ranked = manager.searchProducts(criteria);
+    ASSERT_EQ(ranked.size(), 4);
+    EXPECT_EQ(ranked.at(0).getProductId(), old);
+    EXPECT_EQ(ranked.at(1).getProductId(), inTitle);
+    EXPECT_EQ(ranked.at(2).getProductId(), tagged);
+    EXPECT_EQ(ranked.at(3).getProductId(), inDescription);
+    EXPECT_TRUE(manager.explainSearch(criteria).contains("相关度"));
+    
+    // 按发布时间衰减后，30天前的商品排到最后
+    SearchCriteria decayed = criteria;
+    decayed.setRecencyHalfLife(1.0);
+    ranked = manager.searchProducts(decayed);
+    ASSERT_EQ(ranked.size(), 4);
+    EXPECT_EQ(ranked.at(0).getProductId(), inTitle);
+    EXPECT_EQ(ranked.at(3).getProductId(), old);
+    
+    // 按游标翻页的结果与一次取出的顺序一致
+    QList<int> paged;
+    SearchCriteria page = criteria;
+    page.setPage(0, 3);
+    for (int guard = 0; guard < 5; ++guard) {
+        ProductPage result = manager.searchProductPage(page);
+        for (const Product& product : result.getProducts()) {
+            paged.append(product.getProductId());
+        }
+        if (!result.hasNextPage()) {
+            break;
+        }
+        page.setCursor(result.getNextCursor());
+    }
+    EXPECT_EQ(paged, (QList<int>() << old << inTitle << tagged << inDescription));
+}
+
+TEST_F(ProductManagerIntegrationTest, FuzzyKeywordSearch) {
+    QDateTime now = QDateTime::currentDateTime();
+    QList<int> ids;
+    auto publish = [&](const QString& title, const QString& description) {
+        Product listing(0, title, 1, description, 10.0, 0, "北京", QList<QString>(), now, "active");
+        int productId = 0;
+        EXPECT_TRUE(manager.publishProduct(listing, 2, &productId));
+        ids.append(productId);
+        return ids.last();
+    };
+    const int exact = publish("Samsung Galaxy 手机", "九成新");
+    const int misspelled = publish("Samsnug 蓝牙耳机", "原装");
+    const int described = publish("国产平板", "屏幕由samsung供应");
+    const int other = publish("Apple iPhone", "国行");
+    
+    SearchCriteria criteria;
+    criteria.setKeyword("samsung");
+    criteria.setCategoryId(1);
+    EXPECT_EQ(manager.searchProducts(criteria).size(), 2);
+    
+    // 交换相邻字母是两处编辑，精确包含关键词的描述仍然命中
+    criteria.setFuzzyDistance(2);
+    QList<int> found;
+    for (const Product& product : manager.searchProducts(criteria)) {
+        found.append(product.getProductId());
+    }
+    EXPECT_EQ(found, (QList<int>() << exact << misspelled << described));
+    EXPECT_TRUE(manager.explainSearch(criteria).contains("模糊关键词"));
+    
+    SearchCriteria typo;
+    typo.setKeyword("iphnoe");
+    typo.setCategoryId(1);
+    typo.setFuzzyDistance(2);
+    QList<Product> phones = manager.searchProducts(typo);
+    ASSERT_EQ(phones.size(), 1);
+    EXPECT_EQ(phones.at(0).getProductId(), other);
+    
+    // 短单词只允许一处编辑
+    SearchCriteria shortWord;
+    shortWord.setKeyword("appel");
+    shortWord.setCategoryId(1);
+    shortWord.setFuzzyDistance(2);
+    EXPECT_TRUE(manager.searchProducts(shortWord).isEmpty());
+}
+
+TEST_F(ProductManagerIntegrationTest, SearchSuggestionsByPrefix) {
+    QDateTime now = QDateTime::currentDateTime();
+    QList<int> ids;
+    auto publish = [&](const QString& title, const QList<QString>& tags) {
+        Product listing(0, title, 1, "", 10.0, 0, "北京", tags, now, "active");
+        int productId = 0;
+        EXPECT_TRUE(manager.publishProduct(listing, 2, &productId));
+        ids.append(productId);
+    };
+    publish("zqphone 九成新", QList<QString>() << "zqtag");
+    publish("zqphone", QList<QString>());
+    publish("ZQPhone zqpad", QList<QString>());
+    publish("zqpad", QList<QString>());
+    
+    // 按含有该字符串的商品数排序，前缀不区分大小写
+    EXPECT_EQ(manager.getSearchSuggestions("ZQ", 5), (QStringList() << "zqphone" << "zqpad" << "zqtag"));
+    EXPECT_EQ(manager.getSearchSuggestions("zqp", 1), (QStringList() << "zqphone"));
+    EXPECT_TRUE(manager.getSearchSuggestions("zqx", 5).isEmpty());
+    EXPECT_GT(productRepo.suggestionMemoryUsage(), 0);
+    
+    // 删除商品后热度随之降低，热度为0的字符串不再出现
+    manager.deleteProduct(ids.at(0), 2);
+    manager.deleteProduct(ids.at(1), 2);
+    EXPECT_EQ(manager.getSearchSuggestions("zq", 5), (QStringList() << "zqpad" << "zqphone"));
+    
+    // 大量字符串的热度降为0后重建，回收其节点和文字
+    const qint64 baseline = productRepo.suggestionMemoryUsage();
+    QList<int> temporary;
+    for (int i = 0; i < 2000; ++i) {
+        Product listing(0, QString("zqtemp%1").arg(i), 1, "", 10.0, 0, "北京", QList<QString>(), now, "active");
+        int productId = 0;
+        ASSERT_TRUE(manager.publishProduct(listing, 2, &productId));
+        temporary.append(productId);
+    }
+    const qint64 peak = productRepo.suggestionMemoryUsage();
+    EXPECT_EQ(manager.getSearchSuggestions("zqtemp1999", 1), (QStringList() << "zqtemp1999"));
+    for (int productId : temporary) {
+        ASSERT_TRUE(manager.deleteProduct(productId, 2));
+    }
+    EXPECT_LT(productRepo.suggestionMemoryUsage(), baseline + (peak - baseline) / 4);
+    EXPECT_TRUE(manager.getSearchSuggestions("zqtemp", 5).isEmpty());
+    EXPECT_EQ(manager.getSearchSuggestions("zq", 5), (QStringList() << "zqpad" << "zqphone"));
+}
+
+TEST_F(ProductManagerIntegrationTest, PinyinKeywordSearch) {
+    QDateTime now = QDateTime::currentDateTime();
+    QList<int> ids;
+    auto publish = [&](const QString& title) {
+        Product listing(0, title, 1, "", 10.0, 0, "北京", QList<QString>(), now, "active");
+        int productId = 0;
+        EXPECT_TRUE(manager.publishProduct(listing, 2, &productId));
+        ids.append(productId);
+        return ids.last();
+    };
+    auto found = [&](const QString& keyword) {
+        SearchCriteria criteria;
+        criteria.setKeyword(keyword);
+        criteria.setCategoryId(1);
+        criteria.setPinyinMatching(true);
+        QList<int> result;
+        for (const Product& product : manager.searchProducts(criteria)) {
+            result.append(product.getProductId());
+        }
+        return result;
+    };
+    const int phone = publish("小米手机 全新");
+    const int shelf = publish("实木书架");
+    publish("蓝牙耳机");
+    
+    SearchCriteria plain;
+    plain.setKeyword("shouji");
+    plain.setCategoryId(1);
+    EXPECT_TRUE(manager.searchProducts(plain).isEmpty());
+    
+    // 全拼和首字母都能命中，每个单词分别匹配
+    EXPECT_EQ(found("shouji"), (QList<int>() << phone));
+    EXPECT_EQ(found("SJ"), (QList<int>() << phone << shelf));
+    EXPECT_EQ(found("xiaomi sj"), (QList<int>() << phone));
+    EXPECT_EQ(found("手机"), (QList<int>() << phone));
+    EXPECT_TRUE(found("shoujia").isEmpty());
+    
+    plain.setPinyinMatching(true);
+    EXPECT_TRUE(manager.explainSearch(plain).contains("拼音"));
+    
+    // 新发布和修改标题后同步更新，缓存的结果随之失效
+    const int second = publish("华为手机");
+    EXPECT_EQ(found("shouji"), (QList<int>() << phone << second));
+    Product renamed = productRepo.findById(phone);
+    renamed.setTitle("小米平板");
+    EXPECT_TRUE(manager.editProduct(phone, renamed, 2));
+    EXPECT_EQ(found("shouji"), (QList<int>() << second));
+    EXPECT_EQ(found("pingban"), (QList<int>() << phone));
+}
+
+TEST_F(ProductManagerIntegrationTest, RegionScopedSearch) {
+    QDateTime now = QDateTime::currentDateTime();
+    QList<int> ids;
+    auto publish = [&](const QString& location) {
+        Product listing(0, "二手自行车", 1, "", 10.0, 0, location, QList<QString>(), now, "active");
+        int productId = 0;
+        EXPECT_TRUE(manager.publishProduct(listing, 2, &productId));
+        ids.append(productId);
+        return ids.last();
+    };
+    auto found = [&](const QString& region) {
+        SearchCriteria criteria;
+        criteria.setRegion(region);
+        criteria.setCategoryId(1);
+        QList<int> result;
+        for (const Product& product : manager.searchProducts(criteria)) {
+            result.append(product.getProductId());
+        }
+        return result;
+    };
+    const int haidian = publish("北京市海淀区");
+    const int chaoyang = publish("北京/朝阳");
+    const int shortName = publish("海淀");
+    const int city = publish("北京");
+    const int shanghai = publish("上海市浦东新区");
+    const int unknown = publish("火星基地");
+    
+    // 地区包括全部下级地区，简称、全称和省略上级的写法等价
+    EXPECT_EQ(found("北京"), (QList<int>() << haidian << chaoyang << shortName << city));
+    EXPECT_EQ(found("北京市"), found("北京"));
+    EXPECT_EQ(found("北京/海淀"), (QList<int>() << haidian << shortName));
+    EXPECT_EQ(found("海淀区"), (QList<int>() << haidian << shortName));
+    EXPECT_EQ(found("上海"), (QList<int>() << shanghai));
+    EXPECT_TRUE(found("广东").isEmpty());
+    
+    // 无法识别的地址只能精确匹配
+    EXPECT_EQ(found("火星基地"), (QList<int>() << unknown));
+    EXPECT_TRUE(found("火星").isEmpty());
+    
+    // 原有的地址条件仍然精确匹配
+    SearchCriteria exact;
+    exact.setLocation("北京");
+    exact.setCategoryId(1);
+    EXPECT_EQ(manager.searchProducts(exact).size(), 1);
+    
+    SearchCriteria criteria;
+    criteria.setRegion("北京");
+    EXPECT_TRUE(manager.explainSearch(criteria).contains("地区=北京"));
+    
+    // 新发布和修改地址后同步更新，缓存的结果随之失效
+    const int xicheng = publish("北京西城区");
+    EXPECT_EQ(found("北京").size(), 5);
+    Product moved = productRepo.findById(haidian);
+    moved.setLocation("上海");
+    EXPECT_TRUE(manager.editProduct(haidian, moved, 2));
+    EXPECT_EQ(found("北京"), (QList<int>() << chaoyang << shortName << city << xicheng));
+    EXPECT_EQ(found("上海"), (QList<int>() << haidian << shanghai));
+}
+
+TEST_F(ProductManagerIntegrationTest, CategorySubtreeSearch) {
+    // 电子产品(1)下有手机(2)和电脑(3)，配件(4)是顶级分类
+    ASSERT_TRUE(productRepo.addCategory(1, "电子产品"));
+    ASSERT_TRUE(productRepo.addCategory(2, "手机", 1));
+    ASSERT_TRUE(productRepo.addCategory(3, "电脑", 1));
+    ASSERT_TRUE(productRepo.addCategory(4, "配件"));
+    EXPECT_FALSE(productRepo.addCategory(2, "重复", 4));
+    EXPECT_FALSE(productRepo.moveCategory(1, 2)) << "不能移动到自己的下级之下";
+    
+    QDateTime now = QDateTime::currentDateTime();
+    for (int categoryId = 1; categoryId <= 4; ++categoryId) {
+        Product listing(0, "分类商品", categoryId, "", 10.0, 0, "杭州", QList<QString>(), now, "active");
+        EXPECT_TRUE(manager.publishProduct(listing, 2));
+    }
+    auto found = [&](int categoryId, bool subcategories, SearchCriteria::SortOrder sortOrder) {
+        SearchCriteria criteria;
+        criteria.setCategoryId(categoryId);
+        criteria.setIncludeSubcategories(subcategories);
+        criteria.setSortOrder(sortOrder);
+        QList<int> result;
+        for (const Product& product : manager.searchProducts(criteria)) {
+            result.append(product.getCategoryId());
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    };
+    
+    // 包括下级分类时命中整棵子树，否则只匹配分类本身
+    EXPECT_EQ(found(1, true, SearchCriteria::SortByProductId), (QList<int>() << 1 << 2 << 3));
+    EXPECT_EQ(found(1, true, SearchCriteria::SortByNewest), (QList<int>() << 1 << 2 << 3));
+    EXPECT_EQ(found(1, false, SearchCriteria::SortByProductId), (QList<int>() << 1));
+    EXPECT_EQ(found(2, true, SearchCriteria::SortByProductId), (QList<int>() << 2));
+    
+    SearchCriteria criteria;
+    criteria.setCategoryId(1);
+    criteria.setIncludeSubcategories(true);
+    EXPECT_TRUE(manager.explainSearch(criteria).contains("分类子树=1"));
+    
+    // 移动分类后缓存的结果失效，搜索索引不需要重建
+    ASSERT_TRUE(productRepo.moveCategory(3, 4));
+    EXPECT_TRUE(productRepo.categoryTree().isWithin(4, 3));
+    EXPECT_EQ(found(1, true, SearchCriteria::SortByProductId), (QList<int>() << 1 << 2));
+    EXPECT_EQ(found(4, true, SearchCriteria::SortByProductId), (QList<int>() << 3 << 4));
+    
+    // 分类树与商品保存在同一个存储中
+    CategoryTree saved;
+    ASSERT_TRUE(saved.loadFromJson(FileProductStore().loadCategories()));
+    EXPECT_EQ(saved.category(3).parentId, 4);
+    EXPECT_EQ(saved.subtree(4), productRepo.categoryTree().subtree(4));
+    
+    // 删除分类不影响其中的商品
+    EXPECT_FALSE(productRepo.removeCategory(4)) << "有下级的分类不能删除";
+    for (int categoryId : {3, 2, 1, 4}) {
+        EXPECT_TRUE(productRepo.removeCategory(categoryId));
+    }
+    EXPECT_EQ(productRepo.categoryTree().size(), 0);
+    EXPECT_EQ(manager.getAllProducts().size(), 4);
+}
+
+TEST_F(ProductManagerIntegrationTest, ParallelFilteredScanIsDeterministic) {
+    QDateTime now = QDateTime::currentDateTime();
+    for (int i = 0; i < 6000; ++i) {
+        const QString description = QString("编号%1").arg(i) + (i % 3 == 0 ? "，附带原装充电器" : "");
+        Product listing(0, "批量商品", 1, description, i % 100, 2, "杭州", QList<QString>(), now.addSecs(i % 500),
+                        i % 2 == 0 ? "active" : "sold");
+        ASSERT_TRUE(productRepo.save(listing));
+    }
+    auto productIds = [](const QList<Product>& products) {
+        QList<int> result;
+        for (const Product& product : products) {
+            result.append(product.getProductId());
+        }
+        return result;
+    };
+    
+    // 分类、价格和状态都要逐个过滤全部候选，多线程的结果和顺序与单线程完全一致
+    QList<SearchCriteria> queries;
+    for (SearchCriteria::SortOrder sortOrder : {SearchCriteria::SortByProductId, SearchCriteria::SortByNewest,
+                                                SearchCriteria::SortByPriceDescending}) {
+        SearchCriteria criteria;
+        criteria.setCategoryId(1);
+        criteria.setMinPrice(10.0);
+        criteria.setStatus("active");
+        criteria.setSortOrder(sortOrder);
+        queries.append(criteria);
+    }
+    SearchCriteria paged = queries.first();
+    paged.setKeyword("原装充电器");
+    paged.setPage(0, 25);
+    queries.append(paged);
+    
+    for (const SearchCriteria& criteria : queries) {
+        productRepo.setScanThreadCount(1);
+        const QList<int> sequential = productIds(productRepo.search(criteria));
+        productRepo.setScanThreadCount(8);
+        EXPECT_EQ(productIds(productRepo.search(criteria)), sequential);
+    }
+    productRepo.setScanThreadCount(8);
+    EXPECT_EQ(productRepo.search(queries.first()).size(), 2700);
+    EXPECT_EQ(productRepo.search(paged).size(), 25);
+    EXPECT_TRUE(productRepo.explain(queries.first()).contains("8个线程"));
+    
+    // 逐页翻到最后，游标分页在多线程下同样不重不漏
+    SearchCriteria page = paged;
+    page.setPage(0, 400);
+    QList<int> collected;
+    do {
+        const ProductPage result = productRepo.searchPage(page);
+        collected += productIds(result.getProducts());
+        page.setCursor(result.getNextCursor());
+    } while (!page.getCursor().isEmpty());
+    productRepo.setScanThreadCount(1);
+    SearchCriteria all = paged;
+    all.setPage(0, -1);
+    EXPECT_EQ(collected, productIds(productRepo.search(all)));
+}
+
+TEST_F(ProductManagerIntegrationTest, ColumnarFiltersAndPriceAggregates) {
+    QDateTime now = QDateTime::currentDateTime();
+    QList<int> ids;
+    for (int i = 1; i <= 4; ++i) {
+        Product listing(0, "列存商品", 1, "", i * 10.0, 0, i % 2 == 0 ? "苏州" : "无锡", QList<QString>(), now,
+                        i <= 3 ? "active" : "sold");
+        int productId = 0;
+        EXPECT_TRUE(manager.publishProduct(listing, 2, &productId));
+        ids.append(productId);
+    }
+    
+    // 命中商品的价格聚合与分面在同一遍中读取价格列
+    SearchCriteria criteria;
+    criteria.setCategoryId(1);
+    SearchFacets facets;
+    manager.searchProducts(criteria, &facets);
+    EXPECT_EQ(facets.getTotal(), 4);
+    EXPECT_DOUBLE_EQ(facets.getMinPrice(), 10.0);
+    EXPECT_DOUBLE_EQ(facets.getMaxPrice(), 40.0);
+    EXPECT_DOUBLE_EQ(facets.getAveragePrice(), 25.0);
+    
+    // 卖家、状态和地址按槽位中的列比较
+    criteria.setSellerId(2);
+    criteria.setStatus("active");
+    criteria.setLocation("无锡");
+    QList<Product> result = manager.searchProducts(criteria, &facets);
+    ASSERT_EQ(result.size(), 2);
+    EXPECT_EQ(result.at(0).getProductId(), ids.at(0));
+    EXPECT_EQ(result.at(1).getProductId(), ids.at(2));
+    EXPECT_DOUBLE_EQ(facets.getAveragePrice(), 20.0);
+    criteria.setSellerId(3);
+    EXPECT_TRUE(manager.searchProducts(criteria).isEmpty());
+    
+    // 修改和删除后列同步更新
+    Product changed = productRepo.findById(ids.at(3));
+    changed.setPrice(100.0);
+    changed.setStatus("active");
+    EXPECT_TRUE(manager.editProduct(ids.at(3), changed, 2));
+    EXPECT_TRUE(manager.deleteProduct(ids.at(0), 2));
+    SearchCriteria category;
+    category.setCategoryId(1);
+    category.setStatus("active");
+    manager.searchProducts(category, &facets);
+    EXPECT_EQ(facets.getTotal(), 3);
+    EXPECT_DOUBLE_EQ(facets.getMinPrice(), 20.0);
+    EXPECT_DOUBLE_EQ(facets.getMaxPrice(), 100.0);
+    EXPECT_DOUBLE_EQ(facets.getAveragePrice(), 50.0);
+    
+    // 没有条件时顺序扫描整个价格列
+    SearchFacets allFacets;
+    manager.searchProducts(SearchCriteria(), &allFacets);
+    EXPECT_DOUBLE_EQ(allFacets.getMinPrice(), 20.0);
+    EXPECT_DOUBLE_EQ(allFacets.getMaxPrice(), 100.0);
+}
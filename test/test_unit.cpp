@@ -7,17 +7,25 @@
 #include <QJsonValue>
 #include <QFile>
 #include <QDir>
+#include <QBuffer>
+#include <QSaveFile>
 #include <QApplication>
 
 #include "ConfigManager.h"
 #include "Product.h"
+#include "ProductJsonReader.h"
+#include "ProductJsonWriter.h"
+#include "ProductSnapshot.h"
 #include "UserRepository.h"
+#include "SqliteUserStore.h"
 #include "User.h"
 #include "NormalUser.h"
 #include "Administrator.h"
 
 // 临时文件路径
 const QString TEMP_USER_FILE = QDir::tempPath() + "/test_users.json";
+const QString TEMP_SNAPSHOT_FILE = QDir::tempPath() + "/test_products.snap";
+const QString TEMP_DATABASE_FILE = QDir::tempPath() + "/test_users.db";
 
 class ProductTest : public ::testing::Test {
 protected:
@@ -420,3 +428,230 @@ TEST_F(UserRepositoryTest, BoundaryValues) {
     EXPECT_EQ(found->getRoleId(), 999999);
     EXPECT_EQ(found->getUsername(), "largeiduser");
 }
+
+// 新增测试：SQLite存储后端逐行保存用户
+TEST_F(UserRepositoryTest, SqliteStoreRoundTrip) {
+    QFile::remove(TEMP_DATABASE_FILE);
+    User* admin = new Administrator(1, 1, "admin", "secret");
+    User* normal = new NormalUser(2, 2, "normal", "password");
+    {
+        UserRepository sqliteRepo(std::unique_ptr<UserStore>(new SqliteUserStore(TEMP_DATABASE_FILE)));
+        sqliteRepo.addUser(admin);
+        sqliteRepo.addUser(normal);
+    }
+
+    UserRepository reopened(std::unique_ptr<UserStore>(new SqliteUserStore(TEMP_DATABASE_FILE)));
+    ASSERT_EQ(reopened.getAllUsers().size(), 2);
+    EXPECT_TRUE(reopened.checkUserRole(1, "admin"));
+    EXPECT_TRUE(reopened.checkUserRole(2, "normal"));
+    EXPECT_NE(reopened.validateUser("normal", "password"), nullptr);
+
+    for (User* user : reopened.getAllUsers()) {
+        delete user;
+    }
+    delete admin;
+    delete normal;
+    QFile::remove(TEMP_DATABASE_FILE);
+}
+
+// 新增测试：流式读取与DOM解析结果一致
+TEST_F(ProductTest, StreamingReaderMatchesDom) {
+    QJsonArray array;
+    array.append(Product::toJson(Product(1, "Title with \"quotes\" and\nnewlines", 2, "描述 \U0001F600", 99.99, 3,
+                                         "北京", tags, QDateTime::fromString("2024-05-01T08:30:00", Qt::ISODate), "active")));
+    array.append(Product::toJson(Product(2, "", 0, "", 0.0, 0, "", QList<QString>(), QDateTime(), "")));
+    QJsonObject extra = Product::toJson(Product(3, "Extra", 1, "d", 1.5, 1, "l", tags, time, "s"));
+    extra["unknown"] = QJsonArray({QJsonObject({{"nested", true}}), QJsonValue()});
+    array.append(extra);
+    array.append(QJsonValue(42));
+
+    QByteArray data = QJsonDocument(array).toJson();
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadOnly);
+
+    // 很小的读取块使字符串和转义序列跨越块边界
+    ProductJsonReader reader(&buffer, 7);
+    QList<Product> streamed;
+    ASSERT_TRUE(reader.read([&streamed](const Product& product) { streamed.append(product); }));
+    ASSERT_EQ(reader.productCount(), 3);
+
+    for (int i = 0; i < streamed.size(); i++) {
+        Product expected = Product::fromJson(array[i].toObject());
+        EXPECT_EQ(streamed[i].getProductId(), expected.getProductId());
+        EXPECT_EQ(streamed[i].getTitle(), expected.getTitle());
+        EXPECT_EQ(streamed[i].getCategoryId(), expected.getCategoryId());
+        EXPECT_EQ(streamed[i].getDescription(), expected.getDescription());
+        EXPECT_EQ(streamed[i].getPrice(), expected.getPrice());
+        EXPECT_EQ(streamed[i].getSellerId(), expected.getSellerId());
+        EXPECT_EQ(streamed[i].getLocation(), expected.getLocation());
+        EXPECT_EQ(streamed[i].getTags(), expected.getTags());
+        EXPECT_EQ(streamed[i].getPublicTime(), expected.getPublicTime());
+        EXPECT_EQ(streamed[i].getStatus(), expected.getStatus());
+    }
+}
+
+// 新增测试：流式读取错误处理
+TEST_F(ProductTest, StreamingReaderRejectsInvalidJson) {
+    const char* invalid[] = {"", "invalid json", "{\"not\":\"an array\"}", "[{\"title\":\"unterminated}]",
+                             "[{\"productId\":1},]", "[{\"productId\":1}] trailing"};
+    for (const char* text : invalid) {
+        QByteArray data(text);
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::ReadOnly);
+        ProductJsonReader reader(&buffer);
+        EXPECT_FALSE(reader.read([](const Product&) {})) << text;
+        EXPECT_FALSE(reader.errorString().isEmpty());
+    }
+
+    QByteArray empty("[ ]");
+    QBuffer buffer(&empty);
+    buffer.open(QIODevice::ReadOnly);
+    ProductJsonReader reader(&buffer);
+    EXPECT_TRUE(reader.read([](const Product&) {}));
+    EXPECT_EQ(reader.productCount(), 0);
+}
+
+// 新增测试：流式写入紧凑JSON并可往返读取
+TEST_F(ProductTest, StreamingWriterRoundTrip) {
+    QList<Product> products;
+    products.append(Product(1, "Title with \"quotes\"\tand\nnewlines\\", 2, QString("控制字符") + QChar(0x01), 99.99, 3,
+                            "北京", tags, QDateTime::fromString("2024-05-01T08:30:00", Qt::ISODate), "active"));
+    products.append(Product(2, "", 0, "", 0.1, 0, "", QList<QString>(), QDateTime(), ""));
+    products.append(Product(3, "Large", 999999, "d", 999999.99, -1, "l", tags, time, "s"));
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    // 很小的缓冲区使每个商品都触发一次写出
+    ProductJsonWriter writer(&buffer, 16);
+    ASSERT_TRUE(writer.begin());
+    for (const Product& product : products) {
+        ASSERT_TRUE(writer.write(product));
+    }
+    ASSERT_TRUE(writer.end());
+    buffer.close();
+    EXPECT_EQ(writer.productCount(), products.size());
+
+    // 紧凑格式：字符串之外没有换行
+    EXPECT_FALSE(data.contains('\n'));
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(data, &error);
+    ASSERT_EQ(error.error, QJsonParseError::NoError);
+    ASSERT_TRUE(doc.isArray());
+    EXPECT_EQ(doc.array().size(), products.size());
+
+    buffer.open(QIODevice::ReadOnly);
+    ProductJsonReader reader(&buffer);
+    QList<Product> loaded;
+    ASSERT_TRUE(reader.read([&loaded](const Product& product) { loaded.append(product); }));
+    ASSERT_EQ(loaded.size(), products.size());
+    for (int i = 0; i < products.size(); i++) {
+        EXPECT_EQ(loaded[i].getProductId(), products[i].getProductId());
+        EXPECT_EQ(loaded[i].getTitle(), products[i].getTitle());
+        EXPECT_EQ(loaded[i].getCategoryId(), products[i].getCategoryId());
+        EXPECT_EQ(loaded[i].getDescription(), products[i].getDescription());
+        EXPECT_EQ(loaded[i].getPrice(), products[i].getPrice());
+        EXPECT_EQ(loaded[i].getSellerId(), products[i].getSellerId());
+        EXPECT_EQ(loaded[i].getLocation(), products[i].getLocation());
+        EXPECT_EQ(loaded[i].getTags(), products[i].getTags());
+        EXPECT_EQ(loaded[i].getPublicTime(), Product::fromJson(doc.array()[i].toObject()).getPublicTime());
+        EXPECT_EQ(loaded[i].getStatus(), products[i].getStatus());
+    }
+}
+
+// 新增测试：二进制快照写入后按ID延迟解码
+TEST_F(ProductTest, BinarySnapshotRoundTrip) {
+    QHash<int, Product> products;
+    products.insert(7, Product(7, "标题", 2, "描述", 99.99, 3, "北京", tags,
+                               QDateTime::fromMSecsSinceEpoch(1714552200123), "active"));
+    products.insert(3, Product(3, "", 0, "", 0.0, 0, "", QList<QString>(), QDateTime(), ""));
+    products.insert(42, Product(42, "Other", 1, "d", 1.5, 1, "北京", tags, time, "active"));
+
+    QSaveFile file(TEMP_SNAPSHOT_FILE);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    ASSERT_TRUE(ProductSnapshot::write(&file, QList<int>() << 3 << 7 << 42,
+                                       [&products](int productId) { return products.value(productId); }));
+    ASSERT_TRUE(file.commit());
+
+    ProductSnapshot snapshot;
+    ASSERT_TRUE(snapshot.open(TEMP_SNAPSHOT_FILE));
+    EXPECT_EQ(snapshot.count(), 3);
+    EXPECT_EQ(snapshot.maxProductId(), 42);
+    EXPECT_FALSE(snapshot.contains(5));
+    EXPECT_EQ(snapshot.find(5).getProductId(), 0);
+
+    for (const Product& expected : products) {
+        Product found = snapshot.find(expected.getProductId());
+        EXPECT_EQ(found.getProductId(), expected.getProductId());
+        EXPECT_EQ(found.getTitle(), expected.getTitle());
+        EXPECT_EQ(found.getCategoryId(), expected.getCategoryId());
+        EXPECT_EQ(found.getDescription(), expected.getDescription());
+        EXPECT_EQ(found.getPrice(), expected.getPrice());
+        EXPECT_EQ(found.getSellerId(), expected.getSellerId());
+        EXPECT_EQ(found.getLocation(), expected.getLocation());
+        EXPECT_EQ(found.getTags(), expected.getTags());
+        EXPECT_EQ(found.getPublicTime(), expected.getPublicTime());
+        EXPECT_EQ(found.getStatus(), expected.getStatus());
+    }
+    snapshot.close();
+    QFile::remove(TEMP_SNAPSHOT_FILE);
+}
+
+// 新增测试：损坏或不完整的二进制快照被拒绝
+TEST_F(ProductTest, BinarySnapshotRejectsTruncatedFile) {
+    QSaveFile file(TEMP_SNAPSHOT_FILE);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    ASSERT_TRUE(ProductSnapshot::write(&file, QList<int>() << 1, [this](int productId) {
+        return Product(productId, "Title", 1, "Description", 1.0, 1, "Location", tags, time, "active");
+    }));
+    ASSERT_TRUE(file.commit());
+
+    // 截掉文件尾的最后一个字节，模拟写了一半的快照
+    QFile truncated(TEMP_SNAPSHOT_FILE);
+    ASSERT_TRUE(truncated.resize(truncated.size() - 1));
+
+    ProductSnapshot snapshot;
+    EXPECT_FALSE(snapshot.open(TEMP_SNAPSHOT_FILE));
+    EXPECT_FALSE(snapshot.isOpen());
+    EXPECT_EQ(snapshot.count(), 0);
+    EXPECT_FALSE(snapshot.open(QDir::tempPath() + "/missing_products.snap"));
+    QFile::remove(TEMP_SNAPSHOT_FILE);
+}
+
+// 新增测试：多线程读取与单线程读取结果一致
+TEST_F(ProductTest, ParallelReaderMatchesSequential) {
+    // 字符串中的括号、逗号和转义引号不能被当作切分点
+    QJsonArray array;
+    for (int i = 0; i < 6000; i++) {
+        QJsonObject obj = Product::toJson(Product(i + 1, QString("商品 [%1], {\"x\"}").arg(i), i % 7, QString(120, QChar('d')),
+                                                  i * 0.5, i % 13, "北京", tags, time, "active"));
+        if (i % 100 == 0) {
+            obj["extra"] = QJsonArray({QJsonObject({{"k", "]}"}}), 1});
+        }
+        array.append(obj);
+    }
+    QByteArray data = QJsonDocument(array).toJson();
+    ASSERT_GE(data.size(), ProductJsonReader::kMinParallelBytes);
+
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadOnly);
+    ProductJsonReader reader(&buffer);
+    QList<Product> sequential;
+    ASSERT_TRUE(reader.read([&sequential](const Product& product) { sequential.append(product); }));
+
+    QList<Product> parallel;
+    ASSERT_TRUE(ProductJsonReader::readParallel(data, 4, [&parallel](const Product& product) { parallel.append(product); }));
+    ASSERT_EQ(parallel.size(), sequential.size());
+    for (int i = 0; i < sequential.size(); i++) {
+        EXPECT_EQ(parallel[i].getProductId(), sequential[i].getProductId());
+        EXPECT_EQ(parallel[i].getTitle(), sequential[i].getTitle());
+        EXPECT_EQ(parallel[i].getPrice(), sequential[i].getPrice());
+    }
+
+    // 任一段出错时整体失败
+    QByteArray broken = data;
+    broken[broken.size() * 3 / 4] = '\x01';
+    QString error;
+    EXPECT_FALSE(ProductJsonReader::readParallel(broken, 4, [](const Product&) {}, &error));
+    EXPECT_FALSE(error.isEmpty());
+}